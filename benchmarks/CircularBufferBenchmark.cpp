@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "CircularBuffer.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::size_t CAPACITY   = 1024;
+constexpr std::size_t BATCH_SIZE = 64;
+
+} // namespace
+
+// Every thread pushes and pops, all of them fight for one mutex
+static void BM_CircularBufferPushPop(benchmark::State &state)
+{
+    static CircularBuffer<uint64_t> buffer { CAPACITY };
+
+    uint64_t value = 0;
+    for (auto _: state) {
+        buffer.push(value++);
+        benchmark::DoNotOptimize(buffer.pop());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CircularBufferPushPop)->ThreadRange(1, 8)->UseRealTime();
+
+// The same with one lock for BATCH_SIZE elements
+static void BM_CircularBufferBatch(benchmark::State &state)
+{
+    static CircularBuffer<uint64_t> buffer { CAPACITY };
+
+    std::vector<uint64_t> in(BATCH_SIZE);
+    std::vector<uint64_t> out;
+    out.reserve(BATCH_SIZE);
+
+    for (auto _: state) {
+        buffer.push(std::span<const uint64_t> { in });
+        benchmark::DoNotOptimize(buffer.pop(out, BATCH_SIZE));
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(BATCH_SIZE));
+}
+BENCHMARK(BM_CircularBufferBatch)->ThreadRange(1, 8)->UseRealTime();
+
+// One producer and one consumer waiting on the condition variable, as the
+// send thread of a connection does
+static void BM_CircularBufferProducerConsumer(benchmark::State &state)
+{
+    CircularBuffer<uint64_t> buffer { CAPACITY };
+    std::atomic_bool         stop { false };
+    std::atomic<int64_t>     consumed { 0 };
+
+    std::thread consumer { [&] {
+        std::vector<uint64_t> out;
+        out.reserve(BATCH_SIZE);
+        while (!stop) {
+            consumed += static_cast<int64_t>(buffer.pop(out, BATCH_SIZE, 1ms));
+        }
+    } };
+
+    uint64_t value = 0;
+    for (auto _: state) {
+        buffer.push(value++);
+    }
+
+    stop = true;
+    consumer.join();
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["consumed"] = static_cast<double>(consumed) / static_cast<double>(value);
+}
+BENCHMARK(BM_CircularBufferProducerConsumer)->UseRealTime();
@@ -0,0 +1,39 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "ColorConvert.h"
+
+using namespace video;
+using namespace video::encode_video;
+
+// Whole frame converted, as after a scene change
+static void BM_ConvertBgraToI420(benchmark::State &state)
+{
+    const auto width  = static_cast<std::uint32_t>(state.range(0));
+    const auto height = static_cast<std::uint32_t>(state.range(1));
+
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(width) * height * 4);
+    for (std::size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = static_cast<std::uint8_t>(i * 7);
+    }
+
+    const FrameView frame { pixels.data(), width, height, width * 4, 4 };
+    I420Frame       out;
+
+    for (auto _: state) {
+        convertBgraToI420(frame, out);
+        benchmark::DoNotOptimize(out.y.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(pixels.size()));
+    state.counters["fps"] = benchmark::Counter(
+            static_cast<double>(state.iterations()),
+            benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_ConvertBgraToI420)
+        ->Args({ 1280, 720 })
+        ->Args({ 1920, 1080 })
+        ->Args({ 3840, 2160 })
+        ->Unit(benchmark::kMillisecond);
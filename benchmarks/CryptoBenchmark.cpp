@@ -0,0 +1,37 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "AesGcm.h"
+#include "WireHeader.h"
+
+using namespace pirks::networking;
+
+// Sealing of one packet payload with its header as associated data, on one core
+static void BM_AesGcmSeal(benchmark::State &state)
+{
+    if (!crypto::isAvailable()) {
+        state.SkipWithError("built without OpenSSL");
+        return;
+    }
+
+    crypto::AesGcm aes { crypto::generateSessionKey() };
+
+    std::vector<uint8_t>                   packet(static_cast<std::size_t>(state.range(0)), 0x5A);
+    std::array<uint8_t, wire::HEADER_SIZE> header {};
+    std::array<uint8_t, crypto::TAG_SIZE>  tag {};
+    uint64_t                               index = 0;
+
+    for (auto _: state) {
+        if (!aes.seal(header, packet, tag, index++)) {
+            state.SkipWithError("sealing failed");
+            break;
+        }
+        benchmark::DoNotOptimize(tag.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AesGcmSeal)->Arg(256)->Arg(1392);
@@ -0,0 +1,101 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <iomanip>
+#include <numeric>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "memory_utils.h"
+
+namespace {
+
+// Implementation with iostreams which was replaced by the lookup tables, kept to compare with
+std::string dumpWithStringstream(std::span<const std::uint8_t> data, const std::string &prefix)
+{
+    std::stringstream ss;
+
+    for (size_t i = 0; i < data.size(); i += 16) {
+        ss << prefix;
+        ss << std::hex << std::setw(8) << std::setfill('0') << i << ": ";
+
+        for (size_t j = 0; j < 16; ++j) {
+            if (i + j < data.size()) {
+                ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(data[i + j])
+                   << " ";
+            } else {
+                ss << "   ";
+            }
+            if (j == 7) {
+                ss << " ";
+            }
+        }
+
+        ss << " |";
+        for (size_t j = 0; j < 16; ++j) {
+            if (i + j < data.size()) {
+                char c = static_cast<char>(data[i + j]);
+                ss << (c >= 32 && c <= 126 ? c : '.');
+            } else {
+                ss << " ";
+            }
+            if (j == 7) {
+                ss << " ";
+            }
+        }
+        ss << "|\n";
+    }
+
+    return ss.str();
+}
+
+auto makeData(benchmark::State &state) -> std::vector<std::uint8_t>
+{
+    std::vector<std::uint8_t> data(static_cast<std::size_t>(state.range(0)));
+    std::iota(data.begin(), data.end(), std::uint8_t { 0 });
+    return data;
+}
+
+} // namespace
+
+static void BM_DumpMemoryStringstream(benchmark::State &state)
+{
+    const auto data = makeData(state);
+
+    for (auto _: state) {
+        benchmark::DoNotOptimize(dumpWithStringstream(std::span { data }, "> "));
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DumpMemoryStringstream)->RangeMultiplier(8)->Range(64, 64 << 10);
+
+static void BM_DumpMemoryToString(benchmark::State &state)
+{
+    const auto data = makeData(state);
+
+    for (auto _: state) {
+        benchmark::DoNotOptimize(memory_utils::dumpMemoryToString(std::span { data }, "> "));
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DumpMemoryToString)->RangeMultiplier(8)->Range(64, 64 << 10);
+
+// Buffer is reused, as by code which dumps every packet
+static void BM_DumpMemoryToBuffer(benchmark::State &state)
+{
+    const auto         data = makeData(state);
+    fmt::memory_buffer buffer;
+
+    for (auto _: state) {
+        buffer.clear();
+        memory_utils::dumpMemory(data, buffer, "> ");
+        benchmark::DoNotOptimize(buffer.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DumpMemoryToBuffer)->RangeMultiplier(8)->Range(64, 64 << 10);
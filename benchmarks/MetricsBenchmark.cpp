@@ -0,0 +1,50 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+
+#include "Counter.h"
+#include "Histogram.h"
+
+using namespace pirks::metrics;
+
+// Each thread records into its own shard, so it should not slow down with threads
+static void BM_HistogramRecord(benchmark::State &state)
+{
+    static Histogram histogram;
+
+    uint64_t value = 1000;
+    for (auto _: state) {
+        histogram.record(value);
+        value = value * 3 % 1'000'003;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HistogramRecord)->ThreadRange(1, 8)->UseRealTime();
+
+// Two clock reads and a record, the usual cost of a timed stage
+static void BM_ScopedTimer(benchmark::State &state)
+{
+    static Histogram histogram;
+
+    for (auto _: state) {
+        ScopedTimer timer { histogram };
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScopedTimer)->ThreadRange(1, 8)->UseRealTime();
+
+// All threads increment one cache line
+static void BM_CounterAdd(benchmark::State &state)
+{
+    static Counter counter;
+
+    for (auto _: state) {
+        counter.add();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CounterAdd)->ThreadRange(1, 8)->UseRealTime();
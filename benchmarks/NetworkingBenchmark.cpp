@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "UDPConnection.h"
+#include "UdpSocket.h"
+#include "WireHeader.h"
+
+// TCPConnection is not implemented yet, only UDP can be measured
+
+using namespace pirks::networking;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::size_t BLOCK_SIZE  = 1400;
+constexpr std::size_t BLOCK_COUNT = 4096;
+
+auto loopback(uint16_t port) -> SocketAddress
+{
+    SocketAddress address;
+    address.address.sin_family      = AF_INET;
+    address.address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.address.sin_port        = htons(port);
+    return address;
+}
+
+} // namespace
+
+// Datagram sent and received on loopback, the floor for any connection
+static void BM_UdpSocketLoopback(benchmark::State &state)
+{
+    const auto size = static_cast<std::size_t>(state.range(0));
+
+    UdpSocket sender;
+    UdpSocket receiver;
+    sender.bind(0);
+    receiver.bind(0);
+    receiver.setReceiveTimeout(100ms);
+
+    const auto to = loopback(receiver.localPort());
+
+    std::vector<uint8_t>                                  datagram(size);
+    std::array<uint8_t, UDPConnection::MAX_DATAGRAM_SIZE> buffer {};
+    SocketAddress                                         from;
+
+    for (auto _: state) {
+        sender.sendTo(datagram, to);
+        if (!receiver.receiveFrom(buffer, from)) {
+            state.SkipWithError("datagram lost on loopback");
+            break;
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_UdpSocketLoopback)->Arg(256)->Arg(1200)->Arg(1472)->UseRealTime();
+
+// Unreliable video packets from a socket to in_packets of UDPConnection:
+// receive thread, header parsing and congestion feedback bookkeeping
+static void BM_UDPConnectionReceive(benchmark::State &state)
+{
+    const auto size = static_cast<std::size_t>(state.range(0));
+
+    // Every run connects a new sender, its messages are not interesting
+    spdlog::set_level(spdlog::level::warn);
+
+    auto pool = std::make_shared<PacketPool>(BLOCK_SIZE, BLOCK_COUNT, wire::PACKET_HEADROOM);
+    auto in   = std::make_shared<PacketsQueue>(BLOCK_COUNT);
+    auto out  = std::make_shared<PacketsQueue>(BLOCK_COUNT);
+
+    UDPConnection connection { 0, pool };
+    connection.create(in, out);
+
+    UdpSocket sender;
+    sender.bind(0);
+    const auto to = loopback(connection.localPort());
+
+    std::vector<uint8_t> datagram(wire::HEADER_SIZE + size);
+
+    PacketInfo packet;
+    packet.channel = Channel::Video;
+    packet.size    = static_cast<uint32_t>(size);
+
+    SequenceNumber sequence = 0;
+    for (auto _: state) {
+        wire::serialize(
+                wire::packetHeader(packet, sequence++),
+                std::span<uint8_t, wire::HEADER_SIZE> { datagram.data(), wire::HEADER_SIZE });
+        sender.sendTo(datagram, to);
+
+        const auto received = in->pop(100ms);
+        if (!received) {
+            state.SkipWithError("packet lost on loopback");
+            break;
+        }
+        pool->release(received->data);
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_UDPConnectionReceive)->Arg(256)->Arg(1200)->UseRealTime();
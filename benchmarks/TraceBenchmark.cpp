@@ -0,0 +1,28 @@
+#include <benchmark/benchmark.h>
+
+#include "Trace.h"
+
+using namespace pirks::trace;
+
+// Two clock reads and a store into the ring of the thread, should stay
+// well below 50 ns
+static void BM_TraceScope(benchmark::State &state)
+{
+    enable(state.range(0) != 0);
+
+    for (auto _: state) {
+        PIRKS_TRACE_SCOPE("benchmark", "scope");
+    }
+
+    enable(false);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TraceScope)->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_TraceNow(benchmark::State &state)
+{
+    for (auto _: state) {
+        benchmark::DoNotOptimize(now());
+    }
+}
+BENCHMARK(BM_TraceNow);
@@ -0,0 +1,25 @@
+#include "LatencyConfig.h"
+
+namespace pirks::config
+{
+
+void LatencyConfig::addOptions(CLI::App &args)
+{
+    Config::addOptions(args);
+
+    args.add_option("--width", width_, "Width of synthetic frames")
+            ->check(CLI::Range(64u, 7680u));
+    args.add_option("--height", height_, "Height of synthetic frames")
+            ->check(CLI::Range(64u, 4320u));
+    args.add_option("--fps", fps_, "Frames per second")->check(CLI::Range(1u, 240u));
+    args.add_option("--seconds", seconds_, "Duration of the measurement")
+            ->check(CLI::Range(1u, 3600u));
+    args.add_option("--warmup", warmupSeconds_, "Seconds at the start which are not measured");
+    args.add_option("--bitrate", bitrateKbps_, "Video bitrate in kbps")
+            ->check(CLI::Range(100u, 500000u));
+    args.add_option("--slices", sliceCount_, "Number of slices in one video frame")
+            ->check(CLI::Range(1u, 64u));
+    args.add_option("--json", jsonFile_, "Write results to this file as JSON");
+}
+
+}; // namespace pirks::config
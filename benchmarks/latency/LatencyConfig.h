@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Config.h"
+
+namespace pirks::config
+{
+
+/**
+ * @brief Options of the latency harness
+ */
+class LatencyConfig final: public Config
+{
+public:
+    auto width() const -> uint32_t
+    {
+        return width_;
+    }
+
+    auto height() const -> uint32_t
+    {
+        return height_;
+    }
+
+    auto fps() const -> uint32_t
+    {
+        return fps_;
+    }
+
+    auto seconds() const -> uint32_t
+    {
+        return seconds_;
+    }
+
+    auto warmupSeconds() const -> uint32_t
+    {
+        return warmupSeconds_;
+    }
+
+    auto bitrateKbps() const -> uint32_t
+    {
+        return bitrateKbps_;
+    }
+
+    auto sliceCount() const -> uint32_t
+    {
+        return sliceCount_;
+    }
+
+    auto jsonFile() const -> const std::string &
+    {
+        return jsonFile_;
+    }
+
+protected:
+    void addOptions(CLI::App &args) override;
+
+private:
+    uint32_t width_ { 1920 };
+    uint32_t height_ { 1080 };
+    uint32_t fps_ { 60 };
+    uint32_t seconds_ { 10 };
+    uint32_t warmupSeconds_ { 1 };
+    uint32_t bitrateKbps_ { 20000 };
+    uint32_t sliceCount_ { 4 };
+
+    // Results are also written here as JSON, if it's set
+    std::string jsonFile_;
+};
+
+}; // namespace pirks::config
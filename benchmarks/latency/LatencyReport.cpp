@@ -0,0 +1,97 @@
+#include "LatencyReport.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace pirks::latency
+{
+
+void LatencyReport::add(const std::string &stage, std::chrono::steady_clock::duration latency)
+{
+    auto it = std::find_if(stages_.begin(), stages_.end(), [&stage](const Stage &s) {
+        return s.name == stage;
+    });
+    if (it == stages_.end()) {
+        it = stages_.insert(stages_.end(), Stage { stage, {} });
+    }
+
+    it->samplesUs.push_back(
+            std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+}
+
+void LatencyReport::print() const
+{
+    std::printf(
+            "%-16s %8s %10s %10s %10s %10s\n",
+            "stage",
+            "count",
+            "p50 us",
+            "p99 us",
+            "p99.9 us",
+            "max us");
+
+    for (const auto &stage: stages_) {
+        const auto summary = summarize(stage);
+        std::printf(
+                "%-16s %8zu %10lld %10lld %10lld %10lld\n",
+                stage.name.c_str(),
+                summary.count,
+                static_cast<long long>(summary.p50),
+                static_cast<long long>(summary.p99),
+                static_cast<long long>(summary.p999),
+                static_cast<long long>(summary.max));
+    }
+}
+
+bool LatencyReport::writeJson(const std::string &file) const
+{
+    std::ofstream out { file };
+    if (!out) {
+        spdlog::error("Can't write latency report to {}", file);
+        return false;
+    }
+
+    out << "{\n  \"unit\": \"us\",\n  \"stages\": [";
+    for (std::size_t i = 0; i < stages_.size(); ++i) {
+        const auto summary = summarize(stages_[i]);
+        out << (i == 0 ? "\n" : ",\n")
+            << fmt::format(
+                       "    {{ \"name\": \"{}\", \"count\": {}, \"p50\": {}, \"p99\": {}, "
+                       "\"p99.9\": {}, \"max\": {} }}",
+                       stages_[i].name,
+                       summary.count,
+                       summary.p50,
+                       summary.p99,
+                       summary.p999,
+                       summary.max);
+    }
+    out << "\n  ]\n}\n";
+
+    return static_cast<bool>(out);
+}
+
+auto LatencyReport::summarize(const Stage &stage) -> Summary
+{
+    auto samples = stage.samplesUs;
+    if (samples.empty()) {
+        return {};
+    }
+    std::sort(samples.begin(), samples.end());
+
+    const auto percentile = [&samples](double p) {
+        return samples[static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1))];
+    };
+
+    Summary summary;
+    summary.count = samples.size();
+    summary.p50   = percentile(0.5);
+    summary.p99   = percentile(0.99);
+    summary.p999  = percentile(0.999);
+    summary.max   = samples.back();
+    return summary;
+}
+
+}; // namespace pirks::latency
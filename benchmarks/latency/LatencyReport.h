@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pirks::latency
+{
+
+/**
+ * @brief Latency samples of pipeline stages and their percentiles
+ *
+ * Stages are reported in the order they were first added.
+ */
+class LatencyReport final
+{
+public:
+    void add(const std::string &stage, std::chrono::steady_clock::duration latency);
+
+    /**
+     * @brief Print p50, p99, p99.9 and max of every stage in microseconds
+     */
+    void print() const;
+
+    /**
+     * @brief Write the same as JSON, false if the file can't be written
+     */
+    bool writeJson(const std::string &file) const;
+
+private:
+    struct Stage
+    {
+        std::string          name;
+        std::vector<int64_t> samplesUs;
+    };
+
+    struct Summary
+    {
+        std::size_t count { 0 };
+        int64_t     p50 { 0 };
+        int64_t     p99 { 0 };
+        int64_t     p999 { 0 };
+        int64_t     max { 0 };
+    };
+
+private:
+    static auto summarize(const Stage &stage) -> Summary;
+
+private:
+    std::vector<Stage> stages_;
+};
+
+}; // namespace pirks::latency
@@ -0,0 +1,132 @@
+#include "ReferenceReceiver.h"
+
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <cstring>
+
+#include "UDPConnection.h"
+#include "WireHeader.h"
+
+using namespace std::chrono_literals;
+
+namespace pirks::latency
+{
+
+using namespace ::pirks::networking;
+
+namespace {
+
+constexpr auto RECV_POLL_INTERVAL = 100ms;
+
+} // namespace
+
+ReferenceReceiver::ReferenceReceiver()
+        : stop_ { false }
+{
+}
+
+ReferenceReceiver::~ReferenceReceiver()
+{
+    stop();
+}
+
+void ReferenceReceiver::start(uint16_t server_port)
+{
+    socket_.bind(0);
+    socket_.setReceiveTimeout(RECV_POLL_INTERVAL);
+
+    SocketAddress server;
+    server.address.sin_family      = AF_INET;
+    server.address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    server.address.sin_port        = htons(server_port);
+
+    // Empty unreliable packet on the control channel
+    wire::Header header;
+    header.channel = Channel::Control;
+
+    std::array<uint8_t, wire::HEADER_SIZE> hello {};
+    wire::serialize(header, hello);
+    socket_.sendTo(hello, server);
+
+    recvThread_ = std::thread(recvThreadFunc, this);
+}
+
+void ReferenceReceiver::stop()
+{
+    stop_ = true;
+
+    if (recvThread_.joinable()) {
+        recvThread_.join();
+    }
+}
+
+auto ReferenceReceiver::videoFrames() const -> const std::vector<VideoFrame> &
+{
+    return videoFrames_;
+}
+
+auto ReferenceReceiver::audioLatency() const -> const std::vector<Clock::duration> &
+{
+    return audioLatency_;
+}
+
+void ReferenceReceiver::stampAudio(
+        std::span<uint8_t, AUDIO_STAMP_SIZE> payload,
+        Clock::time_point                    now)
+{
+    const int64_t stamp = now.time_since_epoch().count();
+    std::memcpy(payload.data(), &stamp, sizeof(stamp));
+}
+
+void ReferenceReceiver::recvThreadFunc(ReferenceReceiver *receiver)
+{
+    std::array<uint8_t, UDPConnection::MAX_DATAGRAM_SIZE> buffer;
+    SocketAddress                                         from;
+
+    while (!receiver->stop_) {
+        const auto size = receiver->socket_.receiveFrom(buffer, from);
+        if (!size) {
+            continue;
+        }
+        receiver->process({ buffer.data(), *size }, Clock::now());
+    }
+}
+
+void ReferenceReceiver::process(std::span<const uint8_t> datagram, Clock::time_point now)
+{
+    const auto header = wire::parse(datagram);
+    if (!header || (header->flags & (wire::Flags::Ack | wire::Flags::Feedback)) != 0) {
+        return;
+    }
+
+    if (header->channel == Channel::Audio && header->payloadSize >= AUDIO_STAMP_SIZE) {
+        int64_t stamp = 0;
+        std::memcpy(&stamp, datagram.data() + wire::HEADER_SIZE, sizeof(stamp));
+        audioLatency_.push_back(now - Clock::time_point { Clock::duration { stamp } });
+        return;
+    }
+
+    if (header->channel != Channel::Video) {
+        return;
+    }
+
+    // Datagrams of one frame come one after another, all with its timestamp
+    if (videoFrames_.empty() || videoFrames_.back().timestamp != header->timestamp) {
+        VideoFrame frame;
+        frame.timestamp    = header->timestamp;
+        frame.firstArrival = now;
+        videoFrames_.push_back(frame);
+    }
+
+    auto &frame       = videoFrames_.back();
+    frame.lastArrival = now;
+    ++frame.datagrams;
+
+    if (header->fragmentIndex + 1 == header->fragmentCount) {
+        ++frame.packets;
+        frame.expectedDatagrams += header->fragmentCount;
+    }
+}
+
+}; // namespace pirks::latency
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "UdpSocket.h"
+
+namespace pirks::latency
+{
+
+/**
+ * @brief Client side of the harness, records when datagrams of UDPConnection arrive
+ *
+ * It is not a real client: packets are neither reassembled nor decoded,
+ * only wire headers are parsed. Datagrams of video packets are grouped by
+ * frame timestamp, audio packets carry their send time in the payload.
+ */
+class ReferenceReceiver final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Size of the send time at the start of the payload of an audio packet
+    static constexpr std::size_t AUDIO_STAMP_SIZE = sizeof(int64_t);
+
+    /**
+     * @brief Datagrams of one video frame
+     *
+     * Frame is complete when every packet has arrived in all its fragments:
+     * packets == packets sent and datagrams == expectedDatagrams.
+     */
+    struct VideoFrame
+    {
+        uint32_t          timestamp { 0 }; ///< VIDEO_CLOCK_RATE, from the wire header
+        Clock::time_point firstArrival;
+        Clock::time_point lastArrival;
+        std::size_t       datagrams { 0 };
+        std::size_t       expectedDatagrams { 0 }; ///< Sum of fragment counts of packets
+        std::size_t       packets { 0 };           ///< Packets whose last fragment arrived
+    };
+
+public:
+    ReferenceReceiver();
+    ~ReferenceReceiver();
+
+public:
+    /**
+     * @brief Send the first datagram to the server, so it becomes its remote side
+     */
+    void start(uint16_t server_port);
+    void stop();
+
+    /**
+     * @brief Frames in order of arrival. Valid after stop()
+     */
+    [[nodiscard]]
+    auto videoFrames() const -> const std::vector<VideoFrame> &;
+
+    /**
+     * @brief Latency of every audio packet. Valid after stop()
+     */
+    [[nodiscard]]
+    auto audioLatency() const -> const std::vector<Clock::duration> &;
+
+    /**
+     * @brief Send time of an audio packet, to be written to its payload
+     */
+    static void stampAudio(std::span<uint8_t, AUDIO_STAMP_SIZE> payload, Clock::time_point now);
+
+private:
+    static void recvThreadFunc(ReferenceReceiver *receiver);
+
+    void process(std::span<const uint8_t> datagram, Clock::time_point now);
+
+private:
+    networking::UdpSocket socket_;
+    std::atomic_bool      stop_;
+    std::thread           recvThread_;
+
+    // Used only by receive thread until stop()
+    std::vector<VideoFrame>      videoFrames_;
+    std::vector<Clock::duration> audioLatency_;
+};
+
+}; // namespace pirks::latency
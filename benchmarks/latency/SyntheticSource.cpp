@@ -0,0 +1,47 @@
+#include "SyntheticSource.h"
+
+#include <algorithm>
+
+namespace pirks::latency
+{
+
+SyntheticSource::SyntheticSource(std::uint32_t width, std::uint32_t height)
+        : width_ { width }
+        , height_ { height }
+{
+    const auto boxSize = std::max(height_ / 8, 1u);
+    const auto step    = (width_ - boxSize) / FRAME_COUNT;
+
+    frames_.resize(FRAME_COUNT);
+    for (std::size_t i = 0; i < FRAME_COUNT; ++i) {
+        auto &pixels = frames_[i];
+        pixels.resize(static_cast<std::size_t>(width_) * height_ * 4);
+
+        const auto boxX = static_cast<std::uint32_t>(i) * step;
+        const auto boxY = (height_ - boxSize) / 2;
+
+        for (std::uint32_t y = 0; y < height_; ++y) {
+            auto *row = pixels.data() + static_cast<std::size_t>(y) * width_ * 4;
+            for (std::uint32_t x = 0; x < width_; ++x) {
+                auto *pixel = row + static_cast<std::size_t>(x) * 4;
+
+                if (x >= boxX && x < boxX + boxSize && y >= boxY && y < boxY + boxSize) {
+                    std::fill_n(pixel, 4, std::uint8_t { 255 });
+                    continue;
+                }
+
+                pixel[0] = static_cast<std::uint8_t>(x * 255 / width_);
+                pixel[1] = static_cast<std::uint8_t>(y * 255 / height_);
+                pixel[2] = 64;
+                pixel[3] = 255;
+            }
+        }
+    }
+}
+
+auto SyntheticSource::frame(std::size_t index) const -> video::FrameView
+{
+    return { frames_[index % FRAME_COUNT].data(), width_, height_, width_ * 4, 4 };
+}
+
+}; // namespace pirks::latency
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "FrameView.h"
+
+namespace pirks::latency
+{
+
+/**
+ * @brief Captured frames of a synthetic screen
+ *
+ * FRAME_COUNT BGRA frames are rendered up front: a gradient with a box
+ * moving across it, so every frame differs from the previous one in a few
+ * tiles like a desktop does, and rendering costs nothing while latency is
+ * measured.
+ */
+class SyntheticSource final
+{
+public:
+    static constexpr std::size_t FRAME_COUNT = 16;
+
+public:
+    SyntheticSource(std::uint32_t width, std::uint32_t height);
+
+public:
+    [[nodiscard]]
+    auto frame(std::size_t index) const -> video::FrameView;
+
+private:
+    std::uint32_t                          width_;
+    std::uint32_t                          height_;
+    std::vector<std::vector<std::uint8_t>> frames_;
+};
+
+}; // namespace pirks::latency
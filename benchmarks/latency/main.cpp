@@ -0,0 +1,285 @@
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ExitCode.h"
+#include "LatencyConfig.h"
+#include "LatencyReport.h"
+#include "ReferenceReceiver.h"
+#include "SyntheticSource.h"
+#include "UDPConnection.h"
+#include "VideoEncoderFactory.h"
+#include "VideoStream.h"
+#include "version.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+using namespace ::pirks;
+using namespace ::pirks::latency;
+using namespace ::pirks::networking;
+
+using Clock = std::chrono::steady_clock;
+
+// The same pools as the server has
+constexpr std::size_t PACKET_BLOCK_SIZE  = 1408;
+constexpr std::size_t PACKET_BLOCK_COUNT = 4096;
+constexpr std::size_t FRAME_BLOCK_SIZE   = 512 * 1024;
+constexpr std::size_t FRAME_BLOCK_COUNT  = 16;
+
+// Synthetic encoded audio, one packet every 10 ms
+constexpr auto        AUDIO_INTERVAL    = 10ms;
+constexpr std::size_t AUDIO_PACKET_SIZE = 160;
+
+// Time for the packets still in flight after the last frame
+constexpr auto DRAIN_TIME = 500ms;
+
+struct SubmittedFrame
+{
+    Clock::time_point         captured;  ///< When the frame was due from the source
+    Clock::time_point         submitted; ///< VideoStream::submit() was called
+    Clock::time_point         encoded;   ///< VideoStream::submit() returned
+    std::chrono::microseconds encodeTime { 0 };
+    std::size_t               packets { 0 };
+    bool                      measured { false }; ///< After warm-up
+};
+
+/**
+ * @brief Timestamp VideoStream gives to the packets of a frame encoded at this time
+ */
+auto videoTimestamp(Clock::time_point time) -> uint32_t
+{
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch());
+    return static_cast<uint32_t>(us.count() * VIDEO_CLOCK_RATE / 1'000'000);
+}
+
+void sendAudio(PacketsQueue &out_packets, PacketPool &pool, const std::atomic_bool &stop)
+{
+    auto due = Clock::now();
+    while (!stop) {
+        due += AUDIO_INTERVAL;
+        std::this_thread::sleep_until(due);
+
+        auto *block = out_packets.isFull() ? nullptr : pool.acquire();
+        if (block == nullptr) {
+            continue;
+        }
+
+        const auto now = Clock::now();
+        std::memset(block, 0, AUDIO_PACKET_SIZE);
+        ReferenceReceiver::stampAudio(
+                std::span<uint8_t, ReferenceReceiver::AUDIO_STAMP_SIZE> {
+                        block,
+                        ReferenceReceiver::AUDIO_STAMP_SIZE },
+                now);
+
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                now.time_since_epoch());
+
+        PacketInfo packet;
+        packet.channel   = Channel::Audio;
+        packet.size      = AUDIO_PACKET_SIZE;
+        packet.timestamp = static_cast<uint32_t>(us.count() * AUDIO_CLOCK_RATE / 1'000'000);
+        packet.data      = block;
+        out_packets.push(packet);
+    }
+}
+
+/**
+ * @brief Match received frames with submitted ones, returns number of complete frames
+ */
+auto addVideoStages(
+        const std::vector<SubmittedFrame> &frames,
+        const ReferenceReceiver           &receiver,
+        LatencyReport                     &report) -> std::size_t
+{
+    std::size_t complete = 0;
+    std::size_t next     = 0;
+
+    // Both are in time order. Timestamp of a frame is taken inside submit(),
+    // differences are signed because timestamps wrap around.
+    for (const auto &received: receiver.videoFrames()) {
+        while (next < frames.size()
+               && static_cast<int32_t>(videoTimestamp(frames[next].encoded) - received.timestamp)
+                          < 0)
+        {
+            ++next;
+        }
+        if (next == frames.size()) {
+            break;
+        }
+
+        const auto &frame = frames[next];
+        if (static_cast<int32_t>(received.timestamp - videoTimestamp(frame.submitted)) < 0
+            || !frame.measured)
+        {
+            continue;
+        }
+
+        if (received.packets != frame.packets || received.datagrams != received.expectedDatagrams) {
+            continue;
+        }
+        ++complete;
+
+        report.add("capture wait", frame.submitted - frame.captured);
+        report.add("encoder", frame.encodeTime);
+        report.add("submit", frame.encoded - frame.submitted);
+        report.add("first packet", received.firstArrival - frame.submitted);
+        report.add("network", std::max(received.lastArrival - frame.encoded, Clock::duration {}));
+        report.add("total", received.lastArrival - frame.captured);
+    }
+
+    return complete;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    using namespace ::pirks::config;
+
+    try {
+        LatencyConfig config;
+
+        const auto ret = config.parseArgs(
+                "Glass-to-glass latency of the server pipeline on loopback",
+                "pirks-latency",
+                PROJECT_VERSION,
+                argc,
+                argv);
+        if (config.shouldExit()) {
+            return ret;
+        }
+
+        spdlog::set_level(config.isDebug() ? spdlog::level::debug : spdlog::level::warn);
+
+        video::encode_video::EncoderSettings settings;
+        settings.width       = config.width();
+        settings.height      = config.height();
+        settings.fps         = config.fps();
+        settings.bitrateKbps = config.bitrateKbps();
+        settings.sliceCount  = config.sliceCount();
+
+        if (!video::encode_video::VideoEncoderFactory {}.create(settings)) {
+            spdlog::critical("Video encoder is not available, latency can't be measured");
+            return ExitCode::ConfigurationError;
+        }
+
+        // Server side: the same pools, fragmentation and video pipeline as the
+        // server, bitrate is fixed because there is no congestion feedback
+        auto packetPool = std::make_shared<PacketPool>(
+                PACKET_BLOCK_SIZE,
+                PACKET_BLOCK_COUNT,
+                wire::PACKET_HEADROOM,
+                wire::PACKET_TAILROOM);
+        auto framePool  = std::make_shared<PacketPool>(FRAME_BLOCK_SIZE, FRAME_BLOCK_COUNT);
+        auto inPackets  = std::make_shared<PacketsQueue>();
+        auto outPackets = std::make_shared<PacketsQueue>();
+
+        CongestionSettings congestion;
+        congestion.startBitrateKbps = config.bitrateKbps();
+        congestion.minBitrateKbps   = config.bitrateKbps();
+        congestion.maxBitrateKbps   = config.bitrateKbps();
+
+        UDPConnection connection { config.port(), packetPool };
+        connection.enableFragmentation(framePool);
+        connection.setCongestionSettings(congestion);
+        connection.create(inPackets, outPackets);
+
+        VideoStream videoStream { settings, packetPool, outPackets };
+        videoStream.setFramePool(framePool);
+
+        ReferenceReceiver receiver;
+        receiver.start(connection.localPort());
+
+        const auto hello = inPackets->pop(1s);
+        if (!hello) {
+            spdlog::critical("Receiver can't connect to port {}", connection.localPort());
+            return ExitCode::ConfigurationError;
+        }
+        packetPool->release(hello->data);
+
+        SyntheticSource  source { config.width(), config.height() };
+        std::atomic_bool stopAudio { false };
+        std::thread      audioThread { [&] {
+            sendAudio(*outPackets, *packetPool, stopAudio);
+        } };
+
+        const auto interval = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(1.0 / config.fps()));
+        const auto warmupFrames = std::size_t { config.warmupSeconds() } * config.fps();
+        const auto frameCount   = warmupFrames + std::size_t { config.seconds() } * config.fps();
+
+        std::vector<SubmittedFrame> frames;
+        frames.reserve(frameCount);
+
+        // Frame is due every interval, if the pipeline is late it waits
+        auto due = Clock::now();
+        for (std::size_t i = 0; i < frameCount; ++i, due += interval) {
+            std::this_thread::sleep_until(due);
+
+            SubmittedFrame frame;
+            frame.captured  = due;
+            frame.submitted = Clock::now();
+
+            const auto stats = videoStream.submit(source.frame(i));
+
+            frame.encoded    = Clock::now();
+            frame.encodeTime = stats.encode.encodeTime;
+            frame.packets    = stats.packets;
+            frame.measured   = i >= warmupFrames;
+
+            if (frame.packets != 0) {
+                frames.push_back(frame);
+            }
+        }
+
+        std::this_thread::sleep_for(DRAIN_TIME);
+        stopAudio = true;
+        audioThread.join();
+        receiver.stop();
+
+        LatencyReport report;
+        const auto    complete = addVideoStages(frames, receiver, report);
+        for (const auto latency: receiver.audioLatency()) {
+            report.add("audio", latency);
+        }
+
+        const auto measured = static_cast<std::size_t>(
+                std::count_if(frames.begin(), frames.end(), [](const SubmittedFrame &frame) {
+                    return frame.measured;
+                }));
+
+        std::printf(
+                "%ux%u at %u fps, %u kbps: %zu frames sent, %zu complete, %zu lost or incomplete\n",
+                config.width(),
+                config.height(),
+                config.fps(),
+                config.bitrateKbps(),
+                measured,
+                complete,
+                measured - complete);
+        report.print();
+
+        if (!config.jsonFile().empty() && !report.writeJson(config.jsonFile())) {
+            return ExitCode::ConfigurationError;
+        }
+
+    } catch (std::exception &e) {
+        spdlog::critical("Exception thrown: {}", e.what());
+        return ExitCode::ExceptionThrown;
+    } catch (...) {
+        spdlog::critical("Unknown exception thrown");
+        return ExitCode::ExceptionThrown;
+    }
+
+    return ExitCode::OK;
+}
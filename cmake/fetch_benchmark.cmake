@@ -0,0 +1,22 @@
+# Add the dependency on Google Benchmark which is downloaded from GitHub
+# Based on https://github.com/google/benchmark#usage-with-cmake
+
+# Avoid warning about DOWNLOAD_EXTRACT_TIMESTAMP in CMake 3.24 and greater:
+if (CMAKE_VERSION VERSION_GREATER_EQUAL "3.24.0")
+    cmake_policy(SET CMP0135 NEW)
+endif()
+
+include(FetchContent)
+
+FetchContent_Declare(
+    googlebenchmark
+    URL https://github.com/google/benchmark/archive/refs/tags/v1.9.1.zip
+)
+
+# Only the library is needed: no tests of its own, which would need gtest, and no install
+set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "" FORCE)
+set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+set(BENCHMARK_ENABLE_WERROR OFF CACHE BOOL "" FORCE)
+
+FetchContent_MakeAvailable(googlebenchmark)
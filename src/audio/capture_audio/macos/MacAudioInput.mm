@@ -2,6 +2,8 @@
 
 #include <stdexcept>
 
+#include "trace/Trace.h"
+
 namespace audio::capture_audio::platform_macos
 {
 
@@ -25,6 +27,8 @@ MacAudioInput::~MacAudioInput()
 
 auto MacAudioInput::sample(std::vector<float> &sample_out) -> CaptureResult
 {
+    PIRKS_TRACE_SCOPE("audio", "sample");
+
     const auto sample_size64 = sample_out.size();
     assert(sample_size64 < UINT32_MAX && "audio sample buffer overflow");
     const uint32_t sample_size = static_cast<uint32_t>(sample_size64);
@@ -15,6 +15,8 @@
 
 #include "AudioFormats.h"
 #include "AudioUUIDs.h"
+#include "Logging.h"
+#include "trace/Trace.h"
 
 namespace audio::capture_audio::platform_windows
 {
@@ -299,6 +301,8 @@ WasapiAudioInput::~WasapiAudioInput()
 
 auto WasapiAudioInput::sample(std::vector<float> &sample_out) -> CaptureResult
 {
+    PIRKS_TRACE_SCOPE("audio", "sample");
+
     const auto sample_size64 = sample_out.size();
     assert(sample_size64 < INT32_MAX && "audio sample buffer overflow");
     const int32_t sample_size = static_cast<int32_t>(sample_size64);
@@ -400,7 +404,7 @@ auto WasapiAudioInput::fillBuffer() -> CaptureResult
                 sample_aligned.uninitialized, //
                 block_aligned.audio_sample_size * channels_);
         if (n < block_aligned.audio_sample_size * channels_) {
-            spdlog::warn("Audio capture buffer overflow");
+            PIRKS_WARN_LIMITED("Audio capture buffer overflow");
         }
 
         if (buffer_flags & AUDCLNT_BUFFERFLAGS_SILENT) {
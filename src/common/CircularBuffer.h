@@ -1,19 +1,42 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <condition_variable>
 #include <deque>
+#include <memory_resource>
 #include <optional>
 #include <span>
 #include <vector>
 
+#include "metrics/Counter.h"
+#include "trace/Trace.h"
+
 template<class T>
 class CircularBuffer
 {
 public:
-    explicit CircularBuffer(size_t capacity = 256);
+    /**
+     * @brief Sees every element pushed into the buffer, see setTap()
+     */
+    class Tap
+    {
+    public:
+        virtual ~Tap() = default;
+
+        virtual void onPush(std::span<const T> elements) = 0;
+    };
+
+public:
+    /**
+     * @param capacity  Elements which can be queued
+     * @param resource  Memory of the elements, allocated once in constructor
+     */
+    explicit CircularBuffer(
+            size_t                     capacity = 256,
+            std::pmr::memory_resource *resource = std::pmr::get_default_resource());
     ~CircularBuffer();
 
 public:
@@ -33,17 +56,20 @@ public:
     [[nodiscard]]
     auto pop() -> std::optional<T>;
 
+    // Pops up to max_elements into out_buffer, which is resized with its own allocator, so a
+    // std::pmr::vector on an arena or pool resource keeps the heap out of the batch
+    template<class Allocator>
     [[nodiscard]]
-    auto pop(std::vector<T> &out_buffer, size_t max_elements) -> size_t;
+    auto pop(std::vector<T, Allocator> &out_buffer, size_t max_elements) -> size_t;
 
     template<class Rep, class Period>
     [[nodiscard]]
     auto pop(std::chrono::duration<Rep, Period> delay) -> std::optional<T>;
 
-    template<class Rep, class Period>
+    template<class Allocator, class Rep, class Period>
     [[nodiscard]]
     auto pop(
-            std::vector<T>                    &out_buffer,
+            std::vector<T, Allocator>         &out_buffer,
             size_t                             max_elements,
             std::chrono::duration<Rep, Period> delay) -> size_t;
 
@@ -58,16 +84,32 @@ public:
     [[nodiscard]]
     bool isFull();
 
+    [[nodiscard]]
+    auto size() -> size_t;
+
     [[nodiscard]]
     auto bufferCapacity() const -> size_t;
 
     void stop();
 
+    /**
+     * @brief Keep number of queued elements in a gauge, nullptr stops it
+     */
+    void setDepthGauge(pirks::metrics::Gauge *gauge);
+
+    /**
+     * @brief Show every pushed element to tap, nullptr removes it
+     *
+     * Tap is called by the pushing thread before the buffer is locked, so it
+     * must not block. It must stay alive while anything can push.
+     */
+    void setTap(Tap *tap);
+
     // Unsafe access to buffer. Useful for unit tests. Use with caution.
 public:
     auto mutex() -> std::mutex &;
 
-    auto unsafe() -> std::vector<T> &;
+    auto unsafe() -> std::pmr::vector<T> &;
 
     [[nodiscard]]
     auto startIndex() const -> size_t;
@@ -76,18 +118,25 @@ public:
     auto endIndex() const -> size_t;
 
 private:
-    volatile bool  active_;
-    std::mutex     mutex_;
-    std::vector<T> buffer_;
-    size_t         startIndex_;
-    size_t         endIndex_;
+    void updateDepth();
+
+private:
+    volatile bool       active_;
+    std::mutex          mutex_;
+    std::pmr::vector<T> buffer_;
+    size_t              startIndex_;
+    size_t              endIndex_;
 
     std::condition_variable cv_;
+
+    pirks::metrics::Gauge *depthGauge_ { nullptr };
+    std::atomic<Tap *>     tap_ { nullptr };
 };
 
 template<class T>
-CircularBuffer<T>::CircularBuffer(size_t capacity) //
+CircularBuffer<T>::CircularBuffer(size_t capacity, std::pmr::memory_resource *resource) //
         : active_(true)
+        , buffer_(resource)
         , startIndex_(0)
         , endIndex_(0)
 {
@@ -124,6 +173,10 @@ CircularBuffer<T>::~CircularBuffer()
 template<class T>
 void CircularBuffer<T>::push(const T &element)
 {
+    if (auto *tap = tap_.load(std::memory_order_acquire)) {
+        tap->onPush(std::span<const T> { &element, 1 });
+    }
+
     std::lock_guard lock { mutex_ };
 
     if (!active_) {
@@ -139,6 +192,7 @@ void CircularBuffer<T>::push(const T &element)
     if (endIndex_ == startIndex_) {
         startIndex_ = (startIndex_ + 1) % sz;
     }
+    updateDepth();
 
     cv_.notify_all();
 }
@@ -146,6 +200,10 @@ void CircularBuffer<T>::push(const T &element)
 template<class T>
 void CircularBuffer<T>::push(std::span<const T> elements)
 {
+    if (auto *tap = tap_.load(std::memory_order_acquire)) {
+        tap->onPush(elements);
+    }
+
     std::lock_guard lock { mutex_ };
 
     if (!active_) {
@@ -165,6 +223,7 @@ void CircularBuffer<T>::push(std::span<const T> elements)
             startIndex_ = (startIndex_ + 1) % sz;
         }
     }
+    updateDepth();
 
     cv_.notify_all();
 }
@@ -198,6 +257,7 @@ auto CircularBuffer<T>::peek(std::chrono::duration<Rep, Period> delay) -> std::o
 
     // if start index equal to end index, then buffer is empty
     while (startIndex_ == endIndex_) {
+        PIRKS_TRACE_SCOPE("queue", "wait");
         if (cv_.wait_for(lock, delay) == std::cv_status::timeout) {
             return std::nullopt;
         }
@@ -221,6 +281,7 @@ auto CircularBuffer<T>::pop() -> std::optional<T>
 
     // if start index is equal to end index, then buffer is empty
     while (startIndex_ == endIndex_) {
+        PIRKS_TRACE_SCOPE("queue", "wait");
         cv_.wait(lock);
 
         if (!active_) {
@@ -233,13 +294,14 @@ auto CircularBuffer<T>::pop() -> std::optional<T>
     const auto sz = buffer_.capacity();
 
     startIndex_ = (startIndex_ + 1) % sz;
+    updateDepth();
 
     return result;
 }
 
 template<class T>
-[[nodiscard]]
-auto CircularBuffer<T>::pop(std::vector<T> &out_buffer, size_t max_elements) -> size_t
+template<class Allocator>
+auto CircularBuffer<T>::pop(std::vector<T, Allocator> &out_buffer, size_t max_elements) -> size_t
 {
     std::unique_lock lock { mutex_ };
 
@@ -249,6 +311,7 @@ auto CircularBuffer<T>::pop(std::vector<T> &out_buffer, size_t max_elements) ->
 
     // if start index is equal to end index, then buffer is empty
     while (startIndex_ == endIndex_) {
+        PIRKS_TRACE_SCOPE("queue", "wait");
         cv_.wait(lock);
 
         if (!active_) {
@@ -266,6 +329,7 @@ auto CircularBuffer<T>::pop(std::vector<T> &out_buffer, size_t max_elements) ->
             break;
         }
     }
+    updateDepth();
 
     return i;
 }
@@ -282,6 +346,7 @@ auto CircularBuffer<T>::pop(std::chrono::duration<Rep, Period> delay) -> std::op
 
     // if start index equal to end index, then buffer is empty
     while (startIndex_ == endIndex_) {
+        PIRKS_TRACE_SCOPE("queue", "wait");
         if (cv_.wait_for(lock, delay) == std::cv_status::timeout) {
             return std::nullopt;
         }
@@ -296,14 +361,15 @@ auto CircularBuffer<T>::pop(std::chrono::duration<Rep, Period> delay) -> std::op
     const auto sz = buffer_.capacity();
 
     startIndex_ = (startIndex_ + 1) % sz;
+    updateDepth();
 
     return result;
 }
 
 template<class T>
-template<class Rep, class Period>
+template<class Allocator, class Rep, class Period>
 auto CircularBuffer<T>::pop(
-        std::vector<T>                    &out_buffer,
+        std::vector<T, Allocator>         &out_buffer,
         size_t                             max_elements,
         std::chrono::duration<Rep, Period> delay) -> size_t
 {
@@ -315,6 +381,7 @@ auto CircularBuffer<T>::pop(
 
     // if start index equal to end index, then buffer is empty
     while (startIndex_ == endIndex_) {
+        PIRKS_TRACE_SCOPE("queue", "wait");
         if (cv_.wait_for(lock, delay) == std::cv_status::timeout) {
             return 0;
         }
@@ -334,6 +401,7 @@ auto CircularBuffer<T>::pop(
             break;
         }
     }
+    updateDepth();
 
     return i;
 }
@@ -370,7 +438,19 @@ bool CircularBuffer<T>::isFull()
     const auto sz = buffer_.capacity();
     assert(sz != 0 && "capacity can't be zero");
 
-    return endIndex_ == ((startIndex_ + 1) % sz);
+    // One more element would make end equal to start
+    return ((endIndex_ + 1) % sz) == startIndex_;
+}
+
+template<class T>
+auto CircularBuffer<T>::size() -> size_t
+{
+    std::unique_lock lock { mutex_ };
+
+    const auto sz = buffer_.capacity();
+    assert(sz != 0 && "capacity can't be zero");
+
+    return (endIndex_ + sz - startIndex_) % sz;
 }
 
 template<class T>
@@ -387,6 +467,20 @@ void CircularBuffer<T>::stop()
     cv_.notify_all();
 }
 
+template<class T>
+void CircularBuffer<T>::setDepthGauge(pirks::metrics::Gauge *gauge)
+{
+    std::lock_guard lock { mutex_ };
+    depthGauge_ = gauge;
+    updateDepth();
+}
+
+template<class T>
+void CircularBuffer<T>::setTap(Tap *tap)
+{
+    tap_.store(tap, std::memory_order_release);
+}
+
 // Unsafe access to buffer. Useful for unit tests. Use with caution.
 
 template<class T>
@@ -396,7 +490,7 @@ auto CircularBuffer<T>::mutex() -> std::mutex &
 }
 
 template<class T>
-auto CircularBuffer<T>::unsafe() -> std::vector<T> &
+auto CircularBuffer<T>::unsafe() -> std::pmr::vector<T> &
 {
     return buffer_;
 }
@@ -412,3 +506,16 @@ auto CircularBuffer<T>::endIndex() const -> size_t
 {
     return endIndex_;
 }
+
+// Called with the mutex locked, only when something changed
+
+template<class T>
+void CircularBuffer<T>::updateDepth()
+{
+    if (depthGauge_ == nullptr) {
+        return;
+    }
+
+    const auto sz = buffer_.capacity();
+    depthGauge_->set(static_cast<int64_t>((endIndex_ + sz - startIndex_) % sz));
+}
@@ -1,6 +1,7 @@
 #include "Config.h"
 
 #include "ExitCode.h"
+#include "Logging.h"
 
 namespace pirks::config
 {
@@ -20,6 +21,11 @@ int Config::parseArgs(
 
     try {
         args.parse(argc, argv);
+
+        if (const auto *config = args.get_config_ptr(); config != nullptr && config->count() != 0) {
+            configFile_ = config->as<std::string>();
+        }
+
         if (!parseOptions(args)) {
             shouldExit_ = true;
             return ExitCode::ConfigurationError;
@@ -37,8 +43,36 @@ void Config::addStandardOptions(CLI::App &args, const std::string &version)
     // add version output
     args.set_version_flag("-v,--version", version);
 
+    args.set_config("-c,--config", "", "Read options from TOML or INI file");
+
     args.add_flag("-d,--debug", isDebug_, "Enable debug logging");
     args.add_option("-p,--port", port_, "Server port");
+    args.add_option("--log-level", logLevel_, "Log level, reloaded with config file")
+            ->check(CLI::IsMember(
+                    { "trace", "debug", "info", "warn", "error", "critical", "off" }));
+    args.add_option(
+            "--log-queue",
+            logQueueSize_,
+            "Messages queued for the logging thread, oldest are dropped when it's full, "
+            "0 - log synchronously");
+}
+
+void Config::setupLogging() const
+{
+    applyLogLevel();
+
+    if (logQueueSize_ != 0) {
+        setupAsyncLogging(logQueueSize_);
+    }
+}
+
+void Config::applyLogLevel() const
+{
+    if (!logLevel_.empty()) {
+        spdlog::set_level(spdlog::level::from_str(logLevel_));
+    } else {
+        spdlog::set_level(isDebug_ ? spdlog::level::debug : spdlog::level::info);
+    }
 }
 
 void Config::addOptions([[maybe_unused]] CLI::App &args)
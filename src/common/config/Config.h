@@ -8,6 +8,9 @@ namespace pirks::config
 /**
  * @brief Class for read options from configuration file and program arguments
  *
+ * Options can be given in a TOML or INI file with --config, arguments
+ * override them. The same arguments can be parsed again by a new object to
+ * reload the file, see ConfigReloader.
  */
 class Config
 {
@@ -23,6 +26,19 @@ public:
             int                argc,
             char             **argv);
 
+    /**
+     * @brief Apply logging options: level and asynchronous queue
+     *
+     * Call shutdownLogging() before exit when the queue is used, so
+     * messages left in it are written.
+     */
+    void setupLogging() const;
+
+    /**
+     * @brief Set level of all loggers, can be called again after reload
+     */
+    void applyLogLevel() const;
+
 protected:
     virtual void addOptions(CLI::App &args);
     virtual bool parseOptions(CLI::App &args);
@@ -45,10 +61,31 @@ public:
         return shouldExit_;
     }
 
+    auto logQueueSize() const -> std::size_t
+    {
+        return logQueueSize_;
+    }
+
+    /**
+     * @brief File given with --config, empty if there is none
+     */
+    auto configFile() const -> const std::string &
+    {
+        return configFile_;
+    }
+
 private:
     bool     isDebug_ { false };
     bool     shouldExit_ { false };
     uint16_t port_ { 5101 }; // Some random unused port
+
+    // Messages waiting to be written by the logging thread, 0 - synchronous logging
+    std::size_t logQueueSize_ { 8192 };
+
+    // Overrides --debug, empty - info or debug level
+    std::string logLevel_;
+
+    std::string configFile_;
 };
 
 }; // namespace pirks::config
@@ -0,0 +1,173 @@
+#include "ConfigReloader.h"
+
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+
+#ifdef UNIX
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+#ifdef LINUX
+#include <sys/inotify.h>
+#endif
+
+namespace pirks::config
+{
+
+namespace {
+
+// How long the watching thread waits for a change before checking stop flag
+constexpr int POLL_INTERVAL_MS = 200;
+
+#ifdef UNIX
+
+// Lock-free, so it can be set from a signal handler
+std::atomic_bool g_hangup { false };
+
+static_assert(std::atomic_bool::is_always_lock_free);
+
+extern "C" void onHangup(int)
+{
+    g_hangup.store(true, std::memory_order_relaxed);
+}
+
+#endif
+
+} // namespace
+
+ConfigReloader::ConfigReloader(std::string file, Callback reload)
+        : file_ { std::move(file) }
+        , reload_ { std::move(reload) }
+        , stop_ { false }
+{
+    //
+}
+
+ConfigReloader::~ConfigReloader()
+{
+    stop();
+}
+
+#ifdef UNIX
+
+void ConfigReloader::start()
+{
+    stop();
+
+    struct sigaction action {};
+    action.sa_handler = onHangup;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    if (::sigaction(SIGHUP, &action, nullptr) != 0) {
+        spdlog::warn("Can't handle SIGHUP, config file {} is not reloaded on it", file_);
+    }
+
+#ifdef LINUX
+    const auto directory = std::filesystem::absolute(file_).parent_path();
+
+    inotify_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_ >= 0
+        && ::inotify_add_watch(inotify_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        ::close(inotify_);
+        inotify_ = -1;
+    }
+    if (inotify_ < 0) {
+        spdlog::warn("Changes of config file {} are not watched", file_);
+    }
+#endif
+
+    stop_        = false;
+    watchThread_ = std::thread(watchThreadFunc, this);
+
+    spdlog::info("Config file {} is reloaded on SIGHUP or when it changes", file_);
+}
+
+void ConfigReloader::stop()
+{
+    stop_ = true;
+    if (watchThread_.joinable()) {
+        watchThread_.join();
+
+        ::signal(SIGHUP, SIG_DFL);
+    }
+
+    if (inotify_ >= 0) {
+        ::close(inotify_);
+        inotify_ = -1;
+    }
+}
+
+void ConfigReloader::watchThreadFunc(ConfigReloader *reloader)
+{
+    const auto name = std::filesystem::path(reloader->file_).filename();
+
+    while (!reloader->stop_) {
+        bool changed = false;
+
+#ifdef LINUX
+        if (reloader->inotify_ >= 0) {
+            pollfd fd { reloader->inotify_, POLLIN, 0 };
+            if (::poll(&fd, 1, POLL_INTERVAL_MS) > 0) {
+                // Events of other files in the directory are read and skipped too
+                alignas(inotify_event) std::array<char, 4096> events;
+
+                ssize_t size = 0;
+                while ((size = ::read(reloader->inotify_, events.data(), events.size())) > 0) {
+                    for (ssize_t offset = 0; offset < size;) {
+                        const auto *event = reinterpret_cast<const inotify_event *>(
+                                events.data() + offset);
+                        if (event->len != 0 && name == event->name) {
+                            changed = true;
+                        }
+                        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                    }
+                }
+            }
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+        }
+#else
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+#endif
+
+        if (g_hangup.exchange(false, std::memory_order_relaxed)) {
+            changed = true;
+        }
+
+        if (changed) {
+            try {
+                reloader->reload_();
+            } catch (const std::exception &e) {
+                spdlog::error("Config file {} is not reloaded: {}", reloader->file_, e.what());
+            }
+        }
+    }
+}
+
+#else
+
+void ConfigReloader::start()
+{
+    spdlog::warn("Config file {} can't be reloaded on this platform", file_);
+}
+
+void ConfigReloader::stop()
+{
+    //
+}
+
+void ConfigReloader::watchThreadFunc(ConfigReloader *)
+{
+    //
+}
+
+#endif
+
+}; // namespace pirks::config
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace pirks::config
+{
+
+/**
+ * @brief Calls reload when the config file should be read again
+ *
+ * That is on SIGHUP, and on Linux also when the file is written or replaced
+ * (inotify on its directory, so editors which write a new file and rename
+ * it are noticed too). reload is called from the thread of the reloader,
+ * one call at a time.
+ *
+ * Not available on Windows, start() only logs a warning there.
+ */
+class ConfigReloader final
+{
+public:
+    using Callback = std::function<void()>;
+
+    ConfigReloader(std::string file, Callback reload);
+    ~ConfigReloader();
+
+    ConfigReloader(const ConfigReloader &)            = delete;
+    ConfigReloader &operator=(const ConfigReloader &) = delete;
+
+public:
+    void start();
+    void stop();
+
+private:
+    static void watchThreadFunc(ConfigReloader *reloader);
+
+private:
+    std::string      file_;
+    Callback         reload_;
+    int              inotify_ { -1 };
+    std::atomic_bool stop_;
+    std::thread      watchThread_;
+};
+
+}; // namespace pirks::config
@@ -0,0 +1,61 @@
+#include "Logging.h"
+
+#include <spdlog/async.h>
+#include <spdlog/async_logger.h>
+
+#include <memory>
+
+namespace pirks::config
+{
+
+void setupAsyncLogging(std::size_t queue_size)
+{
+    // One thread writes all messages, so they stay in order
+    spdlog::init_thread_pool(queue_size, 1);
+
+    const auto &sinks  = spdlog::default_logger()->sinks();
+    auto        logger = std::make_shared<spdlog::async_logger>(
+            spdlog::default_logger()->name(),
+            sinks.begin(),
+            sinks.end(),
+            spdlog::thread_pool(),
+            spdlog::async_overflow_policy::overrun_oldest);
+    logger->set_level(spdlog::default_logger()->level());
+
+    spdlog::set_default_logger(std::move(logger));
+}
+
+void shutdownLogging()
+{
+    auto pool = spdlog::thread_pool();
+    if (!pool) {
+        return;
+    }
+
+    // Messages logged while the queue is written go to the same sinks directly
+    const auto &async = spdlog::default_logger();
+    auto        logger = std::make_shared<spdlog::logger>(
+            async->name(),
+            async->sinks().begin(),
+            async->sinks().end());
+    logger->set_level(async->level());
+    spdlog::set_default_logger(std::move(logger));
+
+    // Pool writes queued messages before it's destroyed with the last reference
+    spdlog::details::registry::instance().set_tp(nullptr);
+    const auto dropped = pool->overrun_counter();
+    pool.reset();
+
+    if (dropped != 0) {
+        spdlog::warn("{} log messages were dropped, log queue was full", dropped);
+    }
+}
+
+void logSuppressed(spdlog::level::level_enum level, uint64_t count)
+{
+    if (count != 0) {
+        spdlog::log(level, "{} messages like the next one were suppressed", count);
+    }
+}
+
+}; // namespace pirks::config
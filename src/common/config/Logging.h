@@ -0,0 +1,97 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+/**
+ * @file Logging.h
+ * @brief Logging which doesn't stall capture and network threads
+ *
+ * setupAsyncLogging() moves writing of messages to a background thread, a
+ * thread which logs only puts its message into a preallocated queue.
+ * Warnings which can be logged for every packet go through
+ * PIRKS_WARN_LIMITED() or PIRKS_ERROR_LIMITED(), which log at most one
+ * message per second from each place and count the rest.
+ */
+
+namespace pirks::config
+{
+
+// Messages of one place logged by the limited macros at most this often
+constexpr auto LOG_LIMIT_INTERVAL = std::chrono::seconds(1);
+
+/**
+ * @brief Make the default logger asynchronous, with the same sinks
+ *
+ * Queue of queue_size messages is allocated at once. When it's full the
+ * oldest message is dropped, so a slow sink never blocks the logging thread.
+ */
+void setupAsyncLogging(std::size_t queue_size);
+
+/**
+ * @brief Write messages left in the queue and stop the logging thread
+ *
+ * Number of messages dropped because the queue was full is logged first.
+ */
+void shutdownLogging();
+
+/**
+ * @brief Lets through one event per interval, from any number of threads
+ */
+class RateLimiter final
+{
+public:
+    explicit RateLimiter(std::chrono::nanoseconds interval)
+            : interval_ { interval.count() }
+    {
+    }
+
+    /**
+     * @brief Number of events suppressed since the last one let through, or
+     *        nothing if this event is suppressed too
+     */
+    [[nodiscard]]
+    auto acquire() -> std::optional<uint64_t>
+    {
+        const auto now  = std::chrono::steady_clock::now().time_since_epoch().count();
+        auto       next = next_.load(std::memory_order_relaxed);
+        if (now < next || !next_.compare_exchange_strong(next, now + interval_)) {
+            suppressed_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        return suppressed_.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    const int64_t         interval_;
+    std::atomic<int64_t>  next_ { 0 };
+    std::atomic<uint64_t> suppressed_ { 0 };
+};
+
+/**
+ * @brief Log how many messages were suppressed before the next one
+ */
+void logSuppressed(spdlog::level::level_enum level, uint64_t count);
+
+}; // namespace pirks::config
+
+#define PIRKS_LOG_EVERY(interval, level, ...)                                                   \
+    do {                                                                                        \
+        static ::pirks::config::RateLimiter pirksLogLimiter { interval };                       \
+        if (spdlog::should_log(level)) {                                                        \
+            if (const auto suppressed = pirksLogLimiter.acquire()) {                            \
+                ::pirks::config::logSuppressed(level, *suppressed);                             \
+                spdlog::log(level, __VA_ARGS__);                                                \
+            }                                                                                   \
+        }                                                                                       \
+    } while (false)
+
+#define PIRKS_WARN_LIMITED(...)                                                                 \
+    PIRKS_LOG_EVERY(::pirks::config::LOG_LIMIT_INTERVAL, spdlog::level::warn, __VA_ARGS__)
+
+#define PIRKS_ERROR_LIMITED(...)                                                                \
+    PIRKS_LOG_EVERY(::pirks::config::LOG_LIMIT_INTERVAL, spdlog::level::err, __VA_ARGS__)
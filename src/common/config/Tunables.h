@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace pirks::config
+{
+
+/**
+ * @brief Settings which can be changed while the server runs
+ *
+ * Written when the config file is reloaded and read by the pipeline for
+ * every frame or packet, so they are atomics and nobody takes a lock.
+ * 0 means no limit for all of them.
+ */
+struct Tunables
+{
+    // Upper limit of the encoder bitrate, below the one congestion control allows
+    std::atomic<uint32_t> maxBitrateKbps { 0 };
+
+    // Upper limit of the rate UDP connection sends at
+    std::atomic<uint32_t> pacingKbps { 0 };
+
+    // Packets waiting in the outgoing queue after which new video packets are dropped
+    std::atomic<uint32_t> queueLimit { 0 };
+
+    void store(const Tunables &other)
+    {
+        maxBitrateKbps.store(other.maxBitrateKbps.load(std::memory_order_relaxed));
+        pacingKbps.store(other.pacingKbps.load(std::memory_order_relaxed));
+        queueLimit.store(other.queueLimit.load(std::memory_order_relaxed));
+    }
+};
+
+}; // namespace pirks::config
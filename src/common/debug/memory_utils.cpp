@@ -2,57 +2,110 @@
 
 #include <spdlog/spdlog.h>
 
-#include <iomanip>
-#include <sstream>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
 
 namespace memory_utils
 {
 
-std::string dumpMemoryToString(std::span<const std::uint8_t> data, const std::string &prefix)
+namespace {
+
+// Positions of the parts of a line, second half of the bytes is shifted by one more space
+constexpr std::size_t HEX_START   = 10;
+constexpr std::size_t ASCII_START = HEX_START + DUMP_BYTES_PER_LINE * 3 + 3;
+constexpr std::size_t HALF_LINE   = DUMP_BYTES_PER_LINE / 2;
+
+static_assert(ASCII_START + DUMP_BYTES_PER_LINE + 3 == DUMP_LINE_SIZE);
+
+// Two hex digits of every byte
+constexpr auto HEX_DIGITS = [] {
+    constexpr std::string_view DIGITS = "0123456789abcdef";
+
+    std::array<std::array<char, 2>, 256> table {};
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        table[i] = { DIGITS[i >> 4], DIGITS[i & 0xf] };
+    }
+    return table;
+}();
+
+// Byte as shown in the ASCII column, non-printable characters as dots
+constexpr auto ASCII_CHARS = [] {
+    std::array<char, 256> table {};
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        table[i] = i >= 32 && i <= 126 ? static_cast<char>(i) : '.';
+    }
+    return table;
+}();
+
+void writeDump(std::span<const std::uint8_t> data, std::string_view prefix, char *out)
+{
+    for (std::size_t offset = 0; offset < data.size(); offset += DUMP_BYTES_PER_LINE) {
+        std::memcpy(out, prefix.data(), prefix.size());
+        out += prefix.size();
+
+        const auto count = std::min(DUMP_BYTES_PER_LINE, data.size() - offset);
+        dumpMemoryLine(
+                data.subspan(offset, count),
+                offset,
+                std::span<char, DUMP_LINE_SIZE>(out, DUMP_LINE_SIZE));
+        out += DUMP_LINE_SIZE;
+    }
+}
+
+[[nodiscard]]
+auto dumpSize(std::span<const std::uint8_t> data, std::string_view prefix) -> std::size_t
+{
+    const auto lines = (data.size() + DUMP_BYTES_PER_LINE - 1) / DUMP_BYTES_PER_LINE;
+    return lines * (prefix.size() + DUMP_LINE_SIZE);
+}
+
+} // namespace
+
+void dumpMemoryLine(
+        std::span<const std::uint8_t>   data,
+        std::size_t                     offset,
+        std::span<char, DUMP_LINE_SIZE> line)
 {
-    std::stringstream ss;
-
-    for (size_t i = 0; i < data.size(); i += 16) {
-        ss << prefix;
-
-        // Output memory offset
-        ss << std::hex << std::setw(8) << std::setfill('0') << i << ": ";
-
-        // Output hexadecimal values
-        for (size_t j = 0; j < 16; ++j) {
-            if (i + j < data.size()) {
-                ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(data[i + j])
-                   << " ";
-            } else {
-                ss << "   ";
-            }
-
-            // Add space after 8 bytes
-            if (j == 7) {
-                ss << " ";
-            }
-        }
-
-        // Output ASCII representation
-        ss << " |";
-        for (size_t j = 0; j < 16; ++j) {
-            if (i + j < data.size()) {
-                char c = static_cast<char>(data[i + j]);
-                // Replace non-printable characters with dots
-                ss << (c >= 32 && c <= 126 ? c : '.');
-            } else {
-                ss << " ";
-            }
-
-            // Add space after 8 bytes
-            if (j == 7) {
-                ss << " ";
-            }
-        }
-        ss << "|\n";
+    assert(data.size() <= DUMP_BYTES_PER_LINE);
+
+    // Spaces are left where the short last line has no bytes
+    std::memset(line.data(), ' ', line.size());
+
+    const auto address = static_cast<std::uint32_t>(offset);
+    for (std::size_t i = 0; i < 4; ++i) {
+        const auto byte = (address >> (24 - i * 8)) & 0xff;
+        std::memcpy(&line[i * 2], HEX_DIGITS[byte].data(), 2);
+    }
+    line[8] = ':';
+
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        const std::size_t gap = i < HALF_LINE ? 0 : 1;
+        std::memcpy(&line[HEX_START + i * 3 + gap], HEX_DIGITS[data[i]].data(), 2);
+        line[ASCII_START + i + gap] = ASCII_CHARS[data[i]];
     }
 
-    return ss.str();
+    line[ASCII_START - 1]    = '|';
+    line[DUMP_LINE_SIZE - 2] = '|';
+    line[DUMP_LINE_SIZE - 1] = '\n';
+}
+
+void dumpMemory(
+        std::span<const std::uint8_t> data,
+        fmt::memory_buffer           &out,
+        std::string_view              prefix)
+{
+    const auto start = out.size();
+    out.resize(start + dumpSize(data, prefix));
+    writeDump(data, prefix, out.data() + start);
+}
+
+std::string dumpMemoryToString(std::span<const std::uint8_t> data, const std::string &prefix)
+{
+    std::string result(dumpSize(data, prefix), '\0');
+    writeDump(data, prefix, result.data());
+    return result;
 }
 
 std::string dumpMemoryToString(std::span<std::uint8_t> data, const std::string &prefix)
@@ -65,41 +118,16 @@ void logMemoryDump(
         const std::string            &prefix,
         spdlog::level::level_enum     level)
 {
-    std::string dump = dumpMemoryToString(data, prefix);
-
-    // Split the dump into lines and log each line separately
-    std::istringstream iss(dump);
-    std::string        line;
-    while (std::getline(iss, line)) {
-        switch (level) {
-        case spdlog::level::trace:
-            spdlog::trace("{}", line);
-            break;
-
-        case spdlog::level::debug:
-            spdlog::debug("{}", line);
-            break;
-
-        case spdlog::level::info:
-            spdlog::info("{}", line);
-            break;
-
-        case spdlog::level::warn:
-            spdlog::warn("{}", line);
-            break;
-
-        case spdlog::level::err:
-            spdlog::error("{}", line);
-            break;
-
-        case spdlog::level::critical:
-            spdlog::critical("{}", line);
-            break;
-
-        default:
-            spdlog::info("{}", line);
-            break;
-        }
+    if (!spdlog::should_log(level)) {
+        return;
+    }
+
+    // Each line is logged separately, without its new line
+    std::array<char, DUMP_LINE_SIZE> line;
+    for (std::size_t offset = 0; offset < data.size(); offset += DUMP_BYTES_PER_LINE) {
+        const auto count = std::min(DUMP_BYTES_PER_LINE, data.size() - offset);
+        dumpMemoryLine(data.subspan(offset, count), offset, line);
+        spdlog::log(level, "{}{}", prefix, std::string_view(line.data(), line.size() - 1));
     }
 }
 
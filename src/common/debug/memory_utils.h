@@ -1,10 +1,13 @@
 #pragma once
 
+#include <spdlog/fmt/fmt.h>
 #include <spdlog/spdlog.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <span>
 #include <string>
+#include <string_view>
 
 /**
  * @namespace memory_utils
@@ -13,6 +16,39 @@
 namespace memory_utils
 {
 
+// Bytes shown in one line of a dump
+constexpr std::size_t DUMP_BYTES_PER_LINE = 16;
+
+// Characters in one line of a dump without prefix, including the new line
+constexpr std::size_t DUMP_LINE_SIZE = 80;
+
+/**
+ * @brief Formats one line of a dump into a caller-provided buffer
+ *
+ * Nothing is allocated, bytes are converted with lookup tables. Missing bytes
+ * of a short last line are filled with spaces. Offset is shown by its lower
+ * 32 bits.
+ *
+ * @param data Up to DUMP_BYTES_PER_LINE bytes of the line
+ * @param offset Offset of the first byte, shown at the start of the line
+ * @param line Buffer for the line, it ends with '\n'
+ */
+void dumpMemoryLine(
+        std::span<const std::uint8_t>   data,
+        std::size_t                     offset,
+        std::span<char, DUMP_LINE_SIZE> line);
+
+/**
+ * @brief Appends the dump of data to out, in the format of dumpMemoryToString()
+ *
+ * out is grown once for the whole dump, so reusing the same buffer for many
+ * dumps doesn't allocate after the first one.
+ */
+void dumpMemory(
+        std::span<const std::uint8_t> data,
+        fmt::memory_buffer           &out,
+        std::string_view              prefix = {});
+
 /**
  * @brief Converts memory contents to a string in hexadecimal and ASCII format
  *
@@ -84,8 +120,9 @@ std::string dumpMemoryToString(std::span<T> data, const std::string &prefix = ""
 /**
  * @brief Logs memory contents using spdlog
  *
- * This function formats the memory contents and logs them using spdlog.
- * The output format is the same as in dumpMemoryToString().
+ * This function formats the memory contents and logs them using spdlog,
+ * one message per line. The output format is the same as in
+ * dumpMemoryToString(). Nothing is formatted when level is not logged.
  *
  * @param data A span containing the memory region to dump
  * @param prefix Optional string to prepend to each line of output
@@ -0,0 +1,123 @@
+#include "FrameArena.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace pirks::memory
+{
+
+namespace {
+
+// Both halves start at a cache line
+constexpr std::size_t BUFFER_ALIGNMENT = 64;
+
+constexpr std::byte GUARD_BYTE { 0xFD };
+
+constexpr auto roundUp(std::size_t size, std::size_t alignment) -> std::size_t
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+FrameArena::FrameArena(std::size_t frame_capacity, std::pmr::memory_resource *upstream)
+        : upstream_ { upstream }
+        , frameCapacity_ { roundUp(frame_capacity, BUFFER_ALIGNMENT) }
+        , buffer_ { static_cast<std::byte *>(
+                  upstream->allocate(2 * frameCapacity_, BUFFER_ALIGNMENT)) }
+{
+}
+
+FrameArena::~FrameArena()
+{
+    upstream_->deallocate(buffer_, 2 * frameCapacity_, BUFFER_ALIGNMENT);
+}
+
+void FrameArena::beginFrame()
+{
+    current_ ^= 1;
+    used_ = 0;
+
+#ifdef DEBUG
+    // Everything written into this half has been written by now
+    checkGuards(current_);
+#endif
+}
+
+auto FrameArena::do_allocate(std::size_t bytes, std::size_t alignment) -> void *
+{
+    auto      *base   = half(current_);
+    const auto start  = reinterpret_cast<std::uintptr_t>(base);
+    const auto offset = roundUp(start + used_, alignment) - start;
+
+#ifdef DEBUG
+    const auto end = offset + bytes + GUARD_SIZE;
+#else
+    const auto end = offset + bytes;
+#endif
+
+    if (end > frameCapacity_) {
+        assert(false && "frame arena is too small for a frame");
+        ++overflows_;
+        return upstream_->allocate(bytes, alignment);
+    }
+
+#ifdef DEBUG
+    putGuard(offset + bytes);
+#endif
+
+    used_ = end;
+    return base + offset;
+}
+
+void FrameArena::do_deallocate(void *memory, std::size_t bytes, std::size_t alignment)
+{
+    // Memory of the arena is reused by frames, not released
+    if (!owns(memory)) {
+        upstream_->deallocate(memory, bytes, alignment);
+    }
+}
+
+bool FrameArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this == &other;
+}
+
+auto FrameArena::half(std::size_t index) const -> std::byte *
+{
+    return buffer_ + index * frameCapacity_;
+}
+
+bool FrameArena::owns(const void *memory) const
+{
+    const auto *bytes = static_cast<const std::byte *>(memory);
+    return bytes >= buffer_ && bytes < buffer_ + 2 * frameCapacity_;
+}
+
+void FrameArena::putGuard(std::size_t offset)
+{
+    std::memset(half(current_) + offset, static_cast<int>(GUARD_BYTE), GUARD_SIZE);
+
+    auto &guards = guards_[current_];
+    if (guards.count < MAX_GUARDS) {
+        guards.offsets[guards.count++] = offset;
+    }
+}
+
+void FrameArena::checkGuards(std::size_t index)
+{
+    auto &guards = guards_[index];
+    for (std::size_t i = 0; i < guards.count; ++i) {
+        const auto *guard = half(index) + guards.offsets[i];
+        if (std::any_of(guard, guard + GUARD_SIZE, [](std::byte b) { return b != GUARD_BYTE; })) {
+            spdlog::error("Frame arena buffer was overrun, guard at offset {}", guards.offsets[i]);
+            assert(false && "frame arena buffer was overrun");
+        }
+    }
+    guards.count = 0;
+}
+
+}; // namespace pirks::memory
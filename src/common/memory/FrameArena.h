@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+
+namespace pirks::memory
+{
+
+/**
+ * @brief Scratch memory of pipeline stages which lives for one frame
+ *
+ * Allocations bump a pointer in one half of a buffer allocated once in
+ * constructor, nothing is freed one by one. beginFrame() switches to the
+ * other half and reuses it from the start, so buffers of the previous
+ * frame, which may still be in flight, stay valid while the next frame is
+ * processed.
+ *
+ * When a frame needs more than frameCapacity() bytes, the rest comes from
+ * the upstream resource and is counted in overflows(). Debug builds assert
+ * on it instead, and put a guard after every allocation which is checked
+ * when the half is reused, to catch writes past the end of a buffer.
+ *
+ * Not thread safe, every worker thread has its own arena.
+ */
+class FrameArena final: public std::pmr::memory_resource
+{
+public:
+    // Bytes after every allocation in debug builds
+    static constexpr std::size_t GUARD_SIZE = 16;
+
+    // Guards checked per frame, the rest of allocations are not
+    static constexpr std::size_t MAX_GUARDS = 256;
+
+    /**
+     * @param frame_capacity    Bytes available to one frame
+     * @param upstream          Memory of both halves and of overflows
+     */
+    explicit FrameArena(
+            std::size_t                frame_capacity,
+            std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+    ~FrameArena() override;
+
+    FrameArena(const FrameArena &)            = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+public:
+    /**
+     * @brief Start the next frame, memory of the frame before the previous one is reused
+     */
+    void beginFrame();
+
+    /**
+     * @brief Uninitialized array for the current frame, to use instead of a std::vector
+     */
+    template<class T>
+    [[nodiscard]]
+    auto scratch(std::size_t count) -> std::span<T>
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "scratch is never destroyed");
+        return { static_cast<T *>(allocate(count * sizeof(T), alignof(T))), count };
+    }
+
+    [[nodiscard]]
+    auto frameCapacity() const -> std::size_t
+    {
+        return frameCapacity_;
+    }
+
+    /**
+     * @brief Bytes taken by the current frame, with alignment and guards
+     */
+    [[nodiscard]]
+    auto used() const -> std::size_t
+    {
+        return used_;
+    }
+
+    /**
+     * @brief Allocations which didn't fit into their frame, since construction
+     */
+    [[nodiscard]]
+    auto overflows() const -> uint64_t
+    {
+        return overflows_;
+    }
+
+private:
+    struct Guards
+    {
+        std::array<std::size_t, MAX_GUARDS> offsets; ///< From the start of the half
+        std::size_t                         count { 0 };
+    };
+
+private:
+    auto do_allocate(std::size_t bytes, std::size_t alignment) -> void * override;
+    void do_deallocate(void *memory, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    auto half(std::size_t index) const -> std::byte *;
+    bool owns(const void *memory) const;
+
+    void putGuard(std::size_t offset);
+    void checkGuards(std::size_t index);
+
+private:
+    std::pmr::memory_resource *upstream_;
+    std::size_t                frameCapacity_;
+    std::byte                 *buffer_;
+    std::size_t                current_ { 0 }; ///< Half of the current frame, 0 or 1
+    std::size_t                used_ { 0 };
+    uint64_t                   overflows_ { 0 };
+    std::array<Guards, 2>      guards_;
+};
+
+}; // namespace pirks::memory
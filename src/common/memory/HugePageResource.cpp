@@ -0,0 +1,153 @@
+#include "HugePageResource.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <new>
+
+#ifdef UNIX
+#include <sys/mman.h>
+
+#include <cerrno>
+#endif
+
+namespace pirks::memory
+{
+
+namespace {
+
+constexpr auto roundUp(std::size_t size, std::size_t alignment) -> std::size_t
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+HugePageResource::HugePageResource(HugePageSettings settings)
+        : settings_ { settings }
+{
+}
+
+auto HugePageResource::hugePageAllocations() const -> uint64_t
+{
+    return hugePageAllocations_.load(std::memory_order_relaxed);
+}
+
+auto HugePageResource::fallbackAllocations() const -> uint64_t
+{
+    return fallbackAllocations_.load(std::memory_order_relaxed);
+}
+
+bool HugePageResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    // Mappings can be released by any resource, heap memory too
+    return dynamic_cast<const HugePageResource *>(&other) != nullptr;
+}
+
+#ifdef UNIX
+
+auto HugePageResource::do_allocate(std::size_t bytes, std::size_t alignment) -> void *
+{
+    alignment = std::max(alignment, CACHE_LINE_SIZE);
+    assert(alignment <= HUGE_PAGE_SIZE && "alignment is bigger than a huge page");
+
+    if (bytes < MIN_MAPPED_SIZE) {
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    const auto size   = roundUp(bytes, HUGE_PAGE_SIZE);
+    auto      *memory = map(size);
+
+    if (settings_.prefault) {
+        std::memset(memory, 0, size);
+    }
+
+    if (settings_.lock && ::mlock(memory, size) != 0) {
+        spdlog::warn("Can't lock {} bytes in memory, error {}", size, errno);
+    }
+
+    return memory;
+}
+
+void HugePageResource::do_deallocate(void *memory, std::size_t bytes, std::size_t alignment)
+{
+    alignment = std::max(alignment, CACHE_LINE_SIZE);
+
+    if (bytes < MIN_MAPPED_SIZE) {
+        std::pmr::new_delete_resource()->deallocate(memory, bytes, alignment);
+        return;
+    }
+
+    // Pages are unlocked with the mapping
+    ::munmap(memory, roundUp(bytes, HUGE_PAGE_SIZE));
+}
+
+auto HugePageResource::map(std::size_t size) -> void *
+{
+    constexpr int PROTECTION = PROT_READ | PROT_WRITE;
+    constexpr int FLAGS      = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#ifdef MAP_HUGETLB
+    auto *memory = ::mmap(nullptr, size, PROTECTION, FLAGS | MAP_HUGETLB, -1, 0);
+    if (memory != MAP_FAILED) {
+        hugePageAllocations_.fetch_add(1, std::memory_order_relaxed);
+        return memory;
+    }
+#endif
+
+    // One more page is mapped to cut an aligned range out of it
+    auto *raw = static_cast<std::uint8_t *>(
+            ::mmap(nullptr, size + HUGE_PAGE_SIZE, PROTECTION, FLAGS, -1, 0));
+    if (raw == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+
+    const auto misalign = reinterpret_cast<std::uintptr_t>(raw) % HUGE_PAGE_SIZE;
+    const auto head     = misalign == 0 ? 0 : HUGE_PAGE_SIZE - misalign;
+    if (head != 0) {
+        ::munmap(raw, head);
+    }
+    ::munmap(raw + head + size, HUGE_PAGE_SIZE - head);
+
+#ifdef MADV_HUGEPAGE
+    ::madvise(raw + head, size, MADV_HUGEPAGE);
+#endif
+
+    if (fallbackAllocations_.fetch_add(1, std::memory_order_relaxed) == 0) {
+        spdlog::info("No huge pages are reserved, transparent huge pages are used");
+    }
+    return raw + head;
+}
+
+#else
+
+auto HugePageResource::do_allocate(std::size_t bytes, std::size_t alignment) -> void *
+{
+    auto *memory = std::pmr::new_delete_resource()->allocate(
+            bytes,
+            std::max(alignment, CACHE_LINE_SIZE));
+
+    if (settings_.prefault) {
+        std::memset(memory, 0, bytes);
+    }
+    return memory;
+}
+
+void HugePageResource::do_deallocate(void *memory, std::size_t bytes, std::size_t alignment)
+{
+    std::pmr::new_delete_resource()->deallocate(
+            memory,
+            bytes,
+            std::max(alignment, CACHE_LINE_SIZE));
+}
+
+auto HugePageResource::map(std::size_t) -> void *
+{
+    return nullptr;
+}
+
+#endif
+
+}; // namespace pirks::memory
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+namespace pirks::memory
+{
+
+struct HugePageSettings
+{
+    bool prefault { false }; ///< Touch every page when memory is allocated, not on first use
+    bool lock { false };     ///< Keep pages in RAM (mlock), for memory of real-time threads
+};
+
+/**
+ * @brief Memory for packet pools, frame buffers and queues on 2 MB pages
+ *
+ * Every allocation of at least MIN_MAPPED_SIZE bytes is its own mapping,
+ * rounded up to whole huge pages. Explicit huge pages (MAP_HUGETLB) are
+ * tried first; when none are reserved the mapping is made of normal pages,
+ * aligned to 2 MB and marked for transparent huge pages, so big buffers
+ * need a fraction of TLB entries either way. Smaller allocations come from
+ * the default heap.
+ *
+ * All memory is aligned at least to CACHE_LINE_SIZE, for SIMD loads and so
+ * neighbour buffers never share a cache line. Allocations are expected to
+ * be few and made at startup, wrap the resource into a pool resource for
+ * many small ones.
+ *
+ * Huge pages, prefaulting and locking are available on Unix platforms, on
+ * other ones all memory comes from the default heap.
+ */
+class HugePageResource final: public std::pmr::memory_resource
+{
+public:
+    static constexpr std::size_t HUGE_PAGE_SIZE  = 2 * 1024 * 1024;
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+    static constexpr std::size_t MIN_MAPPED_SIZE = HUGE_PAGE_SIZE / 2;
+
+    explicit HugePageResource(HugePageSettings settings = {});
+
+    HugePageResource(const HugePageResource &)            = delete;
+    HugePageResource &operator=(const HugePageResource &) = delete;
+
+public:
+    /**
+     * @brief Allocations made of explicit huge pages
+     */
+    [[nodiscard]]
+    auto hugePageAllocations() const -> uint64_t;
+
+    /**
+     * @brief Allocations mapped with normal pages, as no huge pages were left
+     */
+    [[nodiscard]]
+    auto fallbackAllocations() const -> uint64_t;
+
+private:
+    auto do_allocate(std::size_t bytes, std::size_t alignment) -> void * override;
+    void do_deallocate(void *memory, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    auto map(std::size_t size) -> void *;
+
+private:
+    HugePageSettings      settings_;
+    std::atomic<uint64_t> hugePageAllocations_ { 0 };
+    std::atomic<uint64_t> fallbackAllocations_ { 0 };
+};
+
+}; // namespace pirks::memory
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace pirks::metrics
+{
+
+// Counters of different threads should not share a cache line
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+#ifdef WITH_METRICS
+
+/**
+ * @brief Monotonic counter, safe to increment from any thread without locking
+ */
+class alignas(CACHE_LINE_SIZE) Counter final
+{
+public:
+    void add(uint64_t value = 1)
+    {
+        value_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]]
+    auto value() const -> uint64_t
+    {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> value_ { 0 };
+};
+
+/**
+ * @brief Value which goes up and down, like depth of a queue
+ */
+class alignas(CACHE_LINE_SIZE) Gauge final
+{
+public:
+    void set(int64_t value)
+    {
+        value_.store(value, std::memory_order_relaxed);
+    }
+
+    void add(int64_t value)
+    {
+        value_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]]
+    auto value() const -> int64_t
+    {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<int64_t> value_ { 0 };
+};
+
+#else
+
+// Metrics are compiled out, calls are optimized away
+
+class Counter final
+{
+public:
+    void add(uint64_t = 1) {}
+
+    [[nodiscard]]
+    auto value() const -> uint64_t
+    {
+        return 0;
+    }
+};
+
+class Gauge final
+{
+public:
+    void set(int64_t) {}
+
+    void add(int64_t) {}
+
+    [[nodiscard]]
+    auto value() const -> int64_t
+    {
+        return 0;
+    }
+};
+
+#endif
+
+}; // namespace pirks::metrics
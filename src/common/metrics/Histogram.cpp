@@ -0,0 +1,100 @@
+#include "Histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace pirks::metrics
+{
+
+auto HistogramSnapshot::quantile(double q) const -> uint64_t
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    // Rank of the value, 1 based: the median of 3 values is the 2nd one
+    const auto rank = std::max(
+            uint64_t { 1 },
+            static_cast<uint64_t>(std::ceil(q * static_cast<double>(count))));
+
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+#ifdef WITH_METRICS
+            return Histogram::bucketUpperBound(i);
+#else
+            return i;
+#endif
+        }
+    }
+
+    return 0;
+}
+
+#ifdef WITH_METRICS
+
+Histogram::~Histogram()
+{
+    for (auto &shard: shards_) {
+        delete shard.load(std::memory_order_acquire);
+    }
+}
+
+auto Histogram::snapshot() const -> HistogramSnapshot
+{
+    HistogramSnapshot snapshot;
+    snapshot.buckets.resize(BUCKET_COUNT);
+
+    // Buckets of a shard may change while they are read, so count is summed
+    // from the same loads as buckets and is consistent with them
+    for (const auto &slot: shards_) {
+        const auto *shard = slot.load(std::memory_order_acquire);
+        if (shard == nullptr) {
+            continue;
+        }
+
+        for (std::size_t i = 0; i < BUCKET_COUNT; ++i) {
+            const auto value = shard->buckets[i].load(std::memory_order_relaxed);
+            snapshot.buckets[i] += value;
+            snapshot.count += value;
+        }
+        snapshot.sum += shard->sum.load(std::memory_order_relaxed);
+    }
+
+    return snapshot;
+}
+
+auto Histogram::allocateShard() -> Shard &
+{
+    auto &slot = shards_[threadIndex()];
+
+    // Another thread with the same index may be allocating it right now
+    auto  *shard    = new Shard();
+    Shard *expected = nullptr;
+    if (!slot.compare_exchange_strong(
+                expected,
+                shard,
+                std::memory_order_acq_rel,
+                std::memory_order_acquire))
+    {
+        delete shard;
+        return *expected;
+    }
+
+    return *shard;
+}
+
+auto Histogram::threadIndex() -> std::size_t
+{
+    static std::atomic<std::size_t> nextIndex { 0 };
+
+    // Threads get consecutive indices, so the first MAX_SHARDS ones never share
+    thread_local const std::size_t index = nextIndex.fetch_add(1, std::memory_order_relaxed)
+                                           % MAX_SHARDS;
+    return index;
+}
+
+#endif
+
+}; // namespace pirks::metrics
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Counter.h"
+
+namespace pirks::metrics
+{
+
+/**
+ * @brief Merged buckets of a histogram at the moment it was read
+ */
+struct HistogramSnapshot
+{
+    std::vector<uint64_t> buckets;
+    uint64_t              count { 0 };
+    uint64_t              sum { 0 };
+
+    /**
+     * @brief Highest value of the bucket where quantile q (0..1) falls, 0 if empty
+     */
+    [[nodiscard]]
+    auto quantile(double q) const -> uint64_t;
+};
+
+#ifdef WITH_METRICS
+
+/**
+ * @brief Latency histogram with HDR-like log-linear buckets
+ *
+ * Every power of two range is split into SUB_BUCKET_COUNT linear buckets, so
+ * a value is known with less than 1 / SUB_BUCKET_COUNT relative error over
+ * the whole 64-bit range. Values are nanoseconds for timings.
+ *
+ * Each thread records into its own shard of buckets, so record() is a
+ * relaxed increment of a cache line nobody else writes. Shards are merged
+ * when the histogram is read. If there are more threads than shards, some
+ * of them share one, which is still correct but slower.
+ */
+class Histogram final
+{
+public:
+    static constexpr std::size_t SUB_BUCKET_BITS  = 5;
+    static constexpr std::size_t SUB_BUCKET_COUNT = std::size_t { 1 } << SUB_BUCKET_BITS;
+    static constexpr std::size_t BUCKET_COUNT     = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+    static constexpr std::size_t MAX_SHARDS       = 16;
+
+public:
+    Histogram() = default;
+    ~Histogram();
+
+    Histogram(const Histogram &)            = delete;
+    Histogram &operator=(const Histogram &) = delete;
+
+public:
+    void record(uint64_t value)
+    {
+        auto &shard = threadShard();
+        shard.buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    template<class Rep, class Period>
+    void record(std::chrono::duration<Rep, Period> duration)
+    {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        record(ns > 0 ? static_cast<uint64_t>(ns) : 0);
+    }
+
+    [[nodiscard]]
+    auto snapshot() const -> HistogramSnapshot;
+
+    [[nodiscard]]
+    static constexpr auto bucketIndex(uint64_t value) -> std::size_t
+    {
+        if (value < SUB_BUCKET_COUNT) {
+            return static_cast<std::size_t>(value);
+        }
+
+        // Highest bit selects the range, next SUB_BUCKET_BITS bits the bucket in it
+        const auto exponent = static_cast<std::size_t>(std::bit_width(value)) - 1;
+        const auto shift    = exponent - SUB_BUCKET_BITS;
+        const auto sub      = static_cast<std::size_t>(value >> shift) - SUB_BUCKET_COUNT;
+        return (shift + 1) * SUB_BUCKET_COUNT + sub;
+    }
+
+    /**
+     * @brief Highest value which falls into the bucket
+     */
+    [[nodiscard]]
+    static constexpr auto bucketUpperBound(std::size_t index) -> uint64_t
+    {
+        if (index < SUB_BUCKET_COUNT) {
+            return index;
+        }
+
+        const auto shift = index / SUB_BUCKET_COUNT - 1;
+        const auto sub   = index % SUB_BUCKET_COUNT;
+        const auto lower = uint64_t { SUB_BUCKET_COUNT + sub } << shift;
+        return lower + ((uint64_t { 1 } << shift) - 1);
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Shard
+    {
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets {};
+        std::atomic<uint64_t>                           sum { 0 };
+    };
+
+private:
+    /**
+     * @brief Shard of the calling thread, allocated on its first record
+     */
+    auto threadShard() -> Shard &
+    {
+        auto *shard = shards_[threadIndex()].load(std::memory_order_acquire);
+        return shard != nullptr ? *shard : allocateShard();
+    }
+
+    auto allocateShard() -> Shard &;
+
+    static auto threadIndex() -> std::size_t;
+
+private:
+    std::array<std::atomic<Shard *>, MAX_SHARDS> shards_ {};
+};
+
+#else
+
+class Histogram final
+{
+public:
+    void record(uint64_t) {}
+
+    template<class Rep, class Period>
+    void record(std::chrono::duration<Rep, Period>)
+    {
+    }
+
+    [[nodiscard]]
+    auto snapshot() const -> HistogramSnapshot
+    {
+        return {};
+    }
+};
+
+#endif
+
+#ifdef WITH_METRICS
+
+/**
+ * @brief Record time spent in a scope into a histogram
+ */
+class ScopedTimer final
+{
+public:
+    explicit ScopedTimer(Histogram &histogram)
+            : histogram_ { histogram }
+            , start_ { std::chrono::steady_clock::now() }
+    {
+    }
+
+    ~ScopedTimer()
+    {
+        histogram_.record(std::chrono::steady_clock::now() - start_);
+    }
+
+    ScopedTimer(const ScopedTimer &)            = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+    Histogram                            &histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#else
+
+class ScopedTimer final
+{
+public:
+    explicit ScopedTimer(Histogram &) {}
+};
+
+#endif
+
+}; // namespace pirks::metrics
@@ -0,0 +1,287 @@
+#include "MetricsExporter.h"
+
+#include <spdlog/spdlog.h>
+
+#include <stdexcept>
+
+#if defined(WITH_METRICS) && defined(UNIX)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace pirks::metrics
+{
+
+#if defined(WITH_METRICS) && defined(UNIX)
+
+namespace {
+
+// How long the serving thread waits for a client before checking stop flag
+constexpr int POLL_INTERVAL_MS = 100;
+
+// Slow or stuck client must not keep others from scraping
+constexpr timeval CLIENT_TIMEOUT = { 1, 0 };
+
+// Request line and headers of a scrape are much smaller
+constexpr std::size_t MAX_REQUEST_SIZE = 4096;
+
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+bool sendAll(int fd, const std::string &data)
+{
+    std::size_t offset = 0;
+    while (offset < data.size()) {
+        const auto sent = ::send(fd, data.data() + offset, data.size() - offset, SEND_FLAGS);
+        if (sent <= 0) {
+            return false;
+        }
+        offset += static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+} // namespace
+
+bool isAvailable()
+{
+    return true;
+}
+
+MetricsExporter::MetricsExporter(Registry &registry)
+        : registry_ { registry }
+        , stop_ { false }
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    stop();
+
+    for (const auto fd: listeners_) {
+        ::close(fd);
+    }
+    if (!unixPath_.empty()) {
+        ::unlink(unixPath_.c_str());
+    }
+}
+
+void MetricsExporter::listenTcp(uint16_t port)
+{
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error(fmt::format("Can't create metrics socket, error {}", errno));
+    }
+
+    const int reuse = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    // Metrics are for this machine only
+    sockaddr_in address {};
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port        = htons(port);
+
+    socklen_t length = sizeof(address);
+    if (::bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0
+        || ::listen(fd, SOMAXCONN) != 0
+        || ::getsockname(fd, reinterpret_cast<sockaddr *>(&address), &length) != 0)
+    {
+        const auto error = errno;
+        ::close(fd);
+        throw std::runtime_error(
+                fmt::format("Can't listen metrics port {}, error {}", port, error));
+    }
+
+    tcpPort_ = ntohs(address.sin_port);
+    listeners_.push_back(fd);
+
+    spdlog::info("Metrics are served on http://127.0.0.1:{}/metrics", tcpPort_);
+}
+
+void MetricsExporter::listenUnix(const std::string &path)
+{
+    sockaddr_un address {};
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error(fmt::format("Invalid metrics socket path '{}'", path));
+    }
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error(fmt::format("Can't create metrics socket, error {}", errno));
+    }
+
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.data(), path.size());
+
+    // Left from a previous run which did not exit cleanly
+    ::unlink(path.c_str());
+
+    if (::bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0
+        || ::listen(fd, SOMAXCONN) != 0)
+    {
+        const auto error = errno;
+        ::close(fd);
+        throw std::runtime_error(
+                fmt::format("Can't listen metrics socket {}, error {}", path, error));
+    }
+
+    unixPath_ = path;
+    listeners_.push_back(fd);
+
+    spdlog::info("Metrics are served on unix socket {}", path);
+}
+
+void MetricsExporter::start()
+{
+    if (listeners_.empty() || serveThread_.joinable()) {
+        return;
+    }
+
+    stop_        = false;
+    serveThread_ = std::thread(serveThreadFunc, this);
+}
+
+void MetricsExporter::stop()
+{
+    stop_ = true;
+
+    if (serveThread_.joinable()) {
+        serveThread_.join();
+    }
+}
+
+auto MetricsExporter::tcpPort() const -> uint16_t
+{
+    return tcpPort_;
+}
+
+void MetricsExporter::serveThreadFunc(MetricsExporter *exporter)
+{
+    std::vector<pollfd> fds;
+    for (const auto fd: exporter->listeners_) {
+        fds.push_back({ fd, POLLIN, 0 });
+    }
+
+    while (!exporter->stop_) {
+        if (::poll(fds.data(), fds.size(), POLL_INTERVAL_MS) <= 0) {
+            continue;
+        }
+
+        for (const auto &listener: fds) {
+            if ((listener.revents & POLLIN) == 0) {
+                continue;
+            }
+
+            const int client = ::accept(listener.fd, nullptr, nullptr);
+            if (client < 0) {
+                continue;
+            }
+            exporter->serve(client);
+            ::close(client);
+        }
+    }
+}
+
+void MetricsExporter::serve(int client)
+{
+    ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &CLIENT_TIMEOUT, sizeof(CLIENT_TIMEOUT));
+    ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &CLIENT_TIMEOUT, sizeof(CLIENT_TIMEOUT));
+
+    // Only the request line matters, read until the end of headers
+    std::string                        request;
+    std::array<char, MAX_REQUEST_SIZE> buffer;
+    while (request.size() < MAX_REQUEST_SIZE && request.find("\r\n\r\n") == std::string::npos) {
+        const auto size = ::recv(client, buffer.data(), buffer.size(), 0);
+        if (size <= 0) {
+            return;
+        }
+        request.append(buffer.data(), static_cast<std::size_t>(size));
+    }
+
+    if (!request.starts_with("GET ")) {
+        sendAll(client,
+                "HTTP/1.1 405 Method Not Allowed\r\n"
+                "Content-Length: 0\r\n"
+                "Connection: close\r\n\r\n");
+        return;
+    }
+
+    const auto body = registry_.exposition();
+    sendAll(client,
+            fmt::format(
+                    "HTTP/1.1 200 OK\r\n"
+                    "Content-Type: text/plain; version=0.0.4\r\n"
+                    "Content-Length: {}\r\n"
+                    "Connection: close\r\n\r\n",
+                    body.size()));
+    sendAll(client, body);
+}
+
+#else
+
+bool isAvailable()
+{
+    return false;
+}
+
+MetricsExporter::MetricsExporter(Registry &registry)
+        : registry_ { registry }
+        , stop_ { false }
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    //
+}
+
+void MetricsExporter::listenTcp(uint16_t)
+{
+    throw std::runtime_error("Metrics are not available in this build");
+}
+
+void MetricsExporter::listenUnix(const std::string &)
+{
+    throw std::runtime_error("Metrics are not available in this build");
+}
+
+void MetricsExporter::start()
+{
+    //
+}
+
+void MetricsExporter::stop()
+{
+    //
+}
+
+auto MetricsExporter::tcpPort() const -> uint16_t
+{
+    return tcpPort_;
+}
+
+void MetricsExporter::serveThreadFunc(MetricsExporter *)
+{
+    //
+}
+
+void MetricsExporter::serve(int)
+{
+    //
+}
+
+#endif
+
+}; // namespace pirks::metrics
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Registry.h"
+
+namespace pirks::metrics
+{
+
+/**
+ * @brief true if the library is built with metrics and can export them
+ */
+[[nodiscard]]
+bool isAvailable();
+
+/**
+ * @brief Serves metrics of a registry in Prometheus text format
+ *
+ * Plain HTTP on a loopback TCP port, so Prometheus can scrape it, and/or on
+ * a Unix socket for local tools: curl --unix-socket <path> http://localhost/metrics
+ * Every request gets the whole exposition, one client at a time, from its
+ * own thread, so hot paths are never blocked by a scrape.
+ *
+ * Available only when built with metrics on a Unix platform, otherwise
+ * listen functions throw std::runtime_error.
+ */
+class MetricsExporter final
+{
+public:
+    explicit MetricsExporter(Registry &registry = Registry::instance());
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter &)            = delete;
+    MetricsExporter &operator=(const MetricsExporter &) = delete;
+
+public:
+    /**
+     * @brief Listen on 127.0.0.1, 0 - any free port. Throws std::runtime_error
+     */
+    void listenTcp(uint16_t port);
+
+    /**
+     * @brief Listen on a Unix socket, stale socket file is replaced. Throws std::runtime_error
+     */
+    void listenUnix(const std::string &path);
+
+    /**
+     * @brief Start serving everything it listens on
+     */
+    void start();
+    void stop();
+
+    /**
+     * @brief Port of listenTcp(), 0 if it does not listen on TCP
+     */
+    [[nodiscard]]
+    auto tcpPort() const -> uint16_t;
+
+private:
+    static void serveThreadFunc(MetricsExporter *exporter);
+
+    void serve(int client);
+
+private:
+    Registry        &registry_;
+    std::vector<int> listeners_;
+    std::string      unixPath_;
+    uint16_t         tcpPort_ { 0 };
+    std::atomic_bool stop_;
+    std::thread      serveThread_;
+};
+
+}; // namespace pirks::metrics
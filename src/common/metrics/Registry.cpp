@@ -0,0 +1,172 @@
+#include "Registry.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <stdexcept>
+
+namespace pirks::metrics
+{
+
+namespace {
+
+// Quantiles every summary is exported with
+constexpr std::array<double, 4> QUANTILES = { 0.5, 0.9, 0.99, 0.999 };
+
+constexpr double NS_PER_SECOND = 1e9;
+
+// name{labels} or name{labels,extra}
+auto seriesName(const std::string &name, const std::string &labels, const std::string &extra = {})
+        -> std::string
+{
+    if (labels.empty() && extra.empty()) {
+        return name;
+    }
+    if (labels.empty() || extra.empty()) {
+        return fmt::format("{}{{{}{}}}", name, labels, extra);
+    }
+    return fmt::format("{}{{{},{}}}", name, labels, extra);
+}
+
+} // namespace
+
+auto Registry::instance() -> Registry &
+{
+    static Registry registry;
+    return registry;
+}
+
+auto Registry::counter(const std::string &name, const std::string &help, const std::string &labels)
+        -> Counter &
+{
+    return *findOrCreate(name, help, labels, Type::Counter).counter;
+}
+
+auto Registry::gauge(const std::string &name, const std::string &help, const std::string &labels)
+        -> Gauge &
+{
+    return *findOrCreate(name, help, labels, Type::Gauge).gauge;
+}
+
+auto Registry::histogram(
+        const std::string &name,
+        const std::string &help,
+        const std::string &labels) -> Histogram &
+{
+    return *findOrCreate(name, help, labels, Type::Summary).histogram;
+}
+
+auto Registry::exposition() const -> std::string
+{
+    std::string out;
+    auto        it = std::back_inserter(out);
+
+    std::lock_guard lock { mutex_ };
+
+    for (const auto &family: families_) {
+        static constexpr std::array<const char *, 3> TYPE_NAMES = { "counter", "gauge", "summary" };
+
+        fmt::format_to(it, "# HELP {} {}\n", family->name, family->help);
+        fmt::format_to(
+                it,
+                "# TYPE {} {}\n",
+                family->name,
+                TYPE_NAMES[static_cast<std::size_t>(family->type)]);
+
+        for (const auto &series: family->series) {
+            switch (family->type) {
+            case Type::Counter:
+                fmt::format_to(
+                        it,
+                        "{} {}\n",
+                        seriesName(family->name, series->labels),
+                        series->counter->value());
+                break;
+
+            case Type::Gauge:
+                fmt::format_to(
+                        it,
+                        "{} {}\n",
+                        seriesName(family->name, series->labels),
+                        series->gauge->value());
+                break;
+
+            case Type::Summary: {
+                const auto snapshot = series->histogram->snapshot();
+                for (const auto q: QUANTILES) {
+                    fmt::format_to(
+                            it,
+                            "{} {}\n",
+                            seriesName(
+                                    family->name,
+                                    series->labels,
+                                    fmt::format("quantile=\"{}\"", q)),
+                            static_cast<double>(snapshot.quantile(q)) / NS_PER_SECOND);
+                }
+                fmt::format_to(
+                        it,
+                        "{} {}\n",
+                        seriesName(family->name + "_sum", series->labels),
+                        static_cast<double>(snapshot.sum) / NS_PER_SECOND);
+                fmt::format_to(
+                        it,
+                        "{} {}\n",
+                        seriesName(family->name + "_count", series->labels),
+                        snapshot.count);
+                break;
+            }
+            }
+        }
+    }
+
+    return out;
+}
+
+auto Registry::findOrCreate(
+        const std::string &name,
+        const std::string &help,
+        const std::string &labels,
+        Type               type) -> Series &
+{
+    std::lock_guard lock { mutex_ };
+
+    auto family = std::find_if(families_.begin(), families_.end(), [&name](const auto &f) {
+        return f->name == name;
+    });
+    if (family == families_.end()) {
+        family = families_.insert(
+                families_.end(),
+                std::make_unique<Family>(Family { name, help, type, {} }));
+    } else if ((*family)->type != type) {
+        throw std::invalid_argument(fmt::format("Metric {} is registered with another type", name));
+    }
+
+    auto &all = (*family)->series;
+    auto  it  = std::find_if(all.begin(), all.end(), [&labels](const auto &s) {
+        return s->labels == labels;
+    });
+    if (it != all.end()) {
+        return **it;
+    }
+
+    auto series    = std::make_unique<Series>();
+    series->labels = labels;
+    switch (type) {
+    case Type::Counter:
+        series->counter = std::make_unique<Counter>();
+        break;
+    case Type::Gauge:
+        series->gauge = std::make_unique<Gauge>();
+        break;
+    case Type::Summary:
+        series->histogram = std::make_unique<Histogram>();
+        break;
+    }
+
+    all.push_back(std::move(series));
+    return *all.back();
+}
+
+}; // namespace pirks::metrics
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Counter.h"
+#include "Histogram.h"
+
+namespace pirks::metrics
+{
+
+/**
+ * @brief All metrics of the process, by name and labels
+ *
+ * Metrics are created once and live as long as the process, so the returned
+ * references can be kept by hot paths. Asking for the same name and labels
+ * again returns the same metric. Only creation and reading take the lock.
+ *
+ * Labels are written the way Prometheus expects them: channel="video".
+ * Histograms hold nanoseconds and are exported as summaries in seconds.
+ */
+class Registry final
+{
+public:
+    static auto instance() -> Registry &;
+
+public:
+    auto counter(const std::string &name, const std::string &help, const std::string &labels = {})
+            -> Counter &;
+
+    auto gauge(const std::string &name, const std::string &help, const std::string &labels = {})
+            -> Gauge &;
+
+    auto histogram(
+            const std::string &name,
+            const std::string &help,
+            const std::string &labels = {}) -> Histogram &;
+
+    /**
+     * @brief Current values in Prometheus text exposition format
+     */
+    [[nodiscard]]
+    auto exposition() const -> std::string;
+
+private:
+    enum class Type
+    {
+        Counter,
+        Gauge,
+        Summary,
+    };
+
+    struct Series
+    {
+        std::string                labels;
+        std::unique_ptr<Counter>   counter;
+        std::unique_ptr<Gauge>     gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    struct Family
+    {
+        std::string                          name;
+        std::string                          help;
+        Type                                 type { Type::Counter };
+        std::vector<std::unique_ptr<Series>> series;
+    };
+
+private:
+    Registry() = default;
+
+    auto findOrCreate(
+            const std::string &name,
+            const std::string &help,
+            const std::string &labels,
+            Type               type) -> Series &;
+
+private:
+    mutable std::mutex                   mutex_;
+    std::vector<std::unique_ptr<Family>> families_;
+};
+
+}; // namespace pirks::metrics
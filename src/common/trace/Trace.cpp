@@ -0,0 +1,360 @@
+#include "Trace.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef LINUX
+#include <time.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PIRKS_TRACE_TSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace pirks::trace
+{
+
+namespace {
+
+// Unused with TSC and without WITH_TRACING
+[[maybe_unused]]
+auto monotonicNs() -> uint64_t
+{
+#ifdef LINUX
+    // Not slewed by NTP, so durations are exact
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &time);
+    return static_cast<uint64_t>(time.tv_sec) * 1'000'000'000
+           + static_cast<uint64_t>(time.tv_nsec);
+#else
+    const auto time = std::chrono::steady_clock::now().time_since_epoch();
+    const auto ns   = std::chrono::duration_cast<std::chrono::nanoseconds>(time);
+    return static_cast<uint64_t>(ns.count());
+#endif
+}
+
+} // namespace
+
+auto now() -> uint64_t
+{
+#ifdef PIRKS_TRACE_TSC
+    return __rdtsc();
+#else
+    return monotonicNs();
+#endif
+}
+
+#ifdef WITH_TRACING
+
+namespace detail {
+
+std::atomic_bool g_enabled { false };
+
+} // namespace detail
+
+namespace {
+
+// Fields are atomics because the ring is read while its thread writes it,
+// relaxed stores of them cost the same as plain ones
+struct Event
+{
+    std::atomic<uint64_t>     start { 0 };
+    std::atomic<uint64_t>     duration { 0 };
+    std::atomic<const char *> category { nullptr };
+    std::atomic<const char *> name { nullptr };
+};
+
+/**
+ * @brief Events of one thread, written only by it
+ *
+ * head is the number of events ever written, event i is in slot
+ * i % RING_CAPACITY. Ring of an exited thread keeps its events until
+ * another thread takes it.
+ */
+struct Ring
+{
+    std::array<Event, RING_CAPACITY> events;
+    std::atomic<uint64_t>            head { 0 };
+    std::atomic<const char *>        threadName { nullptr };
+    uint32_t                         threadId { 0 };
+    bool                             inUse { false };
+};
+
+class Rings final
+{
+public:
+    auto acquire(const char *thread_name) -> Ring *
+    {
+        std::lock_guard lock { mutex_ };
+
+        Ring *ring = nullptr;
+        for (const auto &r: rings_) {
+            if (!r->inUse) {
+                ring = r.get();
+                break;
+            }
+        }
+        if (ring == nullptr) {
+            rings_.push_back(std::make_unique<Ring>());
+            ring = rings_.back().get();
+        }
+
+        ring->head.store(0, std::memory_order_relaxed);
+        ring->threadName.store(thread_name, std::memory_order_relaxed);
+        ring->threadId = ++lastThreadId_;
+        ring->inUse    = true;
+        return ring;
+    }
+
+    void release(Ring *ring)
+    {
+        std::lock_guard lock { mutex_ };
+        ring->inUse = false;
+    }
+
+    /**
+     * @brief Call f for every ring, new rings can't be added meanwhile
+     */
+    template<class F>
+    void forEach(F &&f)
+    {
+        std::lock_guard lock { mutex_ };
+        for (const auto &ring: rings_) {
+            f(*ring);
+        }
+    }
+
+private:
+    std::mutex                         mutex_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+    uint32_t                           lastThreadId_ { 0 };
+};
+
+auto rings() -> Rings &
+{
+    static Rings instance;
+    return instance;
+}
+
+// Gives the ring back when its thread exits
+struct ThreadRing
+{
+    Ring *ring { nullptr };
+
+    ~ThreadRing()
+    {
+        if (ring != nullptr) {
+            rings().release(ring);
+        }
+    }
+};
+
+// Ring is taken on the first event, so threads which never record one
+// don't hold memory for it
+thread_local ThreadRing  t_ring;
+thread_local const char *t_threadName = nullptr;
+
+auto threadRing() -> Ring &
+{
+    if (t_ring.ring == nullptr) {
+        t_ring.ring = rings().acquire(t_threadName);
+    }
+    return *t_ring.ring;
+}
+
+// Same moment in both clocks
+struct ClockPoint
+{
+    uint64_t ticks;
+    uint64_t ns;
+
+    static auto read() -> ClockPoint
+    {
+        return { now(), monotonicNs() };
+    }
+};
+
+// Ticks are converted with the rate measured from the start of the process
+// to the moment trace is written
+const ClockPoint g_processStart = ClockPoint::read();
+
+// Shorter interval would make the rate of TSC inexact
+constexpr auto MIN_CALIBRATION_TIME = std::chrono::milliseconds(10);
+
+auto nsPerTick() -> double
+{
+    auto point = ClockPoint::read();
+
+    const auto elapsed = std::chrono::nanoseconds(point.ns - g_processStart.ns);
+    if (elapsed < MIN_CALIBRATION_TIME) {
+        std::this_thread::sleep_for(MIN_CALIBRATION_TIME - elapsed);
+        point = ClockPoint::read();
+    }
+
+    return static_cast<double>(point.ns - g_processStart.ns)
+           / static_cast<double>(point.ticks - g_processStart.ticks);
+}
+
+// Event copied out of a ring
+struct Copy
+{
+    uint64_t    start;
+    uint64_t    duration; ///< 0 for instant events
+    const char *category;
+    const char *name;
+};
+
+} // namespace
+
+void detail::record(const char *category, const char *name, uint64_t start, uint64_t duration)
+{
+    auto &ring = threadRing();
+
+    const auto head  = ring.head.load(std::memory_order_relaxed);
+    auto      &event = ring.events[head % RING_CAPACITY];
+    event.start.store(start, std::memory_order_relaxed);
+    event.duration.store(duration, std::memory_order_relaxed);
+    event.category.store(category, std::memory_order_relaxed);
+    event.name.store(name, std::memory_order_relaxed);
+
+    // Publishes the event to writeChromeJson()
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+bool isAvailable()
+{
+    return true;
+}
+
+void enable(bool enabled)
+{
+    detail::g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void setThreadName(const char *name)
+{
+    t_threadName = name;
+    if (t_ring.ring != nullptr) {
+        t_ring.ring->threadName.store(name, std::memory_order_relaxed);
+    }
+}
+
+bool writeChromeJson(const std::string &file)
+{
+    std::ofstream out { file };
+    if (!out) {
+        spdlog::error("Can't write trace to {}", file);
+        return false;
+    }
+
+    const auto rate = nsPerTick();
+
+    // Microseconds with nanosecond precision, as the format expects
+    auto micros = [rate](uint64_t ticks) {
+        return fmt::format("{:.3f}", static_cast<double>(ticks) * rate / 1000.0);
+    };
+    auto timestamp = [&micros](uint64_t ticks) {
+        return micros(ticks - g_processStart.ticks);
+    };
+
+    std::size_t written = 0;
+    auto        next    = [&out, &written]() -> std::ofstream & {
+        out << (written++ == 0 ? "\n" : ",\n");
+        return out;
+    };
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    rings().forEach([&](Ring &ring) {
+        if (const auto *name = ring.threadName.load(std::memory_order_relaxed)) {
+            next() << fmt::format(
+                    R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})",
+                    ring.threadId,
+                    name);
+        }
+
+        const auto head  = ring.head.load(std::memory_order_acquire);
+        const auto first = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+
+        std::vector<Copy> events;
+        events.reserve(head - first);
+        for (auto i = first; i < head; ++i) {
+            const auto &event = ring.events[i % RING_CAPACITY];
+            events.push_back({ event.start.load(std::memory_order_relaxed),
+                               event.duration.load(std::memory_order_relaxed),
+                               event.category.load(std::memory_order_relaxed),
+                               event.name.load(std::memory_order_relaxed) });
+        }
+
+        // Events the thread has overwritten while they were copied are torn
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const auto newHead = ring.head.load(std::memory_order_relaxed);
+        const auto valid   = newHead >= RING_CAPACITY ? newHead - RING_CAPACITY + 1 : 0;
+
+        for (auto i = std::max(first, valid); i < head; ++i) {
+            const auto &[start, duration, category, name] = events[i - first];
+
+            if (duration == 0) {
+                next() << fmt::format(
+                        R"({{"name":"{}","cat":"{}","ph":"i","s":"t","ts":{},"pid":1,"tid":{}}})",
+                        name,
+                        category,
+                        timestamp(start),
+                        ring.threadId);
+            } else {
+                next() << fmt::format(
+                        R"({{"name":"{}","cat":"{}","ph":"X","ts":{},"dur":{},"pid":1,"tid":{}}})",
+                        name,
+                        category,
+                        timestamp(start),
+                        micros(duration),
+                        ring.threadId);
+            }
+        }
+    });
+
+    out << "\n]}\n";
+
+    spdlog::info("Trace of {} events is written to {}", written, file);
+    return static_cast<bool>(out);
+}
+
+#else
+
+bool isAvailable()
+{
+    return false;
+}
+
+void enable(bool)
+{
+    //
+}
+
+void setThreadName(const char *)
+{
+    //
+}
+
+bool writeChromeJson(const std::string &)
+{
+    spdlog::error("Tracing is not available in this build");
+    return false;
+}
+
+#endif
+
+}; // namespace pirks::trace
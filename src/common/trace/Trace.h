@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * @file Trace.h
+ * @brief Scoped trace events for finding which stage held a frame
+ *
+ * Events go into a lock-free ring of the thread which recorded them, the
+ * oldest are overwritten when it's full. writeChromeJson() dumps all rings
+ * in Chrome trace event format, which chrome://tracing and ui.perfetto.dev
+ * open. Category and name must be string literals, only pointers are kept.
+ *
+ * @code
+ * void Stage::run()
+ * {
+ *     PIRKS_TRACE_SCOPE("video", "encode");
+ *     ...
+ * }
+ * @endcode
+ *
+ * Recording is off until enable() is called. Without WITH_TRACING the
+ * macros expand to nothing.
+ */
+
+namespace pirks::trace
+{
+
+// Events each thread keeps, older ones are overwritten
+constexpr std::size_t RING_CAPACITY = 16 * 1024;
+
+/**
+ * @brief Time in ticks of the trace clock
+ *
+ * TSC on x86-64, it's read several times faster than the system clock and
+ * is converted to nanoseconds only when the trace is written. Nanoseconds
+ * of CLOCK_MONOTONIC_RAW or steady_clock elsewhere.
+ */
+[[nodiscard]]
+auto now() -> uint64_t;
+
+#ifdef WITH_TRACING
+
+namespace detail {
+
+extern std::atomic_bool g_enabled;
+
+void record(const char *category, const char *name, uint64_t start, uint64_t duration);
+
+} // namespace detail
+
+[[nodiscard]]
+inline bool isEnabled()
+{
+    return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Records time from construction to destruction as one complete event
+ */
+class Scope final
+{
+public:
+    Scope(const char *category, const char *name)
+            : category_ { category }
+            , name_ { name }
+            , start_ { isEnabled() ? now() : 0 }
+    {
+    }
+
+    ~Scope()
+    {
+        if (start_ != 0) {
+            detail::record(category_, name_, start_, now() - start_);
+        }
+    }
+
+    Scope(const Scope &)            = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    const char *category_;
+    const char *name_;
+    uint64_t    start_;
+};
+
+/**
+ * @brief Records an event without duration
+ */
+inline void instant(const char *category, const char *name)
+{
+    if (isEnabled()) {
+        detail::record(category, name, now(), 0);
+    }
+}
+
+#define PIRKS_TRACE_CONCAT_IMPL(a, b) a##b
+#define PIRKS_TRACE_CONCAT(a, b)      PIRKS_TRACE_CONCAT_IMPL(a, b)
+
+#define PIRKS_TRACE_SCOPE(category, name)                                                       \
+    const ::pirks::trace::Scope PIRKS_TRACE_CONCAT(pirksTraceScope, __LINE__)                   \
+    {                                                                                           \
+        category, name                                                                          \
+    }
+
+#define PIRKS_TRACE_INSTANT(category, name) ::pirks::trace::instant(category, name)
+
+#else
+
+[[nodiscard]]
+inline bool isEnabled()
+{
+    return false;
+}
+
+#define PIRKS_TRACE_SCOPE(category, name)   static_cast<void>(0)
+#define PIRKS_TRACE_INSTANT(category, name) static_cast<void>(0)
+
+#endif
+
+/**
+ * @brief true if the library is built with tracing
+ */
+[[nodiscard]]
+bool isAvailable();
+
+/**
+ * @brief Start or stop recording in all threads
+ */
+void enable(bool enabled = true);
+
+/**
+ * @brief Name of the calling thread in the trace, must be a string literal
+ */
+void setThreadName(const char *name);
+
+/**
+ * @brief Write events of all threads in Chrome trace event format
+ *
+ * Threads keep recording while it's written. Returns false if the file
+ * can't be written or the library is built without tracing.
+ */
+bool writeChromeJson(const std::string &file);
+
+}; // namespace pirks::trace
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace pirks::networking
+{
+
+/**
+ * @brief Bitrate the network can carry right now, as estimated by congestion control
+ *
+ * Connection thread publishes the value, encoder stage keeps a shared pointer
+ * and checks it once per frame: encoder reconfiguration must happen on the
+ * encoding thread, so there are no callbacks from network threads.
+ */
+class BitrateTarget final
+{
+public:
+    explicit BitrateTarget(uint32_t bitrate_kbps) : bitrateKbps_ { bitrate_kbps }
+    {
+        //
+    }
+
+    void set(uint32_t bitrate_kbps)
+    {
+        bitrateKbps_.store(bitrate_kbps, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]]
+    auto get() const -> uint32_t
+    {
+        return bitrateKbps_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint32_t> bitrateKbps_;
+};
+
+}; // namespace pirks::networking
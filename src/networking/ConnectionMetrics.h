@@ -0,0 +1,131 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "PacketInfo.h"
+#include "metrics/Registry.h"
+
+namespace pirks::networking
+{
+
+/**
+ * @brief Why a connection dropped a packet
+ */
+enum class DropReason : uint8_t
+{
+    Budget = 0, ///< Channel is over its multiplexer budget
+    Window,     ///< Send window of a reliable channel is full
+    Pool,       ///< No free block to receive into
+    Auth,       ///< Packet failed authentication or was replayed
+    Queue,      ///< Consumer does not keep up with the input queue
+    Invalid,    ///< Packet to send has a bad channel or size, or is not in a pool block
+};
+
+constexpr std::size_t DROP_REASON_COUNT = 6;
+
+/**
+ * @brief Packets and bytes per channel moved by a connection, and its drops
+ *
+ * Metrics are registered once by the constructor, labelled with the
+ * connection kind, so counting on hot paths is one relaxed increment.
+ */
+class ConnectionMetrics final
+{
+public:
+    explicit ConnectionMetrics(const std::string &connection)
+    {
+        static constexpr std::array<const char *, CHANNEL_COUNT> CHANNELS = {
+            "control",
+            "input",
+            "audio",
+            "video",
+        };
+        static constexpr std::array<const char *, DROP_REASON_COUNT> REASONS = {
+            "budget",
+            "window",
+            "pool",
+            "auth",
+            "queue",
+            "invalid",
+        };
+
+        auto &registry = metrics::Registry::instance();
+
+        for (std::size_t i = 0; i < CHANNEL_COUNT; ++i) {
+            const auto labels = fmt::format(
+                    "connection=\"{}\",channel=\"{}\"",
+                    connection,
+                    CHANNELS[i]);
+
+            sentPackets_[i] = &registry.counter(
+                    "pirks_packets_sent_total",
+                    "Packets sent, fragments and retransmissions included",
+                    labels);
+            sentBytes_[i] = &registry.counter(
+                    "pirks_bytes_sent_total",
+                    "Bytes sent in datagrams, headers included",
+                    labels);
+            receivedPackets_[i] = &registry.counter(
+                    "pirks_packets_received_total",
+                    "Packets received, fragments included",
+                    labels);
+            receivedBytes_[i] = &registry.counter(
+                    "pirks_bytes_received_total",
+                    "Bytes received in datagrams, headers included",
+                    labels);
+        }
+
+        for (std::size_t i = 0; i < DROP_REASON_COUNT; ++i) {
+            dropped_[i] = &registry.counter(
+                    "pirks_packets_dropped_total",
+                    "Packets dropped by connection",
+                    fmt::format("connection=\"{}\",reason=\"{}\"", connection, REASONS[i]));
+        }
+
+        transmitTime_ = &registry.histogram(
+                "pirks_transmit_seconds",
+                "Time to seal and send one datagram",
+                fmt::format("connection=\"{}\"", connection));
+    }
+
+public:
+    void onSent(uint8_t channel, std::size_t bytes)
+    {
+        if (channel < CHANNEL_COUNT) {
+            sentPackets_[channel]->add();
+            sentBytes_[channel]->add(bytes);
+        }
+    }
+
+    void onReceived(uint8_t channel, std::size_t bytes)
+    {
+        if (channel < CHANNEL_COUNT) {
+            receivedPackets_[channel]->add();
+            receivedBytes_[channel]->add(bytes);
+        }
+    }
+
+    void onDropped(DropReason reason)
+    {
+        dropped_[static_cast<std::size_t>(reason)]->add();
+    }
+
+    auto transmitTime() -> metrics::Histogram &
+    {
+        return *transmitTime_;
+    }
+
+private:
+    std::array<metrics::Counter *, CHANNEL_COUNT>     sentPackets_ {};
+    std::array<metrics::Counter *, CHANNEL_COUNT>     sentBytes_ {};
+    std::array<metrics::Counter *, CHANNEL_COUNT>     receivedPackets_ {};
+    std::array<metrics::Counter *, CHANNEL_COUNT>     receivedBytes_ {};
+    std::array<metrics::Counter *, DROP_REASON_COUNT> dropped_ {};
+    metrics::Histogram                               *transmitTime_ { nullptr };
+};
+
+}; // namespace pirks::networking
@@ -2,21 +2,49 @@
 
 #include <inttypes.h>
 
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
 namespace pirks::networking
 {
 
+/**
+ * @brief Logical streams multiplexed over one connection
+ *
+ * Stored in PacketHeader::channel
+ */
+enum Channel : uint8_t
+{
+    Control = 0, ///< Session control messages
+    Input,       ///< Mouse, keyboard, gamepad events from client
+    Audio,       ///< Encoded audio
+    Video        ///< Encoded video slices
+};
+
+constexpr std::size_t CHANNEL_COUNT = 4;
+
+// Units of PacketHeader::timestamp, the same as in RTP
+constexpr uint32_t VIDEO_CLOCK_RATE = 90000;
+constexpr uint32_t AUDIO_CLOCK_RATE = 48000;
+
 #pragma pack(push, 1)
 
 /**
  * @brief This header used to store packet from network in memory
  *
+ * Host byte order, layout on the wire is defined by wire::Header
  */
 struct PacketHeader
 {
     uint8_t  channel { 0 };
     bool     reliable { false };
-    uint16_t reserved { 0 };
+    uint16_t sequence { 0 };      ///< Per-channel sequence number, set by connection on receive
     uint32_t size { 0 };
+    uint32_t timestamp { 0 };     ///< Media time, see VIDEO_CLOCK_RATE, AUDIO_CLOCK_RATE
+    uint16_t fragmentIndex { 0 }; ///< Position of the packet among fragments of one frame
+    uint16_t fragmentCount { 1 };
 };
 
 /**
@@ -30,4 +58,39 @@ struct PacketInfo: public PacketHeader
 
 #pragma pack(pop)
 
+/**
+ * @brief Packets taken from a queue at once by a sending thread
+ *
+ * Memory of up to Capacity packets is inside the object, so a batch on the
+ * stack of a thread never touches the heap, CircularBuffer::pop() resizes
+ * packets() within it. More packets than Capacity throw std::bad_alloc.
+ */
+template<std::size_t Capacity>
+class PacketBatch final
+{
+public:
+    PacketBatch()
+    {
+        packets_.reserve(Capacity);
+    }
+
+    PacketBatch(const PacketBatch &)            = delete;
+    PacketBatch &operator=(const PacketBatch &) = delete;
+
+    [[nodiscard]]
+    auto packets() -> std::pmr::vector<PacketInfo> &
+    {
+        return packets_;
+    }
+
+private:
+    std::array<std::byte, Capacity * sizeof(PacketInfo)> storage_;
+    std::pmr::monotonic_buffer_resource                  arena_ {
+        storage_.data(),
+        storage_.size(),
+        std::pmr::null_memory_resource()
+    };
+    std::pmr::vector<PacketInfo> packets_ { &arena_ };
+};
+
 }; // namespace pirks::networking
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace pirks::networking
+{
+
+/**
+ * @brief Preallocated fixed size blocks for packet payloads
+ *
+ * All memory is allocated in constructor, acquire() and release() only move
+ * pointers between the free list and the caller, so streaming does not touch
+ * the heap. PacketInfo::data points into a block; whoever pops the packet
+ * from the queue is responsible for releasing it.
+ *
+ * Optional headroom is reserved in front of every block, so protocol headers
+ * can be written before the payload without moving it, and tailroom after
+ * it for trailers like authentication tags.
+ */
+class PacketPool final
+{
+public:
+    // Blocks are aligned to cache line, so neighbour packets filled from
+    // different threads do not share cache lines
+    static constexpr std::size_t BLOCK_ALIGNMENT = 64;
+
+    /**
+     * @param block_size    Payload bytes of each block
+     * @param block_count   Number of blocks
+     * @param headroom      Bytes available in front of each block, rounded up
+     *                      to BLOCK_ALIGNMENT so blocks stay aligned
+     * @param tailroom      Bytes available after each block, rounded up the same way
+     * @param resource      Memory of all blocks, e.g. memory::HugePageResource
+     */
+    PacketPool(
+            std::size_t                block_size,
+            std::size_t                block_count,
+            std::size_t                headroom = 0,
+            std::size_t                tailroom = 0,
+            std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : headroom_ { alignUp(headroom) }
+            , blockSize_ { alignUp(block_size) }
+            , tailroom_ { alignUp(tailroom) }
+            , stride_ { headroom_ + blockSize_ + tailroom_ }
+            , blockCount_ { block_count }
+            , storage_(stride_ * block_count + BLOCK_ALIGNMENT, resource)
+    {
+        assert(block_size != 0 && "block size can't be zero");
+
+        auto *first = storage_.data();
+        // Align beginning of the first block
+        const auto misalign = reinterpret_cast<std::uintptr_t>(first) % BLOCK_ALIGNMENT;
+        if (misalign != 0) {
+            first += BLOCK_ALIGNMENT - misalign;
+        }
+        begin_ = first;
+
+        free_.reserve(block_count);
+        // Push in reverse order, so first acquire() returns the first block
+        for (std::size_t i = block_count; i > 0; --i) {
+            free_.push_back(first + (i - 1) * stride_ + headroom_);
+        }
+    }
+
+    PacketPool(const PacketPool &)            = delete;
+    PacketPool &operator=(const PacketPool &) = delete;
+
+public:
+    /**
+     * @brief Take one block from the pool
+     *
+     * @return std::uint8_t*    Block of blockSize() bytes or nullptr if pool is exhausted
+     */
+    [[nodiscard]]
+    auto acquire() -> std::uint8_t *
+    {
+        std::lock_guard lock { mutex_ };
+
+        if (free_.empty()) {
+            return nullptr;
+        }
+
+        auto *block = free_.back();
+        free_.pop_back();
+        return block;
+    }
+
+    /**
+     * @brief Return block to the pool. nullptr is ignored
+     */
+    void release(std::uint8_t *block)
+    {
+        if (block == nullptr) {
+            return;
+        }
+
+        assert(owns(block) && "block does not belong to this pool");
+
+        std::lock_guard lock { mutex_ };
+        assert(free_.size() < blockCount_ && "block released twice");
+        // capacity was reserved in constructor, so this never allocates
+        free_.push_back(block);
+    }
+
+    [[nodiscard]]
+    bool owns(const std::uint8_t *block) const
+    {
+        return block >= begin_ + headroom_ && block < begin_ + stride_ * blockCount_
+               && (static_cast<std::size_t>(block - begin_) - headroom_) % stride_ == 0;
+    }
+
+    [[nodiscard]]
+    auto available() -> std::size_t
+    {
+        std::lock_guard lock { mutex_ };
+        return free_.size();
+    }
+
+    [[nodiscard]]
+    auto blockSize() const -> std::size_t
+    {
+        return blockSize_;
+    }
+
+    /**
+     * @brief Bytes in front of every block which the owner of the block may write
+     */
+    [[nodiscard]]
+    auto headroom() const -> std::size_t
+    {
+        return headroom_;
+    }
+
+    /**
+     * @brief Bytes after every block which the owner of the block may write
+     */
+    [[nodiscard]]
+    auto tailroom() const -> std::size_t
+    {
+        return tailroom_;
+    }
+
+    [[nodiscard]]
+    auto blockCount() const -> std::size_t
+    {
+        return blockCount_;
+    }
+
+private:
+    static constexpr auto alignUp(std::size_t size) -> std::size_t
+    {
+        return (size + BLOCK_ALIGNMENT - 1) & ~(BLOCK_ALIGNMENT - 1);
+    }
+
+private:
+    std::mutex                     mutex_;
+    std::size_t                    headroom_;
+    std::size_t                    blockSize_;
+    std::size_t                    tailroom_;
+    std::size_t                    stride_;
+    std::size_t                    blockCount_;
+    std::pmr::vector<std::uint8_t> storage_;
+    std::uint8_t                  *begin_ { nullptr };
+    std::vector<std::uint8_t *>    free_;
+};
+
+}; // namespace pirks::networking
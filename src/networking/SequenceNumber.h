@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+namespace pirks::networking
+{
+
+/**
+ * @brief Per-channel packet sequence number
+ *
+ * 16 bits wrap around after 65536 packets, which is about 18 seconds of 1080p60 video
+ * slices, so sequence numbers must be compared with sequenceNewer() and never with <.
+ */
+using SequenceNumber = uint16_t;
+
+/**
+ * @brief Distance from b to a going forward, modulo 2^16
+ */
+constexpr auto sequenceDistance(SequenceNumber a, SequenceNumber b) -> uint16_t
+{
+    return static_cast<uint16_t>(a - b);
+}
+
+/**
+ * @brief true if a was sent after b, taking wrap around into account
+ */
+constexpr bool sequenceNewer(SequenceNumber a, SequenceNumber b)
+{
+    const auto distance = sequenceDistance(a, b);
+    return distance != 0 && distance < 0x8000;
+}
+
+/**
+ * @brief Full 64-bit index of seq, the one closest to reference
+ *
+ * Reference is the index of a recent packet of the same sequence space, so
+ * wrap arounds are counted as long as packets are less than 2^15 apart.
+ */
+constexpr auto extendSequence(uint64_t reference, SequenceNumber seq) -> uint64_t
+{
+    const auto distance = static_cast<int16_t>(
+            sequenceDistance(seq, static_cast<SequenceNumber>(reference)));
+
+    // Indices before the first wrap around can't go below zero
+    if (distance < 0 && reference < static_cast<uint64_t>(-distance)) {
+        return seq;
+    }
+    return reference + static_cast<uint64_t>(static_cast<int64_t>(distance));
+}
+
+static_assert(sequenceNewer(1, 0));
+static_assert(sequenceNewer(0, 0xFFFF));
+static_assert(!sequenceNewer(0xFFFF, 0));
+static_assert(!sequenceNewer(5, 5));
+static_assert(extendSequence(0xFFFF, 2) == 0x1'0002);
+static_assert(extendSequence(0x1'0002, 0xFFFE) == 0xFFFE);
+static_assert(extendSequence(3, 0xFFF0) == 0xFFF0);
+static_assert(extendSequence(0, 0) == 0);
+
+}; // namespace pirks::networking
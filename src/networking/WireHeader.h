@@ -0,0 +1,208 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include "PacketInfo.h"
+#include "SequenceNumber.h"
+
+namespace pirks::networking::wire
+{
+
+/**
+ * @brief Version of the datagram format, datagrams of other versions are rejected
+ */
+constexpr uint8_t PROTOCOL_VERSION = 1;
+
+/**
+ * @brief Size of the header in front of every datagram
+ *
+ *   0      version
+ *   1      flags, see Flags
+ *   2      channel
+ *   3      FEC shard, see Header::fecShard
+ *   4..5   sequence number
+ *   6..9   timestamp
+ *   10..11 fragment index
+ *   12..13 fragment count
+ *   14..15 payload size
+ *
+ * All numbers are big endian (network byte order).
+ */
+constexpr std::size_t HEADER_SIZE = 16;
+
+/**
+ * @brief Bytes every packet buffer must have in front of PacketInfo::data
+ *
+ * Header is serialized right before the payload, so the datagram leaves
+ * straight from the pool block and arrives straight into one.
+ */
+constexpr std::size_t PACKET_HEADROOM = HEADER_SIZE;
+
+/**
+ * @brief Bytes every pool block must have after its payload for encrypted packets
+ *
+ * Authentication tag of the payload is appended right after it, see Flags::Encrypted.
+ */
+constexpr std::size_t PACKET_TAILROOM = 16;
+
+enum Flags : uint8_t
+{
+    Reliable  = 1 << 0, ///< Sequence number belongs to reliable sequence space of the channel
+    Ack       = 1 << 1, ///< Payload is an acknowledgement, not a packet
+    Feedback  = 1 << 2, ///< Payload is congestion control feedback, not a packet
+    Encrypted = 1 << 3, ///< Payload is AES-GCM ciphertext followed by PACKET_TAILROOM bytes of tag
+    Parity    = 1 << 4, ///< Payload is FEC parity of the unreliable packets in front of it
+
+    KnownFlags = Reliable | Ack | Feedback | Encrypted | Parity
+};
+
+struct Header
+{
+    uint8_t        version { PROTOCOL_VERSION };
+    uint8_t        flags { 0 };
+    uint8_t        channel { 0 };
+    SequenceNumber sequence { 0 };
+    uint32_t       timestamp { 0 };
+    uint16_t       fragmentIndex { 0 };
+    uint16_t       fragmentCount { 1 };
+    uint16_t       payloadSize { 0 };
+
+    /**
+     * @brief Position of the datagram in its FEC group counting from 1, 0 if it has none
+     *
+     * Only unreliable packets are protected. Group is the run of unreliable
+     * sequence numbers of the channel starting at sequence - (fecShard - 1):
+     * data packets first, then parity. Parity datagrams carry the parity
+     * index and count in the fragment fields, so the group has
+     * fecShard - 1 - fragmentIndex data packets.
+     */
+    uint8_t fecShard { 0 };
+
+    constexpr bool operator==(const Header &) const = default;
+};
+
+template<std::unsigned_integral T>
+constexpr void storeBigEndian(uint8_t *out, T value)
+{
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * (sizeof(T) - 1 - i)));
+    }
+}
+
+template<std::unsigned_integral T>
+constexpr auto loadBigEndian(const uint8_t *in) -> T
+{
+    T value = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        value = static_cast<T>((value << 8) | in[i]);
+    }
+    return value;
+}
+
+/**
+ * @brief Header of a data packet, to be serialized in front of its payload
+ */
+constexpr auto packetHeader(const PacketHeader &packet, SequenceNumber seq) -> Header
+{
+    Header header;
+    header.flags         = packet.reliable ? Flags::Reliable : 0;
+    header.channel       = packet.channel;
+    header.sequence      = seq;
+    header.timestamp     = packet.timestamp;
+    header.fragmentIndex = packet.fragmentIndex;
+    header.fragmentCount = packet.fragmentCount;
+    header.payloadSize   = static_cast<uint16_t>(packet.size);
+    return header;
+}
+
+/**
+ * @brief Header space in front of the payload of a packet buffer with PACKET_HEADROOM
+ */
+constexpr auto headerBefore(uint8_t *payload) -> std::span<uint8_t, HEADER_SIZE>
+{
+    return std::span<uint8_t, HEADER_SIZE> { payload - HEADER_SIZE, HEADER_SIZE };
+}
+
+constexpr void serialize(const Header &header, std::span<uint8_t, HEADER_SIZE> out)
+{
+    out[0] = header.version;
+    out[1] = header.flags;
+    out[2] = header.channel;
+    out[3] = header.fecShard;
+    storeBigEndian(&out[4], header.sequence);
+    storeBigEndian(&out[6], header.timestamp);
+    storeBigEndian(&out[10], header.fragmentIndex);
+    storeBigEndian(&out[12], header.fragmentCount);
+    storeBigEndian(&out[14], header.payloadSize);
+}
+
+/**
+ * @brief Header of a received datagram, nullopt if the datagram is malformed
+ *
+ * Payload is the rest of the datagram, datagrams which are truncated or
+ * longer than the header says are rejected.
+ */
+constexpr auto parse(std::span<const uint8_t> datagram) -> std::optional<Header>
+{
+    if (datagram.size() < HEADER_SIZE) {
+        return std::nullopt;
+    }
+
+    Header header;
+    header.version       = datagram[0];
+    header.flags         = datagram[1];
+    header.channel       = datagram[2];
+    header.fecShard      = datagram[3];
+    header.sequence      = loadBigEndian<uint16_t>(&datagram[4]);
+    header.timestamp     = loadBigEndian<uint32_t>(&datagram[6]);
+    header.fragmentIndex = loadBigEndian<uint16_t>(&datagram[10]);
+    header.fragmentCount = loadBigEndian<uint16_t>(&datagram[12]);
+    header.payloadSize   = loadBigEndian<uint16_t>(&datagram[14]);
+
+    const bool control  = (header.flags & (Flags::Ack | Flags::Feedback)) != 0;
+    const bool reliable = (header.flags & Flags::Reliable) != 0;
+    const bool parity   = (header.flags & Flags::Parity) != 0;
+
+    if (header.version != PROTOCOL_VERSION || (header.flags & ~Flags::KnownFlags) != 0
+        || header.channel >= CHANNEL_COUNT || header.payloadSize != datagram.size() - HEADER_SIZE
+        || header.fragmentIndex >= header.fragmentCount
+        || (control && header.fragmentCount != 1)
+        || (header.fecShard != 0 && (control || reliable))
+        || (parity && header.fecShard < header.fragmentIndex + 2))
+    {
+        return std::nullopt;
+    }
+
+    return header;
+}
+
+static_assert(
+        [] {
+            Header header;
+            header.flags         = Flags::Reliable;
+            header.channel       = Channel::Video;
+            header.sequence      = 0xABCD;
+            header.timestamp     = 0x01020304;
+            header.fragmentIndex = 2;
+            header.fragmentCount = 3;
+            header.payloadSize   = 0;
+
+            std::array<uint8_t, HEADER_SIZE> buffer {};
+            serialize(header, buffer);
+            if (buffer[4] != 0xAB || buffer[6] != 0x01 || parse(buffer) != header) {
+                return false;
+            }
+
+            header.flags    = Flags::Parity;
+            header.fecShard = 10;
+            serialize(header, buffer);
+            return buffer[3] == 10 && parse(buffer) == header;
+        }(),
+        "header must round trip in big endian");
+
+}; // namespace pirks::networking::wire
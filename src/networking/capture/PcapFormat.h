@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include "PacketInfo.h"
+#include "WireHeader.h"
+
+/**
+ * @file PcapFormat.h
+ * @brief Blocks of pcapng files written and read by packet capture
+ *
+ * A file is one section header block, one interface description block and
+ * an enhanced packet block per packet, in host byte order as pcapng allows.
+ * Direction of a packet is in its epb_flags option. Packet data is
+ * RECORD_HEADER_SIZE bytes of PacketHeader followed by the payload, link
+ * type is LINKTYPE_USER0, so Wireshark shows it as raw data unless a
+ * dissector is configured for it.
+ */
+
+namespace pirks::networking::capture
+{
+
+/**
+ * @brief Direction bits of epb_flags option
+ */
+enum class Direction : uint32_t
+{
+    Unknown  = 0,
+    Inbound  = 1, ///< Packet received from network
+    Outbound = 2  ///< Packet to be sent
+};
+
+namespace pcapng {
+
+constexpr uint32_t SECTION_HEADER_BLOCK   = 0x0A0D0D0A;
+constexpr uint32_t INTERFACE_BLOCK        = 0x00000001;
+constexpr uint32_t ENHANCED_PACKET_BLOCK  = 0x00000006;
+constexpr uint32_t BYTE_ORDER_MAGIC       = 0x1A2B3C4D;
+constexpr uint16_t LINKTYPE_USER0         = 147;
+constexpr uint16_t OPTION_END             = 0;
+constexpr uint16_t OPTION_EPB_FLAGS       = 2;
+constexpr uint32_t EPB_FLAGS_DIRECTION    = 0x3;
+constexpr uint64_t UNKNOWN_SECTION_LENGTH = ~uint64_t { 0 };
+
+#pragma pack(push, 1)
+
+/**
+ * @brief First block of the file, without options
+ */
+struct SectionHeader
+{
+    uint32_t type { SECTION_HEADER_BLOCK };
+    uint32_t length { 28 };
+    uint32_t byteOrderMagic { BYTE_ORDER_MAGIC };
+    uint16_t majorVersion { 1 };
+    uint16_t minorVersion { 0 };
+    uint64_t sectionLength { UNKNOWN_SECTION_LENGTH };
+    uint32_t trailingLength { 28 };
+};
+
+/**
+ * @brief The only interface of the file, timestamps are in microseconds
+ */
+struct InterfaceDescription
+{
+    uint32_t type { INTERFACE_BLOCK };
+    uint32_t length { 20 };
+    uint16_t linkType { LINKTYPE_USER0 };
+    uint16_t reserved { 0 };
+    uint32_t snapLength { 0 }; ///< No limit
+    uint32_t trailingLength { 20 };
+};
+
+/**
+ * @brief Fields of enhanced packet block in front of packet data
+ */
+struct EnhancedPacketHeader
+{
+    uint32_t type { ENHANCED_PACKET_BLOCK };
+    uint32_t length { 0 };
+    uint32_t interfaceId { 0 };
+    uint32_t timestampHigh { 0 };
+    uint32_t timestampLow { 0 };
+    uint32_t capturedLength { 0 };
+    uint32_t originalLength { 0 };
+};
+
+/**
+ * @brief Options and the trailing length after packet data padded to 4 bytes
+ */
+struct EnhancedPacketTrailer
+{
+    uint16_t flagsCode { OPTION_EPB_FLAGS };
+    uint16_t flagsLength { sizeof(uint32_t) };
+    uint32_t flags { 0 };
+    uint16_t endCode { OPTION_END };
+    uint16_t endLength { 0 };
+    uint32_t trailingLength { 0 };
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(SectionHeader) == 28);
+static_assert(sizeof(InterfaceDescription) == 20);
+static_assert(sizeof(EnhancedPacketHeader) == 28);
+static_assert(sizeof(EnhancedPacketTrailer) == 16);
+
+constexpr auto padded(std::size_t size) -> std::size_t
+{
+    return (size + 3) & ~std::size_t { 3 };
+}
+
+}; // namespace pcapng
+
+/**
+ * @brief PacketHeader in front of every captured payload
+ *
+ *   0      channel
+ *   1      flags, bit 0 - reliable
+ *   2..3   sequence number
+ *   4..7   payload size
+ *   8..11  timestamp
+ *   12..13 fragment index
+ *   14..15 fragment count
+ *
+ * Big endian, like wire::Header, but with 32 bit size: frames queued for
+ * fragmentation are bigger than a datagram.
+ */
+constexpr std::size_t RECORD_HEADER_SIZE = 16;
+
+constexpr void serializeRecordHeader(
+        const PacketHeader                    &packet,
+        std::span<uint8_t, RECORD_HEADER_SIZE> out)
+{
+    out[0] = packet.channel;
+    out[1] = packet.reliable ? 1 : 0;
+    wire::storeBigEndian(&out[2], packet.sequence);
+    wire::storeBigEndian(&out[4], packet.size);
+    wire::storeBigEndian(&out[8], packet.timestamp);
+    wire::storeBigEndian(&out[12], packet.fragmentIndex);
+    wire::storeBigEndian(&out[14], packet.fragmentCount);
+}
+
+/**
+ * @brief Header of captured packet data, nullopt if size does not match the data
+ */
+constexpr auto parseRecordHeader(std::span<const uint8_t> data) -> std::optional<PacketHeader>
+{
+    if (data.size() < RECORD_HEADER_SIZE) {
+        return std::nullopt;
+    }
+
+    PacketHeader packet;
+    packet.channel       = data[0];
+    packet.reliable      = (data[1] & 1) != 0;
+    packet.sequence      = wire::loadBigEndian<uint16_t>(&data[2]);
+    packet.size          = wire::loadBigEndian<uint32_t>(&data[4]);
+    packet.timestamp     = wire::loadBigEndian<uint32_t>(&data[8]);
+    packet.fragmentIndex = wire::loadBigEndian<uint16_t>(&data[12]);
+    packet.fragmentCount = wire::loadBigEndian<uint16_t>(&data[14]);
+
+    if (packet.size != data.size() - RECORD_HEADER_SIZE || packet.channel >= CHANNEL_COUNT) {
+        return std::nullopt;
+    }
+
+    return packet;
+}
+
+}; // namespace pirks::networking::capture
@@ -0,0 +1,215 @@
+#include "PcapReplayer.h"
+
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace pirks::networking::capture
+{
+
+namespace {
+
+// Type and length of a block, followed by its body and the length again
+constexpr std::size_t BLOCK_HEADER_SIZE = 8;
+constexpr std::size_t MIN_BLOCK_SIZE    = BLOCK_HEADER_SIZE + sizeof(uint32_t);
+
+template<class T>
+auto load(const uint8_t *data) -> T
+{
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// Direction from the options of an enhanced packet block
+auto findDirection(std::span<const uint8_t> options) -> Direction
+{
+    while (options.size() >= 4) {
+        const auto code   = load<uint16_t>(options.data());
+        const auto length = load<uint16_t>(options.data() + 2);
+        if (code == pcapng::OPTION_END || options.size() < 4 + pcapng::padded(length)) {
+            break;
+        }
+        if (code == pcapng::OPTION_EPB_FLAGS && length == sizeof(uint32_t)) {
+            const auto flags = load<uint32_t>(options.data() + 4);
+            return static_cast<Direction>(flags & pcapng::EPB_FLAGS_DIRECTION);
+        }
+        options = options.subspan(4 + pcapng::padded(length));
+    }
+    return Direction::Unknown;
+}
+
+} // namespace
+
+PcapReplayer::PcapReplayer(
+        std::shared_ptr<PacketPool> packet_pool,
+        std::shared_ptr<PacketPool> frame_pool)
+        : packetPool_ { std::move(packet_pool) }
+        , framePool_ { std::move(frame_pool) }
+        , stop_ { false }
+{
+}
+
+auto PcapReplayer::replay(
+        const std::string    &file,
+        PacketsQueue         &in_packets,
+        PacketsQueue         &out_packets,
+        const ReplaySettings &settings) -> ReplayStats
+{
+    std::ifstream input { file, std::ios::binary };
+    if (!input) {
+        throw std::runtime_error(fmt::format("Can't open capture file {}", file));
+    }
+
+    // Files are written in host byte order
+    pcapng::SectionHeader section;
+    if (!input.read(reinterpret_cast<char *>(&section), sizeof(section))
+        || section.type != pcapng::SECTION_HEADER_BLOCK
+        || section.byteOrderMagic != pcapng::BYTE_ORDER_MAGIC || section.length < sizeof(section))
+    {
+        throw std::runtime_error(
+                fmt::format("{} is not a pcapng file in byte order of this machine", file));
+    }
+    input.seekg(static_cast<std::streamoff>(section.length - sizeof(section)), std::ios::cur);
+
+    spdlog::info("Replay packets of {}, speed {}", file, settings.speed);
+
+    ReplayStats             stats;
+    std::vector<uint8_t>    block;
+    std::optional<uint64_t> firstTimestamp;
+    const auto              start = std::chrono::steady_clock::now();
+
+    while (!stop_) {
+        std::array<uint32_t, 2> head;
+        if (!input.read(reinterpret_cast<char *>(head.data()), BLOCK_HEADER_SIZE)) {
+            break;
+        }
+
+        const auto [type, length] = head;
+        if (length < MIN_BLOCK_SIZE || length % 4 != 0) {
+            throw std::runtime_error(fmt::format("Capture file {} is damaged", file));
+        }
+
+        block.resize(length);
+        std::memcpy(block.data(), head.data(), BLOCK_HEADER_SIZE);
+        if (!input.read(
+                    reinterpret_cast<char *>(block.data() + BLOCK_HEADER_SIZE),
+                    static_cast<std::streamsize>(length - BLOCK_HEADER_SIZE)))
+        {
+            // Capture which was not closed ends in the middle of a block
+            spdlog::warn("Capture file {} is truncated", file);
+            break;
+        }
+
+        if (type == pcapng::INTERFACE_BLOCK) {
+            const auto linkType = load<uint16_t>(block.data() + BLOCK_HEADER_SIZE);
+            if (linkType != pcapng::LINKTYPE_USER0) {
+                throw std::runtime_error(fmt::format("{} is not a capture of packets", file));
+            }
+            continue;
+        }
+
+        if (type != pcapng::ENHANCED_PACKET_BLOCK
+            || length < sizeof(pcapng::EnhancedPacketHeader) + sizeof(uint32_t))
+        {
+            continue;
+        }
+
+        const auto header    = load<pcapng::EnhancedPacketHeader>(block.data());
+        const auto bodyEnd   = length - sizeof(uint32_t);
+        const auto dataStart = sizeof(header);
+        const auto dataEnd   = dataStart + pcapng::padded(header.capturedLength);
+        if (header.capturedLength > bodyEnd - dataStart || dataEnd > bodyEnd) {
+            ++stats.dropped;
+            continue;
+        }
+
+        const auto bytes     = std::span<const uint8_t> { block };
+        const auto data      = bytes.subspan(dataStart, header.capturedLength);
+        const auto direction = findDirection(bytes.subspan(dataEnd, bodyEnd - dataEnd));
+        const auto packet    = parseRecordHeader(data);
+        if (!packet || direction == Direction::Unknown) {
+            ++stats.dropped;
+            continue;
+        }
+
+        // Microseconds, as the interface has no other resolution
+        const auto timestamp = (uint64_t { header.timestampHigh } << 32) | header.timestampLow;
+        if (!firstTimestamp) {
+            firstTimestamp = timestamp;
+        }
+        if (settings.speed > 0 && timestamp > *firstTimestamp) {
+            const auto offset = std::chrono::duration<double, std::micro>(
+                    static_cast<double>(timestamp - *firstTimestamp) / settings.speed);
+
+            std::unique_lock lock { mutex_ };
+            const auto       deadline =
+                    start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset);
+            if (cv_.wait_until(lock, deadline, [this] { return stop_.load(); })) {
+                break;
+            }
+        }
+
+        auto &queue = direction == Direction::Inbound ? in_packets : out_packets;
+        if (push(*packet, data.subspan(RECORD_HEADER_SIZE), queue)) {
+            ++stats.packets;
+        } else {
+            ++stats.dropped;
+        }
+    }
+
+    spdlog::info("{} packets replayed, {} dropped", stats.packets, stats.dropped);
+
+    return stats;
+}
+
+void PcapReplayer::stop()
+{
+    {
+        std::lock_guard lock { mutex_ };
+        stop_ = true;
+    }
+    cv_.notify_all();
+}
+
+bool PcapReplayer::push(
+        const PacketHeader      &header,
+        std::span<const uint8_t> payload,
+        PacketsQueue            &queue)
+{
+    auto *pool = packetPool_.get();
+    if (payload.size() > pool->blockSize()) {
+        pool = framePool_.get();
+    }
+    if (pool == nullptr || payload.size() > pool->blockSize()) {
+        return false;
+    }
+
+    auto *block = pool->acquire();
+    if (block == nullptr) {
+        return false;
+    }
+
+    // Full queue overwrites its oldest packet, whose block would be lost
+    if (queue.isFull()) {
+        pool->release(block);
+        return false;
+    }
+
+    std::memcpy(block, payload.data(), payload.size());
+
+    PacketInfo packet;
+    static_cast<PacketHeader &>(packet) = header;
+    packet.data                         = block;
+    queue.push(packet);
+
+    return true;
+}
+
+}; // namespace pirks::networking::capture
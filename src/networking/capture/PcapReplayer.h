@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "IConnection.h"
+#include "PacketPool.h"
+#include "PcapFormat.h"
+
+namespace pirks::networking::capture
+{
+
+struct ReplaySettings
+{
+    double speed { 1.0 }; ///< Times faster than captured, 0 - as fast as possible
+};
+
+struct ReplayStats
+{
+    uint64_t packets { 0 }; ///< Pushed into queues
+    uint64_t dropped { 0 }; ///< No pool block or queue was full
+};
+
+/**
+ * @brief Pushes packets of a file written by PcapWriter back into queues
+ *
+ * Inbound packets go into the queue of received packets, outbound ones into
+ * the queue of packets to send, at the captured intervals scaled by speed,
+ * so the same traffic can be played against a server again and again.
+ * Every packet is copied into a block of the packet pool, or of the frame
+ * pool when it's bigger, as the consumers of the queues release them there.
+ */
+class PcapReplayer final
+{
+public:
+    /**
+     * @param packet_pool   Blocks for packets
+     * @param frame_pool    Blocks for packets bigger than a packet block, may be nullptr
+     */
+    PcapReplayer(std::shared_ptr<PacketPool> packet_pool, std::shared_ptr<PacketPool> frame_pool);
+
+    PcapReplayer(const PcapReplayer &)            = delete;
+    PcapReplayer &operator=(const PcapReplayer &) = delete;
+
+public:
+    /**
+     * @brief Replay the whole file, returns when it's done or stopped
+     *
+     * Throws std::runtime_error if the file can't be read or isn't a capture.
+     */
+    auto replay(
+            const std::string    &file,
+            PacketsQueue         &in_packets,
+            PacketsQueue         &out_packets,
+            const ReplaySettings &settings = {}) -> ReplayStats;
+
+    /**
+     * @brief Make replay() return, from any thread
+     */
+    void stop();
+
+private:
+    bool push(const PacketHeader &header, std::span<const uint8_t> payload, PacketsQueue &queue);
+
+private:
+    std::shared_ptr<PacketPool> packetPool_;
+    std::shared_ptr<PacketPool> framePool_;
+
+    std::mutex              mutex_;
+    std::condition_variable cv_;
+    std::atomic_bool        stop_;
+};
+
+}; // namespace pirks::networking::capture
@@ -0,0 +1,307 @@
+#include "PcapWriter.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef UNIX
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace pirks::networking::capture
+{
+
+namespace {
+
+// File is written in multiples of this, direct I/O needs aligned offsets and sizes
+constexpr std::size_t FILE_BLOCK_SIZE = 4096;
+
+// Writer thread is woken when this much is ready, or after FLUSH_INTERVAL
+constexpr std::size_t WRITE_CHUNK_SIZE = 256 * 1024;
+constexpr auto        FLUSH_INTERVAL   = std::chrono::milliseconds(100);
+
+constexpr std::array<std::uint8_t, 3> PADDING {};
+
+} // namespace
+
+PcapWriter::PcapWriter(std::size_t ring_size)
+        : capacity_ { (ring_size + FILE_BLOCK_SIZE - 1) / FILE_BLOCK_SIZE * FILE_BLOCK_SIZE }
+        , stop_ { false }
+        , inboundTap_ { *this, Direction::Inbound }
+        , outboundTap_ { *this, Direction::Outbound }
+{
+    assert(ring_size != 0 && "ring size can't be zero");
+
+    // Filled now, so pages are not faulted in by capturing threads
+    storage_.resize(capacity_ + FILE_BLOCK_SIZE);
+
+    ring_ = storage_.data();
+    const auto misalign = reinterpret_cast<std::uintptr_t>(ring_) % FILE_BLOCK_SIZE;
+    if (misalign != 0) {
+        ring_ += FILE_BLOCK_SIZE - misalign;
+    }
+}
+
+PcapWriter::~PcapWriter()
+{
+    close();
+}
+
+bool PcapWriter::write(const PacketInfo &packet, Direction direction)
+{
+    const auto dataSize = RECORD_HEADER_SIZE + std::size_t { packet.size };
+    const auto size     = sizeof(pcapng::EnhancedPacketHeader) + pcapng::padded(dataSize)
+                      + sizeof(pcapng::EnhancedPacketTrailer);
+
+    const auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::system_clock::now().time_since_epoch())
+                             .count();
+
+    pcapng::EnhancedPacketHeader header;
+    header.length         = static_cast<uint32_t>(size);
+    header.timestampHigh  = static_cast<uint32_t>(static_cast<uint64_t>(now) >> 32);
+    header.timestampLow   = static_cast<uint32_t>(now);
+    header.capturedLength = static_cast<uint32_t>(dataSize);
+    header.originalLength = static_cast<uint32_t>(dataSize);
+
+    std::array<std::uint8_t, RECORD_HEADER_SIZE> record;
+    serializeRecordHeader(packet, record);
+
+    pcapng::EnhancedPacketTrailer trailer;
+    trailer.flags          = static_cast<uint32_t>(direction);
+    trailer.trailingLength = static_cast<uint32_t>(size);
+
+    std::unique_lock lock { mutex_ };
+
+    if (file_ < 0 || stop_) {
+        return false;
+    }
+
+    if (head_ - tail_ + size > capacity_) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    put(&header, sizeof(header));
+    put(record.data(), record.size());
+    if (packet.size != 0) {
+        put(packet.data, packet.size);
+    }
+    put(PADDING.data(), pcapng::padded(dataSize) - dataSize);
+    put(&trailer, sizeof(trailer));
+
+    const bool wake = head_ - tail_ >= WRITE_CHUNK_SIZE;
+    lock.unlock();
+
+    written_.fetch_add(1, std::memory_order_relaxed);
+    if (wake) {
+        cv_.notify_one();
+    }
+    return true;
+}
+
+auto PcapWriter::tap(Direction direction) -> PacketsQueue::Tap &
+{
+    return direction == Direction::Inbound ? inboundTap_ : outboundTap_;
+}
+
+auto PcapWriter::written() const -> uint64_t
+{
+    return written_.load(std::memory_order_relaxed);
+}
+
+auto PcapWriter::dropped() const -> uint64_t
+{
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+void PcapWriter::writeThreadFunc(PcapWriter *writer)
+{
+    while (true) {
+        {
+            std::unique_lock lock { writer->mutex_ };
+            writer->cv_.wait_for(lock, FLUSH_INTERVAL, [writer] {
+                return writer->stop_ || writer->head_ - writer->tail_ >= WRITE_CHUNK_SIZE;
+            });
+            if (writer->stop_) {
+                break;
+            }
+        }
+
+        // Packets are dropped from now on, ring is not emptied any more
+        if (!writer->flush(false)) {
+            return;
+        }
+    }
+
+    writer->flush(true);
+}
+
+void PcapWriter::put(const void *data, std::size_t size)
+{
+    const auto *bytes  = static_cast<const std::uint8_t *>(data);
+    const auto  offset = static_cast<std::size_t>(head_ % capacity_);
+    const auto  first  = std::min(size, capacity_ - offset);
+
+    std::memcpy(ring_ + offset, bytes, first);
+    std::memcpy(ring_, bytes + first, size - first);
+    head_ += size;
+}
+
+PcapWriter::QueueTap::QueueTap(PcapWriter &writer, Direction direction)
+        : writer_ { writer }
+        , direction_ { direction }
+{
+}
+
+void PcapWriter::QueueTap::onPush(std::span<const PacketInfo> packets)
+{
+    for (const auto &packet: packets) {
+        writer_.write(packet, direction_);
+    }
+}
+
+#ifdef UNIX
+
+bool isAvailable()
+{
+    return true;
+}
+
+void PcapWriter::open(const std::string &file)
+{
+    close();
+
+    constexpr int FLAGS = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    constexpr int MODE  = 0644;
+
+#ifdef LINUX
+    // Some file systems, tmpfs for one, do not support direct I/O
+    int fd = ::open(file.c_str(), FLAGS | O_DIRECT, MODE);
+    if (fd < 0 && errno == EINVAL) {
+        fd = ::open(file.c_str(), FLAGS, MODE);
+    }
+#else
+    int fd = ::open(file.c_str(), FLAGS, MODE);
+#endif
+    if (fd < 0) {
+        throw std::runtime_error(
+                fmt::format("Can't create capture file {}, error {}", file, errno));
+    }
+
+    {
+        std::lock_guard lock { mutex_ };
+
+        file_ = fd;
+        stop_ = false;
+        head_ = 0;
+        tail_ = 0;
+
+        const pcapng::SectionHeader        section;
+        const pcapng::InterfaceDescription interface;
+        put(&section, sizeof(section));
+        put(&interface, sizeof(interface));
+    }
+    written_     = 0;
+    dropped_     = 0;
+    writeThread_ = std::thread(writeThreadFunc, this);
+
+    spdlog::info("Packets are captured to {}", file);
+}
+
+void PcapWriter::close()
+{
+    {
+        std::lock_guard lock { mutex_ };
+        stop_ = true;
+    }
+    cv_.notify_one();
+
+    if (writeThread_.joinable()) {
+        writeThread_.join();
+    }
+
+    if (file_ >= 0) {
+        ::close(file_);
+        file_ = -1;
+
+        spdlog::info("{} packets captured, {} dropped", written(), dropped());
+    }
+}
+
+bool PcapWriter::flush(bool last)
+{
+    uint64_t head = 0;
+    uint64_t tail = 0;
+    {
+        std::lock_guard lock { mutex_ };
+        head = head_;
+        tail = tail_;
+    }
+
+    if (!last) {
+        head -= head % FILE_BLOCK_SIZE;
+    }
+
+#ifdef LINUX
+    // Tail stays aligned until the last write, which is not direct
+    if (last && head % FILE_BLOCK_SIZE != 0) {
+        ::fcntl(file_, F_SETFL, ::fcntl(file_, F_GETFL) & ~O_DIRECT);
+    }
+#endif
+
+    while (tail < head) {
+        const auto offset = static_cast<std::size_t>(tail % capacity_);
+        const auto size   = std::min(static_cast<std::size_t>(head - tail), capacity_ - offset);
+
+        const auto result = ::write(file_, ring_ + offset, size);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            spdlog::error("Can't write capture file, error {}, capture is stopped", errno);
+            return false;
+        }
+
+        tail += static_cast<uint64_t>(result);
+
+        std::lock_guard lock { mutex_ };
+        tail_ = tail;
+    }
+
+    return true;
+}
+
+#else
+
+bool isAvailable()
+{
+    return false;
+}
+
+void PcapWriter::open(const std::string &)
+{
+    throw std::runtime_error("Packet capture is not available on this platform");
+}
+
+void PcapWriter::close()
+{
+    //
+}
+
+bool PcapWriter::flush(bool)
+{
+    return false;
+}
+
+#endif
+
+}; // namespace pirks::networking::capture
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "IConnection.h"
+#include "PcapFormat.h"
+
+namespace pirks::networking::capture
+{
+
+/**
+ * @brief true if packets can be captured on this platform
+ */
+[[nodiscard]]
+bool isAvailable();
+
+/**
+ * @brief Writes packets to a pcapng file from its own thread
+ *
+ * Packets are copied into a preallocated ring of file bytes and the writer
+ * thread writes whole blocks of it. When the file can't keep up and the ring
+ * is full, packets are dropped and counted, threads which capture are never
+ * blocked by the disk. On Linux the file is written with O_DIRECT, so a long
+ * capture does not push the rest of the system out of page cache.
+ *
+ * Taps of the writer are set on packet queues, see PacketsQueue::setTap().
+ *
+ * Available on Unix platforms, otherwise open() throws std::runtime_error.
+ */
+class PcapWriter final
+{
+public:
+    static constexpr std::size_t DEFAULT_RING_SIZE = 16 * 1024 * 1024;
+
+    /**
+     * @param ring_size Bytes of packets waiting to be written, rounded up to
+     *                  the size of a file block
+     */
+    explicit PcapWriter(std::size_t ring_size = DEFAULT_RING_SIZE);
+    ~PcapWriter();
+
+    PcapWriter(const PcapWriter &)            = delete;
+    PcapWriter &operator=(const PcapWriter &) = delete;
+
+public:
+    /**
+     * @brief Create the file and start writing. Throws std::runtime_error
+     */
+    void open(const std::string &file);
+
+    /**
+     * @brief Write packets left in the ring and close the file
+     */
+    void close();
+
+    /**
+     * @brief Copy packet into the ring, false if it's dropped
+     */
+    bool write(const PacketInfo &packet, Direction direction);
+
+    /**
+     * @brief Tap which writes packets pushed into a queue in direction
+     */
+    [[nodiscard]]
+    auto tap(Direction direction) -> PacketsQueue::Tap &;
+
+    [[nodiscard]]
+    auto written() const -> uint64_t;
+
+    [[nodiscard]]
+    auto dropped() const -> uint64_t;
+
+private:
+    class QueueTap final: public PacketsQueue::Tap
+    {
+    public:
+        QueueTap(PcapWriter &writer, Direction direction);
+
+        void onPush(std::span<const PacketInfo> packets) override;
+
+    private:
+        PcapWriter &writer_;
+        Direction   direction_;
+    };
+
+private:
+    static void writeThreadFunc(PcapWriter *writer);
+
+    // Called with the mutex locked, there must be space for size bytes
+    void put(const void *data, std::size_t size);
+
+    // Writes ready bytes of the ring, whole blocks only unless it's the last write
+    bool flush(bool last);
+
+private:
+    std::vector<std::uint8_t> storage_;
+    std::uint8_t             *ring_ { nullptr };
+    std::size_t               capacity_ { 0 };
+
+    std::mutex              mutex_;
+    std::condition_variable cv_;
+
+    // Bytes ever put into the ring and written from it, so positions in the
+    // ring are these modulo capacity
+    uint64_t head_ { 0 };
+    uint64_t tail_ { 0 };
+
+    int              file_ { -1 };
+    std::atomic_bool stop_;
+    std::thread      writeThread_;
+
+    std::atomic<uint64_t> written_ { 0 };
+    std::atomic<uint64_t> dropped_ { 0 };
+
+    QueueTap inboundTap_;
+    QueueTap outboundTap_;
+};
+
+}; // namespace pirks::networking::capture
@@ -0,0 +1,172 @@
+#include "AesGcm.h"
+
+#include <cassert>
+#include <climits>
+#include <stdexcept>
+
+#ifdef WITH_OPENSSL
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#endif
+
+namespace pirks::networking::crypto
+{
+
+#ifdef WITH_OPENSSL
+
+namespace {
+
+auto toInt(std::size_t size) -> int
+{
+    assert(size <= INT_MAX && "buffer is too big for OpenSSL");
+    return static_cast<int>(size);
+}
+
+} // namespace
+
+bool isAvailable()
+{
+    return true;
+}
+
+auto generateSessionKey() -> SessionKey
+{
+    SessionKey key;
+    if (RAND_bytes(key.key.data(), toInt(key.key.size())) != 1
+        || RAND_bytes(key.iv.data(), toInt(key.iv.size())) != 1)
+    {
+        throw std::runtime_error("AesGcm: no random bytes for session key");
+    }
+    return key;
+}
+
+AesGcm::AesGcm(const SessionKey &key)
+        : iv_ { key.iv }
+        , encrypt_ { EVP_CIPHER_CTX_new() }
+        , decrypt_ { EVP_CIPHER_CTX_new() }
+{
+    // Key schedule is computed here and kept by the contexts, nonce of GCM is
+    // NONCE_SIZE bytes by default
+    if (encrypt_ == nullptr || decrypt_ == nullptr
+        || EVP_EncryptInit_ex(encrypt_, EVP_aes_128_gcm(), nullptr, key.key.data(), nullptr) != 1
+        || EVP_DecryptInit_ex(decrypt_, EVP_aes_128_gcm(), nullptr, key.key.data(), nullptr) != 1)
+    {
+        EVP_CIPHER_CTX_free(encrypt_);
+        EVP_CIPHER_CTX_free(decrypt_);
+        throw std::runtime_error("AesGcm: cipher initialization failed");
+    }
+}
+
+AesGcm::~AesGcm()
+{
+    EVP_CIPHER_CTX_free(encrypt_);
+    EVP_CIPHER_CTX_free(decrypt_);
+}
+
+bool AesGcm::seal(
+        std::span<const uint8_t>     aad,
+        std::span<uint8_t>           data,
+        std::span<uint8_t, TAG_SIZE> tag,
+        uint64_t                     index)
+{
+    const auto iv = nonce(index);
+
+    int length = 0;
+    if (EVP_EncryptInit_ex(encrypt_, nullptr, nullptr, nullptr, iv.data()) != 1) {
+        return false;
+    }
+    if (!aad.empty()
+        && EVP_EncryptUpdate(encrypt_, nullptr, &length, aad.data(), toInt(aad.size())) != 1)
+    {
+        return false;
+    }
+    if (!data.empty()
+        && EVP_EncryptUpdate(encrypt_, data.data(), &length, data.data(), toInt(data.size())) != 1)
+    {
+        return false;
+    }
+
+    // GCM has no padding, final writes nothing
+    return EVP_EncryptFinal_ex(encrypt_, data.data() + data.size(), &length) == 1
+           && EVP_CIPHER_CTX_ctrl(encrypt_, EVP_CTRL_GCM_GET_TAG, toInt(TAG_SIZE), tag.data()) == 1;
+}
+
+bool AesGcm::open(
+        std::span<const uint8_t>           aad,
+        std::span<uint8_t>                 data,
+        std::span<const uint8_t, TAG_SIZE> tag,
+        uint64_t                           index)
+{
+    const auto iv = nonce(index);
+
+    int length = 0;
+    if (EVP_DecryptInit_ex(decrypt_, nullptr, nullptr, nullptr, iv.data()) != 1) {
+        return false;
+    }
+    if (!aad.empty()
+        && EVP_DecryptUpdate(decrypt_, nullptr, &length, aad.data(), toInt(aad.size())) != 1)
+    {
+        return false;
+    }
+    if (!data.empty()
+        && EVP_DecryptUpdate(decrypt_, data.data(), &length, data.data(), toInt(data.size())) != 1)
+    {
+        return false;
+    }
+
+    // OpenSSL only reads the expected tag
+    auto *expected = const_cast<uint8_t *>(tag.data());
+    return EVP_CIPHER_CTX_ctrl(decrypt_, EVP_CTRL_GCM_SET_TAG, toInt(TAG_SIZE), expected) == 1
+           && EVP_DecryptFinal_ex(decrypt_, data.data() + data.size(), &length) == 1;
+}
+
+#else
+
+bool isAvailable()
+{
+    return false;
+}
+
+auto generateSessionKey() -> SessionKey
+{
+    throw std::runtime_error("AesGcm: built without OpenSSL, encryption is not available");
+}
+
+AesGcm::AesGcm(const SessionKey &key) : iv_ { key.iv }
+{
+    throw std::runtime_error("AesGcm: built without OpenSSL, encryption is not available");
+}
+
+AesGcm::~AesGcm() = default;
+
+bool AesGcm::seal(
+        std::span<const uint8_t>,
+        std::span<uint8_t>,
+        std::span<uint8_t, TAG_SIZE>,
+        uint64_t)
+{
+    return false;
+}
+
+bool AesGcm::open(
+        std::span<const uint8_t>,
+        std::span<uint8_t>,
+        std::span<const uint8_t, TAG_SIZE>,
+        uint64_t)
+{
+    return false;
+}
+
+#endif
+
+auto AesGcm::nonce(uint64_t index) const -> std::array<uint8_t, NONCE_SIZE>
+{
+    // Index is big endian in the last 8 bytes, as in TLS 1.3
+    auto result = iv_;
+    for (std::size_t i = 0; i < 8; ++i) {
+        result[NONCE_SIZE - 1 - i] ^= static_cast<uint8_t>(index >> (8 * i));
+    }
+    return result;
+}
+
+}; // namespace pirks::networking::crypto
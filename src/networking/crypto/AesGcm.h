@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// EVP_CIPHER_CTX of OpenSSL, so its headers stay out of ours
+struct evp_cipher_ctx_st;
+
+namespace pirks::networking::crypto
+{
+
+constexpr std::size_t KEY_SIZE   = 16; ///< AES-128
+constexpr std::size_t NONCE_SIZE = 12;
+constexpr std::size_t TAG_SIZE   = 16;
+
+/**
+ * @brief Key of one direction of one session
+ *
+ * Nonce of a packet is iv XOR its packet index, so every direction of every
+ * session must have its own key: the same index is used by both sides and
+ * again in the next session.
+ */
+struct SessionKey
+{
+    std::array<uint8_t, KEY_SIZE>   key {};
+    std::array<uint8_t, NONCE_SIZE> iv {};
+};
+
+/**
+ * @brief true if the library is built with an AES-GCM implementation
+ */
+[[nodiscard]]
+bool isAvailable();
+
+/**
+ * @brief Random key from the system CSPRNG
+ *
+ * Throws std::runtime_error if encryption is not available
+ */
+[[nodiscard]]
+auto generateSessionKey() -> SessionKey;
+
+/**
+ * @brief Sequence spaces of a channel, every one has its own packet indices
+ */
+enum class SequenceSpace : uint8_t
+{
+    Unreliable = 0,
+    Control    = 1, ///< Acknowledgements and congestion control feedback
+    Reliable   = 2,
+};
+
+constexpr std::size_t SEQUENCE_SPACE_COUNT = 3;
+
+/**
+ * @brief Index which makes the nonce of a packet unique within its session key
+ *
+ * Sequence is the extended sequence number of the packet in its space, see
+ * extendSequence().
+ */
+constexpr auto packetIndex(SequenceSpace space, uint8_t channel, uint64_t sequence) -> uint64_t
+{
+    return (uint64_t { static_cast<uint8_t>(space) } << 62) | (uint64_t { channel } << 48)
+           | (sequence & 0xFFFF'FFFF'FFFF);
+}
+
+constexpr auto packetIndex(bool reliable, uint8_t channel, uint64_t sequence) -> uint64_t
+{
+    return packetIndex(
+            reliable ? SequenceSpace::Reliable : SequenceSpace::Unreliable,
+            channel,
+            sequence);
+}
+
+/**
+ * @brief AES-128-GCM over packet payloads, in place
+ *
+ * Key schedule is done once in constructor, every packet only sets its
+ * nonce, so sealing small packets costs little more than the cipher itself.
+ * Ciphertext has the size of plaintext and is written over it; the tag goes
+ * to a separate buffer, usually the tailroom of the pool block.
+ *
+ * Not thread safe, every thread needs its own instance.
+ */
+class AesGcm final
+{
+public:
+    /**
+     * @brief Throws std::runtime_error if encryption is not available
+     */
+    explicit AesGcm(const SessionKey &key);
+    ~AesGcm();
+
+    AesGcm(const AesGcm &)            = delete;
+    AesGcm &operator=(const AesGcm &) = delete;
+
+public:
+    /**
+     * @brief Encrypt data in place and authenticate it together with aad
+     *
+     * Index must never repeat for this key.
+     */
+    bool seal(
+            std::span<const uint8_t>     aad,
+            std::span<uint8_t>           data,
+            std::span<uint8_t, TAG_SIZE> tag,
+            uint64_t                     index);
+
+    /**
+     * @brief Check tag and decrypt data in place, false if it was forged or damaged
+     *
+     * Data is undefined when false is returned.
+     */
+    [[nodiscard]]
+    bool open(
+            std::span<const uint8_t>           aad,
+            std::span<uint8_t>                 data,
+            std::span<const uint8_t, TAG_SIZE> tag,
+            uint64_t                           index);
+
+private:
+    [[nodiscard]]
+    auto nonce(uint64_t index) const -> std::array<uint8_t, NONCE_SIZE>;
+
+private:
+    std::array<uint8_t, NONCE_SIZE> iv_;
+    evp_cipher_ctx_st              *encrypt_ { nullptr };
+    evp_cipher_ctx_st              *decrypt_ { nullptr };
+};
+
+}; // namespace pirks::networking::crypto
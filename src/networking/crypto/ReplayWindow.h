@@ -0,0 +1,82 @@
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+namespace pirks::networking::crypto
+{
+
+/**
+ * @brief Sliding window of packet indices accepted in one sequence space
+ *
+ * Anti-replay window like the one of IPsec (RFC 4303, 3.4.3): a bit per
+ * index up to SIZE behind the newest accepted one. A recorded packet sent
+ * again by an attacker still passes authentication, the window is what
+ * rejects it. Indices are extended sequence numbers, see extendSequence(),
+ * so old packets can't alias newer ones after a wrap around.
+ *
+ * Only authenticated indices must be accepted, forged ones would move the
+ * window.
+ */
+class ReplayWindow final
+{
+public:
+    // Reliable packets are retransmitted until acknowledged, so the window
+    // covers the whole send window of ReliableChannels
+    static constexpr std::size_t SIZE = 256;
+
+    enum class Status
+    {
+        Fresh, ///< Not accepted before
+        Seen,  ///< Accepted before
+        Stale  ///< Too far behind the newest one to tell
+    };
+
+public:
+    [[nodiscard]]
+    auto check(uint64_t index) const -> Status
+    {
+        if (index > newest_) {
+            return Status::Fresh;
+        }
+
+        const auto behind = newest_ - index;
+        if (behind >= SIZE) {
+            return Status::Stale;
+        }
+        return seen_.test(behind) ? Status::Seen : Status::Fresh;
+    }
+
+    /**
+     * @brief Remember an authenticated index which is not Stale
+     */
+    void accept(uint64_t index)
+    {
+        if (index > newest_) {
+            const auto ahead = index - newest_;
+            if (ahead < SIZE) {
+                seen_ <<= ahead;
+            } else {
+                seen_.reset();
+            }
+            newest_ = index;
+        }
+        seen_.set(newest_ - index);
+    }
+
+    /**
+     * @brief Newest accepted index, reference for extendSequence()
+     */
+    [[nodiscard]]
+    auto newest() const -> uint64_t
+    {
+        return newest_;
+    }
+
+private:
+    uint64_t          newest_ { 0 };
+    std::bitset<SIZE> seen_; ///< Bit i is set if newest_ - i was accepted
+};
+
+}; // namespace pirks::networking::crypto
@@ -0,0 +1,342 @@
+#include "EnetConnection.h"
+
+#include <spdlog/spdlog.h>
+
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include "trace/Trace.h"
+
+#ifdef WITH_ENET
+#include <enet/enet.h>
+#endif
+
+using namespace std::chrono_literals;
+
+namespace pirks::networking::enet
+{
+
+auto sendOptions(const PacketInfo &packet) -> SendOptions
+{
+    // Unreliable packets bigger than MTU are fragmented unreliably too,
+    // otherwise ENet would send their fragments reliably
+    SendOptions options;
+    options.channel = packet.channel;
+    options.flags   = PacketFlags::NoAllocate
+                    | (packet.reliable ? PacketFlags::Reliable : PacketFlags::UnreliableFragment);
+    return options;
+}
+
+auto parseReceived(uint8_t channel, uint32_t flags, std::span<const uint8_t> data)
+        -> std::optional<wire::Header>
+{
+    const auto header = wire::parse(data);
+    if (!header || header->channel != channel
+        || (header->flags & ~wire::Flags::Reliable) != 0)
+    {
+        return std::nullopt;
+    }
+
+    // ENet marks what it delivered reliably, whatever it was fragmented into
+    const bool reliable = (header->flags & wire::Flags::Reliable) != 0;
+    if (reliable != ((flags & PacketFlags::Reliable) != 0)) {
+        return std::nullopt;
+    }
+
+    return header;
+}
+
+#ifdef WITH_ENET
+
+static_assert(PacketFlags::Reliable == static_cast<uint32_t>(ENET_PACKET_FLAG_RELIABLE));
+static_assert(PacketFlags::NoAllocate == static_cast<uint32_t>(ENET_PACKET_FLAG_NO_ALLOCATE));
+static_assert(
+        PacketFlags::UnreliableFragment
+        == static_cast<uint32_t>(ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT));
+
+namespace {
+
+// Packets taken from the output queue at once
+constexpr std::size_t SEND_BATCH_SIZE = 64;
+
+} // namespace
+
+bool isAvailable()
+{
+    return true;
+}
+
+EnetConnection::EnetConnection(const EnetSettings &settings, std::shared_ptr<PacketPool> pool)
+        : settings_ { settings }
+        , stop_ { false }
+        , pool_ { pool }
+        , connected_ { false }
+{
+    assert(pool_ && "packet pool is required");
+
+    if (pool_->headroom() < wire::PACKET_HEADROOM) {
+        throw std::invalid_argument("EnetConnection: packet pool has no headroom for wire header");
+    }
+
+    if (enet_initialize() != 0) {
+        throw std::runtime_error("EnetConnection: ENet can't be initialized");
+    }
+
+    spdlog::debug("EnetConnection created");
+}
+
+EnetConnection::~EnetConnection()
+{
+    spdlog::debug("EnetConnection destructor");
+
+    stop_ = true;
+
+    if (serviceThread_.joinable()) {
+        serviceThread_.join();
+    }
+
+    // Queued packets are destroyed with the host, their blocks go back to the pool
+    if (host_ != nullptr) {
+        if (peer_ != nullptr) {
+            enet_peer_disconnect_now(peer_, 0);
+        }
+        enet_host_destroy(host_);
+    }
+
+    enet_deinitialize();
+}
+
+void EnetConnection::create(
+        std::shared_ptr<PacketsQueue> in_packets,
+        std::shared_ptr<PacketsQueue> out_packets)
+{
+    inPackets_  = in_packets;
+    outPackets_ = out_packets;
+
+    const bool server = settings_.host.empty();
+
+    ENetAddress address {};
+    address.host = ENET_HOST_ANY;
+    address.port = settings_.port;
+
+    // Server accepts one remote side, client has one outgoing connection
+    host_ = enet_host_create(
+            server ? &address : nullptr,
+            1,
+            CHANNEL_COUNT,
+            settings_.incomingBandwidth,
+            settings_.outgoingBandwidth);
+    if (host_ == nullptr) {
+        throw std::runtime_error(
+                fmt::format("EnetConnection: host can't be created on port {}", settings_.port));
+    }
+
+    // MTU is agreed on connect, both sides ask for full ethernet frames
+    host_->mtu = MTU;
+    localPort_ = host_->address.port;
+
+    if (server) {
+        spdlog::debug("EnetConnection listening on port {}", localPort_);
+    } else {
+        if (enet_address_set_host(&address, settings_.host.c_str()) != 0) {
+            throw std::runtime_error("EnetConnection: unknown host " + settings_.host);
+        }
+
+        peer_ = enet_host_connect(host_, &address, CHANNEL_COUNT, 0);
+        if (peer_ == nullptr) {
+            throw std::runtime_error("EnetConnection: can't connect to " + settings_.host);
+        }
+
+        spdlog::debug("EnetConnection connecting to {}:{}", settings_.host, settings_.port);
+    }
+
+    serviceThread_ = std::thread(serviceThreadFunc, this);
+}
+
+auto EnetConnection::localPort() const -> uint16_t
+{
+    return localPort_;
+}
+
+void EnetConnection::serviceThreadFunc(EnetConnection *connection)
+{
+    trace::setThreadName("enet-service");
+
+    // Packets are popped into the stack of the thread, not the heap
+    PacketBatch<SEND_BATCH_SIZE> storage;
+    auto                        &batch = storage.packets();
+
+    while (!connection->stop_) {
+        auto out = connection->outPackets_.lock();
+        if (!out) {
+            break;
+        }
+
+        const auto count = out->pop(batch, SEND_BATCH_SIZE);
+        out.reset();
+
+        for (std::size_t i = 0; i < count; ++i) {
+            PIRKS_TRACE_SCOPE("enet", "send");
+            connection->send(batch[i]);
+        }
+
+        // Sends what was queued and waits for the socket only when there is
+        // nothing to send
+        ENetEvent event;
+        const auto timeout = count == 0 ? SERVICE_INTERVAL_MS : 0;
+        if (enet_host_service(connection->host_, &event, timeout) > 0) {
+            PIRKS_TRACE_SCOPE("enet", "receive");
+            connection->process(event);
+            while (enet_host_check_events(connection->host_, &event) > 0) {
+                connection->process(event);
+            }
+        }
+    }
+}
+
+void EnetConnection::freePacket(ENetPacket *packet)
+{
+    auto *connection = static_cast<EnetConnection *>(packet->userData);
+    connection->pool_->release(packet->data + wire::HEADER_SIZE);
+}
+
+void EnetConnection::send(const PacketInfo &packet)
+{
+    assert(pool_->owns(packet.data) && "packet must be in a block of the packet pool");
+
+    if (!connected_ || packet.channel >= CHANNEL_COUNT) {
+        // Nobody to send to yet
+        pool_->release(packet.data);
+        return;
+    }
+
+    auto      &sequence = packet.reliable ? reliableSequence_ : unreliableSequence_;
+    const auto header   = wire::packetHeader(packet, sequence[packet.channel]++);
+    wire::serialize(header, wire::headerBefore(packet.data));
+
+    const auto options    = sendOptions(packet);
+    auto      *enetPacket = enet_packet_create(
+            wire::headerBefore(packet.data).data(),
+            wire::HEADER_SIZE + packet.size,
+            options.flags);
+    if (enetPacket == nullptr) {
+        pool_->release(packet.data);
+        return;
+    }
+
+    // Block goes back to the pool when ENet is done with the packet
+    enetPacket->userData     = this;
+    enetPacket->freeCallback = freePacket;
+
+    if (enet_peer_send(peer_, options.channel, enetPacket) != 0) {
+        enet_packet_destroy(enetPacket);
+    }
+}
+
+void EnetConnection::receive(uint8_t channel, uint32_t flags, std::span<const uint8_t> data)
+{
+    const auto header = parseReceived(channel, flags, data);
+    if (!header) {
+        spdlog::debug("EnetConnection: malformed packet dropped");
+        return;
+    }
+
+    auto in = inPackets_.lock();
+    if (!in) {
+        return;
+    }
+
+    auto *block = header->payloadSize <= pool_->blockSize() ? pool_->acquire() : nullptr;
+    if (block == nullptr) {
+        spdlog::debug("EnetConnection: no block for packet, dropped");
+        return;
+    }
+    std::memcpy(block, data.data() + wire::HEADER_SIZE, header->payloadSize);
+
+    PacketInfo packet;
+    packet.channel       = header->channel;
+    packet.reliable      = (header->flags & wire::Flags::Reliable) != 0;
+    packet.sequence      = header->sequence;
+    packet.size          = header->payloadSize;
+    packet.timestamp     = header->timestamp;
+    packet.fragmentIndex = header->fragmentIndex;
+    packet.fragmentCount = header->fragmentCount;
+    packet.data          = block;
+
+    in->push(packet);
+}
+
+void EnetConnection::process(ENetEvent &event)
+{
+    switch (event.type) {
+    case ENET_EVENT_TYPE_CONNECT:
+        peer_      = event.peer;
+        connected_ = true;
+        spdlog::info("EnetConnection: remote side connected");
+        break;
+
+    case ENET_EVENT_TYPE_RECEIVE:
+        receive(event.channelID,
+                event.packet->flags,
+                { event.packet->data, event.packet->dataLength });
+        enet_packet_destroy(event.packet);
+        break;
+
+    case ENET_EVENT_TYPE_DISCONNECT:
+        peer_      = nullptr;
+        connected_ = false;
+        spdlog::info("EnetConnection: remote side disconnected");
+        break;
+
+    default:
+        break;
+    }
+}
+
+#else
+
+bool isAvailable()
+{
+    return false;
+}
+
+EnetConnection::EnetConnection(const EnetSettings &settings, std::shared_ptr<PacketPool> pool)
+        : settings_ { settings }
+        , stop_ { false }
+        , pool_ { pool }
+        , connected_ { false }
+{
+    assert(pool_ && "packet pool is required");
+
+    if (pool_->headroom() < wire::PACKET_HEADROOM) {
+        throw std::invalid_argument("EnetConnection: packet pool has no headroom for wire header");
+    }
+
+    throw std::runtime_error("EnetConnection: built without ENet");
+}
+
+EnetConnection::~EnetConnection() = default;
+
+void EnetConnection::create(
+        std::shared_ptr<PacketsQueue> in_packets,
+        std::shared_ptr<PacketsQueue> out_packets)
+{
+    inPackets_  = in_packets;
+    outPackets_ = out_packets;
+}
+
+auto EnetConnection::localPort() const -> uint16_t
+{
+    return localPort_;
+}
+
+#endif
+
+bool EnetConnection::isConnected() const
+{
+    return connected_;
+}
+
+}; // namespace pirks::networking::enet
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+
+#include "../IConnection.h"
+#include "../PacketPool.h"
+#include "../WireHeader.h"
+
+// Host, peer and packet of ENet, so its headers stay out of ours
+struct _ENetHost;
+struct _ENetPeer;
+struct _ENetPacket;
+struct _ENetEvent;
+
+namespace pirks::networking::enet
+{
+
+/**
+ * @brief true if the library is built with ENet
+ */
+[[nodiscard]]
+bool isAvailable();
+
+/**
+ * @brief Packet flags of ENet, the values of ENET_PACKET_FLAG_*
+ */
+enum PacketFlags : uint32_t
+{
+    Reliable           = 1 << 0,
+    NoAllocate         = 1 << 2,
+    UnreliableFragment = 1 << 3,
+};
+
+/**
+ * @brief ENet channel and packet flags a packet goes with
+ */
+struct SendOptions
+{
+    uint8_t  channel { 0 };
+    uint32_t flags { 0 };
+
+    constexpr bool operator==(const SendOptions &) const = default;
+};
+
+/**
+ * @brief How a packet from a pool block is sent: on the ENet channel of its
+ *        Channel, reliably or in unreliable fragments
+ */
+[[nodiscard]]
+auto sendOptions(const PacketInfo &packet) -> SendOptions;
+
+/**
+ * @brief Wire header of a packet ENet received on channel with flags, nullopt if
+ *        the packet is malformed or did not come the way its header says it was sent
+ */
+[[nodiscard]]
+auto parseReceived(uint8_t channel, uint32_t flags, std::span<const uint8_t> data)
+        -> std::optional<wire::Header>;
+
+struct EnetSettings
+{
+    std::string host; ///< Client connects to host:port, empty - server listens on port
+    uint16_t    port { 0 };
+    uint32_t    incomingBandwidth { 0 }; ///< Bytes per second, 0 - unlimited
+    uint32_t    outgoingBandwidth { 0 }; ///< Bytes per second, 0 - unlimited
+};
+
+/**
+ * @brief Reliable UDP connection over ENet
+ *
+ * Every Channel is an ENet channel, reliable packets are sent with
+ * ENET_PACKET_FLAG_RELIABLE and the rest as unreliable ones, which ENet
+ * fragments unreliably too. The wire header goes in front of the payload,
+ * so timestamps and fragment positions survive the trip. Received packets
+ * must come on the channel and with the reliability their header says.
+ *
+ * Outgoing packets are not copied: ENet packets are created with
+ * ENET_PACKET_FLAG_NO_ALLOCATE over the header and payload in the pool
+ * block, and the block is released when ENet destroys the packet. Received
+ * packets are copied into pool blocks once.
+ *
+ * ENet is not thread safe, so one thread runs the host: it sends what is in
+ * out_packets and services the socket for at most SERVICE_INTERVAL when there
+ * is nothing to send. Server accepts one remote side; client connects to
+ * settings.host.
+ */
+class EnetConnection final: public IConnection
+{
+public:
+    // Longest wait for the socket, the worst extra delay of an outgoing packet
+    static constexpr uint32_t SERVICE_INTERVAL_MS = 1;
+
+    // Ethernet MTU without IPv4 and UDP headers, ENet defaults to 1400
+    static constexpr uint32_t MTU = 1472;
+
+public:
+    /**
+     * @brief Packets are sent from blocks of the pool in place, so it must have
+     *        wire::PACKET_HEADROOM
+     *
+     * Throws std::invalid_argument if it does not, std::runtime_error if ENet
+     * is not available.
+     */
+    EnetConnection(const EnetSettings &settings, std::shared_ptr<PacketPool> pool);
+    ~EnetConnection() override;
+
+    EnetConnection(const EnetConnection &)            = delete;
+    EnetConnection &operator=(const EnetConnection &) = delete;
+
+public:
+    void create(
+            std::shared_ptr<PacketsQueue> in_packets, //
+            std::shared_ptr<PacketsQueue> out_packets) override;
+
+    /**
+     * @brief true after the remote side is connected
+     */
+    [[nodiscard]]
+    bool isConnected() const;
+
+    /**
+     * @brief Port the host is bound to. Valid after create()
+     */
+    [[nodiscard]]
+    auto localPort() const -> uint16_t;
+
+private:
+    static void serviceThreadFunc(EnetConnection *connection);
+    static void freePacket(_ENetPacket *packet);
+
+    void send(const PacketInfo &packet);
+    void receive(uint8_t channel, uint32_t flags, std::span<const uint8_t> data);
+    void process(_ENetEvent &event);
+
+private:
+    EnetSettings                settings_;
+    std::atomic_bool            stop_;
+    std::shared_ptr<PacketPool> pool_;
+    std::weak_ptr<PacketsQueue> inPackets_;
+    std::weak_ptr<PacketsQueue> outPackets_;
+    std::thread                 serviceThread_;
+
+    // Host and peer are used only by service thread after create()
+    _ENetHost       *host_ { nullptr };
+    _ENetPeer       *peer_ { nullptr };
+    std::atomic_bool connected_;
+    uint16_t         localPort_ { 0 };
+
+    // Sequence numbers of unreliable and reliable packets
+    std::array<SequenceNumber, CHANNEL_COUNT> unreliableSequence_ {};
+    std::array<SequenceNumber, CHANNEL_COUNT> reliableSequence_ {};
+};
+
+}; // namespace pirks::networking::enet
@@ -0,0 +1,219 @@
+#include "FecCodec.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include "WireHeader.h"
+
+namespace pirks::networking::fec
+{
+
+namespace {
+
+// Tail of a short group is written as an empty header
+void writeHeader(std::uint8_t *dst, const PacketHeader &packet)
+{
+    wire::storeBigEndian(dst, static_cast<std::uint16_t>(packet.size));
+    wire::storeBigEndian(dst + 2, packet.timestamp);
+    wire::storeBigEndian(dst + 6, packet.fragmentIndex);
+    wire::storeBigEndian(dst + 8, packet.fragmentCount);
+}
+
+void readHeader(const std::uint8_t *src, PacketHeader &packet)
+{
+    packet.size          = wire::loadBigEndian<std::uint16_t>(src);
+    packet.timestamp     = wire::loadBigEndian<std::uint32_t>(src + 2);
+    packet.fragmentIndex = wire::loadBigEndian<std::uint16_t>(src + 6);
+    packet.fragmentCount = wire::loadBigEndian<std::uint16_t>(src + 8);
+}
+
+} // namespace
+
+FecEncoder::FecEncoder(const FecSettings &settings, std::shared_ptr<PacketPool> pool)
+        : settings_ { settings }
+        , pool_ { std::move(pool) }
+        , codec_ { settings.dataShards, settings.parityShards }
+        , headers_(settings.dataShards * FEC_HEADER_SIZE)
+        , headerViews_(settings.dataShards)
+        , payloadViews_(settings.dataShards)
+        , headerPointers_(settings.parityShards)
+        , payloadPointers_(settings.parityShards)
+{
+    assert(pool_ && "Packet pool is NULL");
+}
+
+bool FecEncoder::encode(std::span<const PacketInfo> data, std::span<PacketInfo> parity)
+{
+    assert(data.size() <= settings_.dataShards && "too many data packets in group");
+    assert(parity.size() == settings_.parityShards && "wrong number of parity packets");
+
+    std::size_t shardSize = 0;
+    for (std::size_t i = 0; i < settings_.dataShards; ++i) {
+        auto *header = headers_.data() + i * FEC_HEADER_SIZE;
+
+        if (i < data.size()) {
+            writeHeader(header, data[i]);
+            payloadViews_[i] = { data[i].data, data[i].size };
+            shardSize        = std::max<std::size_t>(shardSize, data[i].size);
+        } else {
+            writeHeader(header, PacketHeader { .fragmentCount = 0 });
+            payloadViews_[i] = { header, 0 };
+        }
+        headerViews_[i] = { header, FEC_HEADER_SIZE };
+    }
+
+    // Sizes are protected in 16 bits
+    if (shardSize + FEC_HEADER_SIZE > pool_->blockSize() || shardSize > UINT16_MAX) {
+        spdlog::warn("Packet of {} bytes is too big for FEC", shardSize);
+        return false;
+    }
+
+    for (std::size_t j = 0; j < parity.size(); ++j) {
+        auto *block = pool_->acquire();
+        if (block == nullptr) {
+            // Give back what was already taken
+            for (std::size_t k = 0; k < j; ++k) {
+                pool_->release(parity[k].data);
+                parity[k].data = nullptr;
+            }
+            return false;
+        }
+
+        parity[j].channel  = data.empty() ? std::uint8_t { 0 } : data[0].channel;
+        parity[j].reliable = false;
+        parity[j].size     = static_cast<std::uint32_t>(shardSize + FEC_HEADER_SIZE);
+        parity[j].data     = block;
+
+        headerPointers_[j]  = block;
+        payloadPointers_[j] = block + FEC_HEADER_SIZE;
+    }
+
+    codec_.encode(headerViews_, headerPointers_, FEC_HEADER_SIZE);
+    codec_.encode(payloadViews_, payloadPointers_, shardSize);
+
+    return true;
+}
+
+FecDecoder::FecDecoder(const FecSettings &settings, std::shared_ptr<PacketPool> pool)
+        : settings_ { settings }
+        , pool_ { std::move(pool) }
+        , codec_ { settings.dataShards, settings.parityShards }
+        , headers_(settings.dataShards * FEC_HEADER_SIZE)
+        , headerViews_(settings.dataShards + settings.parityShards)
+        , payloadViews_(settings.dataShards + settings.parityShards)
+        , recoveredPointers_(settings.dataShards)
+        , recoveredHeaders_(settings.dataShards)
+{
+    assert(pool_ && "Packet pool is NULL");
+}
+
+bool FecDecoder::recover(std::span<PacketInfo> data, std::span<const PacketInfo> parity)
+{
+    assert(data.size() <= settings_.dataShards && "too many data packets in group");
+    assert(parity.size() == settings_.parityShards && "wrong number of parity packets");
+
+    std::size_t lost = 0;
+    for (std::size_t i = 0; i < settings_.dataShards; ++i) {
+        auto *header = headers_.data() + i * FEC_HEADER_SIZE;
+
+        recoveredPointers_[i] = nullptr;
+
+        if (i < data.size() && data[i].data == nullptr) {
+            headerViews_[i]  = {};
+            payloadViews_[i] = {};
+            ++lost;
+            continue;
+        }
+
+        // Tail of a short group is known to be empty
+        if (i < data.size()) {
+            writeHeader(header, data[i]);
+            payloadViews_[i] = { data[i].data, data[i].size };
+        } else {
+            writeHeader(header, PacketHeader { .fragmentCount = 0 });
+            payloadViews_[i] = { header, 0 };
+        }
+        headerViews_[i] = { header, FEC_HEADER_SIZE };
+    }
+
+    if (lost == 0) {
+        return true;
+    }
+
+    std::size_t  shardSize = 0;
+    std::uint8_t channel   = 0;
+    for (std::size_t j = 0; j < parity.size(); ++j) {
+        const auto index = settings_.dataShards + j;
+        if (parity[j].data == nullptr || parity[j].size < FEC_HEADER_SIZE) {
+            headerViews_[index]  = {};
+            payloadViews_[index] = {};
+            continue;
+        }
+
+        shardSize = parity[j].size - FEC_HEADER_SIZE;
+        channel   = parity[j].channel;
+
+        headerViews_[index]  = { parity[j].data, FEC_HEADER_SIZE };
+        payloadViews_[index] = { parity[j].data + FEC_HEADER_SIZE, shardSize };
+    }
+
+    if (shardSize > pool_->blockSize()) {
+        return false;
+    }
+
+    // Headers are restored and checked first, so nothing is taken or changed
+    // if it fails
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        if (data[i].data == nullptr) {
+            recoveredPointers_[i] = recoveredHeaders_[i].data();
+        }
+    }
+    if (!codec_.reconstruct(headerViews_, recoveredPointers_, FEC_HEADER_SIZE)) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        PacketHeader header;
+        if (data[i].data == nullptr) {
+            readHeader(recoveredHeaders_[i].data(), header);
+            if (header.size > shardSize) {
+                return false;
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        if (data[i].data != nullptr) {
+            recoveredPointers_[i] = nullptr;
+            continue;
+        }
+
+        auto *block = pool_->acquire();
+        if (block == nullptr) {
+            for (std::size_t k = 0; k < i; ++k) {
+                if (data[k].data == nullptr) {
+                    pool_->release(recoveredPointers_[k]);
+                }
+            }
+            return false;
+        }
+        recoveredPointers_[i] = block;
+    }
+
+    codec_.reconstruct(payloadViews_, recoveredPointers_, shardSize);
+
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        if (data[i].data == nullptr) {
+            readHeader(recoveredHeaders_[i].data(), data[i]);
+            data[i].channel  = channel;
+            data[i].reliable = false;
+            data[i].data     = recoveredPointers_[i];
+        }
+    }
+
+    return true;
+}
+
+}; // namespace pirks::networking::fec
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "PacketInfo.h"
+#include "PacketPool.h"
+#include "ReedSolomon.h"
+
+namespace pirks::networking::fec
+{
+
+struct FecSettings
+{
+    std::uint8_t dataShards { 8 };   ///< Data packets in one group
+    std::uint8_t parityShards { 2 }; ///< Parity packets, so many losses in a group can be restored
+};
+
+/**
+ * @brief Parity packet payload starts with parity of data packet headers
+ *
+ * Size, timestamp, fragment index and fragment count of data packets are
+ * protected together with their payloads, so restored packet gets its
+ * original size, not the size of the largest one, and can be reassembled.
+ * Big endian, like the wire header.
+ */
+constexpr std::size_t FEC_HEADER_SIZE = 10;
+
+/**
+ * @brief Creates parity packets for a group of data packets
+ *
+ * Data packets are not modified or copied. Parity packets are allocated
+ * from the packet pool, whoever sends them releases them.
+ */
+class FecEncoder final
+{
+public:
+    FecEncoder(const FecSettings &settings, std::shared_ptr<PacketPool> pool);
+
+public:
+    /**
+     * @brief Calculate parity packets
+     *
+     * @param data      Up to dataShards packets. Missing tail of a short group is
+     *                  treated as empty packets
+     * @param parity    parityShards packets to fill
+     * @return false    if packets are too big for pool blocks or pool is exhausted
+     */
+    bool encode(std::span<const PacketInfo> data, std::span<PacketInfo> parity);
+
+    auto settings() const -> const FecSettings &
+    {
+        return settings_;
+    }
+
+private:
+    FecSettings                 settings_;
+    std::shared_ptr<PacketPool> pool_;
+    ReedSolomon                 codec_;
+
+    // Scratch, allocated once
+    std::vector<std::uint8_t>   headers_;
+    std::vector<ShardView>      headerViews_;
+    std::vector<ShardView>      payloadViews_;
+    std::vector<std::uint8_t *> headerPointers_;
+    std::vector<std::uint8_t *> payloadPointers_;
+};
+
+/**
+ * @brief Restores lost data packets of a group from parity packets
+ */
+class FecDecoder final
+{
+public:
+    FecDecoder(const FecSettings &settings, std::shared_ptr<PacketPool> pool);
+
+public:
+    /**
+     * @brief Restore lost data packets
+     *
+     * @param data      Data packets of the group (same count as was passed to
+     *                  FecEncoder::encode), lost ones have data == nullptr.
+     *                  Restored packets get payload from the packet pool and
+     *                  their header fields from parity, sequence is left to the caller.
+     * @param parity    parityShards packets, lost ones have data == nullptr
+     * @return false    if too many packets are lost, parity is corrupt or pool
+     *                  is exhausted. Packets are not changed then
+     */
+    bool recover(std::span<PacketInfo> data, std::span<const PacketInfo> parity);
+
+    auto settings() const -> const FecSettings &
+    {
+        return settings_;
+    }
+
+private:
+    FecSettings                 settings_;
+    std::shared_ptr<PacketPool> pool_;
+    ReedSolomon                 codec_;
+
+    // Scratch, allocated once
+    std::vector<std::uint8_t>                              headers_;
+    std::vector<ShardView>                                 headerViews_;
+    std::vector<ShardView>                                 payloadViews_;
+    std::vector<std::uint8_t *>                            recoveredPointers_;
+    std::vector<std::array<std::uint8_t, FEC_HEADER_SIZE>> recoveredHeaders_;
+};
+
+}; // namespace pirks::networking::fec
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace pirks::networking::fec::gf
+{
+
+/**
+ * @brief Arithmetic in GF(2^8) with polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11D)
+ *
+ * The same field as used by Reed-Solomon FEC in Moonlight/Sunshine.
+ * Addition is xor, multiplication uses log/exp tables.
+ */
+
+constexpr unsigned POLYNOMIAL = 0x11D;
+
+struct Tables
+{
+    std::array<std::uint8_t, 512> exp {}; ///< Doubled, so exp[log a + log b] needs no modulo
+    std::array<std::uint8_t, 256> log {};
+};
+
+constexpr auto makeTables() -> Tables
+{
+    Tables tables;
+
+    unsigned value = 1;
+    for (unsigned i = 0; i < 255; ++i) {
+        tables.exp[i]       = static_cast<std::uint8_t>(value);
+        tables.exp[i + 255] = static_cast<std::uint8_t>(value);
+        tables.log[value]   = static_cast<std::uint8_t>(i);
+
+        value <<= 1;
+        if (value & 0x100) {
+            value ^= POLYNOMIAL;
+        }
+    }
+    tables.exp[510] = tables.exp[0];
+    tables.exp[511] = tables.exp[1];
+
+    return tables;
+}
+
+inline constexpr Tables TABLES = makeTables();
+
+constexpr auto mul(std::uint8_t a, std::uint8_t b) -> std::uint8_t
+{
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+    return TABLES.exp[std::size_t { TABLES.log[a] } + TABLES.log[b]];
+}
+
+constexpr auto inv(std::uint8_t a) -> std::uint8_t
+{
+    assert(a != 0 && "zero has no inverse");
+    return TABLES.exp[255u - TABLES.log[a]];
+}
+
+constexpr auto div(std::uint8_t a, std::uint8_t b) -> std::uint8_t
+{
+    assert(b != 0 && "division by zero");
+    if (a == 0) {
+        return 0;
+    }
+    return TABLES.exp[std::size_t { TABLES.log[a] } + 255u - TABLES.log[b]];
+}
+
+}; // namespace pirks::networking::fec::gf
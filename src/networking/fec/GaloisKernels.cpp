@@ -0,0 +1,257 @@
+#include "GaloisKernels.h"
+
+#include <array>
+
+#include "GaloisField.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PIRKS_FEC_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PIRKS_FEC_NEON
+#include <arm_neon.h>
+#endif
+
+// Kernels are compiled for their instruction set with target attribute and
+// selected at runtime, so the rest of the project keeps baseline flags.
+// MSVC allows intrinsics without any attributes.
+#if defined(__GNUC__) || defined(__clang__)
+#define PIRKS_FEC_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PIRKS_FEC_TARGET(isa)
+#endif
+
+namespace pirks::networking::fec
+{
+
+namespace {
+
+/**
+ * @brief Products of c with every possible low and high nibble
+ *
+ * c * x = c * (x & 0x0F) ^ c * (x & 0xF0), so two 16 entry lookups (PSHUFB,
+ * TBL) give the product for 16 or 32 bytes at once.
+ */
+struct NibbleTables
+{
+    std::array<std::array<std::uint8_t, 16>, 256> low {};
+    std::array<std::array<std::uint8_t, 16>, 256> high {};
+};
+
+constexpr auto makeNibbleTables() -> NibbleTables
+{
+    NibbleTables tables;
+    for (unsigned c = 0; c < 256; ++c) {
+        for (unsigned i = 0; i < 16; ++i) {
+            tables.low[c][i]  = gf::mul(static_cast<std::uint8_t>(c), static_cast<std::uint8_t>(i));
+            tables.high[c][i] = gf::mul(
+                    static_cast<std::uint8_t>(c),
+                    static_cast<std::uint8_t>(i << 4));
+        }
+    }
+    return tables;
+}
+
+constexpr NibbleTables NIBBLE_TABLES = makeNibbleTables();
+
+void mulAddScalar(std::uint8_t *dst, const std::uint8_t *src, std::uint8_t c, std::size_t size)
+{
+    if (c == 0) {
+        return;
+    }
+
+    if (c == 1) {
+        for (std::size_t i = 0; i < size; ++i) {
+            dst[i] ^= src[i];
+        }
+        return;
+    }
+
+    const std::size_t logC = gf::TABLES.log[c];
+    for (std::size_t i = 0; i < size; ++i) {
+        if (src[i] != 0) {
+            dst[i] ^= gf::TABLES.exp[logC + gf::TABLES.log[src[i]]];
+        }
+    }
+}
+
+#if defined(PIRKS_FEC_X86)
+
+/**
+ * @brief 8x8 bit matrices of multiplication by constant for GF2P8AFFINEQB
+ *
+ * GFNI multiplication instruction uses AES polynomial 0x11B, but
+ * multiplication by a constant is linear over GF(2) in any field, so the
+ * affine instruction with a precomputed matrix works for 0x11D too.
+ * Byte (7 - i) of the matrix selects input bits which give output bit i.
+ */
+constexpr auto makeAffineMatrices() -> std::array<std::uint64_t, 256>
+{
+    std::array<std::uint64_t, 256> matrices {};
+    for (unsigned c = 0; c < 256; ++c) {
+        std::uint64_t matrix = 0;
+        for (unsigned i = 0; i < 8; ++i) {
+            std::uint64_t row = 0;
+            for (unsigned k = 0; k < 8; ++k) {
+                const auto product = gf::mul(
+                        static_cast<std::uint8_t>(c),
+                        static_cast<std::uint8_t>(1u << k));
+                row |= static_cast<std::uint64_t>((product >> i) & 1u) << k;
+            }
+            matrix |= row << (8 * (7 - i));
+        }
+        matrices[c] = matrix;
+    }
+    return matrices;
+}
+
+constexpr std::array<std::uint64_t, 256> AFFINE_MATRICES = makeAffineMatrices();
+
+PIRKS_FEC_TARGET("ssse3")
+void mulAddSsse3(std::uint8_t *dst, const std::uint8_t *src, std::uint8_t c, std::size_t size)
+{
+    const auto low =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(NIBBLE_TABLES.low[c].data()));
+    const auto high =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(NIBBLE_TABLES.high[c].data()));
+    const auto mask = _mm_set1_epi8(0x0F);
+
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const auto x  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const auto lo = _mm_shuffle_epi8(low, _mm_and_si128(x, mask));
+        const auto hi = _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi64(x, 4), mask));
+        const auto d  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        _mm_storeu_si128(
+                reinterpret_cast<__m128i *>(dst + i),
+                _mm_xor_si128(d, _mm_xor_si128(lo, hi)));
+    }
+
+    mulAddScalar(dst + i, src + i, c, size - i);
+}
+
+PIRKS_FEC_TARGET("avx2")
+void mulAddAvx2(std::uint8_t *dst, const std::uint8_t *src, std::uint8_t c, std::size_t size)
+{
+    const auto low = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(NIBBLE_TABLES.low[c].data())));
+    const auto high = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(NIBBLE_TABLES.high[c].data())));
+    const auto mask = _mm256_set1_epi8(0x0F);
+
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const auto x  = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        const auto lo = _mm256_shuffle_epi8(low, _mm256_and_si256(x, mask));
+        const auto hi = _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi64(x, 4), mask));
+        const auto d  = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+        _mm256_storeu_si256(
+                reinterpret_cast<__m256i *>(dst + i),
+                _mm256_xor_si256(d, _mm256_xor_si256(lo, hi)));
+    }
+
+    mulAddScalar(dst + i, src + i, c, size - i);
+}
+
+PIRKS_FEC_TARGET("gfni,avx2")
+void mulAddGfni(std::uint8_t *dst, const std::uint8_t *src, std::uint8_t c, std::size_t size)
+{
+    const auto matrix = _mm256_set1_epi64x(static_cast<long long>(AFFINE_MATRICES[c]));
+
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        const auto p = _mm256_gf2p8affine_epi64_epi8(x, matrix, 0);
+        const auto d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_xor_si256(d, p));
+    }
+
+    mulAddScalar(dst + i, src + i, c, size - i);
+}
+
+struct CpuFeatures
+{
+    bool ssse3 { false };
+    bool avx2 { false };
+    bool gfni { false };
+};
+
+auto detectCpuFeatures() -> CpuFeatures
+{
+    CpuFeatures features;
+#if defined(_MSC_VER)
+    int info[4] {};
+    __cpuid(info, 1);
+    features.ssse3 = (info[2] & (1 << 9)) != 0;
+
+    // AVX registers must be enabled by OS (OSXSAVE and XCR0)
+    const bool osAvx = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+    __cpuidex(info, 7, 0);
+    features.avx2 = osAvx && (info[1] & (1 << 5)) != 0;
+    features.gfni = (info[2] & (1 << 8)) != 0;
+#else
+    __builtin_cpu_init();
+    features.ssse3 = __builtin_cpu_supports("ssse3");
+    features.avx2  = __builtin_cpu_supports("avx2");
+    features.gfni  = __builtin_cpu_supports("gfni");
+#endif
+    return features;
+}
+
+#elif defined(PIRKS_FEC_NEON)
+
+void mulAddNeon(std::uint8_t *dst, const std::uint8_t *src, std::uint8_t c, std::size_t size)
+{
+    const auto low  = vld1q_u8(NIBBLE_TABLES.low[c].data());
+    const auto high = vld1q_u8(NIBBLE_TABLES.high[c].data());
+    const auto mask = vdupq_n_u8(0x0F);
+
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const auto x  = vld1q_u8(src + i);
+        const auto lo = vqtbl1q_u8(low, vandq_u8(x, mask));
+        const auto hi = vqtbl1q_u8(high, vshrq_n_u8(x, 4));
+        vst1q_u8(dst + i, veorq_u8(vld1q_u8(dst + i), veorq_u8(lo, hi)));
+    }
+
+    mulAddScalar(dst + i, src + i, c, size - i);
+}
+
+#endif
+
+} // namespace
+
+auto availableKernels() -> std::vector<GaloisKernel>
+{
+    std::vector<GaloisKernel> kernels { { "scalar", mulAddScalar } };
+
+#if defined(PIRKS_FEC_X86)
+    const auto features = detectCpuFeatures();
+    if (features.ssse3) {
+        kernels.push_back({ "SSSE3", mulAddSsse3 });
+    }
+    if (features.avx2) {
+        kernels.push_back({ "AVX2", mulAddAvx2 });
+    }
+    if (features.avx2 && features.gfni) {
+        kernels.push_back({ "GFNI", mulAddGfni });
+    }
+#elif defined(PIRKS_FEC_NEON)
+    kernels.push_back({ "NEON", mulAddNeon });
+#endif
+
+    return kernels;
+}
+
+auto bestKernel() -> const GaloisKernel &
+{
+    // Kernels are sorted from slowest to fastest
+    static const GaloisKernel kernel = availableKernels().back();
+    return kernel;
+}
+
+}; // namespace pirks::networking::fec
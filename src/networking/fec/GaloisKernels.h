@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pirks::networking::fec
+{
+
+/**
+ * @brief dst[i] ^= c * src[i] in GF(2^8) for size bytes
+ */
+using MulAddFunc =
+        void (*)(std::uint8_t *dst, const std::uint8_t *src, std::uint8_t c, std::size_t size);
+
+struct GaloisKernel
+{
+    const char *name;
+    MulAddFunc  mulAdd;
+};
+
+/**
+ * @brief Fastest kernel supported by the current CPU
+ *
+ * Selected once on the first call: GFNI+AVX2, AVX2 or SSSE3 (PSHUFB nibble
+ * tables) on x86, NEON on ARM64, scalar log/exp tables otherwise.
+ */
+auto bestKernel() -> const GaloisKernel &;
+
+/**
+ * @brief All kernels which can run on the current CPU, scalar is always first
+ *
+ * Used by tests and benchmarks to compare kernels with each other.
+ */
+auto availableKernels() -> std::vector<GaloisKernel>;
+
+}; // namespace pirks::networking::fec
@@ -0,0 +1,176 @@
+#include "ReedSolomon.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#include "GaloisField.h"
+#include "GaloisKernels.h"
+
+namespace pirks::networking::fec
+{
+
+ReedSolomon::ReedSolomon(std::size_t data_shards, std::size_t parity_shards)
+        : dataShards_ { data_shards }
+        , parityShards_ { parity_shards }
+{
+    if (data_shards == 0 || parity_shards == 0 || data_shards + parity_shards > MAX_SHARDS) {
+        throw std::invalid_argument("Invalid number of Reed-Solomon shards");
+    }
+
+    // Cauchy matrix: a[j][i] = 1 / (x[j] + y[i]), x[j] = dataShards + j, y[i] = i.
+    // All x and y are different, so every square submatrix is invertible.
+    parityMatrix_.resize(parityShards_ * dataShards_);
+    for (std::size_t j = 0; j < parityShards_; ++j) {
+        for (std::size_t i = 0; i < dataShards_; ++i) {
+            const auto x = static_cast<std::uint8_t>(dataShards_ + j);
+            const auto y = static_cast<std::uint8_t>(i);
+
+            parityMatrix_[j * dataShards_ + i] = gf::inv(static_cast<std::uint8_t>(x ^ y));
+        }
+    }
+
+    decodeMatrix_.resize(dataShards_ * dataShards_);
+    inverse_.resize(dataShards_ * dataShards_);
+    rows_.resize(dataShards_);
+}
+
+void ReedSolomon::encode(
+        std::span<const ShardView>     data,
+        std::span<std::uint8_t *const> parity,
+        std::size_t                    shard_size) const
+{
+    assert(data.size() == dataShards_ && "wrong number of data shards");
+    assert(parity.size() == parityShards_ && "wrong number of parity shards");
+
+    const auto &kernel = bestKernel();
+
+    for (std::size_t j = 0; j < parityShards_; ++j) {
+        std::memset(parity[j], 0, shard_size);
+
+        for (std::size_t i = 0; i < dataShards_; ++i) {
+            assert(data[i].size <= shard_size && "data shard is bigger than shard size");
+            kernel.mulAdd(parity[j], data[i].data, coefficient(j, i), data[i].size);
+        }
+    }
+}
+
+bool ReedSolomon::reconstruct(
+        std::span<const ShardView>     shards,
+        std::span<std::uint8_t *const> recovered,
+        std::size_t                    shard_size)
+{
+    assert(shards.size() == dataShards_ + parityShards_ && "wrong number of shards");
+    assert(recovered.size() == dataShards_ && "wrong number of recovered buffers");
+
+    bool anyLost = false;
+    for (std::size_t i = 0; i < dataShards_; ++i) {
+        anyLost = anyLost || shards[i].data == nullptr;
+    }
+    if (!anyLost) {
+        return true;
+    }
+
+    // Take first dataShards available shards. Data shards come first, so
+    // their rows are unit rows and the matrix is mostly identity.
+    std::size_t count = 0;
+    for (std::size_t s = 0; s < shards.size() && count < dataShards_; ++s) {
+        if (shards[s].data != nullptr) {
+            rows_[count++] = s;
+        }
+    }
+    if (count < dataShards_) {
+        return false;
+    }
+
+    for (std::size_t r = 0; r < dataShards_; ++r) {
+        auto *row = decodeMatrix_.data() + r * dataShards_;
+        if (rows_[r] < dataShards_) {
+            std::fill(row, row + dataShards_, std::uint8_t { 0 });
+            row[rows_[r]] = 1;
+        } else {
+            const auto *parityRow = parityMatrix_.data() + (rows_[r] - dataShards_) * dataShards_;
+            std::copy(parityRow, parityRow + dataShards_, row);
+        }
+    }
+
+    if (!invertDecodeMatrix()) {
+        // Can't happen with Cauchy matrix
+        return false;
+    }
+
+    const auto &kernel = bestKernel();
+
+    // data[i] = sum(inverse[i][r] * shard[rows[r]])
+    for (std::size_t i = 0; i < dataShards_; ++i) {
+        if (shards[i].data != nullptr) {
+            continue;
+        }
+
+        assert(recovered[i] != nullptr && "no buffer for lost data shard");
+        std::memset(recovered[i], 0, shard_size);
+
+        for (std::size_t r = 0; r < dataShards_; ++r) {
+            const auto &shard = shards[rows_[r]];
+            kernel.mulAdd(
+                    recovered[i],
+                    shard.data,
+                    inverse_[i * dataShards_ + r],
+                    std::min(shard.size, shard_size));
+        }
+    }
+
+    return true;
+}
+
+bool ReedSolomon::invertDecodeMatrix()
+{
+    const auto n = dataShards_;
+    auto      &a = decodeMatrix_;
+
+    std::fill(inverse_.begin(), inverse_.end(), std::uint8_t { 0 });
+    for (std::size_t i = 0; i < n; ++i) {
+        inverse_[i * n + i] = 1;
+    }
+
+    // Gauss-Jordan elimination, addition and subtraction are both xor
+    for (std::size_t col = 0; col < n; ++col) {
+        auto pivot = col;
+        while (pivot < n && a[pivot * n + col] == 0) {
+            ++pivot;
+        }
+        if (pivot == n) {
+            return false;
+        }
+
+        if (pivot != col) {
+            std::swap_ranges(a.data() + pivot * n, a.data() + pivot * n + n, a.data() + col * n);
+            std::swap_ranges(
+                    inverse_.data() + pivot * n,
+                    inverse_.data() + pivot * n + n,
+                    inverse_.data() + col * n);
+        }
+
+        const auto scale = gf::inv(a[col * n + col]);
+        for (std::size_t k = 0; k < n; ++k) {
+            a[col * n + k]        = gf::mul(a[col * n + k], scale);
+            inverse_[col * n + k] = gf::mul(inverse_[col * n + k], scale);
+        }
+
+        for (std::size_t row = 0; row < n; ++row) {
+            const auto factor = a[row * n + col];
+            if (row == col || factor == 0) {
+                continue;
+            }
+            for (std::size_t k = 0; k < n; ++k) {
+                a[row * n + k] ^= gf::mul(factor, a[col * n + k]);
+                inverse_[row * n + k] ^= gf::mul(factor, inverse_[col * n + k]);
+            }
+        }
+    }
+
+    return true;
+}
+
+}; // namespace pirks::networking::fec
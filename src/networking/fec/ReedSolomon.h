@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace pirks::networking::fec
+{
+
+/**
+ * @brief Read-only shard. Bytes after size are treated as zeros
+ *
+ * Packets in one group have different sizes, so instead of padding them
+ * (and copying) shorter shards are just virtually extended with zeros,
+ * which contribute nothing to parity.
+ */
+struct ShardView
+{
+    const std::uint8_t *data { nullptr };
+    std::size_t         size { 0 };
+};
+
+/**
+ * @brief Systematic Reed-Solomon erasure code over GF(2^8)
+ *
+ * Parity rows form a Cauchy matrix, so any dataShards of the
+ * dataShards + parityShards shards are enough to restore the data.
+ * All memory is allocated in constructor.
+ */
+class ReedSolomon final
+{
+public:
+    static constexpr std::size_t MAX_SHARDS = 256;
+
+    ReedSolomon(std::size_t data_shards, std::size_t parity_shards);
+
+public:
+    /**
+     * @brief Calculate parity shards
+     *
+     * @param data          dataShards shards
+     * @param parity        parityShards buffers of shard_size bytes
+     * @param shard_size    Size of the largest data shard
+     */
+    void encode(
+            std::span<const ShardView>     data,
+            std::span<std::uint8_t *const> parity,
+            std::size_t                    shard_size) const;
+
+    /**
+     * @brief Restore lost data shards
+     *
+     * @param shards        dataShards + parityShards shards, lost ones have data == nullptr
+     * @param recovered     dataShards buffers of shard_size bytes. Only buffers of lost
+     *                      data shards are written, others can be nullptr
+     * @param shard_size    Size of parity shards
+     * @return false        if less than dataShards shards are available
+     */
+    bool reconstruct(
+            std::span<const ShardView>     shards,
+            std::span<std::uint8_t *const> recovered,
+            std::size_t                    shard_size);
+
+    [[nodiscard]]
+    auto dataShards() const -> std::size_t
+    {
+        return dataShards_;
+    }
+
+    [[nodiscard]]
+    auto parityShards() const -> std::size_t
+    {
+        return parityShards_;
+    }
+
+    /**
+     * @brief Coefficient of data shard in parity shard
+     */
+    [[nodiscard]]
+    auto coefficient(std::size_t parity, std::size_t data) const -> std::uint8_t
+    {
+        return parityMatrix_[parity * dataShards_ + data];
+    }
+
+private:
+    bool invertDecodeMatrix();
+
+private:
+    std::size_t               dataShards_;
+    std::size_t               parityShards_;
+    std::vector<std::uint8_t> parityMatrix_; ///< parityShards x dataShards
+
+    // Scratch space for reconstruct()
+    std::vector<std::uint8_t> decodeMatrix_; ///< dataShards x dataShards
+    std::vector<std::uint8_t> inverse_;      ///< dataShards x dataShards
+    std::vector<std::size_t>  rows_;         ///< Shards used for decoding
+};
+
+}; // namespace pirks::networking::fec
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#include "PacketInfo.h"
+
+namespace pirks::networking::fragment
+{
+
+/**
+ * @brief Splits a frame into fragments of fragmentSize() bytes, only the last one may be shorter
+ *
+ * Fragments point into the buffer of the frame, nothing is copied, so the
+ * frame must stay alive until all fragments are sent. Receiver finds the
+ * offset of a fragment as fragmentIndex * fragmentSize(), so both sides must
+ * use the same fragment size.
+ */
+class Fragmenter final
+{
+public:
+    static constexpr std::size_t MAX_FRAGMENTS = std::numeric_limits<uint16_t>::max();
+
+public:
+    explicit Fragmenter(std::size_t fragment_size) : fragmentSize_ { fragment_size }
+    {
+        assert(fragment_size != 0 && "fragment size can't be zero");
+    }
+
+public:
+    [[nodiscard]]
+    auto fragmentSize() const -> std::size_t
+    {
+        return fragmentSize_;
+    }
+
+    /**
+     * @brief Number of fragments for a frame, 0 if it's empty or too big
+     */
+    [[nodiscard]]
+    auto fragmentCount(std::size_t frame_size) const -> std::size_t
+    {
+        const auto count = (frame_size + fragmentSize_ - 1) / fragmentSize_;
+        return count <= MAX_FRAGMENTS ? count : 0;
+    }
+
+    /**
+     * @brief Call emit(const PacketInfo &) for every fragment of the frame, in order
+     *
+     * Fragments inherit channel, reliability and timestamp of the frame.
+     *
+     * @return std::size_t  Number of fragments, 0 if the frame can't be fragmented
+     */
+    template<class Func>
+    auto split(const PacketInfo &frame, Func &&emit) const -> std::size_t;
+
+private:
+    std::size_t fragmentSize_;
+};
+
+template<class Func>
+auto Fragmenter::split(const PacketInfo &frame, Func &&emit) const -> std::size_t
+{
+    const auto count = fragmentCount(frame.size);
+
+    PacketInfo fragment = frame;
+
+    fragment.fragmentCount = static_cast<uint16_t>(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto offset = i * fragmentSize_;
+
+        fragment.fragmentIndex = static_cast<uint16_t>(i);
+        fragment.size          = static_cast<uint32_t>(
+                std::min<std::size_t>(fragmentSize_, frame.size - offset));
+        fragment.data          = frame.data + offset;
+
+        emit(std::as_const(fragment));
+    }
+
+    return count;
+}
+
+}; // namespace pirks::networking::fragment
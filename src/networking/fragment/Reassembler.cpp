@@ -0,0 +1,174 @@
+#include "Reassembler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace pirks::networking::fragment
+{
+
+Reassembler::Reassembler(const ReassemblerSettings &settings, std::shared_ptr<PacketPool> frames)
+        : settings_ { settings }
+        , frames_ { std::move(frames) }
+        , maxFragments_ { 0 }
+{
+    if (!frames_) {
+        throw std::invalid_argument("Reassembler: frames pool is required");
+    }
+    if (settings.fragmentSize == 0 || settings.fragmentSize > frames_->blockSize()) {
+        throw std::invalid_argument("Reassembler: fragment size must be within frame buffer");
+    }
+    if (settings.maxFrames == 0) {
+        throw std::invalid_argument("Reassembler: at least one frame must be allowed");
+    }
+
+    // Every fragment but the last one is full, so the last one starts below blockSize
+    maxFragments_ = std::min<std::size_t>(
+            (frames_->blockSize() - 1) / settings.fragmentSize + 1,
+            UINT16_MAX);
+
+    slots_.resize(settings.maxFrames);
+    for (auto &frame: slots_) {
+        frame.mask.resize((maxFragments_ + 63) / 64);
+    }
+}
+
+Reassembler::~Reassembler()
+{
+    for (auto &frame: slots_) {
+        if (frame.used) {
+            drop(frame);
+        }
+    }
+}
+
+void Reassembler::evictExpired(Clock::time_point now)
+{
+    for (auto &frame: slots_) {
+        if (frame.used && now - frame.started > settings_.timeout) {
+            drop(frame);
+            ++stats_.expired;
+        }
+    }
+}
+
+auto Reassembler::pending() const -> std::size_t
+{
+    return static_cast<std::size_t>(
+            std::count_if(slots_.begin(), slots_.end(), [](const Frame &frame) {
+                return frame.used;
+            }));
+}
+
+auto Reassembler::add(const PacketInfo &fragment, Clock::time_point now)
+        -> std::pair<FragmentResult, Frame *>
+{
+    const auto index = fragment.fragmentIndex;
+    const auto count = fragment.fragmentCount;
+    const bool last  = index + 1 == count;
+
+    const auto offset = std::size_t { index } * settings_.fragmentSize;
+
+    // Only the last fragment may be shorter, otherwise offsets of the rest are unknown
+    if (index >= count || count > maxFragments_ || fragment.size == 0
+        || (!last && fragment.size != settings_.fragmentSize)
+        || offset + fragment.size > frames_->blockSize())
+    {
+        ++stats_.rejected;
+        return { FragmentResult::Rejected, nullptr };
+    }
+
+    const auto first = static_cast<SequenceNumber>(fragment.sequence - index);
+
+    auto *frame = find(fragment.channel, first);
+    if (frame == nullptr) {
+        frame = allocate(now);
+        if (frame == nullptr) {
+            ++stats_.poolExhausted;
+            return { FragmentResult::Rejected, nullptr };
+        }
+
+        frame->channel   = fragment.channel;
+        frame->first     = first;
+        frame->timestamp = fragment.timestamp;
+        frame->count     = count;
+    } else if (frame->count != count || frame->timestamp != fragment.timestamp) {
+        ++stats_.rejected;
+        return { FragmentResult::Rejected, nullptr };
+    }
+
+    auto      &word = frame->mask[index / 64];
+    const auto bit  = uint64_t { 1 } << (index % 64);
+    if (word & bit) {
+        ++stats_.duplicates;
+        return { FragmentResult::Duplicate, nullptr };
+    }
+
+    word |= bit;
+    ++frame->received;
+    std::memcpy(frame->data + offset, fragment.data, fragment.size);
+
+    if (last) {
+        frame->size = offset + fragment.size;
+    }
+
+    if (frame->received != frame->count) {
+        return { FragmentResult::Buffered, nullptr };
+    }
+
+    return { FragmentResult::Completed, frame };
+}
+
+auto Reassembler::find(uint8_t channel, SequenceNumber first) -> Frame *
+{
+    for (auto &frame: slots_) {
+        if (frame.used && frame.channel == channel && frame.first == first) {
+            return &frame;
+        }
+    }
+    return nullptr;
+}
+
+auto Reassembler::allocate(Clock::time_point now) -> Frame *
+{
+    Frame *frame = nullptr;
+    for (auto &slot: slots_) {
+        if (!slot.used) {
+            frame = &slot;
+            break;
+        }
+        if (frame == nullptr || slot.started < frame->started) {
+            frame = &slot;
+        }
+    }
+
+    // All slots are taken, the oldest frame is the least likely to complete
+    if (frame->used) {
+        drop(*frame);
+        ++stats_.evicted;
+    }
+
+    frame->data = frames_->acquire();
+    if (frame->data == nullptr) {
+        return nullptr;
+    }
+
+    frame->used     = true;
+    frame->received = 0;
+    frame->size     = 0;
+    frame->started  = now;
+    std::fill(frame->mask.begin(), frame->mask.end(), 0);
+    return frame;
+}
+
+void Reassembler::drop(Frame &frame)
+{
+    assert(frame.used && "frame is not in use");
+
+    frames_->release(frame.data);
+    frame.data = nullptr;
+    frame.used = false;
+}
+
+}; // namespace pirks::networking::fragment
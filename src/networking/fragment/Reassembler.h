@@ -0,0 +1,156 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "PacketInfo.h"
+#include "PacketPool.h"
+#include "SequenceNumber.h"
+
+namespace pirks::networking::fragment
+{
+
+struct ReassemblerSettings
+{
+    std::size_t               fragmentSize { 1408 }; ///< Must match Fragmenter of the sender
+    std::size_t               maxFrames { 8 };       ///< Incomplete frames kept at once
+    std::chrono::milliseconds timeout { 500 };       ///< Incomplete frame is dropped after this
+};
+
+struct ReassemblerStats
+{
+    uint64_t completed { 0 };
+    uint64_t duplicates { 0 };    ///< Fragment was already received, ignored
+    uint64_t rejected { 0 };      ///< Fragment does not fit frame buffer or its frame
+    uint64_t expired { 0 };       ///< Incomplete frames dropped by timeout
+    uint64_t evicted { 0 };       ///< Incomplete frames dropped to make room for a newer one
+    uint64_t poolExhausted { 0 }; ///< No frame buffer for a new frame, fragment dropped
+};
+
+enum class FragmentResult
+{
+    Buffered,
+    Completed, ///< Frame was delivered
+    Duplicate,
+    Rejected
+};
+
+/**
+ * @brief Collects fragments of large frames into preallocated frame buffers
+ *
+ * Fragments of one frame are sent back to back on their channel, so
+ * sequence - fragmentIndex is the same for all of them and identifies the
+ * frame. Every fragment is copied straight to its place in a frames pool
+ * block, fragmentIndex * fragmentSize; there is no list of fragments to
+ * concatenate at the end.
+ *
+ * Memory is capped by the frames pool: a frame may be at most one block,
+ * and at most maxFrames incomplete frames are kept, the oldest is dropped
+ * for a new one. Not thread safe, it belongs to the receiving thread.
+ */
+class Reassembler final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+public:
+    Reassembler(const ReassemblerSettings &settings, std::shared_ptr<PacketPool> frames);
+    ~Reassembler();
+
+    Reassembler(const Reassembler &)            = delete;
+    Reassembler &operator=(const Reassembler &) = delete;
+
+public:
+    /**
+     * @brief Copy the fragment into its frame
+     *
+     * Fragment stays owned by the caller. When the frame is complete,
+     * deliver(const PacketInfo &) is called with the whole frame in a frames
+     * pool block, ownership of the block goes to deliver.
+     */
+    template<class Func>
+    auto insert(const PacketInfo &fragment, Clock::time_point now, Func &&deliver)
+            -> FragmentResult;
+
+    /**
+     * @brief Drop incomplete frames older than timeout
+     */
+    void evictExpired(Clock::time_point now);
+
+    /**
+     * @brief Number of incomplete frames
+     */
+    [[nodiscard]]
+    auto pending() const -> std::size_t;
+
+    [[nodiscard]]
+    auto stats() const -> const ReassemblerStats &
+    {
+        return stats_;
+    }
+
+private:
+    struct Frame
+    {
+        bool              used { false };
+        uint8_t           channel { 0 };
+        SequenceNumber    first { 0 }; ///< Sequence number of fragment 0
+        uint32_t          timestamp { 0 };
+        uint16_t          count { 0 };
+        uint16_t          received { 0 };
+        std::size_t       size { 0 }; ///< Known when the last fragment arrives
+        Clock::time_point started;
+        uint8_t          *data { nullptr };
+
+        std::vector<uint64_t> mask; ///< Received fragments, preallocated
+    };
+
+private:
+    /**
+     * @brief Copy fragment into its frame, returns the frame if it's complete
+     */
+    auto add(const PacketInfo &fragment, Clock::time_point now)
+            -> std::pair<FragmentResult, Frame *>;
+
+    auto find(uint8_t channel, SequenceNumber first) -> Frame *;
+    auto allocate(Clock::time_point now) -> Frame *;
+    void drop(Frame &frame);
+
+private:
+    ReassemblerSettings         settings_;
+    std::shared_ptr<PacketPool> frames_;
+    std::size_t                 maxFragments_;
+    std::vector<Frame>          slots_;
+    ReassemblerStats            stats_;
+};
+
+template<class Func>
+auto Reassembler::insert(const PacketInfo &fragment, Clock::time_point now, Func &&deliver)
+        -> FragmentResult
+{
+    const auto [result, frame] = add(fragment, now);
+    if (result != FragmentResult::Completed) {
+        return result;
+    }
+
+    PacketInfo packet;
+    packet.channel       = frame->channel;
+    packet.sequence      = frame->first;
+    packet.timestamp     = frame->timestamp;
+    packet.fragmentCount = frame->count;
+    packet.size          = static_cast<uint32_t>(frame->size);
+    packet.data          = frame->data;
+
+    // Block now belongs to deliver
+    frame->data = nullptr;
+    frame->used = false;
+    ++stats_.completed;
+
+    deliver(std::as_const(packet));
+    return result;
+}
+
+}; // namespace pirks::networking::fragment
@@ -0,0 +1,204 @@
+#include "JitterBuffer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <stdexcept>
+
+namespace pirks::networking::jitter
+{
+
+namespace {
+
+// RFC 3550: J = J + (|D| - J) / 16
+constexpr int64_t JITTER_GAIN = 16;
+
+// Timestamps are compared as signed 32-bit differences, rebase long before that overflows
+constexpr int64_t REBASE_THRESHOLD = int64_t { 1 } << 30;
+
+} // namespace
+
+JitterBuffer::JitterBuffer(
+        const JitterBufferSettings &settings,
+        std::shared_ptr<PacketPool> pool,
+        std::pmr::memory_resource  *resource)
+        : settings_ { settings }
+        , pool_ { std::move(pool) }
+        , slots_ { resource }
+        , mask_ { settings.capacity - 1 }
+{
+    if (settings.capacity == 0 || !std::has_single_bit(settings.capacity)
+        || settings.capacity > 65536) {
+        throw std::invalid_argument("Jitter buffer capacity must be a power of two up to 65536");
+    }
+    if (settings.clockRate == 0 || settings.minDelay > settings.maxDelay) {
+        throw std::invalid_argument("Invalid jitter buffer settings");
+    }
+
+    assert(pool_ && "packet pool is required");
+
+    slots_.resize(settings.capacity);
+    targetDelay_ = settings_.minDelay.count();
+}
+
+JitterBuffer::~JitterBuffer()
+{
+    flush();
+}
+
+auto JitterBuffer::insert(const PacketInfo &packet, Clock::time_point arrival) -> InsertResult
+{
+    const SequenceNumber seq = packet.sequence;
+
+    ++stats_.received;
+
+    // Too far ahead: sender restarted or a long burst was lost, start over
+    if (started_ && sequenceNewer(seq, next_)
+        && sequenceDistance(seq, next_) >= slots_.size()) {
+        ++stats_.resyncs;
+        reset();
+    }
+
+    if (!started_) {
+        started_ = true;
+        next_    = seq;
+        highest_ = seq;
+    } else if (sequenceNewer(next_, seq)) {
+        // Until the first packet is played, playout can start from an earlier packet
+        // that was reordered, if all buffered packets still fit
+        const auto span = sequenceDistance(highest_, seq);
+        if (playing_ || count_ == 0 || span >= slots_.size()) {
+            updateTiming(packet.timestamp, arrival);
+            ++stats_.late;
+            return InsertResult::Late;
+        }
+        next_ = seq;
+    }
+
+    auto &target = slot(seq);
+    if (target.present) {
+        ++stats_.duplicates;
+        return InsertResult::Duplicate;
+    }
+
+    updateTiming(packet.timestamp, arrival);
+
+    target.packet  = packet;
+    target.present = true;
+    ++count_;
+
+    if (sequenceNewer(seq, highest_)) {
+        highest_ = seq;
+    }
+
+    return InsertResult::Buffered;
+}
+
+auto JitterBuffer::nextPlayoutTime() const -> std::optional<Clock::time_point>
+{
+    if (count_ == 0) {
+        return std::nullopt;
+    }
+
+    return playoutTime(slot(firstBuffered()).packet.timestamp);
+}
+
+void JitterBuffer::reset()
+{
+    flush();
+
+    started_       = false;
+    playing_       = false;
+    timingStarted_ = false;
+
+    jitter_      = 0;
+    targetDelay_ = settings_.minDelay.count();
+}
+
+auto JitterBuffer::mediaTime(uint32_t timestamp) const -> int64_t
+{
+    const auto ticks = static_cast<int32_t>(timestamp - firstTimestamp_);
+    return int64_t { ticks } * 1'000'000 / settings_.clockRate;
+}
+
+auto JitterBuffer::playoutTime(uint32_t timestamp) const -> Clock::time_point
+{
+    return epoch_ + Duration { mediaTime(timestamp) + baseTransit_ + targetDelay_ };
+}
+
+void JitterBuffer::updateTiming(uint32_t timestamp, Clock::time_point arrival)
+{
+    // The first packet defines both clocks, its transit time is 0
+    if (!timingStarted_) {
+        timingStarted_    = true;
+        epoch_            = arrival;
+        firstTimestamp_   = timestamp;
+        lastTransit_      = 0;
+        baseTransit_      = 0;
+        windowMinTransit_ = 0;
+        windowStart_      = arrival;
+        return;
+    }
+
+    // Keep timestamp differences far from 32-bit overflow on long sessions
+    const auto media = mediaTime(timestamp);
+    if (media > REBASE_THRESHOLD * 1'000'000 / settings_.clockRate) {
+        // Media time of every packet moves back by media, transit moves forward by the
+        // same amount, so buffered packets keep their playout time
+        firstTimestamp_ = timestamp;
+        lastTransit_ += media;
+        baseTransit_ += media;
+        windowMinTransit_ += media;
+    }
+
+    const auto arrivalTime = std::chrono::duration_cast<Duration>(arrival - epoch_).count();
+    const auto transit     = arrivalTime - mediaTime(timestamp);
+
+    const auto difference = transit > lastTransit_ ? transit - lastTransit_
+                                                   : lastTransit_ - transit;
+    jitter_ += (difference - jitter_) / JITTER_GAIN;
+    lastTransit_ = transit;
+
+    baseTransit_      = std::min(baseTransit_, transit);
+    windowMinTransit_ = std::min(windowMinTransit_, transit);
+    if (arrival - windowStart_ >= TRANSIT_WINDOW) {
+        // Lets base transit grow if sender clock is slower than ours
+        baseTransit_      = windowMinTransit_;
+        windowMinTransit_ = transit;
+        windowStart_      = arrival;
+    }
+
+    const auto desired = std::clamp(
+            jitter_ * JITTER_MULTIPLIER,
+            int64_t { settings_.minDelay.count() },
+            int64_t { settings_.maxDelay.count() });
+    if (desired > targetDelay_) {
+        targetDelay_ = desired;
+    } else {
+        targetDelay_ -= (targetDelay_ - desired) / TARGET_DECAY;
+    }
+}
+
+void JitterBuffer::flush()
+{
+    for (auto &s: slots_) {
+        if (s.present) {
+            pool_->release(s.packet.data);
+            s.present = false;
+        }
+    }
+    count_ = 0;
+}
+
+auto JitterBuffer::firstBuffered() const -> SequenceNumber
+{
+    assert(count_ != 0 && "jitter buffer is empty");
+
+    auto seq = next_;
+    while (!slot(seq).present) {
+        ++seq;
+    }
+    return seq;
+}
+
+}; // namespace pirks::networking::jitter
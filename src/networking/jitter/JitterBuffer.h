@@ -0,0 +1,235 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "PacketInfo.h"
+#include "PacketPool.h"
+#include "SequenceNumber.h"
+
+namespace pirks::networking::jitter
+{
+
+struct JitterBufferSettings
+{
+    uint32_t                  clockRate { AUDIO_CLOCK_RATE }; ///< Units of PacketHeader::timestamp
+    std::chrono::microseconds minDelay { std::chrono::milliseconds { 5 } };
+    std::chrono::microseconds maxDelay { std::chrono::milliseconds { 200 } };
+    std::size_t               capacity { 512 }; ///< Packets, must divide 65536
+};
+
+struct JitterBufferStats
+{
+    uint64_t received { 0 };
+    uint64_t played { 0 };
+    uint64_t late { 0 };       ///< Arrived after their playout slot, dropped
+    uint64_t lost { 0 };       ///< Never arrived, skipped at playout
+    uint64_t duplicates { 0 }; ///< Dropped
+    uint64_t resyncs { 0 };    ///< Sequence number jumped beyond capacity, buffer was flushed
+};
+
+enum class InsertResult
+{
+    Buffered,
+    Late,     ///< Packet is not taken, caller still owns it
+    Duplicate ///< Packet is not taken, caller still owns it
+};
+
+/**
+ * @brief Reorders incoming media packets and releases them at steady pace
+ *
+ * Packets are kept by PacketHeader::sequence in a preallocated ring and
+ * played out at
+ *
+ *     media time of the packet + smallest seen transit time + target delay
+ *
+ * Inter-arrival jitter is estimated as in RFC 3550. Target delay follows it
+ * immediately when jitter grows and slowly when jitter falls, and is clamped
+ * to [minDelay, maxDelay]. Smallest transit time is taken over a sliding
+ * window, so clock drift between sender and receiver does not grow delay.
+ *
+ * Packet that arrives after its slot was played or skipped is dropped as
+ * late. Not thread safe, it belongs to the thread which consumes packets.
+ */
+class JitterBuffer final
+{
+public:
+    using Clock    = std::chrono::steady_clock;
+    using Duration = std::chrono::microseconds;
+
+    // Playout delay is this number of jitter estimates
+    static constexpr int64_t JITTER_MULTIPLIER = 4;
+
+    // Target delay moves down by 1/TARGET_DECAY of the difference for every packet
+    static constexpr int64_t TARGET_DECAY = 256;
+
+    // Window for smallest transit time
+    static constexpr Duration TRANSIT_WINDOW { std::chrono::seconds { 2 } };
+
+public:
+    /**
+     * @param settings  Capacity and delay limits
+     * @param pool      Pool that buffered packets are released to
+     * @param resource  Memory of the slots, allocated once in constructor
+     */
+    JitterBuffer(
+            const JitterBufferSettings &settings,
+            std::shared_ptr<PacketPool> pool,
+            std::pmr::memory_resource  *resource = std::pmr::get_default_resource());
+    ~JitterBuffer();
+
+    JitterBuffer(const JitterBuffer &)            = delete;
+    JitterBuffer &operator=(const JitterBuffer &) = delete;
+
+public:
+    /**
+     * @brief Add packet that arrived at the given time
+     *
+     * Buffered packet is owned by the jitter buffer until it's played.
+     */
+    auto insert(const PacketInfo &packet, Clock::time_point arrival) -> InsertResult;
+
+    /**
+     * @brief Call play(const PacketInfo &) for packets whose playout time has come, in order
+     *
+     * Ownership of the packet goes to play.
+     *
+     * @return std::size_t  Number of played packets
+     */
+    template<class Func>
+    auto pop(Clock::time_point now, Func &&play) -> std::size_t;
+
+    /**
+     * @brief When the next packet should be played, nullopt if buffer is empty
+     */
+    [[nodiscard]]
+    auto nextPlayoutTime() const -> std::optional<Clock::time_point>;
+
+    /**
+     * @brief Drop all buffered packets and start over with the next one
+     */
+    void reset();
+
+    /**
+     * @brief Number of buffered packets
+     */
+    [[nodiscard]]
+    auto depth() const -> std::size_t
+    {
+        return count_;
+    }
+
+    [[nodiscard]]
+    auto jitter() const -> Duration
+    {
+        return Duration { jitter_ };
+    }
+
+    [[nodiscard]]
+    auto targetDelay() const -> Duration
+    {
+        return Duration { targetDelay_ };
+    }
+
+    [[nodiscard]]
+    auto stats() const -> const JitterBufferStats &
+    {
+        return stats_;
+    }
+
+private:
+    struct Slot
+    {
+        PacketInfo packet;
+        bool       present { false };
+    };
+
+private:
+    auto slot(SequenceNumber seq) -> Slot &
+    {
+        return slots_[seq & mask_];
+    }
+
+    auto slot(SequenceNumber seq) const -> const Slot &
+    {
+        return slots_[seq & mask_];
+    }
+
+    // Microseconds of media time relative to the first packet
+    auto mediaTime(uint32_t timestamp) const -> int64_t;
+    auto playoutTime(uint32_t timestamp) const -> Clock::time_point;
+
+    void updateTiming(uint32_t timestamp, Clock::time_point arrival);
+    void flush();
+
+    // Oldest buffered packet at or after next_, it's there if count_ != 0
+    auto firstBuffered() const -> SequenceNumber;
+
+private:
+    JitterBufferSettings        settings_;
+    std::shared_ptr<PacketPool> pool_;
+    std::pmr::vector<Slot>      slots_;
+    std::size_t                 mask_;
+    std::size_t                 count_ { 0 };
+
+    bool           started_ { false };
+    bool           playing_ { false };
+    SequenceNumber next_ { 0 };    ///< Next packet to play
+    SequenceNumber highest_ { 0 }; ///< Newest buffered or played packet
+
+    // Timing, all in microseconds
+    bool              timingStarted_ { false };
+    uint32_t          firstTimestamp_ { 0 };
+    Clock::time_point epoch_;
+    int64_t           lastTransit_ { 0 };
+    int64_t           baseTransit_ { 0 };
+    int64_t           windowMinTransit_ { 0 };
+    Clock::time_point windowStart_;
+    int64_t           jitter_ { 0 };
+    int64_t           targetDelay_ { 0 };
+
+    JitterBufferStats stats_;
+};
+
+template<class Func>
+auto JitterBuffer::pop(Clock::time_point now, Func &&play) -> std::size_t
+{
+    std::size_t played = 0;
+
+    while (count_ != 0) {
+        auto &current = slot(next_);
+        if (!current.present) {
+            // Skip the hole only when the packet after it has to be played
+            const auto first = firstBuffered();
+            if (playoutTime(slot(first).packet.timestamp) > now) {
+                break;
+            }
+
+            stats_.lost += sequenceDistance(first, next_);
+            next_        = first;
+            continue;
+        }
+
+        if (playoutTime(current.packet.timestamp) > now) {
+            break;
+        }
+
+        current.present = false;
+        --count_;
+        ++next_;
+        playing_ = true;
+        ++stats_.played;
+        ++played;
+
+        play(std::as_const(current.packet));
+    }
+
+    return played;
+}
+
+}; // namespace pirks::networking::jitter
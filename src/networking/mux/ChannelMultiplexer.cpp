@@ -0,0 +1,138 @@
+#include "ChannelMultiplexer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace pirks::networking::mux
+{
+
+ChannelMultiplexer::ChannelMultiplexer(
+        const MultiplexerSettings &settings,
+        std::pmr::memory_resource *resource)
+        : entries_ { resource }
+{
+    std::size_t total = 0;
+    for (std::size_t channel = 0; channel < CHANNEL_COUNT; ++channel) {
+        const auto &channelSettings = settings.channels[channel];
+        if (channelSettings.maxPackets == 0 || channelSettings.maxBytes == 0) {
+            throw std::invalid_argument("ChannelMultiplexer: channel budget can't be zero");
+        }
+        if (!channelSettings.strictPriority && channelSettings.weight == 0) {
+            throw std::invalid_argument("ChannelMultiplexer: weight can't be zero");
+        }
+
+        rings_[channel].settings = channelSettings;
+        total += channelSettings.maxPackets;
+    }
+
+    entries_.resize(total);
+
+    std::size_t offset = 0;
+    for (auto &ring: rings_) {
+        ring.entries = std::span { entries_ }.subspan(offset, ring.settings.maxPackets);
+        offset += ring.settings.maxPackets;
+    }
+}
+
+bool ChannelMultiplexer::canPush(uint8_t channel, std::size_t packets, std::size_t bytes) const
+{
+    if (channel >= CHANNEL_COUNT) {
+        return false;
+    }
+
+    const auto &ring = rings_[channel];
+    return ring.count + packets <= ring.settings.maxPackets
+           && ring.bytes + bytes <= ring.settings.maxBytes;
+}
+
+bool ChannelMultiplexer::push(const PacketInfo &packet)
+{
+    if (!canPush(packet.channel, 1, packet.size)) {
+        if (packet.channel < CHANNEL_COUNT) {
+            ++rings_[packet.channel].stats.dropped;
+        }
+        return false;
+    }
+
+    auto &ring = rings_[packet.channel];
+
+    auto &entry  = ring.entries[(ring.head + ring.count) % ring.entries.size()];
+    entry.packet = packet;
+
+    // Idle channel starts from current virtual time, backlogged one after its
+    // previous packet
+    if (!ring.settings.strictPriority) {
+        const auto cost = uint64_t { packet.size } * WEIGHT_SCALE / ring.settings.weight;
+        entry.finish    = std::max(virtualTime_, ring.lastFinish) + cost;
+        ring.lastFinish = entry.finish;
+    }
+
+    ++ring.count;
+    ring.bytes += packet.size;
+    ++queued_;
+    return true;
+}
+
+auto ChannelMultiplexer::pop() -> std::optional<PacketInfo>
+{
+    if (queued_ == 0) {
+        return std::nullopt;
+    }
+
+    Ring *next = nullptr;
+    for (auto &ring: rings_) {
+        if (ring.count == 0) {
+            continue;
+        }
+        if (ring.settings.strictPriority) {
+            next = &ring;
+            break;
+        }
+        if (next == nullptr || ring.entries[ring.head].finish < next->entries[next->head].finish) {
+            next = &ring;
+        }
+    }
+
+    assert(next && "queued packets must be in some ring");
+
+    if (!next->settings.strictPriority) {
+        virtualTime_ = next->entries[next->head].finish;
+    }
+
+    ++next->stats.sent;
+    return take(*next);
+}
+
+auto ChannelMultiplexer::size(uint8_t channel) const -> std::size_t
+{
+    assert(channel < CHANNEL_COUNT && "invalid channel");
+    return rings_[channel].count;
+}
+
+auto ChannelMultiplexer::bytes(uint8_t channel) const -> std::size_t
+{
+    assert(channel < CHANNEL_COUNT && "invalid channel");
+    return rings_[channel].bytes;
+}
+
+auto ChannelMultiplexer::stats(uint8_t channel) const -> const ChannelStats &
+{
+    assert(channel < CHANNEL_COUNT && "invalid channel");
+    return rings_[channel].stats;
+}
+
+auto ChannelMultiplexer::take(Ring &ring) -> PacketInfo
+{
+    assert(ring.count != 0 && "ring is empty");
+
+    const auto packet = ring.entries[ring.head].packet;
+
+    ring.head = (ring.head + 1) % ring.entries.size();
+    --ring.count;
+    ring.bytes -= packet.size;
+    --queued_;
+    return packet;
+}
+
+}; // namespace pirks::networking::mux
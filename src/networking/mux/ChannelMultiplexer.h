@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "PacketInfo.h"
+
+namespace pirks::networking::mux
+{
+
+struct ChannelSettings
+{
+    std::size_t maxPackets { 256 };       ///< Ring capacity, preallocated
+    std::size_t maxBytes { 256 * 1024 };  ///< Payload bytes queued at once
+    bool        strictPriority { false }; ///< Served before any weighted channel
+    uint32_t    weight { 1 };             ///< Share of bandwidth among weighted channels
+};
+
+/**
+ * @brief Budgets and scheduling class of every channel, indexed by Channel
+ *
+ * Control and input are tiny and must never wait behind media. Audio gets a
+ * quarter of the bandwidth when video is backlogged, which is far more than
+ * it needs, so its packets go out as soon as the one on the wire is sent.
+ */
+struct MultiplexerSettings
+{
+    std::array<ChannelSettings, CHANNEL_COUNT> channels { {
+            { 256, 64 * 1024, true, 1 },         // Control
+            { 1024, 64 * 1024, true, 1 },        // Input
+            { 256, 128 * 1024, false, 1 },       // Audio
+            { 2048, 1024 * 1024, false, 3 },     // Video
+    } };
+};
+
+struct ChannelStats
+{
+    uint64_t sent { 0 };
+    uint64_t dropped { 0 }; ///< Packets which did not fit the budget
+};
+
+/**
+ * @brief Multi-queue scheduler between outgoing channels
+ *
+ * Every channel has its own ring, so a large video frame no longer blocks a
+ * small audio packet queued after it. pop() picks the next packet:
+ *
+ *  - strict priority channels first, lower Channel value wins;
+ *  - the rest by weighted fair queuing: every packet gets a virtual finish
+ *    tag max(virtual time, tag of previous packet of its channel) +
+ *    size / weight, the smallest tag is sent and becomes the virtual time
+ *    (self-clocked fair queuing).
+ *
+ * A packet which exceeds its channel budget is refused by push() and stays
+ * with the caller, so under load the channel with the largest backlog, video,
+ * drops packets while others keep their latency. Not thread safe, it belongs
+ * to the sending thread.
+ */
+class ChannelMultiplexer final
+{
+public:
+    // Finish tags are in bytes * WEIGHT_SCALE / weight
+    static constexpr uint64_t WEIGHT_SCALE = 1 << 16;
+
+public:
+    /**
+     * @param settings  Budgets and weights of channels
+     * @param resource  Memory of the rings of all channels, allocated once in constructor
+     */
+    explicit ChannelMultiplexer(
+            const MultiplexerSettings &settings = {},
+            std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+    ChannelMultiplexer(const ChannelMultiplexer &)            = delete;
+    ChannelMultiplexer &operator=(const ChannelMultiplexer &) = delete;
+
+public:
+    /**
+     * @brief Check that packets with this many payload bytes fit the channel budget
+     */
+    [[nodiscard]]
+    bool canPush(uint8_t channel, std::size_t packets, std::size_t bytes) const;
+
+    /**
+     * @brief Queue packet on its channel, false if it does not fit the budget
+     *
+     * Ownership of packet data goes to the multiplexer only on success.
+     */
+    bool push(const PacketInfo &packet);
+
+    /**
+     * @brief Take the next packet to send, nullopt if all channels are empty
+     */
+    [[nodiscard]]
+    auto pop() -> std::optional<PacketInfo>;
+
+    /**
+     * @brief Remove all packets, calling release(const PacketInfo &) for each
+     */
+    template<class Func>
+    void clear(Func &&release);
+
+    [[nodiscard]]
+    bool isEmpty() const
+    {
+        return queued_ == 0;
+    }
+
+    /**
+     * @brief Packets queued on the channel
+     */
+    [[nodiscard]]
+    auto size(uint8_t channel) const -> std::size_t;
+
+    /**
+     * @brief Payload bytes queued on the channel
+     */
+    [[nodiscard]]
+    auto bytes(uint8_t channel) const -> std::size_t;
+
+    [[nodiscard]]
+    auto stats(uint8_t channel) const -> const ChannelStats &;
+
+private:
+    struct Entry
+    {
+        PacketInfo packet;
+        uint64_t   finish { 0 };
+    };
+
+    struct Ring
+    {
+        ChannelSettings  settings;
+        std::span<Entry> entries; ///< settings.maxPackets entries of entries_
+        std::size_t      head { 0 };
+        std::size_t      count { 0 };
+        std::size_t      bytes { 0 };
+        uint64_t         lastFinish { 0 };
+        ChannelStats     stats;
+    };
+
+private:
+    auto take(Ring &ring) -> PacketInfo;
+
+private:
+    std::pmr::vector<Entry>         entries_; ///< Rings of all channels, one after another
+    std::array<Ring, CHANNEL_COUNT> rings_;
+    std::size_t                     queued_ { 0 };
+    uint64_t                        virtualTime_ { 0 };
+};
+
+template<class Func>
+void ChannelMultiplexer::clear(Func &&release)
+{
+    for (auto &ring: rings_) {
+        while (ring.count != 0) {
+            const auto packet = take(ring);
+            release(packet);
+        }
+        ring.lastFinish = 0;
+    }
+    virtualTime_ = 0;
+}
+
+}; // namespace pirks::networking::mux
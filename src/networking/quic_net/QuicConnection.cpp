@@ -0,0 +1,716 @@
+#include "QuicConnection.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "Logging.h"
+#include "trace/Trace.h"
+
+#ifdef WITH_MSQUIC
+#include <msquic.h>
+#endif
+
+using namespace std::chrono_literals;
+
+namespace pirks::networking::quic
+{
+
+#ifdef WITH_MSQUIC
+
+static_assert(
+        sizeof(QUIC_BUFFER) <= QuicConnection::PACKET_HEADROOM - wire::HEADER_SIZE,
+        "msquic buffer descriptor must fit the headroom in front of the wire header");
+
+namespace {
+
+// How long send thread waits for packets before checking stop flag
+constexpr auto SEND_POLL_INTERVAL = 1ms;
+
+// Packets taken from the output queue at once
+constexpr std::size_t SEND_BATCH_SIZE = 64;
+
+// Path MTU discovery may grow datagrams up to ethernet MTU, so packets of
+// the pool block size fit one datagram
+constexpr uint16_t MAXIMUM_MTU = 1500;
+
+// Stream of a lower channel is sent first, default priority of msquic is 0x7FFF
+constexpr uint16_t STREAM_PRIORITY = 0x7FFF;
+
+auto alpn() -> QUIC_BUFFER
+{
+    return QUIC_BUFFER {
+        static_cast<uint32_t>(std::strlen(QuicConnection::ALPN)),
+        reinterpret_cast<uint8_t *>(const_cast<char *>(QuicConnection::ALPN)),
+    };
+}
+
+/**
+ * @brief Send descriptor of the wire header and payload of a pool block
+ *
+ * It's placed in the headroom in front of the header, so it stays valid
+ * until msquic completes the send, without any allocation.
+ */
+auto describe(uint8_t *block, std::size_t size) -> QUIC_BUFFER *
+{
+    auto *header     = wire::headerBefore(block).data();
+    auto *descriptor = new (header - sizeof(QUIC_BUFFER)) QUIC_BUFFER;
+    descriptor->Length = static_cast<uint32_t>(wire::HEADER_SIZE + size);
+    descriptor->Buffer = header;
+    return descriptor;
+}
+
+} // namespace
+
+/**
+ * @brief C callbacks of msquic, forwarded to the connection
+ */
+struct Callbacks
+{
+    static QUIC_STATUS QUIC_API listener(HQUIC, void *context, QUIC_LISTENER_EVENT *event)
+    {
+        auto *connection = static_cast<QuicConnection *>(context);
+        return connection->onListenerEvent(*event) ? QUIC_STATUS_SUCCESS
+                                                   : QUIC_STATUS_CONNECTION_REFUSED;
+    }
+
+    static QUIC_STATUS QUIC_API connection(
+            HQUIC                  handle,
+            void                  *context,
+            QUIC_CONNECTION_EVENT *event)
+    {
+        static_cast<QuicConnection *>(context)->onConnectionEvent(handle, *event);
+        return QUIC_STATUS_SUCCESS;
+    }
+
+    static QUIC_STATUS QUIC_API sendStream(HQUIC, void *context, QUIC_STREAM_EVENT *event)
+    {
+        static_cast<QuicConnection *>(context)->onSendStreamEvent(*event);
+        return QUIC_STATUS_SUCCESS;
+    }
+
+    static QUIC_STATUS QUIC_API receiveStream(HQUIC handle, void *context, QUIC_STREAM_EVENT *event)
+    {
+        auto *reader = static_cast<QuicConnection::StreamReader *>(context);
+        reader->connection->onReceiveStreamEvent(handle, *reader, *event);
+        return QUIC_STATUS_SUCCESS;
+    }
+};
+
+bool isAvailable()
+{
+    return true;
+}
+
+void QuicConnection::open()
+{
+    if (QUIC_FAILED(MsQuicOpen2(&api_))) {
+        api_ = nullptr;
+        throw std::runtime_error("QuicConnection: msquic can't be opened");
+    }
+
+    const QUIC_REGISTRATION_CONFIG registration { "pirks", QUIC_EXECUTION_PROFILE_LOW_LATENCY };
+
+    // Stream data is not copied by msquic and stays in pool blocks until it's
+    // acknowledged; peer may open one stream for every channel
+    QUIC_SETTINGS quicSettings {};
+    quicSettings.IdleTimeoutMs                = settings_.idleTimeoutMs;
+    quicSettings.IsSet.IdleTimeoutMs          = TRUE;
+    quicSettings.DatagramReceiveEnabled       = TRUE;
+    quicSettings.IsSet.DatagramReceiveEnabled = TRUE;
+    quicSettings.SendBufferingEnabled         = FALSE;
+    quicSettings.IsSet.SendBufferingEnabled   = TRUE;
+    quicSettings.PeerUnidiStreamCount         = static_cast<uint16_t>(CHANNEL_COUNT);
+    quicSettings.IsSet.PeerUnidiStreamCount   = TRUE;
+    quicSettings.MaximumMtu                   = MAXIMUM_MTU;
+    quicSettings.IsSet.MaximumMtu             = TRUE;
+
+    QUIC_CERTIFICATE_FILE  certificate {};
+    QUIC_CREDENTIAL_CONFIG credential {};
+    if (settings_.host.empty()) {
+        certificate.CertificateFile = settings_.certificateFile.c_str();
+        certificate.PrivateKeyFile  = settings_.privateKeyFile.c_str();
+        credential.Type             = QUIC_CREDENTIAL_TYPE_CERTIFICATE_FILE;
+        credential.CertificateFile  = &certificate;
+    } else {
+        credential.Type  = QUIC_CREDENTIAL_TYPE_NONE;
+        credential.Flags = settings_.verifyServer
+                                   ? QUIC_CREDENTIAL_FLAG_CLIENT
+                                   : static_cast<QUIC_CREDENTIAL_FLAGS>(
+                                             QUIC_CREDENTIAL_FLAG_CLIENT
+                                             | QUIC_CREDENTIAL_FLAG_NO_CERTIFICATE_VALIDATION);
+    }
+
+    const auto alpnBuffer = alpn();
+
+    QUIC_STATUS status = api_->RegistrationOpen(&registration, &registration_);
+    if (QUIC_SUCCEEDED(status)) {
+        status = api_->ConfigurationOpen(
+                registration_,
+                &alpnBuffer,
+                1,
+                &quicSettings,
+                sizeof(quicSettings),
+                nullptr,
+                &configuration_);
+    }
+    if (QUIC_SUCCEEDED(status)) {
+        status = api_->ConfigurationLoadCredential(configuration_, &credential);
+    }
+
+    if (QUIC_FAILED(status)) {
+        close();
+        throw std::runtime_error(fmt::format("QuicConnection: msquic setup failed, {:#x}", status));
+    }
+}
+
+void QuicConnection::close()
+{
+    if (api_ == nullptr) {
+        return;
+    }
+
+    // Listener first, so no new connection arrives while the current one closes
+    if (listener_ != nullptr) {
+        api_->ListenerClose(listener_);
+        listener_ = nullptr;
+    }
+
+    QUIC_HANDLE                             *connection = nullptr;
+    std::array<QUIC_HANDLE *, CHANNEL_COUNT> streams {};
+    {
+        std::lock_guard lock { mutex_ };
+        connection = std::exchange(connection_, nullptr);
+        streams    = std::exchange(streams_, {});
+        connected_ = false;
+    }
+
+    // Closing waits for callbacks of the handle, blocks of canceled sends are
+    // released by them
+    for (auto *stream: streams) {
+        if (stream != nullptr) {
+            api_->StreamClose(stream);
+        }
+    }
+    if (connection != nullptr) {
+        api_->ConnectionClose(connection);
+    }
+    readers_.clear();
+
+    if (configuration_ != nullptr) {
+        api_->ConfigurationClose(configuration_);
+        configuration_ = nullptr;
+    }
+    if (registration_ != nullptr) {
+        api_->RegistrationClose(registration_);
+        registration_ = nullptr;
+    }
+
+    MsQuicClose(api_);
+    api_ = nullptr;
+}
+
+void QuicConnection::create(
+        std::shared_ptr<PacketsQueue> in_packets,
+        std::shared_ptr<PacketsQueue> out_packets)
+{
+    inPackets_  = in_packets;
+    outPackets_ = out_packets;
+
+    if (settings_.host.empty()) {
+        const auto alpnBuffer = alpn();
+
+        QUIC_ADDR address {};
+        QuicAddrSetFamily(&address, QUIC_ADDRESS_FAMILY_UNSPEC);
+        QuicAddrSetPort(&address, settings_.port);
+
+        if (QUIC_FAILED(api_->ListenerOpen(registration_, Callbacks::listener, this, &listener_))
+            || QUIC_FAILED(api_->ListenerStart(listener_, &alpnBuffer, 1, &address)))
+        {
+            throw std::runtime_error(
+                    fmt::format("QuicConnection: can't listen on port {}", settings_.port));
+        }
+
+        spdlog::debug("QuicConnection listening on port {}", localPort());
+    } else {
+        QUIC_HANDLE *connection = nullptr;
+        if (QUIC_FAILED(api_->ConnectionOpen(
+                    registration_,
+                    Callbacks::connection,
+                    this,
+                    &connection)))
+        {
+            throw std::runtime_error("QuicConnection: connection can't be opened");
+        }
+
+        {
+            std::lock_guard lock { mutex_ };
+            connection_ = connection;
+        }
+
+        if (QUIC_FAILED(api_->ConnectionStart(
+                    connection,
+                    configuration_,
+                    QUIC_ADDRESS_FAMILY_UNSPEC,
+                    settings_.host.c_str(),
+                    settings_.port)))
+        {
+            throw std::runtime_error("QuicConnection: can't connect to " + settings_.host);
+        }
+
+        spdlog::debug("QuicConnection connecting to {}:{}", settings_.host, settings_.port);
+    }
+
+    sendThread_ = std::thread(sendThreadFunc, this);
+}
+
+auto QuicConnection::localPort() const -> uint16_t
+{
+    if (listener_ == nullptr) {
+        return 0;
+    }
+
+    QUIC_ADDR address {};
+    uint32_t  size = sizeof(address);
+    if (QUIC_FAILED(api_->GetParam(listener_, QUIC_PARAM_LISTENER_LOCAL_ADDRESS, &size, &address)))
+    {
+        return 0;
+    }
+    return QuicAddrGetPort(&address);
+}
+
+void QuicConnection::sendThreadFunc(QuicConnection *connection)
+{
+    trace::setThreadName("quic-send");
+
+    // Packets are popped into the stack of the thread, not the heap
+    PacketBatch<SEND_BATCH_SIZE> storage;
+    auto                        &batch = storage.packets();
+
+    while (!connection->stop_) {
+        auto out = connection->outPackets_.lock();
+        if (!out) {
+            break;
+        }
+
+        const auto count = out->pop(batch, SEND_BATCH_SIZE, SEND_POLL_INTERVAL);
+        out.reset();
+
+        for (std::size_t i = 0; i < count; ++i) {
+            PIRKS_TRACE_SCOPE("quic", "send");
+            connection->send(batch[i]);
+        }
+    }
+}
+
+void QuicConnection::send(const PacketInfo &packet)
+{
+    assert(pool_->owns(packet.data) && "packet must be in a block of the packet pool");
+
+    if (packet.channel >= CHANNEL_COUNT) {
+        PIRKS_ERROR_LIMITED(
+                "QuicConnection: packet of unknown channel {} dropped",
+                packet.channel);
+        pool_->release(packet.data);
+        return;
+    }
+
+    // Connection can't close while a send is in flight
+    std::lock_guard lock { mutex_ };
+
+    if (!connected_) {
+        // Nobody to send to yet
+        pool_->release(packet.data);
+        return;
+    }
+
+    auto      &sequence = packet.reliable ? streamSequence_ : datagramSequence_;
+    const auto header   = wire::packetHeader(packet, sequence[packet.channel]++);
+    wire::serialize(header, wire::headerBefore(packet.data));
+
+    const bool fitsDatagram = wire::HEADER_SIZE + packet.size <= maxDatagramSize_;
+
+    const bool sent = !packet.reliable && fitsDatagram
+                              ? sendDatagram(connection_, packet.data, packet.size)
+                              : sendOnStream(connection_, packet.channel, packet.data, packet.size);
+    if (!sent) {
+        pool_->release(packet.data);
+    }
+}
+
+bool QuicConnection::sendDatagram(QUIC_HANDLE *connection, uint8_t *block, std::size_t size)
+{
+    // Block is released when the datagram reaches a final send state
+    return QUIC_SUCCEEDED(
+            api_->DatagramSend(connection, describe(block, size), 1, QUIC_SEND_FLAG_NONE, block));
+}
+
+bool QuicConnection::sendOnStream(
+        QUIC_HANDLE *connection,
+        uint8_t      channel,
+        uint8_t     *block,
+        std::size_t  size)
+{
+    auto *stream = openStream(connection, channel);
+    if (stream == nullptr) {
+        return false;
+    }
+
+    // Block is released when the data is acknowledged or the stream is closed
+    return QUIC_SUCCEEDED(
+            api_->StreamSend(stream, describe(block, size), 1, QUIC_SEND_FLAG_NONE, block));
+}
+
+auto QuicConnection::openStream(QUIC_HANDLE *connection, uint8_t channel) -> QUIC_HANDLE *
+{
+    if (streams_[channel] != nullptr) {
+        return streams_[channel];
+    }
+
+    QUIC_HANDLE *stream = nullptr;
+    if (QUIC_FAILED(api_->StreamOpen(
+                connection,
+                QUIC_STREAM_OPEN_FLAG_UNIDIRECTIONAL,
+                Callbacks::sendStream,
+                this,
+                &stream)))
+    {
+        spdlog::error("QuicConnection: stream of channel {} can't be opened", channel);
+        return nullptr;
+    }
+
+    const auto priority = static_cast<uint16_t>(STREAM_PRIORITY + CHANNEL_COUNT - channel);
+    api_->SetParam(stream, QUIC_PARAM_STREAM_PRIORITY, sizeof(priority), &priority);
+
+    if (QUIC_FAILED(api_->StreamStart(stream, QUIC_STREAM_START_FLAG_NONE))) {
+        spdlog::error("QuicConnection: stream of channel {} can't be started", channel);
+        api_->StreamClose(stream);
+        return nullptr;
+    }
+
+    streams_[channel] = stream;
+    return stream;
+}
+
+void QuicConnection::receiveDatagram(std::span<const uint8_t> datagram)
+{
+    // Reliable packets never come in datagrams
+    const auto header = wire::parse(datagram);
+    if (!header || header->flags != 0) {
+        spdlog::debug("QuicConnection: malformed datagram dropped");
+        return;
+    }
+
+    auto *block = header->payloadSize <= pool_->blockSize() ? pool_->acquire() : nullptr;
+    if (block == nullptr) {
+        spdlog::debug("QuicConnection: no block for datagram, dropped");
+        return;
+    }
+
+    std::memcpy(block, datagram.data() + wire::HEADER_SIZE, header->payloadSize);
+    deliver(*header, block);
+}
+
+void QuicConnection::receiveStream(StreamReader &reader, std::span<const uint8_t> data)
+{
+    while (!data.empty()) {
+        if (reader.headerBytes < wire::HEADER_SIZE) {
+            const auto count = std::min(data.size(), wire::HEADER_SIZE - reader.headerBytes);
+            std::memcpy(reader.header.data() + reader.headerBytes, data.data(), count);
+            reader.headerBytes += count;
+            data = data.subspan(count);
+
+            if (reader.headerBytes < wire::HEADER_SIZE) {
+                break;
+            }
+
+            // Payload size is the last field of the header
+            reader.payloadSize  = wire::loadBigEndian<uint16_t>(&reader.header[14]);
+            reader.payloadBytes = 0;
+            reader.block        = reader.payloadSize <= pool_->blockSize() ? pool_->acquire()
+                                                                           : nullptr;
+            if (reader.block != nullptr) {
+                std::copy(reader.header.begin(),
+                          reader.header.end(),
+                          wire::headerBefore(reader.block).begin());
+            } else {
+                PIRKS_WARN_LIMITED(
+                        "QuicConnection: no block for {} bytes packet, skipped",
+                        reader.payloadSize);
+            }
+        }
+
+        const auto count = std::min(data.size(), reader.payloadSize - reader.payloadBytes);
+        if (reader.block != nullptr) {
+            std::memcpy(reader.block + reader.payloadBytes, data.data(), count);
+        }
+        reader.payloadBytes += count;
+        data = data.subspan(count);
+
+        if (reader.payloadBytes < reader.payloadSize) {
+            break;
+        }
+
+        // Whole packet is in the block, header is checked like a datagram
+        if (reader.block != nullptr) {
+            const auto header = wire::parse(std::span<const uint8_t> {
+                    wire::headerBefore(reader.block).data(),
+                    wire::HEADER_SIZE + reader.payloadSize });
+
+            if (header && (header->flags & ~wire::Flags::Reliable) == 0) {
+                deliver(*header, reader.block);
+            } else {
+                PIRKS_WARN_LIMITED("QuicConnection: malformed packet on stream dropped");
+                pool_->release(reader.block);
+            }
+            reader.block = nullptr;
+        }
+        reader.headerBytes = 0;
+    }
+}
+
+void QuicConnection::deliver(const wire::Header &header, uint8_t *block)
+{
+    auto in = inPackets_.lock();
+    if (!in) {
+        pool_->release(block);
+        return;
+    }
+
+    PacketInfo packet;
+    packet.channel       = header.channel;
+    packet.reliable      = (header.flags & wire::Flags::Reliable) != 0;
+    packet.sequence      = header.sequence;
+    packet.size          = header.payloadSize;
+    packet.timestamp     = header.timestamp;
+    packet.fragmentIndex = header.fragmentIndex;
+    packet.fragmentCount = header.fragmentCount;
+    packet.data          = block;
+
+    in->push(packet);
+}
+
+bool QuicConnection::onListenerEvent(QUIC_LISTENER_EVENT &event)
+{
+    if (event.Type != QUIC_LISTENER_EVENT_NEW_CONNECTION) {
+        return true;
+    }
+
+    auto *connection = event.NEW_CONNECTION.Connection;
+    {
+        std::lock_guard lock { mutex_ };
+        if (connection_ != nullptr) {
+            spdlog::warn("QuicConnection: remote side is already connected, connection refused");
+            return false;
+        }
+        connection_ = connection;
+    }
+
+    api_->SetCallbackHandler(
+            connection,
+            reinterpret_cast<void *>(Callbacks::connection),
+            this);
+
+    if (QUIC_FAILED(api_->ConnectionSetConfiguration(connection, configuration_))) {
+        std::lock_guard lock { mutex_ };
+        connection_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void QuicConnection::onConnectionEvent(QUIC_HANDLE *connection, QUIC_CONNECTION_EVENT &event)
+{
+    switch (event.Type) {
+    case QUIC_CONNECTION_EVENT_CONNECTED:
+        connected_ = true;
+        spdlog::info("QuicConnection: remote side connected");
+        break;
+
+    case QUIC_CONNECTION_EVENT_DATAGRAM_STATE_CHANGED:
+        maxDatagramSize_ = event.DATAGRAM_STATE_CHANGED.SendEnabled
+                                   ? event.DATAGRAM_STATE_CHANGED.MaxSendLength
+                                   : uint16_t { 0 };
+        spdlog::debug("QuicConnection: datagrams up to {} bytes", maxDatagramSize_.load());
+        break;
+
+    case QUIC_CONNECTION_EVENT_DATAGRAM_RECEIVED: {
+        const auto *buffer = event.DATAGRAM_RECEIVED.Buffer;
+        receiveDatagram({ buffer->Buffer, buffer->Length });
+        break;
+    }
+
+    case QUIC_CONNECTION_EVENT_DATAGRAM_SEND_STATE_CHANGED:
+        if (QUIC_DATAGRAM_SEND_STATE_IS_FINAL(event.DATAGRAM_SEND_STATE_CHANGED.State)) {
+            pool_->release(static_cast<uint8_t *>(event.DATAGRAM_SEND_STATE_CHANGED.ClientContext));
+        }
+        break;
+
+    case QUIC_CONNECTION_EVENT_PEER_STREAM_STARTED: {
+        auto reader        = std::make_unique<StreamReader>();
+        reader->connection = this;
+
+        api_->SetCallbackHandler(
+                event.PEER_STREAM_STARTED.Stream,
+                reinterpret_cast<void *>(Callbacks::receiveStream),
+                reader.get());
+
+        std::lock_guard lock { mutex_ };
+        readers_.push_back(std::move(reader));
+        break;
+    }
+
+    case QUIC_CONNECTION_EVENT_SHUTDOWN_COMPLETE: {
+        // Closed by close(), which already took the handles
+        if (event.SHUTDOWN_COMPLETE.AppCloseInProgress) {
+            break;
+        }
+
+        std::array<QUIC_HANDLE *, CHANNEL_COUNT> streams {};
+        {
+            std::lock_guard lock { mutex_ };
+            connection_      = nullptr;
+            streams          = std::exchange(streams_, {});
+            connected_       = false;
+            maxDatagramSize_ = 0;
+        }
+
+        for (auto *stream: streams) {
+            if (stream != nullptr) {
+                api_->StreamClose(stream);
+            }
+        }
+        api_->ConnectionClose(connection);
+
+        spdlog::info("QuicConnection: remote side disconnected");
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+void QuicConnection::onSendStreamEvent(QUIC_STREAM_EVENT &event)
+{
+    if (event.Type == QUIC_STREAM_EVENT_SEND_COMPLETE) {
+        pool_->release(static_cast<uint8_t *>(event.SEND_COMPLETE.ClientContext));
+    }
+}
+
+void QuicConnection::onReceiveStreamEvent(
+        QUIC_HANDLE       *stream,
+        StreamReader      &reader,
+        QUIC_STREAM_EVENT &event)
+{
+    switch (event.Type) {
+    case QUIC_STREAM_EVENT_RECEIVE:
+        for (uint32_t i = 0; i < event.RECEIVE.BufferCount; ++i) {
+            const auto &buffer = event.RECEIVE.Buffers[i];
+            receiveStream(reader, { buffer.Buffer, buffer.Length });
+        }
+        break;
+
+    case QUIC_STREAM_EVENT_PEER_SEND_ABORTED:
+        api_->StreamShutdown(stream, QUIC_STREAM_SHUTDOWN_FLAG_ABORT, 0);
+        break;
+
+    case QUIC_STREAM_EVENT_SHUTDOWN_COMPLETE: {
+        pool_->release(std::exchange(reader.block, nullptr));
+        if (!event.SHUTDOWN_COMPLETE.AppCloseInProgress) {
+            api_->StreamClose(stream);
+        }
+
+        // Reader is destroyed here, nothing touches it after this event
+        std::lock_guard lock { mutex_ };
+        std::erase_if(readers_, [&reader](const auto &item) {
+            return item.get() == &reader;
+        });
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+#else
+
+bool isAvailable()
+{
+    return false;
+}
+
+void QuicConnection::open()
+{
+    throw std::runtime_error("QuicConnection: built without QUIC support");
+}
+
+void QuicConnection::close()
+{
+    //
+}
+
+void QuicConnection::create(
+        std::shared_ptr<PacketsQueue> in_packets,
+        std::shared_ptr<PacketsQueue> out_packets)
+{
+    inPackets_  = in_packets;
+    outPackets_ = out_packets;
+}
+
+auto QuicConnection::localPort() const -> uint16_t
+{
+    return 0;
+}
+
+#endif
+
+QuicConnection::QuicConnection(const QuicSettings &settings, std::shared_ptr<PacketPool> pool)
+        : settings_ { settings }
+        , stop_ { false }
+        , pool_ { pool }
+        , connected_ { false }
+        , maxDatagramSize_ { 0 }
+{
+    assert(pool_ && "packet pool is required");
+
+    if (pool_->headroom() < PACKET_HEADROOM) {
+        throw std::invalid_argument("QuicConnection: packet pool has no headroom for wire header");
+    }
+    if (settings_.host.empty()
+        && (settings_.certificateFile.empty() || settings_.privateKeyFile.empty()))
+    {
+        throw std::invalid_argument("QuicConnection: server needs certificate and private key");
+    }
+
+    open();
+
+    spdlog::debug("QuicConnection created");
+}
+
+QuicConnection::~QuicConnection()
+{
+    spdlog::debug("QuicConnection destructor");
+
+    stop_ = true;
+
+    if (sendThread_.joinable()) {
+        sendThread_.join();
+    }
+
+    close();
+}
+
+bool QuicConnection::isConnected() const
+{
+    return connected_;
+}
+
+}; // namespace pirks::networking::quic
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../IConnection.h"
+#include "../PacketPool.h"
+#include "../WireHeader.h"
+
+// Handles and events of msquic, so its headers stay out of ours
+struct QUIC_API_TABLE;
+struct QUIC_HANDLE;
+struct QUIC_LISTENER_EVENT;
+struct QUIC_CONNECTION_EVENT;
+struct QUIC_STREAM_EVENT;
+
+namespace pirks::networking::quic
+{
+
+/**
+ * @brief true if the library is built with a QUIC implementation
+ */
+[[nodiscard]]
+bool isAvailable();
+
+struct QuicSettings
+{
+    std::string host;            ///< Client connects to host:port, empty - server listens on port
+    uint16_t    port { 0 };
+    std::string certificateFile; ///< PEM certificate of the server
+    std::string privateKeyFile;  ///< PEM private key of the server
+    bool        verifyServer { true }; ///< Client rejects server certificates it does not trust
+    uint32_t    idleTimeoutMs { 10000 };
+};
+
+/**
+ * @brief QUIC connection over msquic
+ *
+ * Unreliable packets go out as QUIC datagrams (RFC 9221), so a lost video
+ * packet is never retransmitted and never blocks audio. Reliable packets go
+ * to one unidirectional stream per channel, so control messages arrive in
+ * order and a stalled stream of one channel does not block the others.
+ * Both carry the wire header in front of the payload. Datagrams which don't
+ * fit the current datagram size of the path are sent on the stream of their
+ * channel instead.
+ *
+ * Packets are sent straight from pool blocks: the wire header and the buffer
+ * descriptor of msquic are written to the headroom, and the block is
+ * released when msquic is done with it - when a datagram is sent or lost,
+ * when stream data is acknowledged. Received data is owned by msquic and is
+ * copied into pool blocks once.
+ *
+ * Server accepts one remote side at a time, like UDPConnection; client
+ * connects to settings.host. Congestion control and pacing are done by msquic.
+ */
+class QuicConnection final: public IConnection
+{
+public:
+    // Protocol name negotiated in TLS handshake
+    static constexpr const char *ALPN = "pirks/1";
+
+    // Bytes every pool block needs in front of the payload: wire header
+    // and msquic buffer descriptor
+    static constexpr std::size_t PACKET_HEADROOM = wire::HEADER_SIZE + 16;
+
+public:
+    /**
+     * @brief Packets are sent from blocks of the pool in place, so it must have
+     *        PACKET_HEADROOM
+     *
+     * Throws std::invalid_argument if it does not or the server has no
+     * certificate, std::runtime_error if QUIC is not available.
+     */
+    QuicConnection(const QuicSettings &settings, std::shared_ptr<PacketPool> pool);
+    ~QuicConnection() override;
+
+    QuicConnection(const QuicConnection &)            = delete;
+    QuicConnection &operator=(const QuicConnection &) = delete;
+
+public:
+    void create(
+            std::shared_ptr<PacketsQueue> in_packets, //
+            std::shared_ptr<PacketsQueue> out_packets) override;
+
+    /**
+     * @brief true after the handshake with the remote side is done
+     */
+    [[nodiscard]]
+    bool isConnected() const;
+
+    /**
+     * @brief Port the server listens on. Valid after create()
+     */
+    [[nodiscard]]
+    auto localPort() const -> uint16_t;
+
+private:
+    /**
+     * @brief Incoming stream, collects wire header and payload of packets
+     *        spread over receive buffers
+     */
+    struct StreamReader
+    {
+        QuicConnection                        *connection { nullptr };
+        std::array<uint8_t, wire::HEADER_SIZE> header {};
+        std::size_t                            headerBytes { 0 };
+        uint8_t                               *block { nullptr }; ///< nullptr - payload is skipped
+        std::size_t                            payloadBytes { 0 };
+        std::size_t                            payloadSize { 0 };
+    };
+
+private:
+    static void sendThreadFunc(QuicConnection *connection);
+
+    void open();
+    void close();
+
+    void send(const PacketInfo &packet);
+    bool sendDatagram(QUIC_HANDLE *connection, uint8_t *block, std::size_t size);
+    bool sendOnStream(QUIC_HANDLE *connection, uint8_t channel, uint8_t *block, std::size_t size);
+    auto openStream(QUIC_HANDLE *connection, uint8_t channel) -> QUIC_HANDLE *;
+
+    void receiveDatagram(std::span<const uint8_t> datagram);
+    void receiveStream(StreamReader &reader, std::span<const uint8_t> data);
+    void deliver(const wire::Header &header, uint8_t *block);
+
+    /**
+     * @brief Returns false if the new connection is refused
+     */
+    bool onListenerEvent(QUIC_LISTENER_EVENT &event);
+    void onConnectionEvent(QUIC_HANDLE *connection, QUIC_CONNECTION_EVENT &event);
+    void onSendStreamEvent(QUIC_STREAM_EVENT &event);
+    void onReceiveStreamEvent(QUIC_HANDLE *stream, StreamReader &reader, QUIC_STREAM_EVENT &event);
+
+    friend struct Callbacks;
+
+private:
+    QuicSettings                settings_;
+    std::atomic_bool            stop_;
+    std::shared_ptr<PacketPool> pool_;
+    std::weak_ptr<PacketsQueue> inPackets_;
+    std::weak_ptr<PacketsQueue> outPackets_;
+    std::thread                 sendThread_;
+
+    const QUIC_API_TABLE *api_ { nullptr };
+    QUIC_HANDLE          *registration_ { nullptr };
+    QUIC_HANDLE          *configuration_ { nullptr };
+    QUIC_HANDLE          *listener_ { nullptr };
+
+    // Connection and its outgoing streams are replaced by msquic callbacks
+    // and used by send thread
+    std::mutex                                 mutex_;
+    QUIC_HANDLE                               *connection_ { nullptr };
+    std::array<QUIC_HANDLE *, CHANNEL_COUNT>   streams_ {};
+    std::atomic_bool                           connected_;
+    std::atomic<uint16_t>                      maxDatagramSize_;
+    std::vector<std::unique_ptr<StreamReader>> readers_;
+
+    // Sequence numbers of unreliable and reliable packets, used only by send thread
+    std::array<SequenceNumber, CHANNEL_COUNT> datagramSequence_ {};
+    std::array<SequenceNumber, CHANNEL_COUNT> streamSequence_ {};
+};
+
+}; // namespace pirks::networking::quic
@@ -0,0 +1,349 @@
+#include "CongestionController.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace pirks::networking
+{
+
+namespace {
+
+// Trendline estimator
+constexpr double SMOOTHING_COEFFICIENT = 0.9;
+constexpr double THRESHOLD_GAIN        = 4.0;
+constexpr double MAX_DELTA_COUNT       = 60;
+
+// Adaptive threshold
+constexpr double K_UP            = 0.0087;
+constexpr double K_DOWN          = 0.039;
+constexpr double MIN_THRESHOLD   = 6;
+constexpr double MAX_THRESHOLD   = 600;
+constexpr double MAX_ADAPT_STEP  = 15;
+constexpr double MAX_ADAPT_DELAY = 100;
+
+// Overuse must last this long before it's reported
+constexpr double OVERUSE_TIME_MS = 10;
+
+// Rate control
+constexpr double DECREASE_FACTOR         = 0.85;
+constexpr double INCREASE_PER_SECOND     = 1.08;
+constexpr double MAX_ACKED_RATIO         = 1.5;
+constexpr double HIGH_LOSS               = 0.10;
+constexpr double LOW_LOSS                = 0.02;
+constexpr double LOSS_SMOOTHING          = 0.8;
+constexpr auto   DECREASE_INTERVAL       = std::chrono::milliseconds { 200 };
+constexpr auto   LOSS_DECREASE_INTERVAL  = std::chrono::milliseconds { 300 };
+constexpr auto   ACKED_BITRATE_WINDOW    = std::chrono::milliseconds { 500 };
+constexpr auto   MAX_RATE_UPDATE_PERIOD  = std::chrono::seconds { 1 };
+
+auto toMilliseconds(std::chrono::steady_clock::duration duration) -> double
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+CongestionController::CongestionController(const CongestionSettings &settings)
+        : settings_ { settings }
+        , targetKbps_ { static_cast<double>(settings.startBitrateKbps) }
+{
+    assert(settings.minBitrateKbps <= settings.maxBitrateKbps && "invalid bitrate limits");
+}
+
+void CongestionController::onPacketSent(
+        uint8_t           channel,
+        SequenceNumber    seq,
+        std::size_t       size,
+        Clock::time_point time)
+{
+    std::lock_guard lock { mutex_ };
+
+    assert(channel < CHANNEL_COUNT && "unknown channel");
+
+    auto &sent = channels_[channel].sent[seq % HISTORY_SIZE];
+    sent.seq   = seq;
+    sent.valid = true;
+    sent.size  = static_cast<uint32_t>(size);
+    sent.time  = time;
+}
+
+void CongestionController::onFeedback(const FeedbackFrame &frame, Clock::time_point now)
+{
+    std::lock_guard lock { mutex_ };
+
+    if (frame.channel >= CHANNEL_COUNT || frame.count > FeedbackFrame::MAX_PACKETS) {
+        return;
+    }
+
+    // Unwrap 32-bit receiver clock
+    if (!hasReference_) {
+        hasReference_ = true;
+        reference_    = frame.referenceTime;
+    } else {
+        const auto previous = static_cast<uint32_t>(reference_);
+        reference_ += static_cast<int32_t>(frame.referenceTime - previous);
+    }
+
+    auto &state = channels_[frame.channel];
+
+    uint64_t bytes    = 0;
+    uint32_t received = 0;
+    uint32_t lost     = 0;
+
+    for (std::size_t i = 0; i < frame.count; ++i) {
+        const auto seq  = static_cast<SequenceNumber>(frame.base + i);
+        auto      &sent = state.sent[seq % HISTORY_SIZE];
+        if (!sent.valid || sent.seq != seq) {
+            continue;
+        }
+        sent.valid = false;
+
+        if (frame.arrival[i] == FeedbackFrame::NOT_RECEIVED) {
+            ++lost;
+            continue;
+        }
+
+        ++received;
+        bytes += sent.size;
+
+        const auto offset  = int64_t { frame.arrival[i] } * FeedbackFrame::TICK.count();
+        const auto arrival = reference_ + offset;
+        onPacketArrival(state, sent.time, arrival);
+    }
+
+    if (received + lost != 0) {
+        const auto loss = static_cast<double>(lost) / (received + lost);
+        lossFraction_   = LOSS_SMOOTHING * lossFraction_ + (1 - LOSS_SMOOTHING) * loss;
+    }
+
+    updateAckedBitrate(bytes, now);
+    updateRate(now);
+}
+
+auto CongestionController::targetBitrateKbps() -> uint32_t
+{
+    std::lock_guard lock { mutex_ };
+    return static_cast<uint32_t>(targetKbps_);
+}
+
+auto CongestionController::ackedBitrateKbps() -> uint32_t
+{
+    std::lock_guard lock { mutex_ };
+    return static_cast<uint32_t>(ackedKbps_);
+}
+
+auto CongestionController::usage() -> BandwidthUsage
+{
+    std::lock_guard lock { mutex_ };
+    return usage_;
+}
+
+auto CongestionController::lossFraction() -> double
+{
+    std::lock_guard lock { mutex_ };
+    return lossFraction_;
+}
+
+void CongestionController::onPacketArrival(
+        ChannelState     &state,
+        Clock::time_point send,
+        int64_t           arrival)
+{
+    auto &group = state.current;
+
+    if (group.valid && send - group.firstSend <= BURST_INTERVAL) {
+        group.lastSend    = std::max(group.lastSend, send);
+        group.lastArrival = std::max(group.lastArrival, arrival);
+        return;
+    }
+
+    // Packet starts a new group, compare the finished one with the group before it
+    if (group.valid && state.previous.valid) {
+        const auto arrivalDeltaUs = group.lastArrival - state.previous.lastArrival;
+        const auto arrivalDeltaMs = static_cast<double>(arrivalDeltaUs) / 1000;
+        const auto sendDeltaMs    = toMilliseconds(group.lastSend - state.previous.lastSend);
+        updateTrendline(arrivalDeltaMs - sendDeltaMs, sendDeltaMs, group.lastArrival);
+    }
+
+    if (group.valid) {
+        state.previous = group;
+    }
+
+    group.valid       = true;
+    group.firstSend   = send;
+    group.lastSend    = send;
+    group.lastArrival = arrival;
+}
+
+void CongestionController::updateTrendline(
+        double  delay_variation_ms,
+        double  send_delta_ms,
+        int64_t arrival)
+{
+    if (!hasFirstArrival_) {
+        hasFirstArrival_ = true;
+        firstArrival_    = arrival;
+    }
+
+    deltaCount_ = std::min<std::size_t>(deltaCount_ + 1, 1000);
+
+    accumulatedDelayMs_ += delay_variation_ms;
+    smoothedDelayMs_ = SMOOTHING_COEFFICIENT * smoothedDelayMs_
+                       + (1 - SMOOTHING_COEFFICIENT) * accumulatedDelayMs_;
+
+    const auto arrivalMs = static_cast<double>(arrival - firstArrival_) / 1000;
+
+    samples_[sampleIndex_] = { arrivalMs, smoothedDelayMs_ };
+    sampleIndex_           = (sampleIndex_ + 1) % TRENDLINE_WINDOW;
+    sampleCount_           = std::min(sampleCount_ + 1, TRENDLINE_WINDOW);
+
+    double trend = previousTrend_;
+    if (sampleCount_ == TRENDLINE_WINDOW) {
+        // Least squares slope of smoothed delay over arrival time
+        double meanX = 0;
+        double meanY = 0;
+        for (const auto &sample: samples_) {
+            meanX += sample.arrivalMs;
+            meanY += sample.smoothedDelayMs;
+        }
+        meanX /= TRENDLINE_WINDOW;
+        meanY /= TRENDLINE_WINDOW;
+
+        double numerator   = 0;
+        double denominator = 0;
+        for (const auto &sample: samples_) {
+            numerator += (sample.arrivalMs - meanX) * (sample.smoothedDelayMs - meanY);
+            denominator += (sample.arrivalMs - meanX) * (sample.arrivalMs - meanX);
+        }
+        if (denominator > 0) {
+            trend = numerator / denominator;
+        }
+    }
+
+    detect(trend, send_delta_ms, arrivalMs);
+}
+
+void CongestionController::detect(double trend, double send_delta_ms, double arrival_ms)
+{
+    if (deltaCount_ < 2) {
+        usage_ = BandwidthUsage::Normal;
+        return;
+    }
+
+    const auto modifiedTrend = std::min(static_cast<double>(deltaCount_), MAX_DELTA_COUNT) * trend
+                               * THRESHOLD_GAIN;
+
+    if (modifiedTrend > thresholdMs_) {
+        // Start in the middle of the interval, overuse began somewhere within it
+        timeOverusingMs_ = timeOverusingMs_ < 0 ? send_delta_ms / 2
+                                                : timeOverusingMs_ + send_delta_ms;
+        ++overuseCounter_;
+
+        if (timeOverusingMs_ > OVERUSE_TIME_MS && overuseCounter_ > 1 && trend >= previousTrend_) {
+            timeOverusingMs_ = 0;
+            overuseCounter_  = 0;
+            usage_           = BandwidthUsage::Overusing;
+        }
+    } else if (modifiedTrend < -thresholdMs_) {
+        timeOverusingMs_ = -1;
+        overuseCounter_  = 0;
+        usage_           = BandwidthUsage::Underusing;
+    } else {
+        timeOverusingMs_ = -1;
+        overuseCounter_  = 0;
+        usage_           = BandwidthUsage::Normal;
+    }
+
+    previousTrend_ = trend;
+    updateThreshold(modifiedTrend, arrival_ms);
+}
+
+void CongestionController::updateThreshold(double modified_trend, double arrival_ms)
+{
+    if (lastThresholdUpdateMs_ < 0) {
+        lastThresholdUpdateMs_ = arrival_ms;
+    }
+
+    const auto magnitude = std::abs(modified_trend);
+
+    // Spikes, e.g. route changes, should not move the threshold
+    if (magnitude > thresholdMs_ + MAX_ADAPT_STEP) {
+        lastThresholdUpdateMs_ = arrival_ms;
+        return;
+    }
+
+    const auto k       = magnitude < thresholdMs_ ? K_DOWN : K_UP;
+    const auto elapsed = std::min(arrival_ms - lastThresholdUpdateMs_, MAX_ADAPT_DELAY);
+
+    thresholdMs_ += k * (magnitude - thresholdMs_) * elapsed;
+    thresholdMs_           = std::clamp(thresholdMs_, MIN_THRESHOLD, MAX_THRESHOLD);
+    lastThresholdUpdateMs_ = arrival_ms;
+}
+
+void CongestionController::updateAckedBitrate(uint64_t bytes, Clock::time_point now)
+{
+    if (windowStart_ == Clock::time_point {}) {
+        windowStart_ = now;
+    }
+
+    windowBytes_ += bytes;
+
+    const auto elapsed = now - windowStart_;
+    if (elapsed < ACKED_BITRATE_WINDOW) {
+        return;
+    }
+
+    const auto kbps = static_cast<double>(windowBytes_) * 8 / toMilliseconds(elapsed);
+    ackedKbps_      = ackedKbps_ <= 0 ? kbps : (ackedKbps_ + kbps) / 2;
+    windowBytes_    = 0;
+    windowStart_    = now;
+}
+
+void CongestionController::updateRate(Clock::time_point now)
+{
+    if (lastRateUpdate_ == Clock::time_point {}) {
+        lastRateUpdate_ = now;
+    }
+
+    const auto elapsed = std::min<Clock::duration>(now - lastRateUpdate_, MAX_RATE_UPDATE_PERIOD);
+    lastRateUpdate_    = now;
+
+    switch (usage_) {
+    case BandwidthUsage::Overusing:
+        if (now - lastDecrease_ >= DECREASE_INTERVAL) {
+            const auto base = ackedKbps_ > 0 ? std::min(ackedKbps_, targetKbps_) : targetKbps_;
+            targetKbps_     = DECREASE_FACTOR * base;
+            lastDecrease_   = now;
+        }
+        break;
+
+    case BandwidthUsage::Underusing:
+        // Queues are draining, keep the rate until they are empty
+        break;
+
+    case BandwidthUsage::Normal:
+        if (lossFraction_ < LOW_LOSS) {
+            const auto increased = targetKbps_
+                                   * std::pow(INCREASE_PER_SECOND,
+                                              std::chrono::duration<double>(elapsed).count());
+            // Do not run far ahead of what the receiver actually gets, e.g. when
+            // encoder produces less than the target on a static picture
+            const auto limit = ackedKbps_ > 0 ? MAX_ACKED_RATIO * ackedKbps_ + 10 : increased;
+            targetKbps_      = std::max(targetKbps_, std::min(increased, limit));
+        }
+        break;
+    }
+
+    if (lossFraction_ > HIGH_LOSS && now - lastLossDecrease_ >= LOSS_DECREASE_INTERVAL) {
+        targetKbps_ *= 1 - 0.5 * lossFraction_;
+        lastLossDecrease_ = now;
+    }
+
+    targetKbps_ = std::clamp(
+            targetKbps_,
+            static_cast<double>(settings_.minBitrateKbps),
+            static_cast<double>(settings_.maxBitrateKbps));
+}
+
+}; // namespace pirks::networking
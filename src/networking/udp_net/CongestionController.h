@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "../PacketInfo.h"
+#include "../SequenceNumber.h"
+#include "CongestionFeedback.h"
+
+namespace pirks::networking
+{
+
+struct CongestionSettings
+{
+    uint32_t startBitrateKbps { 10000 };
+    uint32_t minBitrateKbps { 500 };
+    uint32_t maxBitrateKbps { 10000 };
+};
+
+enum class BandwidthUsage
+{
+    Normal,
+    Underusing, ///< Queues on the path are draining
+    Overusing   ///< Queues on the path are growing
+};
+
+/**
+ * @brief Sender side delay-gradient congestion control, modelled after Google Congestion Control
+ *
+ * Packets are grouped by 5 ms send bursts. For every two consecutive groups
+ * the difference between arrival and send intervals is accumulated; growing
+ * queue shows up as a positive slope of the smoothed accumulated delay,
+ * found by linear regression over the last TRENDLINE_WINDOW groups. Slope is
+ * compared with an adaptive threshold to detect overuse.
+ *
+ * Target bitrate is AIMD: on overuse it drops to 85% of the bitrate the
+ * receiver actually got, otherwise grows by 8% per second, but not far above
+ * what the receiver got. Loss above 10% additionally cuts the rate by half
+ * the loss fraction. All methods are thread safe.
+ */
+class CongestionController final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Send times are remembered for this many packets per channel
+    static constexpr std::size_t HISTORY_SIZE = 1024;
+
+    static constexpr std::size_t TRENDLINE_WINDOW = 20;
+
+    static constexpr std::chrono::milliseconds BURST_INTERVAL { 5 };
+
+    static_assert(65536 % HISTORY_SIZE == 0);
+
+public:
+    explicit CongestionController(const CongestionSettings &settings);
+
+public:
+    /**
+     * @brief Remember send time of an unreliable packet, to match it with feedback later
+     */
+    void onPacketSent(
+            uint8_t           channel,
+            SequenceNumber    seq,
+            std::size_t       size,
+            Clock::time_point time);
+
+    void onFeedback(const FeedbackFrame &frame, Clock::time_point now);
+
+    [[nodiscard]]
+    auto targetBitrateKbps() -> uint32_t;
+
+    [[nodiscard]]
+    auto ackedBitrateKbps() -> uint32_t;
+
+    [[nodiscard]]
+    auto usage() -> BandwidthUsage;
+
+    [[nodiscard]]
+    auto lossFraction() -> double;
+
+private:
+    struct SentPacket
+    {
+        SequenceNumber    seq { 0 };
+        bool              valid { false };
+        uint32_t          size { 0 };
+        Clock::time_point time;
+    };
+
+    struct PacketGroup
+    {
+        bool              valid { false };
+        Clock::time_point firstSend;
+        Clock::time_point lastSend;
+        int64_t           lastArrival { 0 }; ///< Receiver clock, microseconds
+    };
+
+    struct ChannelState
+    {
+        std::array<SentPacket, HISTORY_SIZE> sent;
+        PacketGroup                          current;
+        PacketGroup                          previous;
+    };
+
+    struct TrendlineSample
+    {
+        double arrivalMs { 0 };
+        double smoothedDelayMs { 0 };
+    };
+
+private:
+    void onPacketArrival(ChannelState &state, Clock::time_point send, int64_t arrival);
+    void updateTrendline(double delay_variation_ms, double send_delta_ms, int64_t arrival);
+    void detect(double trend, double send_delta_ms, double arrival_ms);
+    void updateThreshold(double modified_trend, double arrival_ms);
+    void updateAckedBitrate(uint64_t bytes, Clock::time_point now);
+    void updateRate(Clock::time_point now);
+
+private:
+    std::mutex         mutex_;
+    CongestionSettings settings_;
+
+    std::array<ChannelState, CHANNEL_COUNT> channels_;
+
+    // Receiver clock unwrapped from 32-bit reference times
+    bool    hasReference_ { false };
+    int64_t reference_ { 0 };
+
+    // Trendline estimator
+    std::array<TrendlineSample, TRENDLINE_WINDOW> samples_ {};
+    std::size_t                                   sampleCount_ { 0 };
+    std::size_t                                   sampleIndex_ { 0 };
+    std::size_t                                   deltaCount_ { 0 };
+    bool                                          hasFirstArrival_ { false };
+    int64_t                                       firstArrival_ { 0 };
+    double                                        accumulatedDelayMs_ { 0 };
+    double                                        smoothedDelayMs_ { 0 };
+    double                                        previousTrend_ { 0 };
+
+    // Overuse detector
+    double         thresholdMs_ { 12.5 };
+    double         lastThresholdUpdateMs_ { -1 };
+    double         timeOverusingMs_ { -1 };
+    int            overuseCounter_ { 0 };
+    BandwidthUsage usage_ { BandwidthUsage::Normal };
+
+    // Rate control
+    double            targetKbps_;
+    double            ackedKbps_ { 0 };
+    double            lossFraction_ { 0 };
+    uint64_t          windowBytes_ { 0 };
+    Clock::time_point windowStart_ {};
+    Clock::time_point lastRateUpdate_ {};
+    Clock::time_point lastDecrease_ {};
+    Clock::time_point lastLossDecrease_ {};
+};
+
+}; // namespace pirks::networking
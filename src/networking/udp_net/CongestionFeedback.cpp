@@ -0,0 +1,94 @@
+#include "CongestionFeedback.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace pirks::networking
+{
+
+void FeedbackBuilder::onReceived(uint8_t channel, SequenceNumber seq, Clock::time_point arrival)
+{
+    std::lock_guard lock { mutex_ };
+
+    assert(channel < CHANNEL_COUNT && "unknown channel");
+    auto &history = channels_[channel];
+
+    if (!history.started) {
+        history.started = true;
+        history.next    = seq;
+        history.highest = seq;
+    } else if (sequenceNewer(history.next, seq)) {
+        // Already reported as not received
+        return;
+    }
+
+    // Packets that don't fit into history are never reported
+    if (sequenceDistance(seq, history.next) >= HISTORY_SIZE) {
+        history.next = static_cast<SequenceNumber>(seq - HISTORY_SIZE + 1);
+    }
+
+    auto &entry    = history.arrivals[seq % HISTORY_SIZE];
+    entry.seq      = seq;
+    entry.received = true;
+    entry.time     = arrival;
+
+    if (sequenceNewer(seq, history.highest)) {
+        history.highest = seq;
+    }
+}
+
+auto FeedbackBuilder::build(uint8_t channel) -> std::optional<FeedbackFrame>
+{
+    std::lock_guard lock { mutex_ };
+
+    assert(channel < CHANNEL_COUNT && "unknown channel");
+    auto &history = channels_[channel];
+
+    const auto end     = static_cast<SequenceNumber>(history.highest + 1);
+    const auto pending = sequenceDistance(end, history.next);
+    if (!history.started || pending == 0) {
+        return std::nullopt;
+    }
+
+    FeedbackFrame frame;
+    frame.channel = channel;
+    frame.base    = history.next;
+    frame.count   = static_cast<uint8_t>(
+            std::min<std::size_t>(pending, FeedbackFrame::MAX_PACKETS));
+
+    auto received = [&](SequenceNumber seq) -> const Arrival * {
+        const auto &entry = history.arrivals[seq % HISTORY_SIZE];
+        return entry.received && entry.seq == seq ? &entry : nullptr;
+    };
+
+    // Reference is the earliest arrival, so all offsets are positive
+    std::optional<Clock::time_point> reference;
+    for (std::size_t i = 0; i < frame.count; ++i) {
+        if (const auto *entry = received(static_cast<SequenceNumber>(frame.base + i))) {
+            reference = reference ? std::min(*reference, entry->time) : entry->time;
+        }
+    }
+
+    if (reference) {
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                reference->time_since_epoch());
+        frame.referenceTime = static_cast<uint32_t>(us.count());
+    }
+
+    for (std::size_t i = 0; i < frame.count; ++i) {
+        const auto *entry = received(static_cast<SequenceNumber>(frame.base + i));
+        if (entry == nullptr) {
+            frame.arrival[i] = FeedbackFrame::NOT_RECEIVED;
+            continue;
+        }
+
+        const auto ticks = (entry->time - *reference) / FeedbackFrame::TICK;
+        frame.arrival[i] = static_cast<uint16_t>(
+                std::min<int64_t>(ticks, FeedbackFrame::MAX_OFFSET));
+    }
+
+    history.next = static_cast<SequenceNumber>(history.next + frame.count);
+    return frame;
+}
+
+}; // namespace pirks::networking
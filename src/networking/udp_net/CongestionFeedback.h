@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+#include "../PacketInfo.h"
+#include "../SequenceNumber.h"
+
+namespace pirks::networking
+{
+
+/**
+ * @brief Arrival times of consecutive unreliable packets of one channel
+ *
+ * Receiver reports when every packet in [base, base + count) arrived,
+ * relative to referenceTime of its own clock. Sender matches them with send
+ * times, so clocks of both sides don't need to be synchronized.
+ */
+struct FeedbackFrame
+{
+    static constexpr std::size_t MAX_PACKETS = 64;
+
+    // Arrival offsets are stored in this units, 16 bits cover 4 seconds
+    static constexpr std::chrono::microseconds TICK { 64 };
+
+    static constexpr uint16_t NOT_RECEIVED = 0xFFFF;
+    static constexpr uint16_t MAX_OFFSET   = 0xFFFE;
+
+    uint8_t        channel { 0 };
+    SequenceNumber base { 0 };
+    uint8_t        count { 0 };
+    uint32_t       referenceTime { 0 }; ///< Receiver clock, microseconds, wraps around
+
+    std::array<uint16_t, MAX_PACKETS> arrival {};
+};
+
+/**
+ * @brief Collects arrival times on receiver side
+ *
+ * Receive thread calls onReceived(), send thread calls build() periodically.
+ * All methods are thread safe.
+ */
+class FeedbackBuilder final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Arrivals are remembered for this many packets per channel
+    static constexpr std::size_t HISTORY_SIZE = 256;
+
+    static_assert(65536 % HISTORY_SIZE == 0);
+
+public:
+    void onReceived(uint8_t channel, SequenceNumber seq, Clock::time_point arrival);
+
+    /**
+     * @brief Report for packets of the channel received since the previous report
+     *
+     * Packets that arrive after they were reported as not received are ignored.
+     */
+    [[nodiscard]]
+    auto build(uint8_t channel) -> std::optional<FeedbackFrame>;
+
+private:
+    struct Arrival
+    {
+        SequenceNumber    seq { 0 };
+        bool              received { false };
+        Clock::time_point time;
+    };
+
+    struct ChannelHistory
+    {
+        std::array<Arrival, HISTORY_SIZE> arrivals;
+        bool                              started { false };
+        SequenceNumber                    next { 0 };    ///< First packet to report
+        SequenceNumber                    highest { 0 }; ///< Newest received packet
+    };
+
+private:
+    std::mutex                                mutex_;
+    std::array<ChannelHistory, CHANNEL_COUNT> channels_;
+};
+
+}; // namespace pirks::networking
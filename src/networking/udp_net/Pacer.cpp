@@ -0,0 +1,65 @@
+#include "Pacer.h"
+
+#include <algorithm>
+
+namespace pirks::networking
+{
+
+namespace {
+
+// Bucket is full after this time anyway, longer intervals would only overflow the math
+constexpr auto MAX_REFILL_INTERVAL = std::chrono::seconds { 1 };
+
+} // namespace
+
+Pacer::Pacer(uint32_t bitrate_kbps) : bitrateKbps_ { 0 }
+{
+    setBitrate(bitrate_kbps);
+    tokens_ = capacity_;
+}
+
+void Pacer::setBitrate(uint32_t bitrate_kbps)
+{
+    if (bitrate_kbps == bitrateKbps_) {
+        return;
+    }
+
+    bitrateKbps_    = bitrate_kbps;
+    bytesPerSecond_ = int64_t { bitrate_kbps } * 1000 / 8 * PACING_FACTOR_PERCENT / 100;
+
+    const auto burst = bytesPerSecond_ * std::chrono::nanoseconds { MAX_BURST }.count()
+                       / 1'000'000'000;
+    capacity_ = std::max(burst, MIN_BURST_BYTES);
+    tokens_   = std::min(tokens_, capacity_);
+}
+
+auto Pacer::delayUntilSend(Clock::time_point now) const -> Clock::duration
+{
+    const auto tokens = tokensAt(now);
+    if (tokens >= 0 || bytesPerSecond_ == 0) {
+        return Clock::duration::zero();
+    }
+
+    // Round up, so the bucket is not empty after waiting
+    const auto nanoseconds = (-tokens * 1'000'000'000 + bytesPerSecond_ - 1) / bytesPerSecond_;
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds { nanoseconds });
+}
+
+void Pacer::onSent(std::size_t bytes, Clock::time_point now)
+{
+    tokens_     = tokensAt(now) - static_cast<int64_t>(bytes);
+    lastUpdate_ = now;
+}
+
+auto Pacer::tokensAt(Clock::time_point now) const -> int64_t
+{
+    const auto elapsed = std::min<Clock::duration>(now - lastUpdate_, MAX_REFILL_INTERVAL);
+    if (elapsed <= Clock::duration::zero()) {
+        return tokens_;
+    }
+
+    const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    return std::min(capacity_, tokens_ + nanoseconds * bytesPerSecond_ / 1'000'000'000);
+}
+
+}; // namespace pirks::networking
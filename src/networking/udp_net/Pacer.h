@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace pirks::networking
+{
+
+/**
+ * @brief Token bucket which spreads packets of a frame over time
+ *
+ * Encoder produces a whole frame at once; a key frame sent as one burst
+ * overflows queues of routers on the way and gets lost. Bucket is refilled at
+ * PACING_FACTOR times the target bitrate, so an average frame leaves well
+ * within the frame interval, and holds at most MAX_BURST worth of bytes.
+ *
+ * Packet may be sent when the bucket is not empty, sending can take it below
+ * zero. Not thread safe, used only by the send thread.
+ */
+class Pacer final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr uint32_t PACING_FACTOR_PERCENT = 150;
+
+    static constexpr Clock::duration MAX_BURST { std::chrono::milliseconds { 2 } };
+
+    // Bucket holds at least this many bytes, so small packets at low bitrate are not delayed
+    static constexpr int64_t MIN_BURST_BYTES = 3000;
+
+public:
+    explicit Pacer(uint32_t bitrate_kbps);
+
+public:
+    void setBitrate(uint32_t bitrate_kbps);
+
+    /**
+     * @brief How long to wait before the next packet may be sent, zero if it can go now
+     */
+    [[nodiscard]]
+    auto delayUntilSend(Clock::time_point now) const -> Clock::duration;
+
+    void onSent(std::size_t bytes, Clock::time_point now);
+
+    [[nodiscard]]
+    auto bitrateKbps() const -> uint32_t
+    {
+        return bitrateKbps_;
+    }
+
+private:
+    auto tokensAt(Clock::time_point now) const -> int64_t;
+
+private:
+    uint32_t          bitrateKbps_;
+    int64_t           bytesPerSecond_ { 0 };
+    int64_t           capacity_ { 0 };
+    int64_t           tokens_ { 0 };
+    Clock::time_point lastUpdate_ {};
+};
+
+}; // namespace pirks::networking
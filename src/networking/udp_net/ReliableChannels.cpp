@@ -0,0 +1,275 @@
+#include "ReliableChannels.h"
+
+#include <algorithm>
+
+namespace pirks::networking
+{
+
+ReliableChannels::ReliableChannels(std::shared_ptr<PacketPool> pool) : pool_ { std::move(pool) }
+{
+    assert(pool_ && "packet pool is required");
+}
+
+ReliableChannels::~ReliableChannels()
+{
+    // Return blocks of packets that were not acknowledged or not delivered yet
+    for (auto &sender: reliableSenders_) {
+        for (auto &sent: sender.window) {
+            if (sent.inUse) {
+                pool_->release(sent.packet.data);
+            }
+        }
+    }
+
+    for (auto &receiver: reliableReceivers_) {
+        for (auto &received: receiver.window) {
+            if (received.present) {
+                pool_->release(received.packet.data);
+            }
+        }
+    }
+}
+
+auto ReliableChannels::send(const PacketInfo &packet, Clock::time_point now)
+        -> std::optional<SequenceNumber>
+{
+    std::lock_guard lock { mutex_ };
+
+    assert(packet.channel < CHANNEL_COUNT && "unknown channel");
+
+    if (!packet.reliable) {
+        auto &sender = unreliableSenders_[packet.channel];
+        ++sender.stats.sent;
+        return sender.next++;
+    }
+
+    auto &sender = reliableSenders_[packet.channel];
+    if (sequenceDistance(sender.next, sender.base) >= WINDOW_SIZE) {
+        return std::nullopt;
+    }
+
+    const auto seq = sender.next++;
+
+    auto &sent         = sender.window[slot(seq)];
+    sent.packet        = packet;
+    sent.lastSent      = now;
+    sent.deadline      = now + retransmitTimeout(1);
+    sent.transmissions = 1;
+    sent.inUse         = true;
+
+    ++sender.stats.sent;
+    return seq;
+}
+
+void ReliableChannels::onAck(const AckFrame &ack, Clock::time_point now)
+{
+    std::lock_guard lock { mutex_ };
+
+    if (ack.channel >= CHANNEL_COUNT) {
+        return;
+    }
+
+    auto &sender = reliableSenders_[ack.channel];
+
+    // Acknowledgement must be inside [base, next], otherwise it's stale or bogus
+    const auto inFlight = sequenceDistance(sender.next, sender.base);
+    if (sequenceDistance(ack.next, sender.base) > inFlight) {
+        return;
+    }
+
+    // Cumulative part
+    for (; sender.base != ack.next; ++sender.base) {
+        acknowledge(sender, sender.base, now);
+    }
+
+    // Selective part
+    SequenceNumber highest  = ack.next;
+    bool           selected = false;
+    for (std::size_t i = 0; i < ACK_MASK_BITS; ++i) {
+        if ((ack.mask & (uint64_t { 1 } << i)) == 0) {
+            continue;
+        }
+
+        const auto seq = static_cast<SequenceNumber>(ack.next + 1 + i);
+        if (sequenceDistance(seq, sender.base) >= sequenceDistance(sender.next, sender.base)) {
+            break;
+        }
+
+        acknowledge(sender, seq, now);
+        highest  = seq;
+        selected = true;
+    }
+
+    // Holes below the highest selectively acknowledged packet were most likely lost,
+    // retransmit them now instead of waiting for timeout. Not more than once per RTT,
+    // the previous retransmission may still be in flight.
+    if (selected) {
+        const auto minInterval = rtt_.hasSamples() ? rtt_.srtt() : RttEstimator::INITIAL_RTO;
+        for (auto seq = ack.next; seq != highest; ++seq) {
+            auto &sent = sender.window[slot(seq)];
+            if (sent.inUse && now - sent.lastSent >= minInterval) {
+                sent.deadline = now;
+            }
+        }
+    }
+
+    // Skip packets acknowledged selectively earlier
+    while (sender.base != sender.next && !sender.window[slot(sender.base)].inUse) {
+        ++sender.base;
+    }
+}
+
+auto ReliableChannels::takeAck(uint8_t channel) -> std::optional<AckFrame>
+{
+    std::lock_guard lock { mutex_ };
+
+    assert(channel < CHANNEL_COUNT && "unknown channel");
+
+    auto &receiver = reliableReceivers_[channel];
+    if (!receiver.ackPending) {
+        return std::nullopt;
+    }
+    receiver.ackPending = false;
+
+    AckFrame ack;
+    ack.channel = channel;
+    ack.next    = receiver.next;
+    for (std::size_t i = 0; i < ACK_MASK_BITS; ++i) {
+        const auto seq = static_cast<SequenceNumber>(receiver.next + 1 + i);
+        if (receiver.window[slot(seq)].present) {
+            ack.mask |= uint64_t { 1 } << i;
+        }
+    }
+
+    return ack;
+}
+
+auto ReliableChannels::rtt() -> RttEstimator
+{
+    std::lock_guard lock { mutex_ };
+    return rtt_;
+}
+
+auto ReliableChannels::sendStats(uint8_t channel, bool reliable) -> StreamStats
+{
+    std::lock_guard lock { mutex_ };
+
+    assert(channel < CHANNEL_COUNT && "unknown channel");
+    return reliable ? reliableSenders_[channel].stats : unreliableSenders_[channel].stats;
+}
+
+auto ReliableChannels::receiveStats(uint8_t channel, bool reliable) -> StreamStats
+{
+    std::lock_guard lock { mutex_ };
+
+    assert(channel < CHANNEL_COUNT && "unknown channel");
+    return reliable ? reliableReceivers_[channel].stats : unreliableReceivers_[channel].stats;
+}
+
+void ReliableChannels::acknowledge(
+        ReliableSender   &sender,
+        SequenceNumber    seq,
+        Clock::time_point now)
+{
+    auto &sent = sender.window[slot(seq)];
+    if (!sent.inUse) {
+        return;
+    }
+
+    // Karn's algorithm: it's unknown which copy of retransmitted packet was acknowledged
+    if (sent.transmissions == 1) {
+        rtt_.addSample(std::chrono::duration_cast<RttEstimator::Duration>(now - sent.lastSent));
+    }
+
+    pool_->release(sent.packet.data);
+    sent.packet = {};
+    sent.inUse  = false;
+}
+
+auto ReliableChannels::retransmitTimeout(uint8_t transmissions) const -> Clock::duration
+{
+    const auto shift = std::min<int>(transmissions - 1, MAX_BACKOFF_SHIFT);
+    return std::min(rtt_.rto() * (1 << shift), RttEstimator::MAX_RTO);
+}
+
+auto ReliableChannels::insertReliable(
+        ReliableReceiver &receiver,
+        const PacketInfo &packet,
+        SequenceNumber    seq) -> ReceiveResult
+{
+    ++receiver.stats.received;
+
+    // Sender did not get our acknowledgement if it sends the same packet again
+    receiver.ackPending = true;
+
+    const auto ahead = sequenceDistance(seq, receiver.next);
+    if (sequenceNewer(receiver.next, seq)) {
+        ++receiver.stats.duplicates;
+        return ReceiveResult::Duplicate;
+    }
+
+    if (ahead >= WINDOW_SIZE) {
+        ++receiver.stats.dropped;
+        return ReceiveResult::Dropped;
+    }
+
+    auto &received = receiver.window[slot(seq)];
+    if (received.present) {
+        ++receiver.stats.duplicates;
+        return ReceiveResult::Duplicate;
+    }
+
+    received.packet  = packet;
+    received.present = true;
+
+    return ahead == 0 ? ReceiveResult::Delivered : ReceiveResult::Buffered;
+}
+
+auto ReliableChannels::insertUnreliable(UnreliableReceiver &receiver, SequenceNumber seq)
+        -> ReceiveResult
+{
+    ++receiver.stats.received;
+
+    if (!receiver.started) {
+        receiver.started = true;
+        receiver.highest = seq;
+        receiver.history = 1;
+        return ReceiveResult::Delivered;
+    }
+
+    if (seq == receiver.highest) {
+        ++receiver.stats.duplicates;
+        return ReceiveResult::Duplicate;
+    }
+
+    if (sequenceNewer(seq, receiver.highest)) {
+        const auto ahead = sequenceDistance(seq, receiver.highest);
+
+        receiver.stats.lost += ahead - 1u;
+        receiver.history = ahead < 64 ? receiver.history << ahead : 0;
+        receiver.history |= 1;
+        receiver.highest = seq;
+        return ReceiveResult::Delivered;
+    }
+
+    // Older than the highest one: reordered or duplicated
+    const auto behind = sequenceDistance(receiver.highest, seq);
+    if (behind < 64) {
+        const auto bit = uint64_t { 1 } << behind;
+        if (receiver.history & bit) {
+            ++receiver.stats.duplicates;
+            return ReceiveResult::Duplicate;
+        }
+        receiver.history |= bit;
+        // It was counted as lost when a newer packet arrived, unless it's older than
+        // the first received packet
+        if (receiver.stats.lost > 0) {
+            --receiver.stats.lost;
+        }
+    }
+
+    ++receiver.stats.reordered;
+    return ReceiveResult::Delivered;
+}
+
+}; // namespace pirks::networking
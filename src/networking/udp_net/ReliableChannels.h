@@ -0,0 +1,273 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "../PacketInfo.h"
+#include "../PacketPool.h"
+#include "../SequenceNumber.h"
+#include "RttEstimator.h"
+
+namespace pirks::networking
+{
+
+/**
+ * @brief Selective acknowledgement for one reliable channel
+ *
+ * All packets before next were received. Bit i of mask is set if packet
+ * next + 1 + i was received too, so cleared bits below the highest set bit
+ * are holes, they work as negative acknowledgements.
+ */
+struct AckFrame
+{
+    uint8_t        channel { 0 };
+    SequenceNumber next { 0 };
+    uint64_t       mask { 0 };
+};
+
+/**
+ * @brief Counters of one direction of one (channel, reliable) stream
+ */
+struct StreamStats
+{
+    uint64_t sent { 0 };
+    uint64_t retransmitted { 0 };
+    uint64_t received { 0 };
+    uint64_t duplicates { 0 };
+    uint64_t dropped { 0 };   ///< Outside of receive window
+    uint64_t lost { 0 };      ///< Unreliable only: gaps in sequence numbers
+    uint64_t reordered { 0 }; ///< Unreliable only: arrived after a newer packet
+};
+
+enum class ReceiveResult
+{
+    Delivered, ///< Packet and possibly buffered ones were passed to deliver function
+    Buffered,  ///< Reliable packet arrived ahead of a lost one and waits for it
+    Duplicate, ///< Already received, packet is not taken
+    Dropped    ///< Too far ahead of receive window, packet is not taken
+};
+
+/**
+ * @brief Per-channel sequencing, acknowledgements and retransmissions
+ *
+ * Every channel has two independent sequence spaces, one for packets with
+ * PacketHeader::reliable set and one for the rest. Reliable packets (control,
+ * input) are kept until acknowledged, retransmitted after RTT based timeout or
+ * immediately when receiver reports a hole, and delivered in order. Unreliable
+ * packets (audio, video) only get sequence numbers, so receiver can count
+ * lost and reordered packets.
+ *
+ * Both windows are fixed arrays indexed by sequence number, nothing is
+ * allocated per packet. Socket I/O is not done here, UDPConnection moves
+ * packets between this class and the socket. All methods are thread safe;
+ * callbacks are called under the lock and must not call back into this class.
+ */
+class ReliableChannels final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Must divide 65536, so slot index stays the same when sequence number wraps around
+    static constexpr std::size_t WINDOW_SIZE   = 256;
+    static constexpr std::size_t ACK_MASK_BITS = 64;
+
+    // Retransmission timeout doubles for every retransmission of the same packet
+    static constexpr uint8_t MAX_BACKOFF_SHIFT = 6;
+
+    static_assert(65536 % WINDOW_SIZE == 0);
+
+public:
+    explicit ReliableChannels(std::shared_ptr<PacketPool> pool);
+    ~ReliableChannels();
+
+    ReliableChannels(const ReliableChannels &)            = delete;
+    ReliableChannels &operator=(const ReliableChannels &) = delete;
+
+public:
+    /**
+     * @brief Assign sequence number to outgoing packet
+     *
+     * Reliable packet is stored in the send window and its block is released
+     * when packet is acknowledged, caller must not release it. Unreliable
+     * packet stays owned by caller.
+     *
+     * @return std::optional<SequenceNumber>    nullopt if send window of reliable channel is full,
+     *                                          packet is not taken in this case
+     */
+    [[nodiscard]]
+    auto send(const PacketInfo &packet, Clock::time_point now) -> std::optional<SequenceNumber>;
+
+    /**
+     * @brief Process acknowledgement from receiver
+     *
+     * Releases acknowledged packets, updates RTT and schedules immediate
+     * retransmission of reported holes.
+     */
+    void onAck(const AckFrame &ack, Clock::time_point now);
+
+    /**
+     * @brief Call func(const PacketInfo &, SequenceNumber) for every reliable packet
+     *        whose retransmission timeout expired
+     */
+    template<class Func>
+    void retransmit(Clock::time_point now, Func &&func);
+
+    /**
+     * @brief Process incoming packet
+     *
+     * deliver(const PacketInfo &) is called for packets that are ready, in
+     * order for reliable channels. Delivered and buffered packets are owned by
+     * this class until deliver takes them; for Duplicate and Dropped results
+     * caller still owns the packet.
+     */
+    template<class Func>
+    auto receive(const PacketInfo &packet, SequenceNumber seq, Func &&deliver) -> ReceiveResult;
+
+    /**
+     * @brief Acknowledgement for reliable channel, if anything arrived since the last call
+     */
+    [[nodiscard]]
+    auto takeAck(uint8_t channel) -> std::optional<AckFrame>;
+
+    [[nodiscard]]
+    auto rtt() -> RttEstimator;
+
+    [[nodiscard]]
+    auto sendStats(uint8_t channel, bool reliable) -> StreamStats;
+
+    [[nodiscard]]
+    auto receiveStats(uint8_t channel, bool reliable) -> StreamStats;
+
+private:
+    struct SentPacket
+    {
+        PacketInfo        packet;
+        Clock::time_point lastSent;
+        Clock::time_point deadline;
+        uint8_t           transmissions { 0 };
+        bool              inUse { false };
+    };
+
+    struct ReliableSender
+    {
+        std::array<SentPacket, WINDOW_SIZE> window;
+        SequenceNumber                      base { 0 }; ///< Oldest not acknowledged packet
+        SequenceNumber                      next { 0 };
+        StreamStats                         stats;
+    };
+
+    struct UnreliableSender
+    {
+        SequenceNumber next { 0 };
+        StreamStats    stats;
+    };
+
+    struct ReceivedPacket
+    {
+        PacketInfo packet;
+        bool       present { false };
+    };
+
+    struct ReliableReceiver
+    {
+        std::array<ReceivedPacket, WINDOW_SIZE> window;
+        SequenceNumber                          next { 0 }; ///< Next packet to deliver
+        bool                                    ackPending { false };
+        StreamStats                             stats;
+    };
+
+    struct UnreliableReceiver
+    {
+        SequenceNumber highest { 0 };
+        uint64_t       history { 0 }; ///< Bit i is set if packet highest - i was received
+        bool           started { false };
+        StreamStats    stats;
+    };
+
+private:
+    static auto slot(SequenceNumber seq) -> std::size_t
+    {
+        return seq % WINDOW_SIZE;
+    }
+
+    void acknowledge(ReliableSender &sender, SequenceNumber seq, Clock::time_point now);
+    auto retransmitTimeout(uint8_t transmissions) const -> Clock::duration;
+
+    auto insertReliable(ReliableReceiver &receiver, const PacketInfo &packet, SequenceNumber seq)
+            -> ReceiveResult;
+    auto insertUnreliable(UnreliableReceiver &receiver, SequenceNumber seq) -> ReceiveResult;
+
+private:
+    std::mutex                  mutex_;
+    std::shared_ptr<PacketPool> pool_;
+    RttEstimator                rtt_;
+
+    std::array<ReliableSender, CHANNEL_COUNT>     reliableSenders_;
+    std::array<UnreliableSender, CHANNEL_COUNT>   unreliableSenders_;
+    std::array<ReliableReceiver, CHANNEL_COUNT>   reliableReceivers_;
+    std::array<UnreliableReceiver, CHANNEL_COUNT> unreliableReceivers_;
+};
+
+template<class Func>
+void ReliableChannels::retransmit(Clock::time_point now, Func &&func)
+{
+    std::lock_guard lock { mutex_ };
+
+    for (auto &sender: reliableSenders_) {
+        for (auto seq = sender.base; seq != sender.next; ++seq) {
+            auto &sent = sender.window[slot(seq)];
+            if (!sent.inUse || sent.deadline > now) {
+                continue;
+            }
+
+            func(std::as_const(sent.packet), seq);
+
+            ++sent.transmissions;
+            sent.lastSent = now;
+            sent.deadline = now + retransmitTimeout(sent.transmissions);
+            ++sender.stats.retransmitted;
+        }
+    }
+}
+
+template<class Func>
+auto ReliableChannels::receive(const PacketInfo &packet, SequenceNumber seq, Func &&deliver)
+        -> ReceiveResult
+{
+    std::lock_guard lock { mutex_ };
+
+    assert(packet.channel < CHANNEL_COUNT && "unknown channel");
+
+    if (!packet.reliable) {
+        const auto result = insertUnreliable(unreliableReceivers_[packet.channel], seq);
+        if (result == ReceiveResult::Delivered) {
+            deliver(packet);
+        }
+        return result;
+    }
+
+    auto &receiver = reliableReceivers_[packet.channel];
+
+    const auto result = insertReliable(receiver, packet, seq);
+    if (result != ReceiveResult::Delivered) {
+        return result;
+    }
+
+    // Deliver this packet and everything buffered after it, until the next hole
+    for (auto *received = &receiver.window[slot(receiver.next)]; received->present;
+         received       = &receiver.window[slot(receiver.next)]) {
+        received->present = false;
+        ++receiver.next;
+        deliver(std::as_const(received->packet));
+    }
+
+    return result;
+}
+
+}; // namespace pirks::networking
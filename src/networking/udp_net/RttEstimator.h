@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+namespace pirks::networking
+{
+
+/**
+ * @brief Smoothed round trip time and retransmission timeout as in RFC 6298
+ *
+ * Samples must come only from packets that were sent once (Karn's algorithm),
+ * otherwise it's unknown which transmission was acknowledged.
+ */
+class RttEstimator final
+{
+public:
+    using Duration = std::chrono::microseconds;
+
+    static constexpr Duration INITIAL_RTO { std::chrono::milliseconds { 200 } };
+    // Game streaming runs over LAN or good WAN links, so lower bound is much
+    // smaller than 1 second recommended by RFC 6298
+    static constexpr Duration MIN_RTO { std::chrono::milliseconds { 10 } };
+    static constexpr Duration MAX_RTO { std::chrono::seconds { 1 } };
+    // Clock granularity G from RFC 6298
+    static constexpr Duration GRANULARITY { std::chrono::milliseconds { 1 } };
+
+public:
+    void addSample(Duration rtt)
+    {
+        if (!hasSamples_) {
+            srtt_       = rtt;
+            rttvar_     = rtt / 2;
+            hasSamples_ = true;
+        } else {
+            const auto error = srtt_ > rtt ? srtt_ - rtt : rtt - srtt_;
+            // rttvar = 3/4 * rttvar + 1/4 * |srtt - rtt|
+            rttvar_ = (rttvar_ * 3 + error) / 4;
+            // srtt = 7/8 * srtt + 1/8 * rtt
+            srtt_ = (srtt_ * 7 + rtt) / 8;
+        }
+
+        rto_ = std::clamp(srtt_ + std::max(GRANULARITY, rttvar_ * 4), MIN_RTO, MAX_RTO);
+    }
+
+    [[nodiscard]]
+    bool hasSamples() const
+    {
+        return hasSamples_;
+    }
+
+    [[nodiscard]]
+    auto srtt() const -> Duration
+    {
+        return srtt_;
+    }
+
+    [[nodiscard]]
+    auto rttvar() const -> Duration
+    {
+        return rttvar_;
+    }
+
+    [[nodiscard]]
+    auto rto() const -> Duration
+    {
+        return rto_;
+    }
+
+private:
+    bool     hasSamples_ { false };
+    Duration srtt_ { 0 };
+    Duration rttvar_ { 0 };
+    Duration rto_ { INITIAL_RTO };
+};
+
+}; // namespace pirks::networking
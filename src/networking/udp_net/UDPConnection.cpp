@@ -2,17 +2,79 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <stdexcept>
 #include <thread>
+#include <utility>
+
+#include "GaloisKernels.h"
+#include "Logging.h"
+#include "trace/Trace.h"
 
 using namespace std::chrono_literals;
 
 namespace pirks::networking
 {
 
-UDPConnection::UDPConnection() : stop_ { false }
+namespace {
+
+// [next][mask]
+constexpr std::size_t ACK_PAYLOAD_SIZE = 10;
+
+// [base][count][reference time], followed by count arrival offsets
+constexpr std::size_t FEEDBACK_PAYLOAD_HEADER_SIZE = 7;
+
+// Congestion control reacts within a few feedback intervals
+constexpr auto FEEDBACK_INTERVAL = 20ms;
+
+// How long threads wait for data before checking stop flag. Also the upper
+// bound of acknowledgement and retransmission delay when there is nothing to send.
+constexpr auto RECV_POLL_INTERVAL = 10ms;
+constexpr auto SEND_POLL_INTERVAL = 1ms;
+
+// Packets moved from the output queue into the multiplexer at once
+constexpr std::size_t SEND_BATCH_SIZE = 64;
+
+auto sequenceSpace(bool reliable) -> crypto::SequenceSpace
+{
+    return reliable ? crypto::SequenceSpace::Reliable : crypto::SequenceSpace::Unreliable;
+}
+
+auto sequenceSpace(const wire::Header &header) -> crypto::SequenceSpace
+{
+    if ((header.flags & (wire::Flags::Ack | wire::Flags::Feedback)) != 0) {
+        return crypto::SequenceSpace::Control;
+    }
+    return sequenceSpace((header.flags & wire::Flags::Reliable) != 0);
+}
+
+// Every channel has unreliable, control and reliable sequence numbers
+auto spaceIndex(crypto::SequenceSpace space, uint8_t channel) -> std::size_t
+{
+    return std::size_t { channel } * crypto::SEQUENCE_SPACE_COUNT + static_cast<std::size_t>(space);
+}
+
+} // namespace
+
+UDPConnection::UDPConnection(uint16_t port, std::shared_ptr<PacketPool> pool)
+        : stop_ { false }
+        , port_ { port }
+        , pool_ { pool }
+        , reliability_ { pool }
+        , pacer_ { congestionSettings_.startBitrateKbps }
+        , bitrateTarget_ { std::make_shared<BitrateTarget>(congestionSettings_.startBitrateKbps) }
+        , hasPeer_ { false }
+        , fragmenter_ { std::min(MAX_PAYLOAD_SIZE, pool->blockSize()) }
+        , metrics_ { "udp" }
 {
-    // This comment needed for clang-format. Without it, this will be in one line
+    assert(pool_ && "packet pool is required");
+
+    if (pool_->headroom() < wire::PACKET_HEADROOM) {
+        throw std::invalid_argument("UDPConnection: packet pool has no headroom for wire header");
+    }
+
     spdlog::debug("UDPConnection created");
 }
 
@@ -21,6 +83,13 @@ UDPConnection::~UDPConnection()
     spdlog::debug("UDPConnection destructor");
 
     stop_ = true;
+
+    if (recvThread_.joinable()) {
+        recvThread_.join();
+    }
+    if (sendThread_.joinable()) {
+        sendThread_.join();
+    }
 }
 
 void UDPConnection::create(
@@ -29,23 +98,937 @@ void UDPConnection::create(
 {
     inPackets_  = in_packets;
     outPackets_ = out_packets;
+
+    congestion_  = std::make_unique<CongestionController>(congestionSettings_);
+    multiplexer_ = std::make_unique<mux::ChannelMultiplexer>(multiplexerSettings_);
+
+    // Fragment size depends on encryption, both are known only now
+    fragmenter_ = fragment::Fragmenter { maxPayloadSize() };
+    if (framePool_) {
+        fragment::ReassemblerSettings settings;
+        settings.fragmentSize = fragmenter_.fragmentSize();
+
+        reassembler_ = std::make_unique<fragment::Reassembler>(settings, framePool_);
+
+        spdlog::debug(
+                "UDPConnection fragmentation enabled: {} bytes per fragment, frames up to {} bytes",
+                settings.fragmentSize,
+                framePool_->blockSize());
+    }
+
+    socket_.bind(port_);
+    socket_.setReceiveTimeout(std::chrono::duration_cast<std::chrono::milliseconds>(
+            RECV_POLL_INTERVAL));
+
+    spdlog::debug("UDPConnection listening on port {}", socket_.localPort());
+
+    recvThread_ = std::thread(recvThreadFunc, this);
+    sendThread_ = std::thread(sendThreadFunc, this);
+}
+
+void UDPConnection::enableFec(const fec::FecSettings &settings)
+{
+    assert(!multiplexer_ && "connection is already running");
+
+    // Position in a group counts from 1 and takes one byte of the header
+    if (settings.dataShards + settings.parityShards > UINT8_MAX) {
+        throw std::invalid_argument("UDPConnection: FEC group is too big for the wire header");
+    }
+
+    spdlog::debug(
+            "UDPConnection FEC enabled: {} data + {} parity packets, kernel {}",
+            settings.dataShards,
+            settings.parityShards,
+            fec::bestKernel().name);
+
+    fecEncoder_ = std::make_unique<fec::FecEncoder>(settings, pool_);
+    fecDecoder_ = std::make_unique<fec::FecDecoder>(settings, pool_);
+
+    const auto shards = std::size_t { settings.dataShards } + settings.parityShards;
+    for (auto *groups: { &fecSent_, &fecReceived_ }) {
+        for (auto &group: *groups) {
+            group.storage.resize(shards * pool_->blockSize());
+            group.data.resize(settings.dataShards);
+            group.parity.resize(settings.parityShards);
+        }
+    }
+}
+
+void UDPConnection::enableFragmentation(std::shared_ptr<PacketPool> frames)
+{
+    assert(frames && "frames pool is required");
+    assert(!reassembler_ && "connection is already running");
+
+    framePool_ = std::move(frames);
+}
+
+void UDPConnection::enableEncryption(
+        const crypto::SessionKey &send,
+        const crypto::SessionKey &receive)
+{
+    assert(!multiplexer_ && "connection is already running");
+
+    if (pool_->tailroom() < wire::PACKET_TAILROOM) {
+        throw std::invalid_argument("UDPConnection: packet pool has no tailroom for tag");
+    }
+
+    sealer_ = std::make_unique<crypto::AesGcm>(send);
+    opener_ = std::make_unique<crypto::AesGcm>(receive);
+
+    spdlog::debug("UDPConnection encryption enabled: AES-128-GCM");
+}
+
+auto UDPConnection::fragmentSize() const -> std::size_t
+{
+    return fragmenter_.fragmentSize();
+}
+
+void UDPConnection::setMultiplexerSettings(const mux::MultiplexerSettings &settings)
+{
+    assert(!multiplexer_ && "multiplexer is already running");
+
+    multiplexerSettings_ = settings;
 }
 
-// TODO: Implement this
-/*
-void UDPConnection::recvThreadFunc(TCPConnection *connection)
+void UDPConnection::setCongestionSettings(const CongestionSettings &settings)
 {
+    assert(!congestion_ && "congestion control is already running");
+
+    congestionSettings_ = settings;
+    pacer_.setBitrate(settings.startBitrateKbps);
+    bitrateTarget_->set(settings.startBitrateKbps);
+}
+
+void UDPConnection::setTunables(std::shared_ptr<const config::Tunables> tunables)
+{
+    tunables_ = std::move(tunables);
+}
+
+auto UDPConnection::pacingBitrate() const -> uint32_t
+{
+    const auto bitrate = congestion_->targetBitrateKbps();
+    if (tunables_) {
+        if (const auto limit = tunables_->pacingKbps.load(std::memory_order_relaxed)) {
+            return std::min(bitrate, limit);
+        }
+    }
+    return bitrate;
+}
+
+auto UDPConnection::bitrateTarget() const -> std::shared_ptr<const BitrateTarget>
+{
+    return bitrateTarget_;
+}
+
+auto UDPConnection::localPort() const -> uint16_t
+{
+    return socket_.localPort();
+}
+
+auto UDPConnection::reliability() -> ReliableChannels &
+{
+    return reliability_;
+}
+
+void UDPConnection::recvThreadFunc(UDPConnection *connection)
+{
+    trace::setThreadName("udp-recv");
+
+    auto &pool = *connection->pool_;
+
+    // Block the next datagram is received into, it's reused until a packet
+    // takes it
+    std::uint8_t *block = nullptr;
+
     while (!connection->stop_) {
-        std::this_thread::sleep_for(100ns);
+        if (connection->reassembler_) {
+            connection->reassembler_->evictExpired(fragment::Reassembler::Clock::now());
+        }
+
+        if (block == nullptr) {
+            block = pool.acquire();
+        }
+
+        // Header lands in the headroom, payload right where PacketInfo::data points.
+        // Without a block acknowledgements and feedback still have to be read.
+        const auto buffer = block != nullptr
+                                    ? std::span { block - wire::HEADER_SIZE,
+                                                  wire::HEADER_SIZE + pool.blockSize()
+                                                          + pool.tailroom() }
+                                    : std::span { connection->recvBuffer_ };
+
+        SocketAddress from;
+
+        const auto size = connection->socket_.receiveFrom(buffer, from);
+        if (!size) {
+            continue;
+        }
+
+        if (connection->hasPeer_ && !(from == connection->peer_)) {
+            continue;
+        }
+
+        PIRKS_TRACE_SCOPE("udp", "receive");
+        const auto result = connection->processDatagram(buffer.first(*size), block);
+        if (result == DatagramResult::Rejected) {
+            continue;
+        }
+
+        // Remote side is fixed, peer_ is written once before hasPeer_ is set
+        // and never changes after that. Garbage or forged datagrams from
+        // another address must not take the place of the client.
+        if (!connection->hasPeer_) {
+            connection->peer_    = from;
+            connection->hasPeer_ = true;
+            spdlog::info("UDPConnection: remote side connected");
+        }
+
+        if (result == DatagramResult::Taken) {
+            block = nullptr;
+        }
     }
+
+    pool.release(block);
 }
 
-void UDPConnection::sendThreadFunc(TCPConnection *connection)
+void UDPConnection::sendThreadFunc(UDPConnection *connection)
 {
+    trace::setThreadName("udp-send");
+
+    // Packets are popped into the stack of the thread, not the heap
+    PacketBatch<SEND_BATCH_SIZE> storage;
+    auto                        &batch = storage.packets();
+
+    auto &multiplexer  = *connection->multiplexer_;
+    auto  nextFeedback = ReliableChannels::Clock::now();
+
+    auto release = [connection](const PacketInfo &packet) {
+        connection->releasePacket(packet);
+    };
+
     while (!connection->stop_) {
-        std::this_thread::sleep_for(100ns);
+        auto out = connection->outPackets_.lock();
+        if (!out) {
+            break;
+        }
+
+        // Wait for new packets only when there is nothing left to send
+        const auto wait  = multiplexer.isEmpty() ? SEND_POLL_INTERVAL : 0ms;
+        const auto count = out->pop(batch, SEND_BATCH_SIZE, wait);
+        out.reset();
+
+        for (std::size_t i = 0; i < count; ++i) {
+            connection->enqueue(batch[i]);
+        }
+
+        if (!connection->hasPeer_) {
+            // Nobody to send to yet
+            multiplexer.clear(release);
+            continue;
+        }
+
+        const auto &peer = connection->peer_;
+
+        connection->pacer_.setBitrate(connection->pacingBitrate());
+
+        // One packet per round: packets which arrive while it's paced compete
+        // for the next slot by priority of their channel
+        if (const auto packet = multiplexer.pop()) {
+            PIRKS_TRACE_SCOPE("udp", "send");
+            connection->sendPacket(*packet, peer);
+        }
+
+        const auto now = ReliableChannels::Clock::now();
+
+        // Group waits for more packets only while the channel has them queued,
+        // the tail of a frame is protected without waiting for the next one
+        if (connection->fecEncoder_) {
+            for (uint8_t channel = 0; channel < CHANNEL_COUNT; ++channel) {
+                const auto &group = connection->fecSent_[channel];
+                if (group.dataCount != 0 && multiplexer.size(channel) == 0) {
+                    connection->sendParity(channel, peer);
+                }
+            }
+        }
+
+        connection->reliability_.retransmit(
+                now,
+                [&](const PacketInfo &packet, SequenceNumber seq) {
+                    connection->transmit(packet, seq, peer, true, {});
+                });
+
+        for (uint8_t channel = 0; channel < CHANNEL_COUNT; ++channel) {
+            if (auto ack = connection->reliability_.takeAck(channel)) {
+                connection->transmitAck(*ack, peer);
+            }
+        }
+
+        if (now >= nextFeedback) {
+            for (uint8_t channel = 0; channel < CHANNEL_COUNT; ++channel) {
+                if (auto frame = connection->feedback_.build(channel)) {
+                    connection->transmitFeedback(*frame, peer);
+                }
+            }
+            nextFeedback = now + FEEDBACK_INTERVAL;
+        }
+    }
+
+    multiplexer.clear(release);
+}
+
+void UDPConnection::enqueue(const PacketInfo &packet)
+{
+    if (isFrame(packet)) {
+        enqueueFrame(packet);
+        return;
+    }
+
+    if (!multiplexer_->push(packet)) {
+        spdlog::debug(
+                "UDPConnection: channel {} is over its budget, packet dropped",
+                packet.channel);
+        metrics_.onDropped(DropReason::Budget);
+        releasePacket(packet);
+    }
+}
+
+void UDPConnection::enqueueFrame(const PacketInfo &frame)
+{
+    const auto count = fragmenter_.fragmentCount(frame.size);
+
+    // Reliable window keeps packets until they are acknowledged and can't
+    // hold slices of a block
+    if (frame.reliable || frame.channel >= CHANNEL_COUNT || count == 0) {
+        PIRKS_ERROR_LIMITED(
+                "UDPConnection: frame can't be fragmented, channel {}, size {}",
+                frame.channel,
+                frame.size);
+        framePool_->release(frame.data);
+        return;
+    }
+
+    // Fragments are queued back to back, so they get consecutive sequence
+    // numbers and the receiver finds the frame by the first one
+    if (!multiplexer_->canPush(frame.channel, count, frame.size)) {
+        spdlog::debug(
+                "UDPConnection: channel {} is over its budget, frame dropped",
+                frame.channel);
+        metrics_.onDropped(DropReason::Budget);
+        framePool_->release(frame.data);
+        return;
+    }
+
+    fragmenter_.split(frame, [&](const PacketInfo &fragment) {
+        multiplexer_->push(fragment);
+    });
+}
+
+void UDPConnection::sendPacket(const PacketInfo &packet, const SocketAddress &peer)
+{
+    // Only blocks of pool_ and fragments of frames can be released after
+    // sending, anything else is not ours to send
+    if (!pool_->owns(packet.data) && !isFragment(packet)) {
+        PIRKS_ERROR_LIMITED(
+                "UDPConnection: packet is not in a pool block, channel {}, size {}",
+                packet.channel,
+                packet.size);
+        metrics_.onDropped(DropReason::Invalid);
+        return;
+    }
+
+    if (packet.channel >= CHANNEL_COUNT || packet.size > maxPayloadSize()) {
+        PIRKS_ERROR_LIMITED(
+                "UDPConnection: invalid packet, channel {}, size {}",
+                packet.channel,
+                packet.size);
+        metrics_.onDropped(DropReason::Invalid);
+        releasePacket(packet);
+        return;
+    }
+
+    // Reliable packet can't be acknowledged and released by receive thread
+    // before it's transmitted below: remote side has not seen it yet
+    const auto seq = reliability_.send(packet, ReliableChannels::Clock::now());
+    if (!seq) {
+        PIRKS_WARN_LIMITED(
+                "UDPConnection: send window of channel {} is full, packet dropped",
+                packet.channel);
+        metrics_.onDropped(DropReason::Window);
+        releasePacket(packet);
+        return;
+    }
+
+    const auto fec = protect(packet, *seq);
+    transmit(packet, *seq, peer, false, fec);
+
+    if (!packet.reliable) {
+        releasePacket(packet);
+    }
+
+    if (fecEncoder_ && fec.shard == fecEncoder_->settings().dataShards) {
+        sendParity(packet.channel, peer);
+    }
+}
+
+void UDPConnection::transmit(
+        const PacketInfo    &packet,
+        SequenceNumber       seq,
+        const SocketAddress &peer,
+        bool                 retransmission,
+        FecPosition          fec)
+{
+    const auto tagSize = sealer_ ? crypto::TAG_SIZE : 0;
+    const auto size    = wire::HEADER_SIZE + packet.size + tagSize;
+
+    // Reliable channels carry small control and input messages, which should
+    // not wait behind a video frame, but they still consume the budget
+    if (packet.reliable) {
+        pacer_.onSent(size, Pacer::Clock::now());
+    } else {
+        pace(size);
+        congestion_->onPacketSent(packet.channel, seq, size, CongestionController::Clock::now());
+    }
+
+    // Pacing delay above is not a cost of sending
+    metrics::ScopedTimer timer { metrics_.transmitTime() };
+
+    auto header     = wire::packetHeader(packet, seq);
+    header.fecShard = fec.shard;
+    if (fec.parity) {
+        header.flags = header.flags | wire::Flags::Parity;
+    }
+    if (sealer_) {
+        header.flags       = header.flags | wire::Flags::Encrypted;
+        header.payloadSize = static_cast<uint16_t>(header.payloadSize + tagSize);
+    }
+
+    const auto space   = sequenceSpace(packet.reliable);
+    const auto payload = std::span { packet.data, packet.size };
+
+    bool sent = false;
+    if (pool_->owns(packet.data)) {
+        // Datagram is sent from the pool block, header goes into its headroom
+        // and tag into its tailroom
+        const auto headroom = wire::headerBefore(packet.data);
+        wire::serialize(header, headroom);
+
+        // Retransmitted packet stays sealed since its first transmission,
+        // sealing it again would reuse the nonce
+        const std::span<uint8_t, crypto::TAG_SIZE> tag { packet.data + packet.size,
+                                                         crypto::TAG_SIZE };
+        if (sealer_ && !retransmission
+            && !seal(headroom, payload, space, packet.channel, seq, tag))
+        {
+            return;
+        }
+
+        sent = socket_.sendTo({ headroom.data(), size }, peer);
+    } else {
+        // Fragment has no headroom or tailroom, bytes around it belong to the
+        // neighbour fragments. Fragments are never retransmitted.
+        std::array<uint8_t, wire::HEADER_SIZE> headroom;
+        std::array<uint8_t, crypto::TAG_SIZE>  tag;
+        wire::serialize(header, headroom);
+
+        if (sealer_ && !seal(headroom, payload, space, packet.channel, seq, tag)) {
+            return;
+        }
+
+        sent = socket_.sendTo(
+                headroom,
+                { packet.data, packet.size },
+                { tag.data(), tagSize },
+                peer);
+    }
+
+    if (!sent) {
+        spdlog::debug("UDPConnection: sendto failed");
+        return;
+    }
+
+    metrics_.onSent(packet.channel, size);
+}
+
+auto UDPConnection::protect(const PacketInfo &packet, SequenceNumber seq) -> FecPosition
+{
+    if (!fecEncoder_ || packet.reliable) {
+        return {};
+    }
+
+    auto &group = fecSent_[packet.channel];
+    if (group.dataCount == 0) {
+        group.base = seq;
+    }
+
+    // Parity is sent as soon as a group is closed, so nothing else takes
+    // unreliable sequence numbers of the channel in between
+    assert(seq == static_cast<SequenceNumber>(group.base + group.dataCount)
+           && "FEC group must have consecutive sequence numbers");
+
+    // Payload is sealed in place and released after sending, parity is
+    // calculated from the plaintext copy
+    auto &copy = group.data[group.dataCount];
+    copy       = packet;
+    copy.data  = group.storage.data() + std::size_t { group.dataCount } * pool_->blockSize();
+    std::memcpy(copy.data, packet.data, packet.size);
+
+    ++group.dataCount;
+    return { group.dataCount, false };
+}
+
+void UDPConnection::sendParity(uint8_t channel, const SocketAddress &peer)
+{
+    auto      &group = fecSent_[channel];
+    const auto count = std::exchange(group.dataCount, uint8_t { 0 });
+
+    if (!fecEncoder_->encode(std::span { group.data }.first(count), group.parity)) {
+        PIRKS_WARN_LIMITED("UDPConnection: no parity for FEC group of channel {}", channel);
+        return;
+    }
+
+    // Parity follows the data packets in the unreliable sequence space, the
+    // receiver finds the group by the position
+    for (std::size_t j = 0; j < group.parity.size(); ++j) {
+        auto &parity         = group.parity[j];
+        parity.timestamp     = 0;
+        parity.fragmentIndex = static_cast<uint16_t>(j);
+        parity.fragmentCount = static_cast<uint16_t>(group.parity.size());
+
+        const auto seq = reliability_.send(parity, ReliableChannels::Clock::now());
+        assert(seq && "unreliable packets are always sent");
+
+        transmit(parity, *seq, peer, false, { static_cast<uint8_t>(count + j + 1), true });
+        pool_->release(parity.data);
+    }
+}
+
+bool UDPConnection::seal(
+        std::span<const uint8_t>             header,
+        std::span<uint8_t>                   payload,
+        crypto::SequenceSpace                space,
+        uint8_t                              channel,
+        SequenceNumber                       seq,
+        std::span<uint8_t, crypto::TAG_SIZE> tag)
+{
+    // Sequence numbers are sealed in order, so the index only grows and the
+    // nonce is never reused within the session
+    auto &last = sealedIndex_[spaceIndex(space, channel)];
+    last       = extendSequence(last, seq);
+
+    if (!sealer_->seal(header, payload, tag, crypto::packetIndex(space, channel, last))) {
+        PIRKS_ERROR_LIMITED("UDPConnection: packet encryption failed, packet dropped");
+        return false;
+    }
+    return true;
+}
+
+bool UDPConnection::open(const wire::Header &header, std::span<uint8_t> datagram)
+{
+    if (header.payloadSize < crypto::TAG_SIZE) {
+        return false;
+    }
+
+    const auto space   = sequenceSpace(header);
+    const auto size    = std::size_t { header.payloadSize } - crypto::TAG_SIZE;
+    const auto payload = datagram.subspan(wire::HEADER_SIZE);
+
+    auto      &window = openedWindows_[spaceIndex(space, header.channel)];
+    const auto index  = extendSequence(window.newest(), header.sequence);
+
+    // Reliable packets are retransmitted sealed as they were, seen ones go on
+    // to ReliableChannels, which drops them and acknowledges them again
+    const auto status = window.check(index);
+    if (status == crypto::ReplayWindow::Status::Stale
+        || (status == crypto::ReplayWindow::Status::Seen
+            && space != crypto::SequenceSpace::Reliable))
+    {
+        return false;
+    }
+
+    if (!opener_->open(
+                datagram.first<wire::HEADER_SIZE>(),
+                payload.first(size),
+                payload.subspan(size).first<crypto::TAG_SIZE>(),
+                crypto::packetIndex(space, header.channel, index)))
+    {
+        return false;
+    }
+
+    // Only authenticated packets move the window, forged ones can't shift it
+    window.accept(index);
+    return true;
+}
+
+void UDPConnection::pace(std::size_t bytes)
+{
+    auto now = Pacer::Clock::now();
+    if (const auto delay = pacer_.delayUntilSend(now); delay > Pacer::Clock::duration::zero()) {
+        std::this_thread::sleep_for(delay);
+        now = Pacer::Clock::now();
+    }
+
+    pacer_.onSent(bytes, now);
+}
+
+void UDPConnection::transmitAck(const AckFrame &ack, const SocketAddress &peer)
+{
+    wire::Header header;
+    header.flags       = wire::Flags::Reliable | wire::Flags::Ack;
+    header.channel     = ack.channel;
+    header.payloadSize = ACK_PAYLOAD_SIZE;
+
+    auto *payload = sendBuffer_.data() + wire::HEADER_SIZE;
+    wire::storeBigEndian(payload, ack.next);
+    wire::storeBigEndian(payload + 2, ack.mask);
+
+    transmitControl(header, peer);
+}
+
+void UDPConnection::transmitFeedback(const FeedbackFrame &frame, const SocketAddress &peer)
+{
+    const auto payloadSize = FEEDBACK_PAYLOAD_HEADER_SIZE + 2 * std::size_t { frame.count };
+
+    wire::Header header;
+    header.flags       = wire::Flags::Feedback;
+    header.channel     = frame.channel;
+    header.payloadSize = static_cast<uint16_t>(payloadSize);
+
+    auto *payload = sendBuffer_.data() + wire::HEADER_SIZE;
+    wire::storeBigEndian(payload, frame.base);
+    payload[2] = frame.count;
+    wire::storeBigEndian(payload + 3, frame.referenceTime);
+
+    for (std::size_t i = 0; i < frame.count; ++i) {
+        wire::storeBigEndian(payload + FEEDBACK_PAYLOAD_HEADER_SIZE + 2 * i, frame.arrival[i]);
     }
+
+    transmitControl(header, peer);
+}
+
+void UDPConnection::transmitControl(wire::Header header, const SocketAddress &peer)
+{
+    const auto tagSize = sealer_ ? crypto::TAG_SIZE : 0;
+    const auto size    = std::size_t { header.payloadSize };
+
+    // Control frames have sequence numbers of their own, only for the nonce
+    header.sequence = controlSequence_[header.channel]++;
+    if (sealer_) {
+        header.flags       = header.flags | wire::Flags::Encrypted;
+        header.payloadSize = static_cast<uint16_t>(header.payloadSize + tagSize);
+    }
+
+    const auto buffer = std::span { sendBuffer_ };
+    wire::serialize(header, buffer.first<wire::HEADER_SIZE>());
+
+    if (sealer_
+        && !seal(buffer.first<wire::HEADER_SIZE>(),
+                 buffer.subspan(wire::HEADER_SIZE, size),
+                 crypto::SequenceSpace::Control,
+                 header.channel,
+                 header.sequence,
+                 buffer.subspan(wire::HEADER_SIZE + size).first<crypto::TAG_SIZE>()))
+    {
+        return;
+    }
+
+    socket_.sendTo(buffer.first(wire::HEADER_SIZE + size + tagSize), peer);
+}
+
+auto UDPConnection::processDatagram(std::span<uint8_t> datagram, uint8_t *block) -> DatagramResult
+{
+    const auto header = wire::parse(datagram);
+    if (!header) {
+        spdlog::debug("UDPConnection: malformed datagram of {} bytes", datagram.size());
+        return DatagramResult::Rejected;
+    }
+
+    const bool control = (header->flags & (wire::Flags::Ack | wire::Flags::Feedback)) != 0;
+    if (!control && block == nullptr) {
+        PIRKS_WARN_LIMITED("UDPConnection: packet pool is exhausted, packet dropped");
+        metrics_.onDropped(DropReason::Pool);
+        return DatagramResult::Rejected;
+    }
+
+    // Plaintext is not accepted once encryption is enabled, nor the other way
+    // round. Forged acknowledgements would release packets the remote side
+    // never got and forged feedback would cut the bitrate, so control frames
+    // are checked like packets.
+    const bool encrypted = (header->flags & wire::Flags::Encrypted) != 0;
+    if (encrypted != (opener_ != nullptr) || (encrypted && !open(*header, datagram))) {
+        spdlog::debug("UDPConnection: datagram failed authentication or was replayed, dropped");
+        metrics_.onDropped(DropReason::Auth);
+        return DatagramResult::Rejected;
+    }
+
+    const auto payload = datagram.subspan(
+            wire::HEADER_SIZE,
+            header->payloadSize - (encrypted ? crypto::TAG_SIZE : 0));
+
+    if (header->flags & wire::Flags::Ack) {
+        processAck(*header, payload);
+        return DatagramResult::Accepted;
+    }
+
+    if (header->flags & wire::Flags::Feedback) {
+        processFeedback(*header, payload);
+        return DatagramResult::Accepted;
+    }
+
+    // Payload is already in place
+    assert(payload.data() == block && "datagram is not received into the block");
+
+    metrics_.onReceived(header->channel, datagram.size());
+
+    PacketInfo packet;
+    packet.channel       = header->channel;
+    packet.reliable      = (header->flags & wire::Flags::Reliable) != 0;
+    packet.sequence      = header->sequence;
+    packet.size          = static_cast<uint32_t>(
+            header->payloadSize - (encrypted ? crypto::TAG_SIZE : 0));
+    packet.timestamp     = header->timestamp;
+    packet.fragmentIndex = header->fragmentIndex;
+    packet.fragmentCount = header->fragmentCount;
+    packet.data          = block;
+
+    if (!packet.reliable) {
+        feedback_.onReceived(packet.channel, packet.sequence, FeedbackBuilder::Clock::now());
+    }
+
+    auto inPackets = inPackets_.lock();
+
+    // Parity is counted like a packet by congestion control and loss
+    // statistics, but only its copy is kept
+    if (header->flags & wire::Flags::Parity) {
+        const auto result = reliability_.receive(packet, packet.sequence, [](const auto &) {});
+        if (result == ReceiveResult::Delivered) {
+            keepFecShard(*header, packet);
+            recoverFec(packet.channel, inPackets.get());
+        }
+        return DatagramResult::Accepted;
+    }
+
+    // Copy is taken before the block goes to the consumer
+    if (header->fecShard != 0) {
+        keepFecShard(*header, packet);
+    }
+
+    const auto result = reliability_.receive(packet, packet.sequence, [&](const PacketInfo &ready) {
+        deliver(ready, inPackets.get());
+    });
+
+    if (header->fecShard != 0) {
+        recoverFec(packet.channel, inPackets.get());
+    }
+
+    // Block can be reused for the next datagram
+    if (result == ReceiveResult::Duplicate || result == ReceiveResult::Dropped) {
+        return DatagramResult::Accepted;
+    }
+    return DatagramResult::Taken;
+}
+
+void UDPConnection::keepFecShard(const wire::Header &header, const PacketInfo &packet)
+{
+    if (!fecDecoder_) {
+        return;
+    }
+
+    const auto &settings = fecDecoder_->settings();
+    const bool  parity   = (header.flags & wire::Flags::Parity) != 0;
+    const auto  position = std::size_t { header.fecShard } - 1;
+
+    // Groups of a sender with other settings can't be restored
+    const bool valid = parity ? header.fragmentCount == settings.parityShards
+                                        && position - header.fragmentIndex <= settings.dataShards
+                              : position < settings.dataShards;
+    if (!valid || packet.size > pool_->blockSize()) {
+        PIRKS_WARN_LIMITED("UDPConnection: FEC group does not match settings, not restored");
+        return;
+    }
+
+    auto      &group = fecReceived_[packet.channel];
+    const auto base  = static_cast<SequenceNumber>(header.sequence - position);
+
+    if (!group.active || group.base != base) {
+        // Shards of an older group come too late to be useful
+        if (group.active && sequenceNewer(group.base, base)) {
+            return;
+        }
+
+        // What is still missing from the current group is lost for good
+        group.active    = true;
+        group.done      = false;
+        group.base      = base;
+        group.dataCount = 0;
+        for (auto &shard: group.data) {
+            shard.data = nullptr;
+        }
+        for (auto &shard: group.parity) {
+            shard.data = nullptr;
+        }
+    }
+
+    if (group.done) {
+        return;
+    }
+
+    const auto index = parity ? settings.dataShards + header.fragmentIndex : position;
+    auto      &copy  = parity ? group.parity[header.fragmentIndex] : group.data[position];
+    copy             = packet;
+    copy.data        = group.storage.data() + index * pool_->blockSize();
+    std::memcpy(copy.data, packet.data, packet.size);
+
+    if (parity) {
+        group.dataCount = static_cast<uint8_t>(position - header.fragmentIndex);
+    }
+}
+
+void UDPConnection::recoverFec(uint8_t channel, PacketsQueue *in_packets)
+{
+    auto &group = fecReceived_[channel];
+    if (!fecDecoder_ || !group.active || group.done || group.dataCount == 0) {
+        return;
+    }
+
+    const auto present  = [](const PacketInfo &shard) { return shard.data != nullptr; };
+    const auto data     = std::span { group.data }.first(group.dataCount);
+    const auto received = std::ranges::count_if(data, present);
+    if (received == group.dataCount) {
+        group.done = true;
+        return;
+    }
+    if (received + std::ranges::count_if(group.parity, present) < group.dataCount) {
+        return;
+    }
+
+    group.done = true;
+    if (!fecDecoder_->recover(data, group.parity)) {
+        PIRKS_WARN_LIMITED("UDPConnection: FEC group of channel {} not restored", channel);
+        return;
+    }
+
+    // Restored packets are in pool blocks, received ones are copies
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        auto &packet = data[i];
+        if (!pool_->owns(packet.data)) {
+            continue;
+        }
+
+        packet.sequence = static_cast<SequenceNumber>(group.base + i);
+
+        const auto result = reliability_.receive(
+                packet,
+                packet.sequence,
+                [&](const PacketInfo &ready) { deliver(ready, in_packets); });
+        if (result != ReceiveResult::Delivered) {
+            pool_->release(packet.data);
+        }
+        packet.data = nullptr;
+    }
+}
+
+void UDPConnection::deliver(const PacketInfo &packet, PacketsQueue *in_packets)
+{
+    auto push = [this, in_packets](const PacketInfo &ready, PacketPool &pool) {
+        // Reliable packet is already acknowledged here, so it's lost if the
+        // consumer does not keep up
+        if (in_packets == nullptr || in_packets->isFull()) {
+            metrics_.onDropped(DropReason::Queue);
+            pool.release(ready.data);
+            return;
+        }
+        in_packets->push(ready);
+    };
+
+    if (packet.fragmentCount == 1 || !reassembler_) {
+        push(packet, *pool_);
+        return;
+    }
+
+    reassembler_->insert(packet, fragment::Reassembler::Clock::now(), [&](const PacketInfo &frame) {
+        push(frame, *framePool_);
+    });
+
+    // Fragment is copied into its frame
+    pool_->release(packet.data);
+}
+
+void UDPConnection::releasePacket(const PacketInfo &packet)
+{
+    if (pool_->owns(packet.data)) {
+        pool_->release(packet.data);
+        return;
+    }
+
+    // Fragments point into their frame block, it's free after the last one
+    if (isFragment(packet) && packet.fragmentIndex + 1 == packet.fragmentCount) {
+        const auto offset = std::size_t { packet.fragmentIndex } * fragmenter_.fragmentSize();
+        framePool_->release(packet.data - offset);
+    }
+}
+
+bool UDPConnection::isFrame(const PacketInfo &packet) const
+{
+    return framePool_ && framePool_->owns(packet.data);
+}
+
+bool UDPConnection::isFragment(const PacketInfo &packet) const
+{
+    // Reliable frames are never fragmented, see enqueueFrame()
+    if (!framePool_ || packet.data == nullptr || packet.reliable
+        || packet.fragmentIndex >= packet.fragmentCount)
+    {
+        return false;
+    }
+
+    const auto offset = std::size_t { packet.fragmentIndex } * fragmenter_.fragmentSize();
+    return framePool_->owns(packet.data - offset);
+}
+
+auto UDPConnection::maxPayloadSize() const -> std::size_t
+{
+    const auto tagSize = sealer_ ? crypto::TAG_SIZE : 0;
+    const auto fecSize = fecEncoder_ ? fec::FEC_HEADER_SIZE : 0;
+    return std::min(MAX_PAYLOAD_SIZE - tagSize, pool_->blockSize()) - fecSize;
+}
+
+void UDPConnection::processAck(const wire::Header &header, std::span<const uint8_t> payload)
+{
+    if (payload.size() != ACK_PAYLOAD_SIZE) {
+        return;
+    }
+
+    AckFrame ack;
+    ack.channel = header.channel;
+    ack.next    = wire::loadBigEndian<SequenceNumber>(payload.data());
+    ack.mask    = wire::loadBigEndian<uint64_t>(payload.data() + 2);
+    reliability_.onAck(ack, ReliableChannels::Clock::now());
+}
+
+void UDPConnection::processFeedback(const wire::Header &header, std::span<const uint8_t> payload)
+{
+    if (payload.size() < FEEDBACK_PAYLOAD_HEADER_SIZE) {
+        return;
+    }
+
+    FeedbackFrame frame;
+    frame.channel       = header.channel;
+    frame.base          = wire::loadBigEndian<SequenceNumber>(payload.data());
+    frame.count         = payload[2];
+    frame.referenceTime = wire::loadBigEndian<uint32_t>(payload.data() + 3);
+
+    if (frame.count > FeedbackFrame::MAX_PACKETS
+        || payload.size() != FEEDBACK_PAYLOAD_HEADER_SIZE + 2 * std::size_t { frame.count }) {
+        return;
+    }
+
+    for (std::size_t i = 0; i < frame.count; ++i) {
+        frame.arrival[i] = wire::loadBigEndian<uint16_t>(
+                payload.data() + FEEDBACK_PAYLOAD_HEADER_SIZE + 2 * i);
+    }
+
+    congestion_->onFeedback(frame, CongestionController::Clock::now());
+    bitrateTarget_->set(congestion_->targetBitrateKbps());
 }
-*/
 
 }; // namespace pirks::networking
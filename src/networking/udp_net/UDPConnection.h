@@ -1,19 +1,83 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <memory>
+#include <span>
 #include <thread>
+#include <vector>
 
+#include "../BitrateTarget.h"
+#include "../ConnectionMetrics.h"
 #include "../IConnection.h"
+#include "../PacketPool.h"
+#include "../WireHeader.h"
+#include "AesGcm.h"
+#include "ChannelMultiplexer.h"
+#include "CongestionController.h"
+#include "CongestionFeedback.h"
+#include "FecCodec.h"
+#include "Fragmenter.h"
+#include "Pacer.h"
+#include "Reassembler.h"
+#include "ReliableChannels.h"
+#include "ReplayWindow.h"
+#include "Tunables.h"
+#include "UdpSocket.h"
 
 namespace pirks::networking
 {
 
-// TODO: Implement UDP connection
+/**
+ * @brief Datagram connection with selective reliability
+ *
+ * Packets popped from out_packets are sequenced per channel by
+ * ReliableChannels: packets with PacketHeader::reliable set are retransmitted
+ * until acknowledged, the rest are sent once. Received packets are pushed to
+ * in_packets, reliable ones in order. Remote side is the first address a
+ * valid datagram arrives from, authenticated when encryption is enabled.
+ *
+ * Outgoing packets are paced at the bitrate estimated by CongestionController
+ * from arrival times the remote side reports for unreliable packets. The
+ * estimate is published through bitrateTarget() for the encoder.
+ *
+ * With fragmentation enabled, unreliable packets in frames pool blocks are
+ * sent as fragments of fragmentSize() bytes and reassembled on receive.
+ *
+ * With FEC enabled, unreliable packets of every channel are sent in groups
+ * followed by parity datagrams, see wire::Header::fecShard. Lost packets of
+ * a group are restored from parity on receive and delivered like reordered ones.
+ *
+ * With encryption enabled, payloads are sealed with AES-GCM in place, the
+ * wire header is authenticated with them and the tag is written to the
+ * tailroom of the block. Acknowledgements and feedback are sealed the same
+ * way in a control sequence space of their channel, plaintext ones are
+ * dropped. Every sequence space has a crypto::ReplayWindow, so recorded
+ * datagrams sent again are dropped too. Datagrams are sealed one by one as
+ * they leave the multiplexer: pacing sends one per round, so there is no
+ * sendmmsg() batch to seal at once.
+ *
+ * Outgoing packets wait in per-channel rings of mux::ChannelMultiplexer and
+ * go out one by one in its order, so control, input and audio packets do
+ * not queue behind a video frame. Packets over the budget of their channel
+ * are dropped.
+ */
 class UDPConnection final: public IConnection
 {
 public:
-    UDPConnection();
+    // Ethernet MTU without IPv4 and UDP headers
+    static constexpr std::size_t MAX_DATAGRAM_SIZE = 1472;
+
+    // Largest payload of a packet, the rest is taken by the wire header. The
+    // authentication tag of encrypted packets takes PACKET_TAILROOM more.
+    static constexpr std::size_t MAX_PAYLOAD_SIZE = MAX_DATAGRAM_SIZE - wire::HEADER_SIZE;
+
+public:
+    /**
+     * @brief Packets are sent from and received into blocks of the pool in
+     *        place, so it must have wire::PACKET_HEADROOM
+     */
+    UDPConnection(uint16_t port, std::shared_ptr<PacketPool> pool);
     ~UDPConnection() override;
 
 public:
@@ -21,17 +85,248 @@ public:
             std::shared_ptr<PacketsQueue> in_packets, //
             std::shared_ptr<PacketsQueue> out_packets) override;
 
+    /**
+     * @brief Protect unreliable channels with Reed-Solomon parity packets
+     *
+     * Every settings.dataShards outgoing packets of a channel are followed by
+     * settings.parityShards parity packets, so lost packets are restored on
+     * receiver without retransmission round trip. A group is closed early when
+     * the channel has nothing more queued, so short groups cost relatively
+     * more parity. Payload of a packet becomes
+     * fec::FEC_HEADER_SIZE smaller. Both sides must use the same settings,
+     * their sum must fit wire::Header::fecShard, std::invalid_argument is
+     * thrown if it does not. Must be called before create().
+     */
+    void enableFec(const fec::FecSettings &settings);
+
+    /**
+     * @brief Send frames bigger than a datagram in fragments and reassemble them
+     *
+     * Unreliable packets whose data is a frames block are split into
+     * fragments which point into the block, the block is released when all of
+     * them are sent. Received fragments are collected into frames blocks,
+     * complete frames are pushed to in_packets. Must be called before create().
+     */
+    void enableFragmentation(std::shared_ptr<PacketPool> frames);
+
+    /**
+     * @brief Encrypt and authenticate packets, drop the ones which fail authentication
+     *
+     * Keys must be new for every session, and the remote side must use them
+     * the other way round. Packet pool must have wire::PACKET_TAILROOM, and
+     * std::invalid_argument is thrown if it does not. Must be called before
+     * create().
+     */
+    void enableEncryption(const crypto::SessionKey &send, const crypto::SessionKey &receive);
+
+    /**
+     * @brief Payload of every fragment but the last one, both sides must use the
+     *        same. Valid after create()
+     */
+    [[nodiscard]]
+    auto fragmentSize() const -> std::size_t;
+
+    /**
+     * @brief Budgets and priorities of outgoing channels. Must be called before create()
+     */
+    void setMultiplexerSettings(const mux::MultiplexerSettings &settings);
+
+    /**
+     * @brief Bitrate limits of congestion control. Must be called before create()
+     */
+    void setCongestionSettings(const CongestionSettings &settings);
+
+    /**
+     * @brief Send no faster than Tunables::pacingKbps, checked for every packet
+     */
+    void setTunables(std::shared_ptr<const config::Tunables> tunables);
+
+    /**
+     * @brief Bitrate the encoder should produce, updated by congestion control
+     */
+    [[nodiscard]]
+    auto bitrateTarget() const -> std::shared_ptr<const BitrateTarget>;
+
+    /**
+     * @brief Port the socket is bound to. Valid after create()
+     */
+    [[nodiscard]]
+    auto localPort() const -> uint16_t;
+
+    [[nodiscard]]
+    auto reliability() -> ReliableChannels &;
+
 private:
-    // TODO: implement this
-    // static void recvThreadFunc(TCPConnection *connection);
-    // static void sendThreadFunc(TCPConnection *connection);
+    enum class DatagramResult
+    {
+        Rejected, ///< Malformed, failed authentication or no block for it
+        Accepted, ///< Valid, the block can be reused
+        Taken     ///< Valid, a packet took the block
+    };
+
+    // Position of an unreliable packet in its FEC group, see wire::Header::fecShard
+    struct FecPosition
+    {
+        uint8_t shard { 0 };
+        bool    parity { false };
+    };
+
+    // Packets of a channel protected by one set of parity packets. Sender
+    // keeps plaintext copies, payloads are sealed in place and released right
+    // after sending. Receiver keeps copies of what arrived, the blocks are
+    // delivered.
+    struct FecGroup
+    {
+        std::vector<uint8_t>    storage; ///< Pool block size per shard
+        std::vector<PacketInfo> data;
+        std::vector<PacketInfo> parity;
+        SequenceNumber          base { 0 };
+        uint8_t                 dataCount { 0 }; ///< Receiver: 0 until parity tells
+        bool                    active { false };
+        bool                    done { false };
+    };
+
+private:
+    static void recvThreadFunc(UDPConnection *connection);
+    static void sendThreadFunc(UDPConnection *connection);
+
+    void enqueue(const PacketInfo &packet);
+    void enqueueFrame(const PacketInfo &frame);
+    void sendPacket(const PacketInfo &packet, const SocketAddress &peer);
+    void transmit(
+            const PacketInfo    &packet,
+            SequenceNumber       seq,
+            const SocketAddress &peer,
+            bool                 retransmission,
+            FecPosition          fec);
+
+    /**
+     * @brief Add an outgoing unreliable packet to the FEC group of its channel
+     */
+    auto protect(const PacketInfo &packet, SequenceNumber seq) -> FecPosition;
+
+    /**
+     * @brief Close the FEC group of the channel and send its parity packets
+     */
+    void sendParity(uint8_t channel, const SocketAddress &peer);
+
+    /**
+     * @brief Keep a copy of a received data or parity packet of a FEC group
+     */
+    void keepFecShard(const wire::Header &header, const PacketInfo &packet);
+
+    /**
+     * @brief Restore lost packets of the FEC group of the channel once enough shards arrived
+     */
+    void recoverFec(uint8_t channel, PacketsQueue *in_packets);
+    bool seal(
+            std::span<const uint8_t>             header,
+            std::span<uint8_t>                   payload,
+            crypto::SequenceSpace                space,
+            uint8_t                              channel,
+            SequenceNumber                       seq,
+            std::span<uint8_t, crypto::TAG_SIZE> tag);
+
+    /**
+     * @brief Check and decrypt the payload in place, false if it's forged or replayed
+     */
+    bool open(const wire::Header &header, std::span<uint8_t> datagram);
+    void transmitAck(const AckFrame &ack, const SocketAddress &peer);
+    void transmitFeedback(const FeedbackFrame &frame, const SocketAddress &peer);
+
+    /**
+     * @brief Seal and send a control frame whose payload is already in sendBuffer_
+     */
+    void transmitControl(wire::Header header, const SocketAddress &peer);
+    void deliver(const PacketInfo &packet, PacketsQueue *in_packets);
+
+    /**
+     * @brief Return block of an outgoing packet, fragment releases its frame if it's the last one
+     *
+     * Buffers which are not from either pool are left alone.
+     */
+    void releasePacket(const PacketInfo &packet);
+    bool isFrame(const PacketInfo &packet) const;
+
+    /**
+     * @brief True if the packet is a fragment of a block of framePool_
+     */
+    bool isFragment(const PacketInfo &packet) const;
+
+    /**
+     * @brief Largest payload of one datagram, with room for the tag when encrypted
+     *        and for the FEC header of parity when FEC is enabled
+     */
+    auto maxPayloadSize() const -> std::size_t;
+
+    auto processDatagram(std::span<uint8_t> datagram, uint8_t *block) -> DatagramResult;
+    void processAck(const wire::Header &header, std::span<const uint8_t> payload);
+    void processFeedback(const wire::Header &header, std::span<const uint8_t> payload);
+    void pace(std::size_t bytes);
+
+    /**
+     * @brief Bitrate of congestion control, limited by tunables
+     */
+    auto pacingBitrate() const -> uint32_t;
 
 private:
     std::atomic_bool            stop_;
+    uint16_t                    port_;
+    std::shared_ptr<PacketPool> pool_;
     std::weak_ptr<PacketsQueue> inPackets_;
     std::weak_ptr<PacketsQueue> outPackets_;
     std::thread                 recvThread_;
     std::thread                 sendThread_;
+
+    UdpSocket        socket_;
+    ReliableChannels reliability_;
+
+    // Controller is created by create() with the final settings, pacer is
+    // used only by send thread
+    CongestionSettings                      congestionSettings_;
+    std::unique_ptr<CongestionController>   congestion_;
+    FeedbackBuilder                         feedback_;
+    Pacer                                   pacer_;
+    std::shared_ptr<BitrateTarget>          bitrateTarget_;
+    std::shared_ptr<const config::Tunables> tunables_;
+
+    // Multiplexer is created by create() and used only by send thread
+    mux::MultiplexerSettings                 multiplexerSettings_;
+    std::unique_ptr<mux::ChannelMultiplexer> multiplexer_;
+
+    std::atomic_bool hasPeer_;
+    SocketAddress    peer_;
+
+    // Acknowledgements and feedback are built in sendBuffer_. Packets are
+    // received into pool blocks, recvBuffer_ is used when the pool is exhausted.
+    std::array<uint8_t, MAX_DATAGRAM_SIZE> sendBuffer_;
+    std::array<uint8_t, MAX_DATAGRAM_SIZE> recvBuffer_;
+
+    // Encoder and sent groups are used only by send thread, decoder and
+    // received groups only by receive thread
+    std::unique_ptr<fec::FecEncoder>    fecEncoder_;
+    std::unique_ptr<fec::FecDecoder>    fecDecoder_;
+    std::array<FecGroup, CHANNEL_COUNT> fecSent_;
+    std::array<FecGroup, CHANNEL_COUNT> fecReceived_;
+
+    // Reassembler is used only by receive thread
+    fragment::Fragmenter                   fragmenter_;
+    std::shared_ptr<PacketPool>            framePool_;
+    std::unique_ptr<fragment::Reassembler> reassembler_;
+
+    // Sealer and control sequence numbers are used only by send thread,
+    // opener and replay windows only by receive thread. Extended sequence
+    // number of the last sealed packet and replay window of every sequence
+    // space are indexed by channel * SEQUENCE_SPACE_COUNT + space
+    static constexpr std::size_t SEQUENCE_SPACES = crypto::SEQUENCE_SPACE_COUNT * CHANNEL_COUNT;
+
+    std::unique_ptr<crypto::AesGcm>                   sealer_;
+    std::unique_ptr<crypto::AesGcm>                   opener_;
+    std::array<uint64_t, SEQUENCE_SPACES>             sealedIndex_ {};
+    std::array<crypto::ReplayWindow, SEQUENCE_SPACES> openedWindows_ {};
+    std::array<SequenceNumber, CHANNEL_COUNT>         controlSequence_ {};
+
+    ConnectionMetrics metrics_;
 };
 
 }; // namespace pirks::networking
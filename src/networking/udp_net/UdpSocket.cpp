@@ -0,0 +1,214 @@
+#include "UdpSocket.h"
+
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+#ifndef WINDOWS
+#include <arpa/inet.h>
+#include <cerrno>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace pirks::networking
+{
+
+namespace {
+
+#ifdef WINDOWS
+using SocketLength = int;
+
+auto lastError() -> int
+{
+    return WSAGetLastError();
+}
+
+void initializeWinsock()
+{
+    static std::once_flag once;
+    std::call_once(once, [] {
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+            throw std::runtime_error("WSAStartup failed");
+        }
+    });
+}
+#else
+using SocketLength = socklen_t;
+
+auto lastError() -> int
+{
+    return errno;
+}
+#endif
+
+} // namespace
+
+UdpSocket::UdpSocket()
+{
+#ifdef WINDOWS
+    initializeWinsock();
+#endif
+}
+
+UdpSocket::~UdpSocket()
+{
+    close();
+}
+
+void UdpSocket::bind(uint16_t port)
+{
+    close();
+
+    socket_ = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (socket_ == NO_SOCKET) {
+        throw std::runtime_error(fmt::format("Can't create UDP socket, error {}", lastError()));
+    }
+
+    sockaddr_in address {};
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port        = htons(port);
+
+    if (::bind(socket_, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+        const auto error = lastError();
+        close();
+        throw std::runtime_error(fmt::format("Can't bind UDP port {}, error {}", port, error));
+    }
+}
+
+auto UdpSocket::localPort() const -> uint16_t
+{
+    sockaddr_in  address {};
+    SocketLength length = sizeof(address);
+    if (::getsockname(socket_, reinterpret_cast<sockaddr *>(&address), &length) != 0) {
+        return 0;
+    }
+    return ntohs(address.sin_port);
+}
+
+void UdpSocket::setReceiveTimeout(std::chrono::milliseconds timeout)
+{
+#ifdef WINDOWS
+    const auto value = static_cast<DWORD>(timeout.count());
+#else
+    timeval value {};
+    value.tv_sec  = static_cast<decltype(value.tv_sec)>(timeout.count() / 1000);
+    value.tv_usec = static_cast<decltype(value.tv_usec)>((timeout.count() % 1000) * 1000);
+#endif
+
+    if (::setsockopt(
+                socket_,
+                SOL_SOCKET,
+                SO_RCVTIMEO,
+                reinterpret_cast<const char *>(&value),
+                sizeof(value))
+        != 0) {
+        spdlog::warn("Can't set UDP socket receive timeout, error {}", lastError());
+    }
+}
+
+bool UdpSocket::sendTo(std::span<const uint8_t> datagram, const SocketAddress &to)
+{
+    const auto sent = ::sendto(
+            socket_,
+            reinterpret_cast<const char *>(datagram.data()),
+            static_cast<SocketLength>(datagram.size()),
+            0,
+            reinterpret_cast<const sockaddr *>(&to.address),
+            sizeof(to.address));
+
+    return sent >= 0 && static_cast<std::size_t>(sent) == datagram.size();
+}
+
+bool UdpSocket::sendTo(
+        std::span<const uint8_t> header,
+        std::span<const uint8_t> payload,
+        std::span<const uint8_t> trailer,
+        const SocketAddress     &to)
+{
+    const auto size = header.size() + payload.size() + trailer.size();
+
+#ifdef WINDOWS
+    std::array<WSABUF, 3> buffers {};
+    buffers[0].buf = const_cast<char *>(reinterpret_cast<const char *>(header.data()));
+    buffers[0].len = static_cast<ULONG>(header.size());
+    buffers[1].buf = const_cast<char *>(reinterpret_cast<const char *>(payload.data()));
+    buffers[1].len = static_cast<ULONG>(payload.size());
+    buffers[2].buf = const_cast<char *>(reinterpret_cast<const char *>(trailer.data()));
+    buffers[2].len = static_cast<ULONG>(trailer.size());
+
+    DWORD sent = 0;
+    if (::WSASendTo(
+                socket_,
+                buffers.data(),
+                static_cast<DWORD>(buffers.size()),
+                &sent,
+                0,
+                reinterpret_cast<const sockaddr *>(&to.address),
+                sizeof(to.address),
+                nullptr,
+                nullptr)
+        != 0) {
+        return false;
+    }
+    return sent == size;
+#else
+    std::array<iovec, 3> buffers {};
+    buffers[0].iov_base = const_cast<uint8_t *>(header.data());
+    buffers[0].iov_len  = header.size();
+    buffers[1].iov_base = const_cast<uint8_t *>(payload.data());
+    buffers[1].iov_len  = payload.size();
+    buffers[2].iov_base = const_cast<uint8_t *>(trailer.data());
+    buffers[2].iov_len  = trailer.size();
+
+    msghdr message {};
+    message.msg_name    = const_cast<sockaddr_in *>(&to.address);
+    message.msg_namelen = sizeof(to.address);
+    message.msg_iov     = buffers.data();
+    message.msg_iovlen  = buffers.size();
+
+    const auto sent = ::sendmsg(socket_, &message, 0);
+    return sent >= 0 && static_cast<std::size_t>(sent) == size;
+#endif
+}
+
+auto UdpSocket::receiveFrom(std::span<uint8_t> buffer, SocketAddress &from)
+        -> std::optional<std::size_t>
+{
+    SocketLength length = sizeof(from.address);
+
+    const auto received = ::recvfrom(
+            socket_,
+            reinterpret_cast<char *>(buffer.data()),
+            static_cast<SocketLength>(buffer.size()),
+            0,
+            reinterpret_cast<sockaddr *>(&from.address),
+            &length);
+
+    if (received < 0) {
+        return std::nullopt;
+    }
+    return static_cast<std::size_t>(received);
+}
+
+void UdpSocket::close()
+{
+    if (socket_ == NO_SOCKET) {
+        return;
+    }
+
+#ifdef WINDOWS
+    ::closesocket(socket_);
+#else
+    ::close(socket_);
+#endif
+    socket_ = NO_SOCKET;
+}
+
+}; // namespace pirks::networking
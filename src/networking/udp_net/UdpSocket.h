@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#ifdef WINDOWS
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+namespace pirks::networking
+{
+
+/**
+ * @brief IPv4 address and port of the remote side
+ */
+struct SocketAddress
+{
+    sockaddr_in address {};
+
+    [[nodiscard]]
+    bool operator==(const SocketAddress &other) const
+    {
+        return address.sin_port == other.address.sin_port
+               && address.sin_addr.s_addr == other.address.sin_addr.s_addr;
+    }
+};
+
+/**
+ * @brief Thin wrapper around BSD / Winsock datagram socket
+ *
+ */
+class UdpSocket final
+{
+public:
+    UdpSocket();
+    ~UdpSocket();
+
+    UdpSocket(const UdpSocket &)            = delete;
+    UdpSocket &operator=(const UdpSocket &) = delete;
+
+public:
+    /**
+     * @brief Open socket and bind it to port on all interfaces, 0 - any free port
+     *
+     * Throws std::runtime_error on failure
+     */
+    void bind(uint16_t port);
+
+    /**
+     * @brief Port the socket is bound to
+     */
+    [[nodiscard]]
+    auto localPort() const -> uint16_t;
+
+    /**
+     * @brief receiveFrom() returns nullopt if nothing arrived during this time
+     */
+    void setReceiveTimeout(std::chrono::milliseconds timeout);
+
+    bool sendTo(std::span<const uint8_t> datagram, const SocketAddress &to);
+
+    /**
+     * @brief Send header, payload and trailer from different buffers as one
+     *        datagram, without copying. Trailer may be empty
+     */
+    bool sendTo(
+            std::span<const uint8_t> header,
+            std::span<const uint8_t> payload,
+            std::span<const uint8_t> trailer,
+            const SocketAddress     &to);
+
+    /**
+     * @return std::optional<std::size_t>  Size of received datagram, nullopt on timeout or error
+     */
+    [[nodiscard]]
+    auto receiveFrom(std::span<uint8_t> buffer, SocketAddress &from) -> std::optional<std::size_t>;
+
+    void close();
+
+private:
+#ifdef WINDOWS
+    using Handle                      = SOCKET;
+    static constexpr Handle NO_SOCKET = INVALID_SOCKET;
+#else
+    using Handle                      = int;
+    static constexpr Handle NO_SOCKET = -1;
+#endif
+
+    Handle socket_ { NO_SOCKET };
+};
+
+}; // namespace pirks::networking
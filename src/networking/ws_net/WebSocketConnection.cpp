@@ -0,0 +1,474 @@
+#include "WebSocketConnection.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "Logging.h"
+#include "trace/Trace.h"
+
+#ifdef WITH_LIBWEBSOCKETS
+#include <libwebsockets.h>
+#endif
+
+namespace pirks::networking::ws
+{
+
+auto frameMessage(const PacketInfo &packet, SequenceNumber sequence) -> std::span<uint8_t>
+{
+    const auto message = wire::headerBefore(packet.data);
+    wire::serialize(wire::packetHeader(packet, sequence), message);
+    return { message.data(), wire::HEADER_SIZE + packet.size };
+}
+
+MessageReader::MessageReader(std::shared_ptr<PacketPool> pool)
+        : pool_ { pool }
+{
+}
+
+MessageReader::~MessageReader()
+{
+    reset();
+}
+
+auto MessageReader::add(std::span<const uint8_t> data, bool binary, bool final)
+        -> std::optional<PacketInfo>
+{
+    if (!binary) {
+        dropped_ = true;
+    }
+
+    const auto headerCount = std::min(data.size(), wire::HEADER_SIZE - headerBytes_);
+    std::memcpy(header_.data() + headerBytes_, data.data(), headerCount);
+    headerBytes_ += headerCount;
+    data          = data.subspan(headerCount);
+
+    // Header goes to the headroom, so the whole message is checked by wire::parse()
+    if (headerBytes_ == wire::HEADER_SIZE && block_ == nullptr && !dropped_) {
+        block_ = pool_->acquire();
+        if (block_ != nullptr) {
+            std::copy(header_.begin(), header_.end(), wire::headerBefore(block_).begin());
+        } else {
+            spdlog::debug("WebSocketConnection: no block for message, dropped");
+            dropped_ = true;
+        }
+    }
+
+    if (!data.empty() && block_ != nullptr && !dropped_) {
+        if (payloadBytes_ + data.size() <= pool_->blockSize()) {
+            std::memcpy(block_ + payloadBytes_, data.data(), data.size());
+            payloadBytes_ += data.size();
+        } else {
+            dropped_ = true;
+        }
+    }
+
+    if (!final) {
+        return std::nullopt;
+    }
+
+    std::optional<PacketInfo> packet;
+    if (!dropped_ && block_ != nullptr) {
+        const auto header = wire::parse(std::span<const uint8_t> {
+                wire::headerBefore(block_).data(),
+                wire::HEADER_SIZE + payloadBytes_ });
+
+        if (header && (header->flags & ~wire::Flags::Reliable) == 0) {
+            packet                = PacketInfo {};
+            packet->channel       = header->channel;
+            packet->reliable      = (header->flags & wire::Flags::Reliable) != 0;
+            packet->sequence      = header->sequence;
+            packet->size          = header->payloadSize;
+            packet->timestamp     = header->timestamp;
+            packet->fragmentIndex = header->fragmentIndex;
+            packet->fragmentCount = header->fragmentCount;
+            packet->data          = std::exchange(block_, nullptr);
+        }
+    }
+
+    if (block_ != nullptr || dropped_) {
+        spdlog::debug("WebSocketConnection: malformed message dropped");
+    }
+    reset();
+
+    return packet;
+}
+
+void MessageReader::reset()
+{
+    pool_->release(std::exchange(block_, nullptr));
+    headerBytes_  = 0;
+    payloadBytes_ = 0;
+    dropped_      = false;
+}
+
+#ifdef WITH_LIBWEBSOCKETS
+
+static_assert(
+        LWS_PRE <= WebSocketConnection::PACKET_HEADROOM - wire::HEADER_SIZE,
+        "WebSocket frame header must fit the headroom in front of the wire header");
+
+namespace {
+
+// Messages of one packet with its wire header usually arrive whole
+constexpr std::size_t RX_BUFFER_SIZE = 2048;
+
+} // namespace
+
+struct WebSocketConnection::Timer
+{
+    lws_sorted_usec_list_t sul {};
+    WebSocketConnection   *connection { nullptr };
+};
+
+/**
+ * @brief C callbacks of libwebsockets, forwarded to the connection
+ */
+struct Callbacks
+{
+    static int event(lws *wsi, lws_callback_reasons reason, void *, void *in, size_t len)
+    {
+        auto *connection = static_cast<WebSocketConnection *>(
+                lws_context_user(lws_get_context(wsi)));
+        if (connection == nullptr) {
+            return 0;
+        }
+        return connection->onEvent(wsi, static_cast<int>(reason), in, len) ? 0 : -1;
+    }
+
+    static void timer(lws_sorted_usec_list_t *sul)
+    {
+        lws_container_of(sul, WebSocketConnection::Timer, sul)->connection->onTimer();
+    }
+};
+
+namespace {
+
+const lws_protocols PROTOCOLS[] = {
+    { WebSocketConnection::PROTOCOL, Callbacks::event, 0, RX_BUFFER_SIZE, 0, nullptr, 0 },
+    { nullptr, nullptr, 0, 0, 0, nullptr, 0 },
+};
+
+const lws_extension EXTENSIONS[] = {
+    { "permessage-deflate",
+      lws_extension_callback_pm_deflate,
+      "permessage-deflate; client_no_context_takeover" },
+    { nullptr, nullptr, nullptr },
+};
+
+} // namespace
+
+bool isAvailable()
+{
+    return true;
+}
+
+WebSocketConnection::WebSocketConnection(
+        const WebSocketSettings    &settings,
+        std::shared_ptr<PacketPool> pool)
+        : settings_ { settings }
+        , stop_ { false }
+        , pool_ { pool }
+        , reader_ { pool_ }
+        , connected_ { false }
+{
+    assert(pool_ && "packet pool is required");
+
+    if (pool_->headroom() < PACKET_HEADROOM) {
+        throw std::invalid_argument(
+                "WebSocketConnection: packet pool has no headroom for frame header");
+    }
+
+    lws_set_log_level(LLL_ERR | LLL_WARN, nullptr);
+
+    spdlog::debug("WebSocketConnection created");
+}
+
+WebSocketConnection::~WebSocketConnection()
+{
+    spdlog::debug("WebSocketConnection destructor");
+
+    stop_ = true;
+
+    if (context_ != nullptr) {
+        lws_cancel_service(context_);
+    }
+    if (serviceThread_.joinable()) {
+        serviceThread_.join();
+    }
+
+    if (context_ != nullptr) {
+        lws_context_destroy(context_);
+    }
+}
+
+void WebSocketConnection::create(
+        std::shared_ptr<PacketsQueue> in_packets,
+        std::shared_ptr<PacketsQueue> out_packets)
+{
+    inPackets_  = in_packets;
+    outPackets_ = out_packets;
+
+    const bool server = settings_.host.empty();
+
+    lws_context_creation_info info {};
+    info.port       = server ? settings_.port : CONTEXT_PORT_NO_LISTEN;
+    info.protocols  = PROTOCOLS;
+    info.extensions = settings_.perMessageDeflate ? EXTENSIONS : nullptr;
+    info.user       = this;
+
+    if (server && !settings_.certificateFile.empty()) {
+        info.options                 |= LWS_SERVER_OPTION_DO_SSL_GLOBAL_INIT;
+        info.ssl_cert_filepath        = settings_.certificateFile.c_str();
+        info.ssl_private_key_filepath = settings_.privateKeyFile.c_str();
+    }
+
+    context_ = lws_create_context(&info);
+    if (context_ == nullptr) {
+        throw std::runtime_error("WebSocketConnection: context can't be created");
+    }
+
+    // Event loop sleeps until the socket or the timer wakes it up
+    timer_             = std::make_unique<Timer>();
+    timer_->connection = this;
+    lws_sul_schedule(context_, 0, &timer_->sul, Callbacks::timer, SEND_POLL_INTERVAL_US);
+
+    if (server) {
+        localPort_ = static_cast<uint16_t>(
+                lws_get_vhost_listen_port(lws_get_vhost_by_name(context_, "default")));
+
+        spdlog::debug("WebSocketConnection listening on port {}", localPort_);
+    } else {
+        lws_client_connect_info connect {};
+        connect.context  = context_;
+        connect.address  = settings_.host.c_str();
+        connect.port     = settings_.port;
+        connect.path     = settings_.path.c_str();
+        connect.host     = connect.address;
+        connect.origin   = connect.address;
+        connect.protocol = PROTOCOL;
+
+        if (lws_client_connect_via_info(&connect) == nullptr) {
+            throw std::runtime_error("WebSocketConnection: can't connect to " + settings_.host);
+        }
+
+        spdlog::debug("WebSocketConnection connecting to {}:{}", settings_.host, settings_.port);
+    }
+
+    serviceThread_ = std::thread(serviceThreadFunc, this);
+}
+
+auto WebSocketConnection::localPort() const -> uint16_t
+{
+    return localPort_;
+}
+
+void WebSocketConnection::serviceThreadFunc(WebSocketConnection *connection)
+{
+    trace::setThreadName("ws-service");
+
+    while (!connection->stop_) {
+        if (lws_service(connection->context_, 0) < 0) {
+            break;
+        }
+    }
+}
+
+bool WebSocketConnection::onEvent(lws *wsi, int reason, void *in, std::size_t len)
+{
+    switch (reason) {
+    case LWS_CALLBACK_ESTABLISHED:
+    case LWS_CALLBACK_CLIENT_ESTABLISHED:
+        if (wsi_ != nullptr) {
+            spdlog::warn("WebSocketConnection: remote side is already connected, refused");
+            return false;
+        }
+        wsi_       = wsi;
+        connected_ = true;
+        spdlog::info("WebSocketConnection: remote side connected");
+        break;
+
+    case LWS_CALLBACK_SERVER_WRITEABLE:
+    case LWS_CALLBACK_CLIENT_WRITEABLE:
+        return wsi != wsi_ || write(wsi);
+
+    case LWS_CALLBACK_RECEIVE:
+    case LWS_CALLBACK_CLIENT_RECEIVE:
+        if (wsi == wsi_) {
+            receive(wsi, { static_cast<const uint8_t *>(in), len });
+        }
+        break;
+
+    case LWS_CALLBACK_CLOSED:
+    case LWS_CALLBACK_CLIENT_CLOSED:
+        if (wsi == wsi_) {
+            wsi_       = nullptr;
+            connected_ = false;
+            reader_.reset();
+            spdlog::info("WebSocketConnection: remote side disconnected");
+        }
+        break;
+
+    case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
+        spdlog::error(
+                "WebSocketConnection: can't connect, {}",
+                in != nullptr ? static_cast<const char *>(in) : "unknown error");
+        break;
+
+    default:
+        break;
+    }
+
+    return true;
+}
+
+void WebSocketConnection::onTimer()
+{
+    if (wsi_ == nullptr) {
+        // Nobody to send to yet
+        dropPackets();
+    } else if (auto out = outPackets_.lock(); out && !out->isEmpty()) {
+        lws_callback_on_writable(wsi_);
+    }
+
+    lws_sul_schedule(context_, 0, &timer_->sul, Callbacks::timer, SEND_POLL_INTERVAL_US);
+}
+
+bool WebSocketConnection::write(lws *wsi)
+{
+    auto out = outPackets_.lock();
+    if (!out) {
+        return true;
+    }
+
+    // Several packets per writable event, as long as the kernel takes them
+    while (!lws_send_pipe_choked(wsi)) {
+        const auto packet = out->pop();
+        if (!packet) {
+            return true;
+        }
+        PIRKS_TRACE_SCOPE("ws", "send");
+        if (!writePacket(wsi, *packet)) {
+            return false;
+        }
+    }
+
+    lws_callback_on_writable(wsi);
+    return true;
+}
+
+bool WebSocketConnection::writePacket(lws *wsi, const PacketInfo &packet)
+{
+    assert(pool_->owns(packet.data) && "packet must be in a block of the packet pool");
+
+    if (packet.channel >= CHANNEL_COUNT) {
+        PIRKS_ERROR_LIMITED(
+                "WebSocketConnection: packet of unknown channel {} dropped",
+                packet.channel);
+        pool_->release(packet.data);
+        return true;
+    }
+
+    auto      &sequence = packet.reliable ? reliableSequence_ : unreliableSequence_;
+    const auto message  = frameMessage(packet, sequence[packet.channel]++);
+
+    // Frame header goes to LWS_PRE bytes in front of the message. What the
+    // socket does not take is buffered by libwebsockets, so the block is free
+    // either way.
+    const auto written = lws_write(wsi, message.data(), message.size(), LWS_WRITE_BINARY);
+    pool_->release(packet.data);
+
+    return written >= 0;
+}
+
+void WebSocketConnection::receive(lws *wsi, std::span<const uint8_t> data)
+{
+    const auto packet = reader_.add(
+            data,
+            lws_frame_is_binary(wsi) != 0,
+            lws_is_final_fragment(wsi) != 0);
+    if (packet) {
+        deliver(*packet);
+    }
+}
+
+void WebSocketConnection::deliver(const PacketInfo &packet)
+{
+    auto in = inPackets_.lock();
+    if (!in) {
+        pool_->release(packet.data);
+        return;
+    }
+
+    in->push(packet);
+}
+
+void WebSocketConnection::dropPackets()
+{
+    auto out = outPackets_.lock();
+    if (!out) {
+        return;
+    }
+
+    while (const auto packet = out->pop()) {
+        pool_->release(packet->data);
+    }
+}
+
+#else
+
+bool isAvailable()
+{
+    return false;
+}
+
+struct WebSocketConnection::Timer
+{
+};
+
+WebSocketConnection::WebSocketConnection(
+        const WebSocketSettings    &settings,
+        std::shared_ptr<PacketPool> pool)
+        : settings_ { settings }
+        , stop_ { false }
+        , pool_ { pool }
+        , reader_ { pool_ }
+        , connected_ { false }
+{
+    assert(pool_ && "packet pool is required");
+
+    if (pool_->headroom() < PACKET_HEADROOM) {
+        throw std::invalid_argument(
+                "WebSocketConnection: packet pool has no headroom for frame header");
+    }
+
+    throw std::runtime_error("WebSocketConnection: built without libwebsockets");
+}
+
+WebSocketConnection::~WebSocketConnection() = default;
+
+void WebSocketConnection::create(
+        std::shared_ptr<PacketsQueue> in_packets,
+        std::shared_ptr<PacketsQueue> out_packets)
+{
+    inPackets_  = in_packets;
+    outPackets_ = out_packets;
+}
+
+auto WebSocketConnection::localPort() const -> uint16_t
+{
+    return localPort_;
+}
+
+#endif
+
+bool WebSocketConnection::isConnected() const
+{
+    return connected_;
+}
+
+}; // namespace pirks::networking::ws
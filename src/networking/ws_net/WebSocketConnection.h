@@ -0,0 +1,191 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+
+#include "../IConnection.h"
+#include "../PacketPool.h"
+#include "../WireHeader.h"
+
+// Context and connection of libwebsockets, so its headers stay out of ours
+struct lws;
+struct lws_context;
+
+namespace pirks::networking::ws
+{
+
+/**
+ * @brief true if the library is built with libwebsockets
+ */
+[[nodiscard]]
+bool isAvailable();
+
+struct WebSocketSettings
+{
+    std::string host; ///< Client connects to host:port, empty - server listens on port
+    uint16_t    port { 0 };
+    std::string path { "/" };
+    std::string certificateFile; ///< PEM certificate, server uses wss:// when it's set
+    std::string privateKeyFile;  ///< PEM private key of the certificate
+
+    /**
+     * Negotiate permessage-deflate. It compresses every message of the
+     * connection, and encoded audio and video don't get smaller, so it's off
+     */
+    bool perMessageDeflate { false };
+};
+
+/**
+ * @brief Writes the wire header of a packet from a pool block with
+ *        wire::PACKET_HEADROOM in front of its payload, returns the message to send
+ */
+[[nodiscard]]
+auto frameMessage(const PacketInfo &packet, SequenceNumber sequence) -> std::span<uint8_t>;
+
+/**
+ * @brief Collects a received message, which may come in several fragments,
+ *        into a block of the pool
+ *
+ * Text messages, messages bigger than a block, malformed ones and the ones
+ * with flags other than Reliable are dropped. Blocks must have
+ * wire::PACKET_HEADROOM, the header is checked in place together with the
+ * payload.
+ */
+class MessageReader
+{
+public:
+    explicit MessageReader(std::shared_ptr<PacketPool> pool);
+    ~MessageReader();
+
+    MessageReader(const MessageReader &)            = delete;
+    MessageReader &operator=(const MessageReader &) = delete;
+
+    /**
+     * @brief Adds the next fragment of the message, returns the packet when the
+     *        final fragment completes a valid one. Its data is a block of the pool
+     */
+    [[nodiscard]]
+    auto add(std::span<const uint8_t> data, bool binary, bool final) -> std::optional<PacketInfo>;
+
+    /**
+     * @brief Drops the message being received
+     */
+    void reset();
+
+private:
+    std::shared_ptr<PacketPool>            pool_;
+    std::array<uint8_t, wire::HEADER_SIZE> header_ {};
+    std::size_t                            headerBytes_ { 0 };
+    uint8_t                               *block_ { nullptr };
+    std::size_t                            payloadBytes_ { 0 };
+    bool                                   dropped_ { false };
+};
+
+/**
+ * @brief WebSocket connection over libwebsockets, for browser clients
+ *
+ * Every packet is one binary message: wire header followed by the payload.
+ * WebSocket runs over TCP, so every packet arrives and in order, reliable
+ * or not.
+ *
+ * One thread runs the event loop of libwebsockets and does everything:
+ * accepts the remote side, writes packets from out_packets when the socket
+ * is writable and reads messages. Packets are written straight from pool
+ * blocks - the frame header of WebSocket goes to the headroom in front of
+ * the wire header, so the pool must have PACKET_HEADROOM. Received messages
+ * are copied into pool blocks once.
+ *
+ * Server accepts one remote side at a time; client connects to
+ * settings.host.
+ */
+class WebSocketConnection final: public IConnection
+{
+public:
+    // Subprotocol both sides must ask for
+    static constexpr const char *PROTOCOL = "pirks";
+
+    // Bytes every pool block needs in front of the payload: wire header and
+    // LWS_PRE for the WebSocket frame header
+    static constexpr std::size_t PACKET_HEADROOM = wire::HEADER_SIZE + 16;
+
+    // How often event loop looks for new outgoing packets, the worst extra
+    // delay of an outgoing packet
+    static constexpr uint32_t SEND_POLL_INTERVAL_US = 500;
+
+public:
+    /**
+     * @brief Throws std::invalid_argument if the pool has no PACKET_HEADROOM,
+     *        std::runtime_error if libwebsockets is not available
+     */
+    WebSocketConnection(const WebSocketSettings &settings, std::shared_ptr<PacketPool> pool);
+    ~WebSocketConnection() override;
+
+    WebSocketConnection(const WebSocketConnection &)            = delete;
+    WebSocketConnection &operator=(const WebSocketConnection &) = delete;
+
+public:
+    void create(
+            std::shared_ptr<PacketsQueue> in_packets, //
+            std::shared_ptr<PacketsQueue> out_packets) override;
+
+    /**
+     * @brief true after the WebSocket handshake with the remote side is done
+     */
+    [[nodiscard]]
+    bool isConnected() const;
+
+    /**
+     * @brief Port the server listens on. Valid after create()
+     */
+    [[nodiscard]]
+    auto localPort() const -> uint16_t;
+
+private:
+    struct Timer;
+
+private:
+    static void serviceThreadFunc(WebSocketConnection *connection);
+
+    /**
+     * @brief Event of libwebsockets, returns false if the connection must be closed
+     */
+    bool onEvent(lws *wsi, int reason, void *in, std::size_t len);
+    void onTimer();
+
+    bool write(lws *wsi);
+    bool writePacket(lws *wsi, const PacketInfo &packet);
+    void receive(lws *wsi, std::span<const uint8_t> data);
+    void deliver(const PacketInfo &packet);
+    void dropPackets();
+
+    friend struct Callbacks;
+
+private:
+    WebSocketSettings           settings_;
+    std::atomic_bool            stop_;
+    std::shared_ptr<PacketPool> pool_;
+    std::weak_ptr<PacketsQueue> inPackets_;
+    std::weak_ptr<PacketsQueue> outPackets_;
+    std::thread                 serviceThread_;
+
+    // Everything below is used only by service thread after create()
+    lws_context           *context_ { nullptr };
+    lws                   *wsi_ { nullptr };
+    std::unique_ptr<Timer> timer_;
+    MessageReader          reader_;
+    std::atomic_bool       connected_;
+    uint16_t               localPort_ { 0 };
+
+    // Sequence numbers of unreliable and reliable packets
+    std::array<SequenceNumber, CHANNEL_COUNT> unreliableSequence_ {};
+    std::array<SequenceNumber, CHANNEL_COUNT> reliableSequence_ {};
+};
+
+}; // namespace pirks::networking::ws
@@ -2,8 +2,17 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+
+#include "EnetConnection.h"
+#include "PcapReplayer.h"
+#include "QuicConnection.h"
 #include "TCPConnection.h"
+#include "TestPatternSource.h"
 #include "UDPConnection.h"
+#include "WebSocketConnection.h"
+#include "WireHeader.h"
+#include "trace/Trace.h"
 
 namespace pirks
 {
@@ -11,50 +20,251 @@ namespace pirks
 using namespace ::pirks::config;
 using namespace ::pirks::networking;
 
-Server::Server(ServerConfig::ConnectionType connectionType)
-        : connectionType_ { connectionType }
+namespace {
+
+// Payload of one packet should fit into ethernet MTU with IP, UDP and wire headers
+constexpr std::size_t PACKET_BLOCK_SIZE  = 1408;
+constexpr std::size_t PACKET_BLOCK_COUNT = 4096;
+
+// Encoded slice sent as one fragmented frame, bigger ones are split into packets
+constexpr std::size_t FRAME_BLOCK_SIZE  = 512 * 1024;
+constexpr std::size_t FRAME_BLOCK_COUNT = 16;
+
+// Packets waiting in each of the queues
+constexpr std::size_t QUEUE_CAPACITY = 256;
+
+// Lowest bitrate congestion control may ask the encoder for
+constexpr uint32_t MIN_BITRATE_KBPS = 500;
+
+// Size of generated frames of --test-pattern
+constexpr uint32_t TEST_PATTERN_WIDTH  = 1280;
+constexpr uint32_t TEST_PATTERN_HEIGHT = 720;
+
+} // namespace
+
+Server::Server(const ServerConfig &config)
+        : connectionType_ { config.connectionType() }
+        , port_ { config.port() }
+        , quicCertificateFile_ { config.quicCertificateFile() }
+        , quicPrivateKeyFile_ { config.quicPrivateKeyFile() }
+        , metricsPort_ { config.metricsPort() }
+        , metricsSocket_ { config.metricsSocket() }
+        , testPattern_ { config.testPattern() }
+        , tunables_ { config.tunables() }
+        , hugePages_ { config.hugePages() }
+        , hugePageSettings_ { config.hugePageSettings() }
+        , captureFile_ { config.captureFile() }
+        , replayFile_ { config.replayFile() }
+        , replaySpeed_ { config.replaySpeed() }
         , connection_ { nullptr }
 {
-    //
+    encoderSettings_.bitrateKbps = config.bitrateKbps();
+    encoderSettings_.gopLength   = config.gopLength();
+    encoderSettings_.sliceCount  = config.sliceCount();
+    encoderSettings_.fps         = config.fps();
+
+    fecSettings_.dataShards   = config.fecDataShards();
+    fecSettings_.parityShards = config.fecParityShards();
 }
 
 Server::~Server()
 {
-    //
+    stopVideo();
 }
 
 void Server::run()
 {
+    PIRKS_TRACE_SCOPE("server", "run");
+
     spdlog::info("Run server");
 
-    inPackets_.reset(new networking::PacketsQueue());
-    outPackets_.reset(new networking::PacketsQueue());
+    std::shared_ptr<const BitrateTarget> bitrateTarget;
+
+    // Wire header is written in front of the payload and authentication tag
+    // after it without copying the payload. QUIC also keeps its send
+    // descriptor in front of the header and WebSocket its frame header.
+    auto headroom = wire::PACKET_HEADROOM;
+    if (connectionType_ == ServerConfig::ConnectionType::QUIC) {
+        headroom = quic::QuicConnection::PACKET_HEADROOM;
+    } else if (connectionType_ == ServerConfig::ConnectionType::WebSocket) {
+        headroom = ws::WebSocketConnection::PACKET_HEADROOM;
+    }
+    // Pools and queues take all memory of streaming at once, so it can be
+    // on huge pages
+    auto *resource = std::pmr::get_default_resource();
+    if (hugePages_) {
+        memory_.reset(new memory::HugePageResource(hugePageSettings_));
+        resource = memory_.get();
+    }
+
+    packetPool_ = std::make_shared<PacketPool>(
+            PACKET_BLOCK_SIZE,
+            PACKET_BLOCK_COUNT,
+            headroom,
+            wire::PACKET_TAILROOM,
+            resource);
+    inPackets_.reset(new networking::PacketsQueue(QUEUE_CAPACITY, resource));
+    outPackets_.reset(new networking::PacketsQueue(QUEUE_CAPACITY, resource));
+
+    auto &registry = metrics::Registry::instance();
+    inPackets_->setDepthGauge(&registry.gauge(
+            "pirks_queue_depth",
+            "Packets waiting in a queue",
+            "queue=\"in\""));
+    outPackets_->setDepthGauge(&registry.gauge(
+            "pirks_queue_depth",
+            "Packets waiting in a queue",
+            "queue=\"out\""));
+
+    if (!captureFile_.empty()) {
+        capture_.reset(new capture::PcapWriter());
+        capture_->open(captureFile_);
+        inPackets_->setTap(&capture_->tap(capture::Direction::Inbound));
+        outPackets_->setTap(&capture_->tap(capture::Direction::Outbound));
+    }
+
+    if (metricsPort_ != 0 || !metricsSocket_.empty()) {
+        metricsExporter_.reset(new metrics::MetricsExporter());
+        if (metricsPort_ != 0) {
+            metricsExporter_->listenTcp(metricsPort_);
+        }
+        if (!metricsSocket_.empty()) {
+            metricsExporter_->listenUnix(metricsSocket_);
+        }
+        metricsExporter_->start();
+    }
 
     switch (connectionType_) {
     case ServerConfig::ConnectionType::Default:
         [[fallthrough]];
-    case ServerConfig::ConnectionType::UDP:
-        connection_.reset(new UDPConnection());
+    case ServerConfig::ConnectionType::UDP: {
+        auto *udp = new UDPConnection(port_, packetPool_);
+        connection_.reset(udp);
+        if (fecSettings_.parityShards != 0) {
+            udp->enableFec(fecSettings_);
+        }
+        udp->setTunables(tunables_);
+
+        framePool_ = std::make_shared<PacketPool>(
+                FRAME_BLOCK_SIZE,
+                FRAME_BLOCK_COUNT,
+                0,
+                0,
+                resource);
+        udp->enableFragmentation(framePool_);
+
+        // Configured bitrate is the upper limit, congestion control lowers it
+        // when the network can't carry it
+        CongestionSettings congestion;
+        congestion.startBitrateKbps = encoderSettings_.bitrateKbps;
+        congestion.maxBitrateKbps   = encoderSettings_.bitrateKbps;
+        congestion.minBitrateKbps   = std::min(MIN_BITRATE_KBPS, encoderSettings_.bitrateKbps);
+        udp->setCongestionSettings(congestion);
+
+        bitrateTarget = udp->bitrateTarget();
         break;
+    }
 
     case ServerConfig::ConnectionType::TCP:
         connection_.reset(new TCPConnection());
         break;
+
+    case ServerConfig::ConnectionType::QUIC: {
+        // Congestion control is done by QUIC itself, the encoder keeps the
+        // configured bitrate
+        quic::QuicSettings settings;
+        settings.port            = port_;
+        settings.certificateFile = quicCertificateFile_;
+        settings.privateKeyFile  = quicPrivateKeyFile_;
+        connection_.reset(new quic::QuicConnection(settings, packetPool_));
+        break;
+    }
+
+    case ServerConfig::ConnectionType::ENet: {
+        // ENet does its own flow control, the encoder keeps the configured bitrate
+        enet::EnetSettings settings;
+        settings.port = port_;
+        connection_.reset(new enet::EnetConnection(settings, packetPool_));
+        break;
+    }
+
+    case ServerConfig::ConnectionType::WebSocket: {
+        // TCP does the flow control, the encoder keeps the configured bitrate
+        ws::WebSocketSettings settings;
+        settings.port = port_;
+        connection_.reset(new ws::WebSocketConnection(settings, packetPool_));
+        break;
+    }
     }
 
     // Checking that connection was made
     assert(connection_ && "Connection is NULL, but should be already created");
 
     connection_->create(inPackets_, outPackets_);
+
+    // Encoder settings and the bitrate target are used only with a frame source
+    if (testPattern_) {
+        video::frame_source::TestPatternSettings pattern;
+        pattern.width  = TEST_PATTERN_WIDTH;
+        pattern.height = TEST_PATTERN_HEIGHT;
+        pattern.fps    = encoderSettings_.fps;
+        frameSource_.reset(new video::frame_source::TestPatternSource(pattern));
+
+        videoStream_.reset(new VideoStream(encoderSettings_, packetPool_, outPackets_));
+        if (bitrateTarget) {
+            videoStream_->setBitrateTarget(bitrateTarget);
+        }
+        if (framePool_) {
+            videoStream_->setFramePool(framePool_);
+        }
+        videoStream_->setTunables(tunables_);
+
+        videoThread_ = std::thread(videoThreadFunc, this);
+    }
+
+    // Captured traffic is played through the whole pipeline, as a load test
+    if (!replayFile_.empty()) {
+        capture::ReplaySettings settings;
+        settings.speed = replaySpeed_;
+
+        capture::PcapReplayer replayer { packetPool_, framePool_ };
+        replayer.replay(replayFile_, *inPackets_, *outPackets_, settings);
+    }
 }
 
 void Server::stop()
 {
     spdlog::info("Stop server");
 
+    stopVideo();
+    videoStream_.reset();
+    frameSource_.reset();
     connection_.reset();
+    capture_.reset();
     inPackets_.reset();
     outPackets_.reset();
+    metricsExporter_.reset();
+}
+
+void Server::videoThreadFunc(Server *server)
+{
+    trace::setThreadName("video");
+
+    while (!server->stopVideo_) {
+        const auto frame = server->frameSource_->next();
+        if (!frame) {
+            break;
+        }
+        server->videoStream_->submit(*frame);
+    }
+}
+
+void Server::stopVideo()
+{
+    stopVideo_ = true;
+    if (videoThread_.joinable()) {
+        videoThread_.join();
+    }
 }
 
 }; // namespace pirks
@@ -1,9 +1,19 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <string>
+#include <thread>
 
+#include "FecCodec.h"
+#include "HugePageResource.h"
 #include "IConnection.h"
+#include "IFrameSource.h"
+#include "MetricsExporter.h"
+#include "PacketPool.h"
+#include "PcapWriter.h"
 #include "ServerConfig.h"
+#include "VideoStream.h"
 
 namespace pirks
 {
@@ -11,7 +21,7 @@ namespace pirks
 class Server final
 {
 public:
-    explicit Server(config::ServerConfig::ConnectionType connectionType);
+    explicit Server(const config::ServerConfig &config);
     ~Server();
 
 public:
@@ -19,10 +29,41 @@ public:
     void stop();
 
 private:
-    config::ServerConfig::ConnectionType      connectionType_;
-    std::unique_ptr<networking::IConnection>  connection_;
-    std::shared_ptr<networking::PacketsQueue> inPackets_;
-    std::shared_ptr<networking::PacketsQueue> outPackets_;
+    static void videoThreadFunc(Server *server);
+
+    void stopVideo();
+
+private:
+    config::ServerConfig::ConnectionType               connectionType_;
+    uint16_t                                           port_;
+    std::string                                        quicCertificateFile_;
+    std::string                                        quicPrivateKeyFile_;
+    uint16_t                                           metricsPort_;
+    std::string                                        metricsSocket_;
+    video::encode_video::EncoderSettings               encoderSettings_;
+    bool                                               testPattern_;
+    networking::fec::FecSettings                       fecSettings_;
+    std::shared_ptr<const config::Tunables>            tunables_;
+    bool                                               hugePages_;
+    memory::HugePageSettings                           hugePageSettings_;
+    // Outlives everything allocated from it
+    std::unique_ptr<memory::HugePageResource>          memory_;
+    std::string                                        captureFile_;
+    std::string                                        replayFile_;
+    double                                             replaySpeed_;
+    // Destroyed after the connection, whose threads push into tapped queues
+    std::unique_ptr<networking::capture::PcapWriter>   capture_;
+    std::unique_ptr<networking::IConnection>           connection_;
+    std::shared_ptr<networking::PacketPool>            packetPool_;
+    std::shared_ptr<networking::PacketPool>            framePool_;
+    std::shared_ptr<networking::PacketsQueue>          inPackets_;
+    std::shared_ptr<networking::PacketsQueue>          outPackets_;
+    // Frames are submitted by videoThread_, which is stopped before both go
+    std::unique_ptr<video::frame_source::IFrameSource> frameSource_;
+    std::unique_ptr<VideoStream>                       videoStream_;
+    std::thread                                        videoThread_;
+    std::atomic_bool                                   stopVideo_ { false };
+    std::unique_ptr<metrics::MetricsExporter>          metricsExporter_;
 };
 
 }; // namespace pirks
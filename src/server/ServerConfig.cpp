@@ -11,18 +11,100 @@ void ServerConfig::addOptions(CLI::App &args)
 
     args.add_flag("-t,--tcp", isTCP_, "Use TCP/IP for networking");
     args.add_flag("-u,--udp", isUDP_, "Use UDP for networking");
+    args.add_flag("-q,--quic", isQUIC_, "Use QUIC for networking");
+    args.add_flag("-e,--enet", isENet_, "Use ENet reliable UDP for networking");
+    args.add_flag("-w,--websocket", isWebSocket_, "Use WebSocket for networking");
+
+    args.add_option("--bitrate", bitrateKbps_, "Video bitrate in kbps")
+            ->check(CLI::Range(100u, 500000u));
+    args.add_option("--gop", gopLength_, "Frames between video key frames, 0 - only on request");
+    args.add_option("--slices", sliceCount_, "Number of slices in one video frame")
+            ->check(CLI::Range(1u, 64u));
+    args.add_option("--fps", fps_, "Video frames per second")->check(CLI::Range(1u, 240u));
+    args.add_flag("--test-pattern", testPattern_, "Stream generated video frames");
+
+    args.add_option("--fec-data", fecDataShards_, "Data packets in one FEC group")
+            ->check(CLI::Range(1, 128));
+    args.add_option(
+                "--fec-parity",
+                fecParityShards_,
+                "Parity packets in one FEC group, 0 - FEC is disabled")
+            ->check(CLI::Range(0, 127));
+
+    args.add_option("--quic-cert", quicCertificateFile_, "PEM certificate of QUIC server")
+            ->check(CLI::ExistingFile);
+    args.add_option("--quic-key", quicPrivateKeyFile_, "PEM private key of QUIC server")
+            ->check(CLI::ExistingFile);
+
+    args.add_option(
+            "--metrics-port",
+            metricsPort_,
+            "Serve metrics on 127.0.0.1:port, 0 - disabled");
+    args.add_option("--metrics-socket", metricsSocket_, "Serve metrics on a Unix socket");
+
+    args.add_option("--trace", traceFile_, "Record trace events and write them to file on exit");
+
+    args.add_flag("--hugepages", hugePages_, "Allocate packet pools and queues on 2 MB pages");
+    args.add_flag(
+            "--prefault",
+            hugePageSettings_.prefault,
+            "Fault in pages of --hugepages at startup");
+    args.add_flag("--mlock", hugePageSettings_.lock, "Lock pages of --hugepages in memory");
+
+    args.add_option(
+            "--capture",
+            captureFile_,
+            "Write packets of the server queues to a pcapng file");
+    args.add_option(
+                "--replay",
+                replayFile_,
+                "Push packets of a capture file into the server queues, then exit")
+            ->check(CLI::ExistingFile);
+    args.add_option(
+                "--replay-speed",
+                replaySpeed_,
+                "Times faster than captured packets are replayed, 0 - as fast as possible")
+            ->check(CLI::Range(0.0, 1000.0));
+
+    // Applied again when the config file is reloaded
+    args.add_option(
+            "--max-bitrate",
+            maxBitrateKbps_,
+            "Upper limit of video bitrate in kbps, 0 - no limit, reloaded with config file");
+    args.add_option(
+            "--pacing-rate",
+            pacingKbps_,
+            "Upper limit of UDP sending rate in kbps, 0 - no limit, reloaded with config file");
+    args.add_option(
+            "--queue-limit",
+            queueLimit_,
+            "Outgoing packets after which video packets are dropped, 0 - whole queue, "
+            "reloaded with config file");
 }
 
 bool ServerConfig::parseOptions([[maybe_unused]] CLI::App &args)
 {
     Config::parseOptions(args);
 
-    if (isTCP_ && isUDP_) {
-        std::cout << "You can not use both TCP and UDP connection types at the same time."
+    if (int { isTCP_ } + int { isUDP_ } + int { isQUIC_ } + int { isENet_ } + int { isWebSocket_ }
+        > 1)
+    {
+        std::cout << "You can use only one of TCP, UDP, QUIC, ENet and WebSocket connection "
+                     "types at the same time."
                   << std::endl;
         return false;
     }
 
+    if (isQUIC_ && (quicCertificateFile_.empty() || quicPrivateKeyFile_.empty())) {
+        std::cout << "QUIC connection needs --quic-cert and --quic-key." << std::endl;
+        return false;
+    }
+
+    if (!hugePages_ && (hugePageSettings_.prefault || hugePageSettings_.lock)) {
+        std::cout << "--prefault and --mlock need --hugepages." << std::endl;
+        return false;
+    }
+
     if (isTCP_) {
         connectionType_ = ConnectionType::TCP;
     }
@@ -31,10 +113,26 @@ bool ServerConfig::parseOptions([[maybe_unused]] CLI::App &args)
         connectionType_ = ConnectionType::UDP;
     }
 
+    if (isQUIC_) {
+        connectionType_ = ConnectionType::QUIC;
+    }
+
+    if (isENet_) {
+        connectionType_ = ConnectionType::ENet;
+    }
+
+    if (isWebSocket_) {
+        connectionType_ = ConnectionType::WebSocket;
+    }
+
     if (connectionType_ == ConnectionType::Default) {
         connectionType_ = ConnectionType::UDP;
     }
 
+    tunables_->maxBitrateKbps = maxBitrateKbps_;
+    tunables_->pacingKbps     = pacingKbps_;
+    tunables_->queueLimit     = queueLimit_;
+
     return true;
 }
 
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <memory>
+
 #include "Config.h"
+#include "HugePageResource.h"
+#include "Tunables.h"
 
 namespace pirks::config
 {
@@ -13,9 +17,9 @@ public:
         Default = 0, ///< Default (for now default is UDP)
         UDP,         ///< Use UDP for networking
         TCP,         ///< Use TCP/IP for networking
-        // TODO: libwebsockets
-        // TODO: enet
-        // TODO: quic
+        QUIC,        ///< Use QUIC for networking
+        ENet,        ///< Use ENet reliable UDP for networking
+        WebSocket,   ///< Use WebSocket for networking, for browser clients
     };
 
 public:
@@ -24,6 +28,102 @@ public:
         return connectionType_;
     }
 
+    auto bitrateKbps() const -> uint32_t
+    {
+        return bitrateKbps_;
+    }
+
+    auto gopLength() const -> uint32_t
+    {
+        return gopLength_;
+    }
+
+    auto sliceCount() const -> uint32_t
+    {
+        return sliceCount_;
+    }
+
+    auto fps() const -> uint32_t
+    {
+        return fps_;
+    }
+
+    /**
+     * @brief Stream generated frames, there is no screen capture yet
+     */
+    auto testPattern() const -> bool
+    {
+        return testPattern_;
+    }
+
+    auto fecDataShards() const -> uint8_t
+    {
+        return fecDataShards_;
+    }
+
+    auto fecParityShards() const -> uint8_t
+    {
+        return fecParityShards_;
+    }
+
+    auto quicCertificateFile() const -> const std::string &
+    {
+        return quicCertificateFile_;
+    }
+
+    auto quicPrivateKeyFile() const -> const std::string &
+    {
+        return quicPrivateKeyFile_;
+    }
+
+    auto metricsPort() const -> uint16_t
+    {
+        return metricsPort_;
+    }
+
+    auto metricsSocket() const -> const std::string &
+    {
+        return metricsSocket_;
+    }
+
+    auto traceFile() const -> const std::string &
+    {
+        return traceFile_;
+    }
+
+    auto hugePages() const -> bool
+    {
+        return hugePages_;
+    }
+
+    auto hugePageSettings() const -> const memory::HugePageSettings &
+    {
+        return hugePageSettings_;
+    }
+
+    auto captureFile() const -> const std::string &
+    {
+        return captureFile_;
+    }
+
+    auto replayFile() const -> const std::string &
+    {
+        return replayFile_;
+    }
+
+    auto replaySpeed() const -> double
+    {
+        return replaySpeed_;
+    }
+
+    /**
+     * @brief Settings applied while the server runs, shared with the pipeline
+     */
+    auto tunables() const -> const std::shared_ptr<Tunables> &
+    {
+        return tunables_;
+    }
+
 protected:
     void addOptions(CLI::App &args) override;
     bool parseOptions(CLI::App &args) override;
@@ -31,9 +131,51 @@ protected:
 private:
     ConnectionType connectionType_ { ConnectionType::Default };
 
+    // Video encoder options
+    uint32_t bitrateKbps_ { 10000 };
+    uint32_t gopLength_ { 0 };
+    uint32_t sliceCount_ { 4 };
+    uint32_t fps_ { 60 };
+
+    // Video source, without one encoder options are unused
+    bool testPattern_ { false };
+
+    // Forward error correction options, 0 parity shards disables FEC
+    uint8_t fecDataShards_ { 8 };
+    uint8_t fecParityShards_ { 0 };
+
+    // TLS credentials of QUIC server
+    std::string quicCertificateFile_;
+    std::string quicPrivateKeyFile_;
+
+    // Prometheus text endpoint, 0 port and empty socket path - not served
+    uint16_t    metricsPort_ { 0 };
+    std::string metricsSocket_;
+
+    // Chrome trace event file, empty - nothing is recorded
+    std::string traceFile_;
+
+    // Packet pools and queues on huge pages, prefaulted and locked if asked
+    bool                     hugePages_ { false };
+    memory::HugePageSettings hugePageSettings_;
+
+    // pcapng files of packets in the server queues, empty - nothing is captured or replayed
+    std::string captureFile_;
+    std::string replayFile_;
+    double      replaySpeed_ { 1.0 };
+
+    // Options below are copied to tunables_, 0 - no limit
+    uint32_t                  maxBitrateKbps_ { 0 };
+    uint32_t                  pacingKbps_ { 0 };
+    uint32_t                  queueLimit_ { 0 };
+    std::shared_ptr<Tunables> tunables_ { std::make_shared<Tunables>() };
+
     // this members needed only to read config options from command line
     bool isTCP_ { false };
     bool isUDP_ { false };
+    bool isQUIC_ { false };
+    bool isENet_ { false };
+    bool isWebSocket_ { false };
 };
 
 }; // namespace pirks::config
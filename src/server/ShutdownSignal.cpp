@@ -0,0 +1,49 @@
+#include "ShutdownSignal.h"
+
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <thread>
+
+namespace pirks
+{
+
+namespace {
+
+// How often the waiting thread checks for a signal
+constexpr auto POLL_INTERVAL = std::chrono::milliseconds(200);
+
+// Lock-free, so it can be set from a signal handler
+std::atomic_int g_signal { 0 };
+
+static_assert(std::atomic_int::is_always_lock_free);
+
+extern "C" void onShutdownSignal(int signal)
+{
+    g_signal.store(signal, std::memory_order_relaxed);
+}
+
+} // namespace
+
+void waitForShutdownSignal()
+{
+    g_signal = 0;
+    std::signal(SIGINT, onShutdownSignal);
+    std::signal(SIGTERM, onShutdownSignal);
+
+    spdlog::info("Press Ctrl+C to stop");
+
+    int received = 0;
+    while ((received = g_signal.load(std::memory_order_relaxed)) == 0) {
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+
+    spdlog::info("Signal {} received", received);
+}
+
+}; // namespace pirks
@@ -0,0 +1,14 @@
+#pragma once
+
+namespace pirks
+{
+
+/**
+ * @brief Block until SIGINT or SIGTERM is received
+ *
+ * Handlers are installed for the call only, so a second signal while the
+ * server is being stopped terminates the process as usual.
+ */
+void waitForShutdownSignal();
+
+}; // namespace pirks
@@ -0,0 +1,273 @@
+#include "VideoStream.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "ColorConvert.h"
+#include "Logging.h"
+#include "trace/Trace.h"
+
+namespace pirks
+{
+
+using namespace ::pirks::networking;
+using namespace ::video::encode_video;
+using namespace ::video::frame_diff;
+
+namespace {
+
+// Current time in VIDEO_CLOCK_RATE units, wraps around like RTP timestamps
+auto videoTimestamp() -> std::uint32_t
+{
+    const auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch());
+    return static_cast<std::uint32_t>(now.count() * VIDEO_CLOCK_RATE / 1'000'000);
+}
+
+} // namespace
+
+VideoStream::VideoStream(
+        const EncoderSettings        &settings,
+        std::shared_ptr<PacketPool>   pool,
+        std::shared_ptr<PacketsQueue> out_packets)
+        : settings_ { settings }
+        , pool_ { std::move(pool) }
+        , outPackets_ { out_packets }
+        , configuredBitrateKbps_ { settings.bitrateKbps }
+        , frameInterval_ { metrics::Registry::instance().histogram(
+                  "pirks_video_frame_interval_seconds",
+                  "Time between frames reaching the video pipeline") }
+        , diffTime_ { metrics::Registry::instance().histogram(
+                  "pirks_video_diff_seconds",
+                  "Time to compare a frame with the previous one") }
+        , convertTime_ { metrics::Registry::instance().histogram(
+                  "pirks_video_convert_seconds",
+                  "Time to convert dirty tiles of a frame to I420") }
+        , encodeTime_ { metrics::Registry::instance().histogram(
+                  "pirks_video_encode_seconds",
+                  "Time to encode a frame, as reported by the encoder") }
+        , submitTime_ { metrics::Registry::instance().histogram(
+                  "pirks_video_submit_seconds",
+                  "Time from a frame submitted to its last packet queued") }
+        , droppedCounter_ { metrics::Registry::instance().counter(
+                  "pirks_video_packets_dropped_total",
+                  "Video packets dropped because the output queue or pool was full") }
+{
+    assert(pool_ && "Packet pool is NULL");
+
+    static constexpr std::array<const char *, 3> DECISIONS = { "full", "partial", "repeat" };
+    for (std::size_t i = 0; i < frames_.size(); ++i) {
+        frames_[i] = &metrics::Registry::instance().counter(
+                "pirks_video_frames_total",
+                "Frames submitted to the video pipeline by frame diff decision",
+                fmt::format("decision=\"{}\"", DECISIONS[i]));
+    }
+}
+
+auto VideoStream::submit(const video::FrameView &frame) -> VideoFrameStats
+{
+    PIRKS_TRACE_SCOPE("video", "submit");
+
+    VideoFrameStats stats;
+
+    const auto submitted = std::chrono::steady_clock::now();
+    if (lastFrame_.time_since_epoch().count() != 0) {
+        frameInterval_.record(submitted - lastFrame_);
+    }
+    lastFrame_ = submitted;
+
+    const auto diff = frameDiff_.compare(frame);
+    stats.decision  = diff.decision;
+
+    diffTime_.record(std::chrono::steady_clock::now() - submitted);
+    frames_[static_cast<std::size_t>(diff.decision)]->add();
+
+    // Nothing changed, so there is nothing to encode or send
+    if (diff.decision == FrameDecision::Repeat) {
+        return stats;
+    }
+
+    bool fullFrame = diff.decision == FrameDecision::Full;
+
+    if (!encoder_ || encoder_->settings().width != frame.width
+        || encoder_->settings().height != frame.height)
+    {
+        if (!openEncoder(frame)) {
+            // Keep trying with the next frames, even if they are the same
+            frameDiff_.invalidate();
+            return stats;
+        }
+
+        // New encoder starts with a key frame, so all tiles must be converted
+        fullFrame = true;
+    }
+
+    if (bitrateTarget_ || tunables_) {
+        auto bitrate = bitrateTarget_ ? bitrateTarget_->get() : configuredBitrateKbps_;
+        if (tunables_) {
+            if (const auto limit = tunables_->maxBitrateKbps.load(std::memory_order_relaxed)) {
+                bitrate = std::min(bitrate, limit);
+            }
+        }
+
+        if (bitrate != settings_.bitrateKbps) {
+            spdlog::debug("Video bitrate {} -> {} kbps", settings_.bitrateKbps, bitrate);
+            setBitrate(bitrate);
+        }
+    }
+
+    // All slices of the frame share one timestamp, receiver uses it for playout
+    frameTimestamp_ = videoTimestamp();
+
+    const auto *dirty = fullFrame ? nullptr : &frameDiff_.dirtyTiles();
+    {
+        PIRKS_TRACE_SCOPE("video", "convert");
+        metrics::ScopedTimer timer { convertTime_ };
+        convertBgraToI420(frame, yuv_, dirty, frameDiff_.tileSize());
+    }
+
+    {
+        // Slices are sent while the frame is encoded, so they are inside it
+        PIRKS_TRACE_SCOPE("video", "encode");
+        stats.encode = encoder_->encode(yuv_, [this, &stats](const EncodedSlice &slice) {
+            sendSlice(slice, stats);
+        });
+    }
+
+    encodeTime_.record(stats.encode.encodeTime);
+    submitTime_.record(std::chrono::steady_clock::now() - submitted);
+
+    spdlog::trace(
+            "Video frame: {}/{} tiles changed, {} bytes in {} slices, encoded in {} us{}",
+            diff.dirtyTiles,
+            diff.totalTiles,
+            stats.encode.bytes,
+            stats.encode.slices,
+            stats.encode.encodeTime.count(),
+            stats.encode.keyFrame ? " (key frame)" : "");
+
+    // Client can't decode frames which depend on lost data, so start over
+    if (packetsDropped_) {
+        packetsDropped_ = false;
+        encoder_->requestKeyFrame();
+    }
+
+    return stats;
+}
+
+void VideoStream::requestKeyFrame()
+{
+    if (encoder_) {
+        encoder_->requestKeyFrame();
+    }
+}
+
+void VideoStream::setBitrate(std::uint32_t bitrate_kbps)
+{
+    settings_.bitrateKbps = bitrate_kbps;
+    if (encoder_) {
+        encoder_->setBitrate(bitrate_kbps);
+    }
+}
+
+void VideoStream::setBitrateTarget(std::shared_ptr<const BitrateTarget> target)
+{
+    bitrateTarget_ = std::move(target);
+}
+
+void VideoStream::setTunables(std::shared_ptr<const config::Tunables> tunables)
+{
+    tunables_ = std::move(tunables);
+}
+
+void VideoStream::setEncoderFactory(EncoderFactory factory)
+{
+    encoderFactory_ = std::move(factory);
+}
+
+void VideoStream::setFramePool(std::shared_ptr<PacketPool> frames)
+{
+    framePool_ = std::move(frames);
+}
+
+bool VideoStream::openEncoder(const video::FrameView &frame)
+{
+    encoder_.reset();
+
+    settings_.width  = frame.width;
+    settings_.height = frame.height;
+
+    encoder_ = encoderFactory_ ? encoderFactory_(settings_) : factory_.create(settings_);
+    if (!encoder_) {
+        spdlog::error("Video encoder is not available for {}x{}", frame.width, frame.height);
+        return false;
+    }
+
+    return true;
+}
+
+void VideoStream::sendSlice(const EncodedSlice &slice, VideoFrameStats &stats)
+{
+    PIRKS_TRACE_SCOPE("video", "send");
+
+    auto outPackets = outPackets_.lock();
+    if (!outPackets) {
+        return;
+    }
+
+    // Whole slice is one packet, connection sends it in fragments and the
+    // receiver gets it back whole
+    if (framePool_ && slice.data.size() <= framePool_->blockSize()) {
+        sendPacket(*outPackets, *framePool_, slice.data, stats);
+        return;
+    }
+
+    const auto blockSize = pool_->blockSize();
+
+    // Receiver gets these in order as a plain Annex B byte stream
+    for (std::size_t offset = 0; offset < slice.data.size(); offset += blockSize) {
+        const auto size = std::min(blockSize, slice.data.size() - offset);
+        if (!sendPacket(*outPackets, *pool_, { slice.data.data() + offset, size }, stats)) {
+            return;
+        }
+    }
+}
+
+bool VideoStream::sendPacket(
+        PacketsQueue                  &out_packets,
+        PacketPool                    &pool,
+        std::span<const std::uint8_t> data,
+        VideoFrameStats               &stats)
+{
+    // Queue overwrites the oldest packet when full, and that block would
+    // never return to the pool. Drop the new packet instead.
+    const auto limit = tunables_ ? tunables_->queueLimit.load(std::memory_order_relaxed) : 0;
+    const bool full  = out_packets.isFull() || (limit != 0 && out_packets.size() >= limit);
+
+    auto *block = full ? nullptr : pool.acquire();
+    if (block == nullptr) {
+        ++droppedPackets_;
+        packetsDropped_ = true;
+        droppedCounter_.add();
+        PIRKS_WARN_LIMITED("Video packet dropped, total dropped: {}", droppedPackets_);
+        return false;
+    }
+
+    std::memcpy(block, data.data(), data.size());
+
+    PacketInfo packet;
+    packet.channel   = Channel::Video;
+    packet.reliable  = false;
+    packet.size      = static_cast<std::uint32_t>(data.size());
+    packet.timestamp = frameTimestamp_;
+    packet.data      = block;
+    out_packets.push(packet);
+
+    ++stats.packets;
+    return true;
+}
+
+}; // namespace pirks
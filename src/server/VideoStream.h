@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <span>
+
+#include "BitrateTarget.h"
+#include "FrameDiff.h"
+#include "FrameView.h"
+#include "I420Frame.h"
+#include "IConnection.h"
+#include "IVideoEncoder.h"
+#include "PacketPool.h"
+#include "Tunables.h"
+#include "VideoEncoderFactory.h"
+#include "metrics/Registry.h"
+
+namespace pirks
+{
+
+struct VideoFrameStats
+{
+    video::frame_diff::FrameDecision decision { video::frame_diff::FrameDecision::Repeat };
+    video::encode_video::EncodeStats encode;
+    std::size_t                      packets { 0 };
+};
+
+/**
+ * @brief Video pipeline from captured frame to packets in the output queue
+ *
+ * Unchanged frames are detected by FrameDiff and never reach the encoder,
+ * only dirty tiles are converted to I420. Encoded slices are copied into
+ * pool blocks and pushed to the output queue on the Video channel as soon as
+ * the encoder reports them.
+ */
+class VideoStream final
+{
+public:
+    using EncoderFactory = std::function<std::unique_ptr<video::encode_video::IVideoEncoder>(
+            const video::encode_video::EncoderSettings &settings)>;
+
+public:
+    VideoStream(
+            const video::encode_video::EncoderSettings &settings,
+            std::shared_ptr<networking::PacketPool>     pool,
+            std::shared_ptr<networking::PacketsQueue>   out_packets);
+
+public:
+    /**
+     * @brief Process captured frame
+     *
+     * Encoder is (re)created on the first frame and when frame size changes.
+     */
+    auto submit(const video::FrameView &frame) -> VideoFrameStats;
+
+    void requestKeyFrame();
+
+    void setBitrate(std::uint32_t bitrate_kbps);
+
+    /**
+     * @brief Follow bitrate estimated by congestion control
+     *
+     * Target is checked once per submitted frame, encoder is reconfigured
+     * only when it changes.
+     */
+    void setBitrateTarget(std::shared_ptr<const networking::BitrateTarget> target);
+
+    /**
+     * @brief Send every slice that fits into a block of frames as one packet
+     *
+     * Connection must have fragmentation enabled with the same pool.
+     * Slices bigger than a frames block are split into pool_ blocks as before.
+     */
+    void setFramePool(std::shared_ptr<networking::PacketPool> frames);
+
+    /**
+     * @brief Limit bitrate and queued packets by settings changed at runtime
+     *
+     * They are checked once per submitted frame and packet.
+     */
+    void setTunables(std::shared_ptr<const config::Tunables> tunables);
+
+    /**
+     * @brief Create encoders with factory instead of the backends compiled in
+     *
+     * Takes effect when the encoder is (re)created, nullptr restores the default.
+     */
+    void setEncoderFactory(EncoderFactory factory);
+
+private:
+    bool openEncoder(const video::FrameView &frame);
+    void sendSlice(const video::encode_video::EncodedSlice &slice, VideoFrameStats &stats);
+
+    /**
+     * @brief Copy data into a block of the pool and queue it, false if it was dropped
+     */
+    bool sendPacket(
+            networking::PacketsQueue      &out_packets,
+            networking::PacketPool        &pool,
+            std::span<const std::uint8_t> data,
+            VideoFrameStats               &stats);
+
+private:
+    video::encode_video::EncoderSettings                settings_;
+    video::encode_video::VideoEncoderFactory            factory_;
+    EncoderFactory                                      encoderFactory_;
+    std::unique_ptr<video::encode_video::IVideoEncoder> encoder_;
+    video::frame_diff::FrameDiff                        frameDiff_;
+    video::encode_video::I420Frame                      yuv_;
+
+    std::shared_ptr<networking::PacketPool> pool_;
+    std::shared_ptr<networking::PacketPool> framePool_;
+    std::weak_ptr<networking::PacketsQueue> outPackets_;
+
+    std::shared_ptr<const networking::BitrateTarget> bitrateTarget_;
+    std::shared_ptr<const config::Tunables>          tunables_;
+
+    // Bitrate used when there is no target, the limit of tunables_ applies to it too
+    std::uint32_t configuredBitrateKbps_;
+
+    std::uint32_t frameTimestamp_ { 0 };
+    bool          packetsDropped_ { false };
+    std::size_t   droppedPackets_ { 0 };
+
+    // Frames by FrameDecision, stage timings and drops, see metrics::Registry
+    std::array<metrics::Counter *, 3>     frames_ {};
+    metrics::Histogram                   &frameInterval_;
+    metrics::Histogram                   &diffTime_;
+    metrics::Histogram                   &convertTime_;
+    metrics::Histogram                   &encodeTime_;
+    metrics::Histogram                   &submitTime_;
+    metrics::Counter                     &droppedCounter_;
+    std::chrono::steady_clock::time_point lastFrame_;
+};
+
+}; // namespace pirks
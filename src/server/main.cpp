@@ -1,10 +1,19 @@
 #include <spdlog/spdlog.h>
 
+#include "ConfigReloader.h"
+#include "EnetConnection.h"
 #include "ExitCode.h"
+#include "Logging.h"
+#include "MetricsExporter.h"
+#include "PcapWriter.h"
+#include "QuicConnection.h"
 #include "Server.h"
 #include "ServerConfig.h"
+#include "ShutdownSignal.h"
+#include "WebSocketConnection.h"
 #include "deferral.h"
 #include "str_utils.h"
+#include "trace/Trace.h"
 #include "version.h"
 
 #ifdef WINDOWS
@@ -33,6 +42,12 @@ int main(int argc, char **argv)
             return ret;
         }
 
+        config.setupLogging();
+        defer
+        {
+            shutdownLogging();
+        };
+
         // Print version information early
         spdlog::info(
                 "{} v{} (Platform: {})"sv,
@@ -44,10 +59,7 @@ int main(int argc, char **argv)
             spdlog::info("{} v{} exited"sv, PROJECT_NAME, PROJECT_VERSION);
         };
 
-        if (config.isDebug()) {
-            spdlog::set_level(spdlog::level::debug);
-            spdlog::debug("Debug logging is enabled");
-        }
+        spdlog::debug("Debug logging is enabled");
 
         switch (config.connectionType()) {
         case ServerConfig::ConnectionType::Default:
@@ -60,11 +72,102 @@ int main(int argc, char **argv)
             spdlog::info("Connection type: TCP, port number: {}", config.port());
             spdlog::critical("TCP connection is not yet implemented");
             return ExitCode::ConfigurationError;
+
+        case ServerConfig::ConnectionType::QUIC:
+            spdlog::info("Connection type: QUIC, port number: {}", config.port());
+            if (!networking::quic::isAvailable()) {
+                spdlog::critical("QUIC connection is not available in this build");
+                return ExitCode::ConfigurationError;
+            }
+            break;
+
+        case ServerConfig::ConnectionType::ENet:
+            spdlog::info("Connection type: ENet, port number: {}", config.port());
+            if (!networking::enet::isAvailable()) {
+                spdlog::critical("ENet connection is not available in this build");
+                return ExitCode::ConfigurationError;
+            }
+            break;
+
+        case ServerConfig::ConnectionType::WebSocket:
+            spdlog::info("Connection type: WebSocket, port number: {}", config.port());
+            if (!networking::ws::isAvailable()) {
+                spdlog::critical("WebSocket connection is not available in this build");
+                return ExitCode::ConfigurationError;
+            }
+            break;
+        }
+
+        if ((config.metricsPort() != 0 || !config.metricsSocket().empty())
+            && !metrics::isAvailable())
+        {
+            spdlog::critical("Metrics are not available in this build");
+            return ExitCode::ConfigurationError;
+        }
+
+        if (!config.captureFile().empty() && !networking::capture::isAvailable()) {
+            spdlog::critical("Packet capture is not available on this platform");
+            return ExitCode::ConfigurationError;
         }
 
-        Server server { config.connectionType() };
+        if (!config.traceFile().empty() && !trace::isAvailable()) {
+            spdlog::critical("Tracing is not available in this build");
+            return ExitCode::ConfigurationError;
+        }
+
+        if (config.testPattern()) {
+            spdlog::info(
+                    "Video: test pattern at {} fps, {} kbps, GOP {}, {} slices per frame",
+                    config.fps(),
+                    config.bitrateKbps(),
+                    config.gopLength(),
+                    config.sliceCount());
+        } else {
+            spdlog::info("Video: no frame source, video is not streamed");
+        }
+
+        // Written after the server is stopped, so events of all its threads are there
+        if (!config.traceFile().empty()) {
+            trace::setThreadName("main");
+            trace::enable();
+        }
+        defer
+        {
+            if (!config.traceFile().empty()) {
+                trace::enable(false);
+                trace::writeChromeJson(config.traceFile());
+            }
+        };
+
+        // Arguments are parsed again, so they still override the file. Only
+        // tunables and log level are applied, other options need a restart.
+        auto reload = [&config, argc, argv] {
+            ServerConfig fresh;
+            fresh.parseArgs(PROJECT_DESCRIPTION, PROJECT_NAME, PROJECT_VERSION, argc, argv);
+            if (fresh.shouldExit()) {
+                spdlog::error("Config file has errors, it's not reloaded");
+                return;
+            }
+
+            fresh.applyLogLevel();
+            config.tunables()->store(*fresh.tunables());
+            spdlog::info("Config file {} is reloaded", fresh.configFile());
+        };
+        ConfigReloader reloader { config.configFile(), reload };
+        if (!config.configFile().empty()) {
+            reloader.start();
+        }
+
+        Server server { config };
         server.run();
 
+        // Threads of the server, reloader and exporter do the work until the
+        // server is told to stop. Replay is over when run() returns.
+        if (config.replayFile().empty()) {
+            waitForShutdownSignal();
+        }
+        server.stop();
+
     } catch (std::exception &e) {
         spdlog::critical("Exception thrown: {}", e.what());
         return ExitCode::ExceptionThrown;
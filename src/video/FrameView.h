@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace video
+{
+
+/**
+ * @brief Non-owning view of a captured frame in memory
+ *
+ * Pixels are packed (for example BGRA), rows can be padded so stride can be
+ * greater than width * bytesPerPixel.
+ */
+struct FrameView
+{
+    const std::uint8_t *data { nullptr };
+    std::uint32_t       width { 0 };
+    std::uint32_t       height { 0 };
+    std::uint32_t       stride { 0 }; ///< Size of one row in bytes
+    std::uint32_t       bytesPerPixel { 4 };
+
+    auto rowSize() const -> std::size_t
+    {
+        return static_cast<std::size_t>(width) * bytesPerPixel;
+    }
+
+    auto row(std::uint32_t y) const -> const std::uint8_t *
+    {
+        return data + static_cast<std::size_t>(y) * stride;
+    }
+};
+
+}; // namespace video
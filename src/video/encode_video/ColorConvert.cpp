@@ -0,0 +1,113 @@
+#include "ColorConvert.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace video::encode_video
+{
+
+namespace {
+
+// BT.709 limited range coefficients in 8.8 fixed point. Chroma rows sum to zero,
+// so gray stays exactly at 128
+constexpr int YR = 47;
+constexpr int YG = 157;
+constexpr int YB = 16;
+constexpr int UR = -26;
+constexpr int UG = -86;
+constexpr int UB = 112;
+constexpr int VR = 112;
+constexpr int VG = -102;
+constexpr int VB = -10;
+
+inline auto toLuma(int r, int g, int b) -> std::uint8_t
+{
+    return static_cast<std::uint8_t>(((YR * r + YG * g + YB * b + 128) >> 8) + 16);
+}
+
+/**
+ * @brief Convert rectangle of the frame. x0 and y0 must be even.
+ */
+void convertRect(
+        const FrameView &frame,
+        I420Frame       &out,
+        std::uint32_t    x0,
+        std::uint32_t    y0,
+        std::uint32_t    x1,
+        std::uint32_t    y1)
+{
+    assert(x0 % 2 == 0 && y0 % 2 == 0 && "rectangle must start at even position");
+
+    const auto width       = static_cast<std::size_t>(out.width);
+    const auto chromaWidth = static_cast<std::size_t>(out.chromaWidth());
+
+    // Walk by 2x2 blocks, each block gives 4 luma and 1 chroma sample
+    for (std::uint32_t y = y0; y < y1; y += 2) {
+        const auto  y2    = std::min(y + 1, y1 - 1);
+        const auto *row0  = frame.row(y);
+        const auto *row1  = frame.row(y2);
+        auto       *luma0 = out.y.data() + y * width;
+        auto       *luma1 = out.y.data() + y2 * width;
+        auto       *u     = out.u.data() + (y / 2) * chromaWidth;
+        auto       *v     = out.v.data() + (y / 2) * chromaWidth;
+
+        for (std::uint32_t x = x0; x < x1; x += 2) {
+            const auto x2 = std::min(x + 1, x1 - 1);
+
+            // BGRA byte order
+            const auto *p00 = row0 + x * 4;
+            const auto *p01 = row0 + x2 * 4;
+            const auto *p10 = row1 + x * 4;
+            const auto *p11 = row1 + x2 * 4;
+
+            luma0[x]  = toLuma(p00[2], p00[1], p00[0]);
+            luma0[x2] = toLuma(p01[2], p01[1], p01[0]);
+            luma1[x]  = toLuma(p10[2], p10[1], p10[0]);
+            luma1[x2] = toLuma(p11[2], p11[1], p11[0]);
+
+            const int r = (p00[2] + p01[2] + p10[2] + p11[2] + 2) >> 2;
+            const int g = (p00[1] + p01[1] + p10[1] + p11[1] + 2) >> 2;
+            const int b = (p00[0] + p01[0] + p10[0] + p11[0] + 2) >> 2;
+
+            u[x / 2] = static_cast<std::uint8_t>(((UR * r + UG * g + UB * b + 128) >> 8) + 128);
+            v[x / 2] = static_cast<std::uint8_t>(((VR * r + VG * g + VB * b + 128) >> 8) + 128);
+        }
+    }
+}
+
+} // namespace
+
+void convertBgraToI420(
+        const FrameView                &frame,
+        I420Frame                      &out,
+        const frame_diff::DirtyTileMap *dirty,
+        std::uint32_t                   tile_size)
+{
+    assert(frame.bytesPerPixel == 4 && "only BGRA frames are supported");
+    assert(tile_size % 2 == 0 && "tile size must be even");
+
+    if (out.width != frame.width || out.height != frame.height) {
+        out.resize(frame.width, frame.height);
+        // previous content is lost, so dirty map can't be used
+        dirty = nullptr;
+    }
+
+    if (dirty == nullptr) {
+        convertRect(frame, out, 0, 0, frame.width, frame.height);
+        return;
+    }
+
+    dirty->forEachDirty([&](std::uint32_t tx, std::uint32_t ty) {
+        const auto x0 = tx * tile_size;
+        const auto y0 = ty * tile_size;
+        convertRect(
+                frame,
+                out,
+                x0,
+                y0,
+                std::min(x0 + tile_size, frame.width),
+                std::min(y0 + tile_size, frame.height));
+    });
+}
+
+}; // namespace video::encode_video
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "DirtyTileMap.h"
+#include "FrameView.h"
+#include "I420Frame.h"
+
+namespace video::encode_video
+{
+
+/**
+ * @brief Convert BGRA frame to I420 (BT.709, limited range)
+ *
+ * If dirty tile map is given, only dirty tiles are converted and the rest of
+ * the output keeps the result of the previous conversion. Output is resized
+ * (and fully converted) when frame size changes.
+ *
+ * @param frame         Source BGRA frame, 4 bytes per pixel
+ * @param out           Destination frame, reused between calls
+ * @param dirty         Dirty tiles from frame_diff::FrameDiff or nullptr for the whole frame
+ * @param tile_size     Tile size used to build dirty map, must be even
+ */
+void convertBgraToI420(
+        const FrameView                &frame,
+        I420Frame                      &out,
+        const frame_diff::DirtyTileMap *dirty     = nullptr,
+        std::uint32_t                   tile_size = 64);
+
+}; // namespace video::encode_video
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+namespace video::encode_video
+{
+
+/**
+ * @brief Encoder tunables
+ *
+ * Defaults are tuned for low latency streaming: no B-frames, periodic
+ * intra refresh instead of large IDR frames, and several slices per frame
+ * so the first slices can be sent while the rest of the frame is encoded.
+ */
+struct EncoderSettings
+{
+    std::uint32_t width { 0 };
+    std::uint32_t height { 0 };
+    std::uint32_t fps { 60 };
+    std::uint32_t bitrateKbps { 10000 };
+    std::uint32_t gopLength { 0 };  ///< Frames between key frames, 0 - only on request
+    std::uint32_t sliceCount { 4 }; ///< Slices per frame
+    std::uint32_t threads { 0 };    ///< Encoder threads, 0 - auto
+    bool          intraRefresh { true };
+};
+
+}; // namespace video::encode_video
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace video::encode_video
+{
+
+/**
+ * @brief Planar YUV 4:2:0 frame, input format for encoders
+ *
+ * Planes are tightly packed: luma stride is width, chroma stride is
+ * (width + 1) / 2.
+ */
+struct I420Frame
+{
+    std::uint32_t width { 0 };
+    std::uint32_t height { 0 };
+
+    std::vector<std::uint8_t> y;
+    std::vector<std::uint8_t> u;
+    std::vector<std::uint8_t> v;
+
+    void resize(std::uint32_t frame_width, std::uint32_t frame_height)
+    {
+        width  = frame_width;
+        height = frame_height;
+
+        y.assign(static_cast<std::size_t>(width) * height, 0);
+        u.assign(static_cast<std::size_t>(chromaWidth()) * chromaHeight(), 128);
+        v.assign(static_cast<std::size_t>(chromaWidth()) * chromaHeight(), 128);
+    }
+
+    auto chromaWidth() const -> std::uint32_t
+    {
+        return (width + 1) / 2;
+    }
+
+    auto chromaHeight() const -> std::uint32_t
+    {
+        return (height + 1) / 2;
+    }
+};
+
+}; // namespace video::encode_video
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+#include "EncoderSettings.h"
+#include "I420Frame.h"
+
+namespace video::encode_video
+{
+
+/**
+ * @brief One encoded NAL unit in Annex B format (with start code)
+ */
+struct EncodedSlice
+{
+    std::span<const std::uint8_t> data;
+    std::uint64_t                 frameIndex { 0 };
+    std::uint8_t                  nalType { 0 };
+};
+
+/**
+ * @brief Called as soon as a slice is ready
+ *
+ * Backends with sliced threads can call it from encoder worker threads, but
+ * never concurrently for the same encoder. data is valid only during the call.
+ */
+using SliceCallback = std::function<void(const EncodedSlice &slice)>;
+
+struct EncodeStats
+{
+    std::chrono::microseconds encodeTime { 0 };
+    std::size_t               bytes { 0 };
+    std::size_t               slices { 0 };
+    bool                      keyFrame { false };
+};
+
+/**
+ * @brief Interface for video encoders
+ *
+ */
+class IVideoEncoder
+{
+public:
+    virtual ~IVideoEncoder() = default;
+
+public:
+    /**
+     * @brief Encode one frame
+     *
+     * @param frame         Frame in I420 format, size must match settings
+     * @param on_slice      Called for every NAL unit of this frame
+     * @return EncodeStats  Statistics of the encoded frame
+     */
+    virtual auto encode(const I420Frame &frame, const SliceCallback &on_slice) -> EncodeStats = 0;
+
+    /**
+     * @brief Next encoded frame will be a key frame
+     */
+    virtual void requestKeyFrame() = 0;
+
+    /**
+     * @brief Change target bitrate without reopening encoder
+     */
+    virtual void setBitrate(std::uint32_t bitrate_kbps) = 0;
+
+    virtual auto settings() const -> const EncoderSettings & = 0;
+};
+
+}; // namespace video::encode_video
@@ -0,0 +1,28 @@
+#include "VideoEncoderFactory.h"
+
+#include <spdlog/spdlog.h>
+
+#ifdef WITH_X264
+#include "X264VideoEncoder.h"
+#endif
+
+namespace video::encode_video
+{
+
+auto VideoEncoderFactory::create([[maybe_unused]] const EncoderSettings &settings)
+        -> std::unique_ptr<IVideoEncoder>
+{
+#ifdef WITH_X264
+    try {
+        return std::make_unique<x264::X264VideoEncoder>(settings);
+    } catch (const std::exception &e) {
+        spdlog::error("Couldn't create x264 encoder: {}", e.what());
+        return nullptr;
+    }
+#else
+    spdlog::error("No video encoder backend was compiled in");
+    return nullptr;
+#endif
+}
+
+}; // namespace video::encode_video
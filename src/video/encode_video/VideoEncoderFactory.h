@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+
+#include "EncoderSettings.h"
+#include "IVideoEncoder.h"
+
+namespace video::encode_video
+{
+
+/**
+ * @brief Creates video encoder from the backends compiled in
+ *
+ * For now only software x264 backend exists (WITH_X264 CMake option).
+ */
+class VideoEncoderFactory final
+{
+public:
+    /**
+     * @brief Create encoder
+     *
+     * @return std::unique_ptr<IVideoEncoder>   nullptr if there is no backend
+     *                                          or it can't be opened
+     */
+    auto create(const EncoderSettings &settings) -> std::unique_ptr<IVideoEncoder>;
+};
+
+}; // namespace video::encode_video
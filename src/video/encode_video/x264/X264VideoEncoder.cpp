@@ -0,0 +1,219 @@
+#include "X264VideoEncoder.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+
+// x264.h needs stdint types declared before it
+#include <x264.h>
+
+namespace video::encode_video::x264
+{
+
+namespace {
+
+void naluProcess(x264_t *h, x264_nal_t *nal, void *opaque)
+{
+    auto *encoder = static_cast<X264VideoEncoder *>(opaque);
+
+    // With sliced threads callback can be called from several threads at once
+    std::lock_guard lock { encoder->nalMutex() };
+
+    // Buffer size required by x264_nal_encode() documentation
+    const auto required = static_cast<std::size_t>(nal->i_payload) * 3 / 2 + 5 + 64;
+    auto      *buffer   = encoder->nalBuffer(required);
+
+    x264_nal_encode(h, buffer, nal);
+
+    encoder->onNal(
+            nal->p_payload,
+            static_cast<std::size_t>(nal->i_payload),
+            static_cast<std::uint8_t>(nal->i_type));
+}
+
+void applyRateControl(x264_param_t &param, const EncoderSettings &settings)
+{
+    const auto bitrate = static_cast<int>(settings.bitrateKbps);
+
+    param.rc.i_rc_method       = X264_RC_ABR;
+    param.rc.i_bitrate         = bitrate;
+    param.rc.i_vbv_max_bitrate = bitrate;
+    // One frame VBV buffer: no frame can be much bigger than average, so
+    // network never gets a burst bigger than one frame interval
+    param.rc.i_vbv_buffer_size = std::max(1, bitrate / static_cast<int>(settings.fps));
+    param.rc.f_vbv_buffer_init = 0.9f;
+}
+
+} // namespace
+
+X264VideoEncoder::X264VideoEncoder(const EncoderSettings &settings) : settings_ { settings }
+{
+    if (settings_.width == 0 || settings_.height == 0 || settings_.fps == 0) {
+        throw std::runtime_error("Invalid encoder settings");
+    }
+
+    x264_param_t param;
+    if (x264_param_default_preset(&param, "ultrafast", "zerolatency") < 0) {
+        throw std::runtime_error("Couldn't apply x264 zerolatency preset");
+    }
+
+    param.i_log_level = X264_LOG_WARNING;
+    param.i_width     = static_cast<int>(settings_.width);
+    param.i_height    = static_cast<int>(settings_.height);
+    param.i_csp       = X264_CSP_I420;
+    param.i_fps_num   = settings_.fps;
+    param.i_fps_den   = 1;
+    param.i_threads   = settings_.threads == 0 ? X264_THREADS_AUTO
+                                               : static_cast<int>(settings_.threads);
+
+    // Latency: no B-frames, no lookahead, slices are encoded in parallel
+    param.i_bframe         = 0;
+    param.b_sliced_threads = 1;
+    param.i_slice_count    = static_cast<int>(settings_.sliceCount);
+    param.rc.i_lookahead   = 0;
+    param.i_sync_lookahead = 0;
+
+    // Intra refresh replaces IDR frames with a moving column of intra blocks.
+    // Its period is keyint, so use one second if GOP was not set.
+    param.b_intra_refresh = settings_.intraRefresh ? 1 : 0;
+    if (settings_.gopLength != 0) {
+        param.i_keyint_max = static_cast<int>(settings_.gopLength);
+    } else if (settings_.intraRefresh) {
+        param.i_keyint_max = static_cast<int>(settings_.fps);
+    } else {
+        param.i_keyint_max = X264_KEYINT_MAX_INFINITE;
+    }
+
+    // Every key frame has SPS/PPS, so client can join at any key frame
+    param.b_repeat_headers = 1;
+    param.b_annexb         = 1;
+
+    applyRateControl(param, settings_);
+
+    param.nalu_process = naluProcess;
+
+    if (x264_param_apply_profile(&param, "high") < 0) {
+        throw std::runtime_error("Couldn't apply x264 profile");
+    }
+
+    encoder_ = x264_encoder_open(&param);
+    if (encoder_ == nullptr) {
+        throw std::runtime_error("Couldn't open x264 encoder");
+    }
+
+    // Maximum size of one NAL for uncompressed frame, so buffer never grows later
+    nalBuffer_.resize(static_cast<std::size_t>(settings_.width) * settings_.height * 3);
+
+    spdlog::info(
+            "x264 encoder opened: {}x{}@{} {} kbps, GOP {}, {} slices, intra refresh {}",
+            settings_.width,
+            settings_.height,
+            settings_.fps,
+            settings_.bitrateKbps,
+            param.i_keyint_max,
+            settings_.sliceCount,
+            settings_.intraRefresh);
+}
+
+X264VideoEncoder::~X264VideoEncoder()
+{
+    if (encoder_ != nullptr) {
+        x264_encoder_close(encoder_);
+    }
+}
+
+auto X264VideoEncoder::encode(const I420Frame &frame, const SliceCallback &on_slice)
+        -> EncodeStats
+{
+    assert(frame.width == settings_.width && frame.height == settings_.height
+           && "frame size doesn't match encoder settings");
+
+    x264_picture_t picture;
+    x264_picture_init(&picture);
+    picture.img.i_csp       = X264_CSP_I420;
+    picture.img.i_plane     = 3;
+    picture.img.plane[0]    = const_cast<std::uint8_t *>(frame.y.data());
+    picture.img.plane[1]    = const_cast<std::uint8_t *>(frame.u.data());
+    picture.img.plane[2]    = const_cast<std::uint8_t *>(frame.v.data());
+    picture.img.i_stride[0] = static_cast<int>(frame.width);
+    picture.img.i_stride[1] = static_cast<int>(frame.chromaWidth());
+    picture.img.i_stride[2] = static_cast<int>(frame.chromaWidth());
+    picture.i_pts           = static_cast<int64_t>(frameIndex_);
+    picture.i_type          = keyFrameRequested_.exchange(false) ? X264_TYPE_IDR : X264_TYPE_AUTO;
+    picture.opaque          = this;
+
+    {
+        std::lock_guard lock { nalMutex_ };
+        onSlice_ = &on_slice;
+        stats_   = {};
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    x264_nal_t    *nals      = nullptr;
+    int            nalsCount = 0;
+    x264_picture_t pictureOut;
+    const auto     size = x264_encoder_encode(encoder_, &nals, &nalsCount, &picture, &pictureOut);
+
+    const auto finish = std::chrono::steady_clock::now();
+
+    std::lock_guard lock { nalMutex_ };
+    onSlice_ = nullptr;
+
+    if (size < 0) {
+        spdlog::error("x264 failed to encode frame {}", frameIndex_);
+        return {};
+    }
+
+    stats_.encodeTime = std::chrono::duration_cast<std::chrono::microseconds>(finish - start);
+    stats_.keyFrame   = pictureOut.b_keyframe != 0;
+
+    ++frameIndex_;
+
+    return stats_;
+}
+
+void X264VideoEncoder::requestKeyFrame()
+{
+    keyFrameRequested_ = true;
+}
+
+void X264VideoEncoder::setBitrate(std::uint32_t bitrate_kbps)
+{
+    if (bitrate_kbps == 0 || bitrate_kbps == settings_.bitrateKbps) {
+        return;
+    }
+
+    settings_.bitrateKbps = bitrate_kbps;
+
+    x264_param_t param;
+    x264_encoder_parameters(encoder_, &param);
+    applyRateControl(param, settings_);
+    if (x264_encoder_reconfig(encoder_, &param) < 0) {
+        spdlog::warn("x264 couldn't change bitrate to {} kbps", bitrate_kbps);
+    }
+}
+
+void X264VideoEncoder::onNal(const std::uint8_t *data, std::size_t size, std::uint8_t nal_type)
+{
+    stats_.bytes += size;
+    ++stats_.slices;
+
+    if (onSlice_ != nullptr && *onSlice_) {
+        (*onSlice_)(EncodedSlice { { data, size }, frameIndex_, nal_type });
+    }
+}
+
+auto X264VideoEncoder::nalBuffer(std::size_t size) -> std::uint8_t *
+{
+    if (nalBuffer_.size() < size) {
+        nalBuffer_.resize(size);
+    }
+    return nalBuffer_.data();
+}
+
+}; // namespace video::encode_video::x264
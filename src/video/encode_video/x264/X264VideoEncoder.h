@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "IVideoEncoder.h"
+
+struct x264_t;
+
+namespace video::encode_video::x264
+{
+
+/**
+ * @brief Software H.264 encoder based on libx264 in zerolatency mode
+ *
+ * Uses sliced threads and nalu_process callback, so every slice is passed
+ * to SliceCallback as soon as it is encoded, not when the whole frame is done.
+ */
+class X264VideoEncoder final: public IVideoEncoder
+{
+public:
+    explicit X264VideoEncoder(const EncoderSettings &settings);
+    ~X264VideoEncoder() override;
+
+    X264VideoEncoder(const X264VideoEncoder &)            = delete;
+    X264VideoEncoder &operator=(const X264VideoEncoder &) = delete;
+
+public:
+    auto encode(const I420Frame &frame, const SliceCallback &on_slice) -> EncodeStats override;
+
+    void requestKeyFrame() override;
+
+    void setBitrate(std::uint32_t bitrate_kbps) override;
+
+    auto settings() const -> const EncoderSettings & override
+    {
+        return settings_;
+    }
+
+public:
+    // Called by libx264 from nalu_process callback, possibly from worker threads
+    void onNal(const std::uint8_t *data, std::size_t size, std::uint8_t nal_type);
+
+    // Buffer for x264_nal_encode. Valid while nalMutex() is locked
+    auto nalBuffer(std::size_t size) -> std::uint8_t *;
+
+    auto nalMutex() -> std::mutex &
+    {
+        return nalMutex_;
+    }
+
+private:
+    EncoderSettings settings_;
+    ::x264_t       *encoder_ { nullptr };
+
+    std::atomic_bool keyFrameRequested_ { false };
+    std::uint64_t    frameIndex_ { 0 };
+
+    // Current frame state, used from nalu_process callback
+    std::mutex                nalMutex_;
+    std::vector<std::uint8_t> nalBuffer_;
+    const SliceCallback      *onSlice_ { nullptr };
+    EncodeStats               stats_;
+};
+
+}; // namespace video::encode_video::x264
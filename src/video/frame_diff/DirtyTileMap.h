@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace video::frame_diff
+{
+
+/**
+ * @brief Bitmap with one bit per tile of a frame
+ *
+ * Set bit means that tile was changed since the previous frame. Tiles are
+ * stored row by row: index = ty * tilesX + tx.
+ */
+class DirtyTileMap final
+{
+public:
+    DirtyTileMap() = default;
+
+    DirtyTileMap(std::uint32_t tiles_x, std::uint32_t tiles_y)
+    {
+        resize(tiles_x, tiles_y);
+    }
+
+public:
+    void resize(std::uint32_t tiles_x, std::uint32_t tiles_y)
+    {
+        tilesX_ = tiles_x;
+        tilesY_ = tiles_y;
+        bits_.assign((tileCount() + 63) / 64, 0);
+    }
+
+    void clear()
+    {
+        std::fill(bits_.begin(), bits_.end(), 0);
+    }
+
+    void setAll()
+    {
+        std::fill(bits_.begin(), bits_.end(), ~std::uint64_t { 0 });
+
+        // Keep unused bits of the last word clear, so count() stays correct
+        const auto tail = tileCount() % 64;
+        if (tail != 0) {
+            bits_.back() = (std::uint64_t { 1 } << tail) - 1;
+        }
+    }
+
+    void set(std::uint32_t tx, std::uint32_t ty)
+    {
+        const auto index = indexOf(tx, ty);
+        bits_[index / 64] |= std::uint64_t { 1 } << (index % 64);
+    }
+
+    [[nodiscard]]
+    bool isDirty(std::uint32_t tx, std::uint32_t ty) const
+    {
+        const auto index = indexOf(tx, ty);
+        return (bits_[index / 64] >> (index % 64)) & 1;
+    }
+
+    [[nodiscard]]
+    auto count() const -> std::size_t
+    {
+        std::size_t result = 0;
+        for (const auto word: bits_) {
+            result += static_cast<std::size_t>(std::popcount(word));
+        }
+        return result;
+    }
+
+    [[nodiscard]]
+    bool isEmpty() const
+    {
+        return std::all_of(bits_.begin(), bits_.end(), [](auto word) { return word == 0; });
+    }
+
+    /**
+     * @brief Call func(tx, ty) for every dirty tile in row-major order
+     */
+    template<class Func>
+    void forEachDirty(Func &&func) const
+    {
+        for (std::size_t w = 0; w < bits_.size(); ++w) {
+            auto word = bits_[w];
+            while (word != 0) {
+                const auto index = w * 64 + static_cast<std::size_t>(std::countr_zero(word));
+                func(static_cast<std::uint32_t>(index % tilesX_),
+                     static_cast<std::uint32_t>(index / tilesX_));
+                word &= word - 1;
+            }
+        }
+    }
+
+    auto tilesX() const -> std::uint32_t
+    {
+        return tilesX_;
+    }
+
+    auto tilesY() const -> std::uint32_t
+    {
+        return tilesY_;
+    }
+
+    auto tileCount() const -> std::size_t
+    {
+        return static_cast<std::size_t>(tilesX_) * tilesY_;
+    }
+
+private:
+    auto indexOf(std::uint32_t tx, std::uint32_t ty) const -> std::size_t
+    {
+        assert(tx < tilesX_ && ty < tilesY_ && "tile is out of range");
+        return static_cast<std::size_t>(ty) * tilesX_ + tx;
+    }
+
+private:
+    std::uint32_t              tilesX_ { 0 };
+    std::uint32_t              tilesY_ { 0 };
+    std::vector<std::uint64_t> bits_;
+};
+
+}; // namespace video::frame_diff
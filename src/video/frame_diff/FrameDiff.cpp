@@ -0,0 +1,96 @@
+#include "FrameDiff.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "TileCompare.h"
+
+namespace video::frame_diff
+{
+
+FrameDiff::FrameDiff(std::uint32_t tile_size) : tileSize_ { tile_size }
+{
+    assert(tileSize_ != 0 && "tile size can't be zero");
+
+    spdlog::debug(
+            "FrameDiff created, tile size {}, compare kernel {}",
+            tileSize_,
+            bytesEqualKernelName());
+}
+
+auto FrameDiff::compare(const FrameView &frame) -> DiffResult
+{
+    assert(frame.data != nullptr && "frame data is NULL");
+    assert(frame.stride >= frame.rowSize() && "frame stride is less than row size");
+
+    const bool sameFormat = hasPrevious_                            //
+                            && frame.width == width_                //
+                            && frame.height == height_              //
+                            && frame.bytesPerPixel == bytesPerPixel_;
+    if (!sameFormat) {
+        return storeFullFrame(frame);
+    }
+
+    dirty_.clear();
+
+    const auto rowSize  = frame.rowSize();
+    const auto tileSize = static_cast<std::size_t>(tileSize_) * bytesPerPixel_;
+
+    for (std::uint32_t y = 0; y < height_; ++y) {
+        const auto   *src = frame.row(y);
+        auto         *dst = previous_.data() + y * rowSize;
+        const auto    ty  = y / tileSize_;
+        std::uint32_t tx  = 0;
+
+        for (std::size_t offset = 0; offset < rowSize; offset += tileSize, ++tx) {
+            const auto size = std::min(tileSize, rowSize - offset);
+
+            // Once tile is dirty, its remaining rows are only copied
+            if (dirty_.isDirty(tx, ty) || !bytesEqual(src + offset, dst + offset, size)) {
+                dirty_.set(tx, ty);
+                std::memcpy(dst + offset, src + offset, size);
+            }
+        }
+    }
+
+    DiffResult result;
+    result.dirtyTiles = dirty_.count();
+    result.totalTiles = dirty_.tileCount();
+    result.decision   = result.dirtyTiles == 0 ? FrameDecision::Repeat : FrameDecision::Partial;
+
+    return result;
+}
+
+void FrameDiff::invalidate()
+{
+    hasPrevious_ = false;
+}
+
+auto FrameDiff::storeFullFrame(const FrameView &frame) -> DiffResult
+{
+    width_         = frame.width;
+    height_        = frame.height;
+    bytesPerPixel_ = frame.bytesPerPixel;
+    hasPrevious_   = true;
+
+    const auto rowSize = frame.rowSize();
+    previous_.resize(rowSize * height_);
+    for (std::uint32_t y = 0; y < height_; ++y) {
+        std::memcpy(previous_.data() + y * rowSize, frame.row(y), rowSize);
+    }
+
+    dirty_.resize((width_ + tileSize_ - 1) / tileSize_, (height_ + tileSize_ - 1) / tileSize_);
+    dirty_.setAll();
+
+    DiffResult result;
+    result.decision   = FrameDecision::Full;
+    result.dirtyTiles = dirty_.tileCount();
+    result.totalTiles = dirty_.tileCount();
+
+    return result;
+}
+
+}; // namespace video::frame_diff
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "DirtyTileMap.h"
+#include "FrameView.h"
+
+namespace video::frame_diff
+{
+
+enum class FrameDecision : int
+{
+    Full = 0, ///< No previous frame to compare with, everything should be encoded
+    Partial,  ///< Some tiles are changed, see dirty tile map
+    Repeat    ///< Frame is identical to the previous one, encoder can be skipped
+};
+
+struct DiffResult
+{
+    FrameDecision decision { FrameDecision::Full };
+    std::size_t   dirtyTiles { 0 };
+    std::size_t   totalTiles { 0 };
+};
+
+/**
+ * @brief Finds changed regions between captured frames
+ *
+ * Frame is split into square tiles (64x64 pixels by default). Every call to
+ * compare() checks the new frame against a copy of the previous one and marks
+ * changed tiles in the dirty tile map. Only changed rows of dirty tiles are
+ * copied into the internal previous frame, so a static desktop costs only
+ * one read pass over the frame.
+ *
+ * Rows are processed top to bottom, so both frames are read sequentially
+ * and hardware prefetcher can follow them.
+ */
+class FrameDiff final
+{
+public:
+    static constexpr std::uint32_t DEFAULT_TILE_SIZE = 64;
+
+    explicit FrameDiff(std::uint32_t tile_size = DEFAULT_TILE_SIZE);
+
+public:
+    /**
+     * @brief Compare frame with the previous one and remember it
+     *
+     * @param frame         Captured frame. Width, height or pixel size change
+     *                      resets the state and gives FrameDecision::Full
+     * @return DiffResult   Decision and number of dirty tiles
+     */
+    auto compare(const FrameView &frame) -> DiffResult;
+
+    /**
+     * @brief Forget previous frame, next compare() will return FrameDecision::Full
+     *
+     * Useful when the encoder needs a key frame.
+     */
+    void invalidate();
+
+    [[nodiscard]]
+    auto dirtyTiles() const -> const DirtyTileMap &
+    {
+        return dirty_;
+    }
+
+    [[nodiscard]]
+    auto tileSize() const -> std::uint32_t
+    {
+        return tileSize_;
+    }
+
+private:
+    auto storeFullFrame(const FrameView &frame) -> DiffResult;
+
+private:
+    std::uint32_t             tileSize_;
+    std::uint32_t             width_ { 0 };
+    std::uint32_t             height_ { 0 };
+    std::uint32_t             bytesPerPixel_ { 0 };
+    bool                      hasPrevious_ { false };
+    std::vector<std::uint8_t> previous_; ///< Previous frame, rows are tightly packed
+    DirtyTileMap              dirty_;
+};
+
+}; // namespace video::frame_diff
@@ -0,0 +1,120 @@
+#include "TileCompare.h"
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIRKS_FRAME_DIFF_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace video::frame_diff
+{
+
+namespace {
+
+constexpr std::size_t BLOCK_SIZE = 64;
+
+#if defined(__AVX2__)
+
+bool blocksEqual(const std::uint8_t *a, const std::uint8_t *b, std::size_t blocks)
+{
+    for (std::size_t i = 0; i < blocks; ++i, a += BLOCK_SIZE, b += BLOCK_SIZE) {
+        const auto a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));
+        const auto a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + 32));
+        const auto b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b));
+        const auto b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + 32));
+
+        // xor gives zero for equal bytes, or both halves together and test once
+        const auto diff = _mm256_or_si256(_mm256_xor_si256(a0, b0), _mm256_xor_si256(a1, b1));
+        if (!_mm256_testz_si256(diff, diff)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr const char *KERNEL_NAME = "AVX2";
+
+#elif defined(PIRKS_FRAME_DIFF_SSE2)
+
+bool blocksEqual(const std::uint8_t *a, const std::uint8_t *b, std::size_t blocks)
+{
+    for (std::size_t i = 0; i < blocks; ++i, a += BLOCK_SIZE, b += BLOCK_SIZE) {
+        const auto a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+        const auto a1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + 16));
+        const auto a2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + 32));
+        const auto a3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + 48));
+        const auto b0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+        const auto b1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + 16));
+        const auto b2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + 32));
+        const auto b3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + 48));
+
+        // Combine all four compares, so there is only one branch per block
+        const auto eq = _mm_and_si128(
+                _mm_and_si128(_mm_cmpeq_epi8(a0, b0), _mm_cmpeq_epi8(a1, b1)),
+                _mm_and_si128(_mm_cmpeq_epi8(a2, b2), _mm_cmpeq_epi8(a3, b3)));
+        if (_mm_movemask_epi8(eq) != 0xFFFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr const char *KERNEL_NAME = "SSE2";
+
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+
+bool blocksEqual(const std::uint8_t *a, const std::uint8_t *b, std::size_t blocks)
+{
+    for (std::size_t i = 0; i < blocks; ++i, a += BLOCK_SIZE, b += BLOCK_SIZE) {
+        const auto va = vld1q_u8_x4(a);
+        const auto vb = vld1q_u8_x4(b);
+
+        const auto diff = vorrq_u8(
+                vorrq_u8(veorq_u8(va.val[0], vb.val[0]), veorq_u8(va.val[1], vb.val[1])),
+                vorrq_u8(veorq_u8(va.val[2], vb.val[2]), veorq_u8(va.val[3], vb.val[3])));
+        if (vmaxvq_u8(diff) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr const char *KERNEL_NAME = "NEON";
+
+#else
+
+bool blocksEqual(const std::uint8_t *a, const std::uint8_t *b, std::size_t blocks)
+{
+    return std::memcmp(a, b, blocks * BLOCK_SIZE) == 0;
+}
+
+constexpr const char *KERNEL_NAME = "scalar";
+
+#endif
+
+} // namespace
+
+bool bytesEqual(const std::uint8_t *a, const std::uint8_t *b, std::size_t size)
+{
+    const auto blocks = size / BLOCK_SIZE;
+    if (!blocksEqual(a, b, blocks)) {
+        return false;
+    }
+
+    // Tail is shorter than one block. It happens only for the rightmost tiles
+    // when frame width is not a multiple of the tile size.
+    const auto done = blocks * BLOCK_SIZE;
+    return std::memcmp(a + done, b + done, size - done) == 0;
+}
+
+auto bytesEqualKernelName() -> const char *
+{
+    return KERNEL_NAME;
+}
+
+}; // namespace video::frame_diff
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace video::frame_diff
+{
+
+/**
+ * @brief Compare two memory regions for equality
+ *
+ * Same result as memcmp(a, b, size) == 0, but uses SIMD compares
+ * (SSE2/AVX2 on x86, NEON on ARM) on 64 bytes per iteration.
+ * One tile row is 64 pixels * 4 bytes = 256 bytes, so the loop is short
+ * and branches only once per 64 bytes.
+ */
+bool bytesEqual(const std::uint8_t *a, const std::uint8_t *b, std::size_t size);
+
+/**
+ * @brief Name of SIMD kernel selected at compile time. Used for logging.
+ */
+auto bytesEqualKernelName() -> const char *;
+
+}; // namespace video::frame_diff
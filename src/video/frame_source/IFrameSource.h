@@ -0,0 +1,28 @@
+#pragma once
+
+#include <optional>
+
+#include "FrameView.h"
+
+namespace video::frame_source
+{
+
+/**
+ * @brief Interface for sources of captured frames
+ */
+class IFrameSource
+{
+public:
+    virtual ~IFrameSource() = default;
+
+public:
+    /**
+     * @brief Wait for the next frame
+     *
+     * @return std::optional<FrameView>  nullopt if there are no more frames,
+     *                                   frame is valid until the next call
+     */
+    virtual auto next() -> std::optional<FrameView> = 0;
+};
+
+}; // namespace video::frame_source
@@ -0,0 +1,91 @@
+#include "TestPatternSource.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace video::frame_source
+{
+
+namespace {
+
+constexpr std::uint32_t BYTES_PER_PIXEL = 4;
+
+} // namespace
+
+TestPatternSource::TestPatternSource(const TestPatternSettings &settings)
+        : settings_ { settings }
+{
+    if (settings.width < SQUARE_SIZE || settings.height < SQUARE_SIZE) {
+        throw std::invalid_argument("TestPatternSource: frame is smaller than the square");
+    }
+    if (settings.fps == 0) {
+        throw std::invalid_argument("TestPatternSource: frame rate can't be zero");
+    }
+
+    interval_ = std::chrono::duration_cast<Clock::duration>(std::chrono::seconds { 1 })
+                / settings.fps;
+
+    pixels_.resize(std::size_t { settings.width } * settings.height * BYTES_PER_PIXEL);
+    drawBackground(0, 0, settings.width, settings.height);
+}
+
+auto TestPatternSource::next() -> std::optional<FrameView>
+{
+    if (frameIndex_ == 0) {
+        nextFrame_ = Clock::now();
+    } else {
+        std::this_thread::sleep_until(nextFrame_);
+
+        // Square moves to the right and starts over from the left edge
+        drawBackground(squareX_, (settings_.height - SQUARE_SIZE) / 2, SQUARE_SIZE, SQUARE_SIZE);
+        squareX_ += SQUARE_STEP;
+        if (squareX_ > settings_.width - SQUARE_SIZE) {
+            squareX_ = 0;
+        }
+    }
+
+    drawSquare(squareX_, (settings_.height - SQUARE_SIZE) / 2);
+
+    // Late consumer doesn't get the missed frames in a burst
+    nextFrame_ = std::max(nextFrame_ + interval_, Clock::now());
+    ++frameIndex_;
+
+    return FrameView {
+        pixels_.data(),
+        settings_.width,
+        settings_.height,
+        settings_.width * BYTES_PER_PIXEL,
+        BYTES_PER_PIXEL,
+    };
+}
+
+void TestPatternSource::drawBackground(
+        std::uint32_t x,
+        std::uint32_t y,
+        std::uint32_t width,
+        std::uint32_t height)
+{
+    for (auto row = y; row < y + height; ++row) {
+        auto *pixel = pixels_.data()
+                      + (std::size_t { row } * settings_.width + x) * BYTES_PER_PIXEL;
+        for (auto column = x; column < x + width; ++column) {
+            pixel[0] = static_cast<std::uint8_t>(column * 255 / settings_.width);
+            pixel[1] = static_cast<std::uint8_t>(row * 255 / settings_.height);
+            pixel[2] = 128;
+            pixel[3] = 255;
+            pixel += BYTES_PER_PIXEL;
+        }
+    }
+}
+
+void TestPatternSource::drawSquare(std::uint32_t x, std::uint32_t y)
+{
+    for (auto row = y; row < y + SQUARE_SIZE; ++row) {
+        auto *pixel = pixels_.data()
+                      + (std::size_t { row } * settings_.width + x) * BYTES_PER_PIXEL;
+        std::fill(pixel, pixel + SQUARE_SIZE * BYTES_PER_PIXEL, std::uint8_t { 255 });
+    }
+}
+
+}; // namespace video::frame_source
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "IFrameSource.h"
+
+namespace video::frame_source
+{
+
+struct TestPatternSettings
+{
+    std::uint32_t width { 1280 };
+    std::uint32_t height { 720 };
+    std::uint32_t fps { 60 };
+};
+
+/**
+ * @brief Generated BGRA frames, until there is a real screen capture
+ *
+ * Static gradient with a white square moving across it, so consecutive
+ * frames differ only in a few tiles, like a desktop with a moving window.
+ * Frames are paced at settings.fps, a late consumer gets the next frame
+ * at once but frames are never sent in a burst to catch up.
+ */
+class TestPatternSource final: public IFrameSource
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::uint32_t SQUARE_SIZE = 64;
+    static constexpr std::uint32_t SQUARE_STEP = 8; ///< Pixels the square moves per frame
+
+public:
+    /**
+     * @throw std::invalid_argument  Frame is smaller than the square or fps is 0
+     */
+    explicit TestPatternSource(const TestPatternSettings &settings);
+
+public:
+    auto next() -> std::optional<FrameView> override;
+
+private:
+    void drawBackground(std::uint32_t x, std::uint32_t y, std::uint32_t width, std::uint32_t height);
+    void drawSquare(std::uint32_t x, std::uint32_t y);
+
+private:
+    TestPatternSettings       settings_;
+    std::vector<std::uint8_t> pixels_;
+    Clock::duration           interval_ {};
+    Clock::time_point         nextFrame_;
+    std::uint64_t             frameIndex_ { 0 };
+    std::uint32_t             squareX_ { 0 };
+};
+
+}; // namespace video::frame_source
@@ -0,0 +1,208 @@
+#include "AllocationTracker.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef WINDOWS
+#include <malloc.h>
+#endif
+
+namespace {
+
+// Trivial types, so nothing runs before the first allocation of a thread
+thread_local constinit uint64_t threadCount = 0;
+constinit std::atomic<uint64_t> totalCount  = 0;
+
+void count()
+{
+    ++threadCount;
+    totalCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto allocate(std::size_t size) noexcept -> void *
+{
+    count();
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+auto allocateAligned(std::size_t size, std::align_val_t alignment) noexcept -> void *
+{
+    count();
+
+    const auto bytes = size == 0 ? 1 : size;
+#ifdef WINDOWS
+    return ::_aligned_malloc(bytes, static_cast<std::size_t>(alignment));
+#else
+    const auto align  = std::max(static_cast<std::size_t>(alignment), sizeof(void *));
+    void      *memory = nullptr;
+    if (::posix_memalign(&memory, align, bytes) != 0) {
+        return nullptr;
+    }
+    return memory;
+#endif
+}
+
+void release(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void releaseAligned(void *memory) noexcept
+{
+#ifdef WINDOWS
+    ::_aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+template<class Allocate>
+auto allocateOrThrow(Allocate &&allocate_memory) -> void *
+{
+    auto *memory = allocate_memory();
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+} // namespace
+
+namespace pirks::test
+{
+
+auto threadAllocations() -> uint64_t
+{
+    return threadCount;
+}
+
+auto totalAllocations() -> uint64_t
+{
+    return totalCount.load(std::memory_order_relaxed);
+}
+
+NoAllocationScope::NoAllocationScope()
+        : start_ { threadCount }
+{
+}
+
+NoAllocationScope::~NoAllocationScope()
+{
+    // Reporting a failure allocates too, so the count is taken first
+    if (const auto count = allocations(); count != 0) {
+        ADD_FAILURE() << count << " allocations where none are allowed";
+    }
+}
+
+auto NoAllocationScope::allocations() const -> uint64_t
+{
+    return threadCount - start_;
+}
+
+}; // namespace pirks::test
+
+// Replacements of the global allocation functions, see [new.delete]
+
+void *operator new(std::size_t size)
+{
+    return allocateOrThrow([size] { return allocate(size); });
+}
+
+void *operator new[](std::size_t size)
+{
+    return allocateOrThrow([size] { return allocate(size); });
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocateOrThrow([=] { return allocateAligned(size, alignment); });
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return allocateOrThrow([=] { return allocateAligned(size, alignment); });
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocateAligned(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void *memory) noexcept
+{
+    release(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    release(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    release(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    release(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept
+{
+    release(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept
+{
+    release(memory);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept
+{
+    releaseAligned(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t) noexcept
+{
+    releaseAligned(memory);
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept
+{
+    releaseAligned(memory);
+}
+
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept
+{
+    releaseAligned(memory);
+}
+
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    releaseAligned(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    releaseAligned(memory);
+}
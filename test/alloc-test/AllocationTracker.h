@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+namespace pirks::test
+{
+
+/**
+ * @brief Allocations made with global operator new by the calling thread
+ *
+ * AllocationTracker.cpp replaces every global operator new and delete of
+ * the test executable, so all C++ allocations are counted: containers,
+ * std::function, std::string and memory resources on the default heap.
+ * Direct malloc() calls of C libraries are not.
+ */
+[[nodiscard]]
+auto threadAllocations() -> uint64_t;
+
+/**
+ * @brief Allocations made with global operator new by all threads
+ */
+[[nodiscard]]
+auto totalAllocations() -> uint64_t;
+
+/**
+ * @brief Fails the current test if its thread allocates while the scope is alive
+ *
+ * Hot paths are expected to allocate nothing once they are warmed up, so
+ * the scope is opened after the first iterations. Scopes can be nested.
+ */
+class NoAllocationScope final
+{
+public:
+    NoAllocationScope();
+    ~NoAllocationScope();
+
+    NoAllocationScope(const NoAllocationScope &)            = delete;
+    NoAllocationScope &operator=(const NoAllocationScope &) = delete;
+
+public:
+    /**
+     * @brief Allocations made by this thread since the scope was opened
+     */
+    [[nodiscard]]
+    auto allocations() const -> uint64_t;
+
+private:
+    uint64_t start_;
+};
+
+}; // namespace pirks::test
@@ -0,0 +1,62 @@
+#include <gtest/gtest-spi.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "AllocationTracker.h"
+
+using namespace pirks::test;
+
+namespace {
+
+// Keeps allocations from being optimized away
+void *volatile sink = nullptr;
+
+} // namespace
+
+TEST(AllocationTracker, CountsThreads)
+{
+    const auto thread = threadAllocations();
+    const auto total  = totalAllocations();
+
+    auto value = std::make_unique<int>(1);
+    sink       = value.get();
+    EXPECT_EQ(threadAllocations() - thread, 1u);
+
+    uint64_t    otherAllocations = 0;
+    std::thread other { [&otherAllocations] {
+        const auto before = threadAllocations();
+        auto       values = std::make_unique<int[]>(16);
+        sink              = values.get();
+        otherAllocations  = threadAllocations() - before;
+    } };
+
+    // Allocations of the other thread are not counted for this one
+    const auto started = threadAllocations();
+    other.join();
+
+    EXPECT_EQ(otherAllocations, 1u);
+    EXPECT_EQ(threadAllocations(), started);
+    EXPECT_GE(totalAllocations() - total, 2u);
+}
+
+TEST(AllocationTracker, ScopeFailsTest)
+{
+    {
+        NoAllocationScope scope;
+        int               values[16] = {};
+        sink                         = values;
+        EXPECT_EQ(scope.allocations(), 0u);
+    }
+
+    EXPECT_NONFATAL_FAILURE(
+            {
+                NoAllocationScope scope;
+                std::vector<int>  values(16);
+                sink = values.data();
+            },
+            "1 allocations where none are allowed");
+}
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "AllocationTracker.h"
+#include "CircularBuffer.h"
+#include "ColorConvert.h"
+#include "FrameDiff.h"
+#include "UDPConnection.h"
+
+using namespace pirks::networking;
+using namespace pirks::test;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr int WARM_UP_ROUNDS = 4;
+
+auto makeFrame(std::uint32_t width, std::uint32_t height, std::uint8_t seed)
+        -> std::vector<std::uint8_t>
+{
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(width) * height * 4);
+    for (std::size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = static_cast<std::uint8_t>(i * 7 + seed);
+    }
+    return pixels;
+}
+
+} // namespace
+
+TEST(HotPathAllocations, CircularBuffer)
+{
+    CircularBuffer<PacketInfo> queue { 64 };
+    PacketBatch<16>            storage;
+    auto                      &batch = storage.packets();
+
+    std::array<PacketInfo, 8> packets {};
+
+    auto round = [&] {
+        queue.push(packets[0]);
+        queue.push(packets);
+        (void)queue.pop();
+        (void)queue.pop(10ms);
+        (void)queue.pop(batch, 4);
+        (void)queue.pop(batch, 16, 10ms);
+    };
+
+    for (int i = 0; i < WARM_UP_ROUNDS; ++i) {
+        round();
+    }
+
+    NoAllocationScope scope;
+    for (int i = 0; i < 1000; ++i) {
+        round();
+    }
+}
+
+TEST(HotPathAllocations, ColorConversion)
+{
+    using namespace video;
+
+    constexpr std::uint32_t WIDTH  = 320;
+    constexpr std::uint32_t HEIGHT = 240;
+
+    const std::array frames = { makeFrame(WIDTH, HEIGHT, 1), makeFrame(WIDTH, HEIGHT, 2) };
+
+    frame_diff::FrameDiff    diff;
+    encode_video::I420Frame  yuv;
+    std::array<FrameView, 2> views;
+    for (std::size_t i = 0; i < views.size(); ++i) {
+        views[i] = FrameView { frames[i].data(), WIDTH, HEIGHT, WIDTH * 4, 4 };
+    }
+
+    // Buffers are sized by the first frames, after that frames of the same
+    // size only reuse them
+    auto round = [&](std::size_t i) {
+        const auto &frame   = views[i % views.size()];
+        const auto  result  = diff.compare(frame);
+        const bool  partial = result.decision == frame_diff::FrameDecision::Partial;
+        encode_video::convertBgraToI420(
+                frame,
+                yuv,
+                partial ? &diff.dirtyTiles() : nullptr,
+                diff.tileSize());
+    };
+
+    for (int i = 0; i < WARM_UP_ROUNDS; ++i) {
+        round(static_cast<std::size_t>(i));
+    }
+
+    NoAllocationScope scope;
+    for (std::size_t i = 0; i < 100; ++i) {
+        round(i);
+    }
+}
+
+TEST(HotPathAllocations, UdpSendLoop)
+{
+    constexpr std::size_t PAYLOAD_SIZE = 200;
+
+    auto pool = std::make_shared<PacketPool>(
+            UDPConnection::MAX_PAYLOAD_SIZE,
+            64,
+            wire::PACKET_HEADROOM);
+    auto in  = std::make_shared<PacketsQueue>();
+    auto out = std::make_shared<PacketsQueue>();
+
+    UDPConnection connection { 0, pool };
+    connection.create(in, out);
+
+    UdpSocket client;
+    client.bind(0);
+    client.setReceiveTimeout(100ms);
+
+    SocketAddress server;
+    server.address.sin_family      = AF_INET;
+    server.address.sin_port        = htons(connection.localPort());
+    server.address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    // First valid datagram makes the client the remote side
+    wire::Header hello;
+    hello.channel     = Channel::Control;
+    hello.payloadSize = 1;
+
+    std::array<uint8_t, wire::HEADER_SIZE + 1> helloDatagram {};
+    wire::serialize(hello, std::span { helloDatagram }.first<wire::HEADER_SIZE>());
+    ASSERT_TRUE(client.sendTo(helloDatagram, server));
+
+    const auto delivered = in->pop(1s);
+    ASSERT_TRUE(delivered);
+    pool->release(delivered->data);
+
+    std::array<uint8_t, UDPConnection::MAX_DATAGRAM_SIZE> datagram;
+
+    // Sends one packet through the connection, true when the client gets it
+    auto roundTrip = [&] {
+        auto *block = pool->acquire();
+        if (block == nullptr) {
+            return false;
+        }
+        std::memset(block, 0x5A, PAYLOAD_SIZE);
+
+        PacketInfo packet;
+        packet.channel = Channel::Video;
+        packet.size    = PAYLOAD_SIZE;
+        packet.data    = block;
+        out->push(packet);
+
+        SocketAddress from;
+        for (int i = 0; i < 10; ++i) {
+            const auto size = client.receiveFrom(datagram, from);
+            if (size && *size >= PAYLOAD_SIZE) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Until the connection has seen the client and every lazy buffer is made
+    int received = 0;
+    for (int i = 0; i < 100 && received < 10; ++i) {
+        received += roundTrip() ? 1 : 0;
+    }
+    ASSERT_EQ(received, 10);
+
+    // Send and receive threads of the connection are counted too
+    const auto total = totalAllocations();
+    {
+        NoAllocationScope scope;
+        for (int i = 0; i < 100; ++i) {
+            ASSERT_TRUE(roundTrip());
+        }
+    }
+    EXPECT_EQ(totalAllocations() - total, 0u);
+}
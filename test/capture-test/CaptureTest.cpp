@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PcapReplayer.h"
+#include "PcapWriter.h"
+
+using namespace pirks::networking;
+using namespace pirks::networking::capture;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::size_t PACKET_BLOCK_SIZE = 256;
+constexpr std::size_t FRAME_BLOCK_SIZE  = 64 * 1024;
+
+class CaptureTest: public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        file_ = (std::filesystem::temp_directory_path()
+                 / ("pirks-capture-test-" + std::to_string(::getpid()) + ".pcapng"))
+                        .string();
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(file_);
+    }
+
+    // Packet of size bytes, every one derived from seed
+    auto makePacket(std::size_t size, uint8_t seed) -> PacketInfo
+    {
+        auto &payload = payloads_.emplace_back(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            payload[i] = static_cast<uint8_t>(i * 13 + seed);
+        }
+
+        PacketInfo packet;
+        packet.channel       = Channel::Video;
+        packet.reliable      = seed % 2 == 0;
+        packet.sequence      = seed;
+        packet.size          = static_cast<uint32_t>(size);
+        packet.timestamp     = seed * 3000u;
+        packet.fragmentIndex = 0;
+        packet.fragmentCount = 1;
+        packet.data          = payload.data();
+        return packet;
+    }
+
+    // Pops everything from queue, payloads are copied and blocks released
+    auto drain(PacketsQueue &queue) -> std::vector<std::vector<uint8_t>>
+    {
+        std::vector<std::vector<uint8_t>> result;
+        while (!queue.isEmpty()) {
+            const auto packet = queue.pop();
+            result.emplace_back(packet->data, packet->data + packet->size);
+            headers_.push_back(*packet);
+            if (packets_->owns(packet->data)) {
+                packets_->release(packet->data);
+            } else {
+                frames_->release(packet->data);
+            }
+        }
+        return result;
+    }
+
+    std::string                       file_;
+    std::vector<std::vector<uint8_t>> payloads_;
+    std::vector<PacketHeader>         headers_;
+    std::shared_ptr<PacketPool> packets_ { std::make_shared<PacketPool>(PACKET_BLOCK_SIZE, 64) };
+    std::shared_ptr<PacketPool> frames_ { std::make_shared<PacketPool>(FRAME_BLOCK_SIZE, 4) };
+};
+
+} // namespace
+
+TEST(PcapFormat, RecordHeaderRoundTrip)
+{
+    PacketHeader packet;
+    packet.channel       = Channel::Audio;
+    packet.reliable      = true;
+    packet.sequence      = 0xABCD;
+    packet.size          = 100000;
+    packet.timestamp     = 0x01020304;
+    packet.fragmentIndex = 2;
+    packet.fragmentCount = 5;
+
+    std::vector<uint8_t> data(RECORD_HEADER_SIZE + packet.size);
+    serializeRecordHeader(packet, std::span<uint8_t, RECORD_HEADER_SIZE> { data.data(), 16 });
+
+    const auto parsed = parseRecordHeader(data);
+    ASSERT_TRUE(parsed);
+    EXPECT_EQ(parsed->channel, packet.channel);
+    EXPECT_EQ(parsed->reliable, packet.reliable);
+    EXPECT_EQ(parsed->sequence, packet.sequence);
+    EXPECT_EQ(parsed->size, packet.size);
+    EXPECT_EQ(parsed->timestamp, packet.timestamp);
+    EXPECT_EQ(parsed->fragmentIndex, packet.fragmentIndex);
+    EXPECT_EQ(parsed->fragmentCount, packet.fragmentCount);
+
+    // Size must match the captured data
+    data.pop_back();
+    EXPECT_FALSE(parseRecordHeader(data));
+}
+
+TEST_F(CaptureTest, TapAndReplay)
+{
+    PacketsQueue captureIn;
+    PacketsQueue captureOut;
+
+    const std::vector<PacketInfo> sent = {
+        makePacket(100, 1),
+        makePacket(0, 2),
+        makePacket(PACKET_BLOCK_SIZE, 3),
+        makePacket(FRAME_BLOCK_SIZE, 4), // Frame, replayed from the frame pool
+        makePacket(7, 5),
+    };
+
+    {
+        PcapWriter writer { 1024 * 1024 };
+        writer.open(file_);
+        captureIn.setTap(&writer.tap(Direction::Inbound));
+        captureOut.setTap(&writer.tap(Direction::Outbound));
+
+        captureIn.push(sent[0]);
+        captureOut.push(std::span<const PacketInfo> { sent }.subspan(1));
+
+        captureIn.setTap(nullptr);
+        captureOut.setTap(nullptr);
+        writer.close();
+
+        EXPECT_EQ(writer.written(), sent.size());
+        EXPECT_EQ(writer.dropped(), 0u);
+    }
+
+    PacketsQueue in;
+    PacketsQueue out;
+    PcapReplayer replayer { packets_, frames_ };
+
+    const auto stats = replayer.replay(file_, in, out, ReplaySettings { .speed = 0 });
+    EXPECT_EQ(stats.packets, sent.size());
+    EXPECT_EQ(stats.dropped, 0u);
+
+    const auto inbound = drain(in);
+    ASSERT_EQ(inbound.size(), 1u);
+    EXPECT_EQ(inbound[0], payloads_[0]);
+
+    const auto outbound = drain(out);
+    ASSERT_EQ(outbound.size(), sent.size() - 1);
+    for (std::size_t i = 0; i < outbound.size(); ++i) {
+        EXPECT_EQ(outbound[i], payloads_[i + 1]);
+    }
+
+    ASSERT_EQ(headers_.size(), sent.size());
+    for (std::size_t i = 0; i < sent.size(); ++i) {
+        EXPECT_EQ(headers_[i].sequence, sent[i].sequence);
+        EXPECT_EQ(headers_[i].reliable, sent[i].reliable);
+        EXPECT_EQ(headers_[i].timestamp, sent[i].timestamp);
+    }
+
+    EXPECT_EQ(packets_->available(), packets_->blockCount());
+    EXPECT_EQ(frames_->available(), frames_->blockCount());
+}
+
+TEST_F(CaptureTest, DropsWhenRingIsFull)
+{
+    PcapWriter writer { 4096 };
+    writer.open(file_);
+
+    // Nothing is written until a whole block is ready or the writer wakes up
+    const auto packet = makePacket(1000, 1);
+    int        passed = 0;
+    for (int i = 0; i < 100; ++i) {
+        passed += writer.write(packet, Direction::Outbound) ? 1 : 0;
+    }
+    writer.close();
+
+    EXPECT_GT(passed, 0);
+    EXPECT_EQ(writer.written(), static_cast<uint64_t>(passed));
+    EXPECT_EQ(writer.written() + writer.dropped(), 100u);
+
+    // Everything which was let through is in the file
+    PacketsQueue in;
+    PacketsQueue out;
+    PcapReplayer replayer { packets_, frames_ };
+    const auto   stats = replayer.replay(file_, in, out, ReplaySettings { .speed = 0 });
+    EXPECT_EQ(stats.packets, writer.written());
+}
+
+TEST_F(CaptureTest, ReplayKeepsTiming)
+{
+    {
+        PcapWriter writer;
+        writer.open(file_);
+        writer.write(makePacket(10, 1), Direction::Outbound);
+        std::this_thread::sleep_for(100ms);
+        writer.write(makePacket(10, 2), Direction::Outbound);
+    }
+
+    PacketsQueue in;
+    PacketsQueue out;
+    PcapReplayer replayer { packets_, frames_ };
+
+    // Twice as fast as captured
+    auto start = std::chrono::steady_clock::now();
+    replayer.replay(file_, in, out, ReplaySettings { .speed = 2 });
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 50ms);
+    drain(out);
+
+    start = std::chrono::steady_clock::now();
+    replayer.replay(file_, in, out, ReplaySettings { .speed = 0 });
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 50ms);
+    drain(out);
+}
+
+TEST_F(CaptureTest, ReplayRejectsOtherFiles)
+{
+    std::ofstream { file_ } << "not a capture";
+
+    PacketsQueue in;
+    PacketsQueue out;
+    PcapReplayer replayer { packets_, frames_ };
+    EXPECT_THROW(replayer.replay(file_, in, out), std::runtime_error);
+    EXPECT_THROW(replayer.replay(file_ + ".missing", in, out), std::runtime_error);
+}
@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <array>
+#include <iterator>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -444,3 +445,66 @@ TEST_F(MemoryUtilsTest, DumpMemoryToString_LastLinePartial_Mixed)
     const auto newline_count = std::count(result.begin(), result.end(), '\n');
     EXPECT_EQ(newline_count, 3);
 }
+
+TEST_F(MemoryUtilsTest, DumpMemoryLine_CallerBuffer)
+{
+    std::vector<uint8_t> data = { 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x2c, 0x20, 0x57, 0x6f };
+
+    std::array<char, memory_utils::DUMP_LINE_SIZE> line;
+    memory_utils::dumpMemoryLine(std::span { data }, 0x1234abcd, line);
+
+    std::string expected =
+            "1234abcd: 48 65 6c 6c 6f 2c 20 57  6f                       |Hello, W o       |\n";
+    EXPECT_EQ(std::string(line.begin(), line.end()), expected);
+}
+
+TEST_F(MemoryUtilsTest, DumpMemory_AppendsToBuffer)
+{
+    std::vector<uint8_t> data(40);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    // Every length gives the same lines as dumpMemoryToString, after what's in the buffer
+    fmt::memory_buffer buffer;
+    for (size_t size = 0; size <= data.size(); ++size) {
+        const auto part = std::span<const uint8_t> { data }.first(size);
+
+        buffer.clear();
+        fmt::format_to(std::back_inserter(buffer), "head\n");
+        memory_utils::dumpMemory(part, buffer, "> ");
+
+        EXPECT_EQ(fmt::to_string(buffer), "head\n" + memory_utils::dumpMemoryToString(part, "> "));
+    }
+}
+
+TEST_F(MemoryUtilsTest, LogMemoryDump_SameAsString)
+{
+    std::vector<uint8_t> data(20);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(0x41 + i);
+    }
+
+    testing::internal::CaptureStdout();
+    memory_utils::logMemoryDump(std::span { data }, "DUMP ", spdlog::level::info);
+    std::string output = testing::internal::GetCapturedStdout();
+
+    // Every line is logged with the pattern of the fixture
+    std::string expected;
+    std::istringstream dump(memory_utils::dumpMemoryToString(std::span { data }, "DUMP "));
+    for (std::string line; std::getline(dump, line);) {
+        expected += "[info] " + line + "\n";
+    }
+    EXPECT_EQ(output, expected);
+}
+
+TEST_F(MemoryUtilsTest, LogMemoryDump_LevelOff)
+{
+    std::vector<uint8_t> data = { 0x48, 0x65, 0x6c, 0x6c, 0x6f };
+
+    testing::internal::CaptureStdout();
+    memory_utils::logMemoryDump(std::span { data }, "", spdlog::level::trace);
+    std::string output = testing::internal::GetCapturedStdout();
+
+    EXPECT_TRUE(output.empty());
+}
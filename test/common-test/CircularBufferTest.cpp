@@ -1,5 +1,11 @@
 #include <gtest/gtest.h>
 
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
 #include "CircularBuffer.h"
 #include "debug/CircularBufferToStr.h"
 
@@ -169,6 +175,101 @@ TEST(CircularBuffer, Overwrite)
     EXPECT_EQ(CircularBufferToStr(buff), "{}"s);
 }
 
+TEST(CircularBuffer, IsFull)
+{
+    CircularBuffer<int> buff { 3 };
+
+    buff.push(1);
+    EXPECT_FALSE(buff.isFull());
+
+    buff.push(2);
+    EXPECT_FALSE(buff.isFull());
+
+    buff.push(3);
+    EXPECT_TRUE(buff.isFull());
+
+    buff.push(4);
+    EXPECT_TRUE(buff.isFull());
+
+    EXPECT_EQ(buff.pop(), 2);
+    EXPECT_FALSE(buff.isFull());
+
+    EXPECT_EQ(buff.pop(), 3);
+    EXPECT_EQ(buff.pop(), 4);
+    EXPECT_FALSE(buff.isFull());
+}
+
+// isFull() used to be true whenever exactly one element was queued
+TEST(CircularBuffer, IsFullOnlyAtCapacity)
+{
+    for (const size_t capacity : { 1u, 2u, 3u, 7u }) {
+        // Every start position, so the indices wrap around at every fill level
+        for (size_t offset = 0; offset <= capacity; ++offset) {
+            CircularBuffer<int> buff { capacity };
+            for (size_t i = 0; i < offset; ++i) {
+                buff.push(0);
+                EXPECT_EQ(buff.pop(), 0);
+            }
+
+            for (size_t count = 1; count <= capacity; ++count) {
+                buff.push(static_cast<int>(count));
+                EXPECT_EQ(buff.size(), count);
+                EXPECT_EQ(buff.isFull(), count == capacity)
+                        << "capacity " << capacity << ", offset " << offset << ", " << count
+                        << " queued";
+            }
+
+            EXPECT_EQ(buff.pop(), 1);
+            EXPECT_FALSE(buff.isFull());
+        }
+    }
+}
+
+TEST(CircularBuffer, Size)
+{
+    CircularBuffer<int> buff { 3 };
+    EXPECT_EQ(buff.size(), 0u);
+
+    buff.push(1);
+    buff.push(2);
+    EXPECT_EQ(buff.size(), 2u);
+
+    // Overwritten element is not counted
+    buff.push(3);
+    buff.push(4);
+    EXPECT_EQ(buff.size(), 3u);
+
+    EXPECT_EQ(buff.pop(), 2);
+    EXPECT_EQ(buff.size(), 2u);
+}
+
+TEST(CircularBuffer, Tap)
+{
+    struct Recorder final: CircularBuffer<int>::Tap
+    {
+        std::vector<int> seen;
+
+        void onPush(std::span<const int> elements) override
+        {
+            seen.insert(seen.end(), elements.begin(), elements.end());
+        }
+    };
+
+    CircularBuffer<int> buff { 2 };
+    Recorder            recorder;
+    buff.setTap(&recorder);
+
+    // Overwritten elements are seen too
+    buff.push(1);
+    const int elements[] = { 2, 3 };
+    buff.push(elements);
+    EXPECT_EQ(recorder.seen, (std::vector<int> { 1, 2, 3 }));
+
+    buff.setTap(nullptr);
+    buff.push(4);
+    EXPECT_EQ(recorder.seen.size(), 3u);
+}
+
 TEST(CircularBuffer, PushMultipleElements)
 {
     CircularBuffer<int> buff { 8 };
@@ -264,3 +365,34 @@ TEST(CircularBuffer, PopMultipleElements)
         EXPECT_EQ(buff.pop(v, 16, 20ms), 0u);
     }
 }
+
+TEST(CircularBuffer, PopIntoMemoryResource)
+{
+    CircularBuffer<int> buff { 8 };
+
+    // Output buffer can't take memory from anywhere else than the arena
+    std::array<std::byte, 4 * sizeof(int)> storage;
+    std::pmr::monotonic_buffer_resource    arena {
+        storage.data(),
+        storage.size(),
+        std::pmr::null_memory_resource()
+    };
+    std::pmr::vector<int> v { &arena };
+    v.reserve(4);
+
+    for (int round = 0; round < 3; ++round) {
+        const int elements[] = { round, round + 1, round + 2, round + 3, round + 4 };
+        buff.push(elements);
+
+        EXPECT_EQ(buff.pop(v, 4), 4u);
+        EXPECT_EQ(v.at(0), round);
+        EXPECT_EQ(v.at(3), round + 3);
+
+        EXPECT_EQ(buff.pop(v, 4, 20ms), 1u);
+        EXPECT_EQ(v.at(0), round + 4);
+    }
+
+    std::pmr::vector<int> small { &arena };
+    buff.push(1);
+    EXPECT_THROW((void)buff.pop(small, 4), std::bad_alloc);
+}
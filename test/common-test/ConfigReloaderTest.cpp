@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "ConfigReloader.h"
+
+using namespace pirks::config;
+using namespace std::chrono_literals;
+
+#ifdef LINUX
+
+namespace {
+
+// Waits a bit longer than the reloader polls
+bool waitFor(const std::atomic_int &reloads, int expected)
+{
+    for (int i = 0; i < 100 && reloads < expected; ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+    return reloads == expected;
+}
+
+} // namespace
+
+class ConfigReloaderTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        directory_ = std::filesystem::temp_directory_path()
+                     / ("pirks-reload-test-" + std::to_string(::getpid()));
+        std::filesystem::create_directories(directory_);
+        file_ = (directory_ / "server.toml").string();
+        std::ofstream { file_ } << "bitrate = 1000\n";
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory_);
+    }
+
+    std::filesystem::path directory_;
+    std::string           file_;
+};
+
+TEST_F(ConfigReloaderTest, ReloadsOnWrite)
+{
+    std::atomic_int reloads { 0 };
+    ConfigReloader  reloader { file_, [&reloads] { ++reloads; } };
+    reloader.start();
+
+    std::ofstream { file_ } << "bitrate = 2000\n";
+    EXPECT_TRUE(waitFor(reloads, 1));
+
+    // Other files in the directory are ignored
+    std::ofstream { directory_ / "other.toml" } << "bitrate = 3000\n";
+    std::this_thread::sleep_for(300ms);
+    EXPECT_EQ(reloads, 1);
+}
+
+TEST_F(ConfigReloaderTest, ReloadsOnRename)
+{
+    std::atomic_int reloads { 0 };
+    ConfigReloader  reloader { file_, [&reloads] { ++reloads; } };
+    reloader.start();
+
+    // As editors save files
+    const auto temporary = directory_ / "server.toml.tmp";
+    std::ofstream { temporary } << "bitrate = 2000\n";
+    EXPECT_EQ(reloads, 0);
+
+    std::filesystem::rename(temporary, file_);
+    EXPECT_TRUE(waitFor(reloads, 1));
+}
+
+TEST_F(ConfigReloaderTest, ReloadsOnHangup)
+{
+    std::atomic_int reloads { 0 };
+    ConfigReloader  reloader { file_, [&reloads] { ++reloads; } };
+    reloader.start();
+
+    ::raise(SIGHUP);
+    EXPECT_TRUE(waitFor(reloads, 1));
+}
+
+TEST_F(ConfigReloaderTest, ThrowingReloadKeepsWatching)
+{
+    std::atomic_int reloads { 0 };
+    auto            reload = [&reloads] {
+        ++reloads;
+        throw std::runtime_error("Invalid config");
+    };
+    ConfigReloader reloader { file_, reload };
+    reloader.start();
+
+    ::raise(SIGHUP);
+    EXPECT_TRUE(waitFor(reloads, 1));
+
+    ::raise(SIGHUP);
+    EXPECT_TRUE(waitFor(reloads, 2));
+}
+
+#endif
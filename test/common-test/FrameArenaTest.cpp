@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory_resource>
+#include <numeric>
+#include <vector>
+
+#include "FrameArena.h"
+
+using namespace pirks::memory;
+
+namespace {
+
+// Counts allocations passed to the upstream resource
+class CountingResource final: public std::pmr::memory_resource
+{
+public:
+    std::size_t allocations { 0 };
+    std::size_t deallocations { 0 };
+
+private:
+    auto do_allocate(std::size_t bytes, std::size_t alignment) -> void * override
+    {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *memory, std::size_t bytes, std::size_t alignment) override
+    {
+        ++deallocations;
+        std::pmr::new_delete_resource()->deallocate(memory, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+} // namespace
+
+TEST(FrameArena, PreviousFrameStaysValid)
+{
+    FrameArena arena { 1024 };
+
+    auto first = arena.scratch<uint32_t>(16);
+    std::iota(first.begin(), first.end(), 0u);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(first.data()) % alignof(uint32_t), 0u);
+
+    arena.beginFrame();
+    auto second = arena.scratch<uint32_t>(16);
+    std::fill(second.begin(), second.end(), 0xFFFFFFFF);
+
+    for (uint32_t i = 0; i < first.size(); ++i) {
+        EXPECT_EQ(first[i], i);
+    }
+
+    // Memory of the frame before the previous one is reused
+    arena.beginFrame();
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.scratch<uint32_t>(16).data(), first.data());
+}
+
+TEST(FrameArena, NoAllocationsPerFrame)
+{
+    CountingResource upstream;
+    {
+        FrameArena arena { 64 * 1024, &upstream };
+        EXPECT_EQ(upstream.allocations, 1u);
+
+        // Stages may keep their std::pmr containers on the arena too
+        auto *previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+        for (int frame = 0; frame < 1000; ++frame) {
+            arena.beginFrame();
+
+            auto samples = arena.scratch<float>(960 * 2);
+            std::fill(samples.begin(), samples.end(), 0.5f);
+
+            std::pmr::vector<uint8_t> packet { &arena };
+            packet.resize(1200);
+        }
+        std::pmr::set_default_resource(previous);
+
+        EXPECT_EQ(upstream.allocations, 1u);
+        EXPECT_EQ(arena.overflows(), 0u);
+    }
+    EXPECT_EQ(upstream.deallocations, 1u);
+}
+
+#ifdef DEBUG
+
+TEST(FrameArenaDeathTest, Overflow)
+{
+    FrameArena arena { 256 };
+    EXPECT_DEATH((void)arena.scratch<uint8_t>(1024), "too small");
+}
+
+TEST(FrameArenaDeathTest, Overrun)
+{
+    FrameArena arena { 256 };
+
+    auto buffer = arena.scratch<uint8_t>(32);
+    buffer.data()[32] = 0;
+
+    arena.beginFrame();
+    EXPECT_DEATH(arena.beginFrame(), "overrun");
+}
+
+#else
+
+TEST(FrameArena, OverflowGoesUpstream)
+{
+    CountingResource upstream;
+    FrameArena       arena { 256, &upstream };
+
+    auto *memory = arena.allocate(1024);
+    EXPECT_EQ(arena.overflows(), 1u);
+    EXPECT_EQ(upstream.allocations, 2u);
+
+    arena.deallocate(memory, 1024);
+    EXPECT_EQ(upstream.deallocations, 1u);
+}
+
+#endif
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "CircularBuffer.h"
+#include "HugePageResource.h"
+
+using namespace pirks::memory;
+
+namespace {
+
+bool isAligned(const void *memory, std::size_t alignment)
+{
+    return reinterpret_cast<std::uintptr_t>(memory) % alignment == 0;
+}
+
+} // namespace
+
+TEST(HugePageResource, SmallAllocationsAreCacheLineAligned)
+{
+    HugePageResource resource;
+
+    for (const std::size_t size: { 1u, 24u, 100u, 4096u }) {
+        void *memory = resource.allocate(size, alignof(std::max_align_t));
+        EXPECT_TRUE(isAligned(memory, HugePageResource::CACHE_LINE_SIZE)) << size;
+        resource.deallocate(memory, size, alignof(std::max_align_t));
+    }
+
+    EXPECT_EQ(resource.hugePageAllocations() + resource.fallbackAllocations(), 0u);
+}
+
+TEST(HugePageResource, BigAllocationsAreMapped)
+{
+    HugePageResource resource { HugePageSettings { .prefault = true, .lock = false } };
+
+    // Not a multiple of the huge page, the rest of the last one is unused
+    constexpr std::size_t SIZE = 3 * HugePageResource::HUGE_PAGE_SIZE + 100;
+
+    auto *memory = static_cast<uint8_t *>(resource.allocate(SIZE));
+    ASSERT_NE(memory, nullptr);
+    EXPECT_TRUE(isAligned(memory, HugePageResource::HUGE_PAGE_SIZE));
+
+    // Prefaulted pages are zeroed
+    EXPECT_EQ(memory[0], 0);
+    EXPECT_EQ(memory[SIZE - 1], 0);
+    memory[0]        = 1;
+    memory[SIZE - 1] = 2;
+
+    resource.deallocate(memory, SIZE);
+
+    // Whichever is available on this machine
+    EXPECT_EQ(resource.hugePageAllocations() + resource.fallbackAllocations(), 1u);
+}
+
+TEST(HugePageResource, Locked)
+{
+    // Locking may be refused by RLIMIT_MEMLOCK, memory is usable anyway
+    HugePageResource resource { HugePageSettings { .prefault = false, .lock = true } };
+
+    std::pmr::vector<uint8_t> buffer { HugePageResource::HUGE_PAGE_SIZE, &resource };
+    buffer.back() = 1;
+    EXPECT_TRUE(isAligned(buffer.data(), HugePageResource::HUGE_PAGE_SIZE));
+}
+
+TEST(HugePageResource, CircularBufferStorage)
+{
+    HugePageResource resource;
+
+    struct Slot
+    {
+        uint8_t bytes[4096];
+    };
+
+    CircularBuffer<Slot> buff { 1024, &resource };
+    EXPECT_TRUE(isAligned(buff.unsafe().data(), HugePageResource::HUGE_PAGE_SIZE));
+    EXPECT_EQ(buff.unsafe().get_allocator().resource(), &resource);
+
+    buff.push(Slot { { 42 } });
+    EXPECT_EQ(buff.pop()->bytes[0], 42);
+}
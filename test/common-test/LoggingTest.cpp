@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <spdlog/sinks/base_sink.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Logging.h"
+
+using namespace pirks::config;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Keeps messages, and can be as slow as a blocked terminal
+class TestSink final : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    explicit TestSink(std::chrono::milliseconds delay = 0ms)
+            : delay_ { delay }
+    {
+    }
+
+    std::vector<std::string> messages;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override
+    {
+        std::this_thread::sleep_for(delay_);
+        messages.emplace_back(msg.payload.begin(), msg.payload.end());
+    }
+
+    void flush_() override
+    {
+        //
+    }
+
+private:
+    std::chrono::milliseconds delay_;
+};
+
+// Default logger is replaced by one writing to sink while it's alive
+class DefaultLogger final
+{
+public:
+    explicit DefaultLogger(std::shared_ptr<TestSink> sink)
+            : previous_ { spdlog::default_logger() }
+    {
+        spdlog::set_default_logger(std::make_shared<spdlog::logger>("test", std::move(sink)));
+    }
+
+    ~DefaultLogger()
+    {
+        spdlog::set_default_logger(previous_);
+    }
+
+    DefaultLogger(const DefaultLogger &)            = delete;
+    DefaultLogger &operator=(const DefaultLogger &) = delete;
+
+private:
+    std::shared_ptr<spdlog::logger> previous_;
+};
+
+} // namespace
+
+TEST(RateLimiter, OnePerInterval)
+{
+    RateLimiter limiter { 1h };
+
+    EXPECT_EQ(limiter.acquire(), 0u);
+    EXPECT_FALSE(limiter.acquire());
+    EXPECT_FALSE(limiter.acquire());
+}
+
+TEST(RateLimiter, CountsSuppressed)
+{
+    RateLimiter limiter { 20ms };
+
+    EXPECT_EQ(limiter.acquire(), 0u);
+    EXPECT_FALSE(limiter.acquire());
+    EXPECT_FALSE(limiter.acquire());
+
+    std::this_thread::sleep_for(30ms);
+    EXPECT_EQ(limiter.acquire(), 2u);
+}
+
+TEST(Logging, LimitedMacro)
+{
+    auto                sink = std::make_shared<TestSink>();
+    const DefaultLogger logger { sink };
+
+    auto log = [](int i) {
+        PIRKS_LOG_EVERY(50ms, spdlog::level::warn, "Packet {} dropped", i);
+    };
+
+    // Limiter is static, so it may be left closed by a repeated run
+    std::this_thread::sleep_for(60ms);
+
+    for (int i = 0; i < 100; ++i) {
+        log(i);
+    }
+    std::this_thread::sleep_for(60ms);
+    log(100);
+
+    const std::vector<std::string> expected = {
+        "Packet 0 dropped",
+        "99 messages like the next one were suppressed",
+        "Packet 100 dropped",
+    };
+    EXPECT_EQ(sink->messages, expected);
+}
+
+TEST(Logging, AsyncDoesNotBlock)
+{
+    constexpr int MESSAGES = 1000;
+
+    auto                sink = std::make_shared<TestSink>(1ms);
+    const DefaultLogger logger { sink };
+    setupAsyncLogging(16);
+
+    // Synchronously it would take a second
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < MESSAGES; ++i) {
+        spdlog::info("Message {}", i);
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 500ms);
+
+    shutdownLogging();
+
+    // Oldest ones were dropped, queued ones are written with the report about them
+    ASSERT_GE(sink->messages.size(), 2u);
+    EXPECT_LT(sink->messages.size(), static_cast<std::size_t>(MESSAGES));
+    EXPECT_EQ(sink->messages[sink->messages.size() - 2], "Message 999");
+    EXPECT_TRUE(sink->messages.back().ends_with("log messages were dropped, log queue was full"));
+}
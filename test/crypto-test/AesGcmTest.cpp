@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <string_view>
+#include <vector>
+
+#include "AesGcm.h"
+
+using namespace pirks::networking::crypto;
+
+namespace {
+
+auto fromHex(std::string_view hex) -> std::vector<uint8_t>
+{
+    auto nibble = [](char c) {
+        return static_cast<uint8_t>(c <= '9' ? c - '0' : c - 'a' + 10);
+    };
+
+    std::vector<uint8_t> result;
+    for (std::size_t i = 0; i + 1 < hex.size(); i += 2) {
+        result.push_back(static_cast<uint8_t>(nibble(hex[i]) << 4 | nibble(hex[i + 1])));
+    }
+    return result;
+}
+
+auto testKey() -> SessionKey
+{
+    SessionKey key;
+    for (std::size_t i = 0; i < key.key.size(); ++i) {
+        key.key[i] = static_cast<uint8_t>(i * 11);
+    }
+    for (std::size_t i = 0; i < key.iv.size(); ++i) {
+        key.iv[i] = static_cast<uint8_t>(i * 5 + 1);
+    }
+    return key;
+}
+
+class AesGcmTest: public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (!isAvailable()) {
+            GTEST_SKIP() << "built without OpenSSL";
+        }
+    }
+};
+
+} // namespace
+
+TEST(AesGcm, NotAvailableThrows)
+{
+    if (isAvailable()) {
+        GTEST_SKIP() << "built with OpenSSL";
+    }
+
+    EXPECT_THROW(AesGcm { SessionKey {} }, std::runtime_error);
+    EXPECT_THROW(static_cast<void>(generateSessionKey()), std::runtime_error);
+}
+
+TEST(AesGcm, PacketIndexSpacesDoNotOverlap)
+{
+    EXPECT_NE(packetIndex(false, 1, 5), packetIndex(true, 1, 5));
+    EXPECT_NE(packetIndex(false, 1, 5), packetIndex(false, 2, 5));
+    EXPECT_EQ(packetIndex(false, 0, 0x1'0000), 0x1'0000u);
+    EXPECT_EQ(packetIndex(true, 3, 7), 0x8003'0000'0000'0007u);
+    EXPECT_EQ(packetIndex(SequenceSpace::Control, 3, 7), 0x4003'0000'0000'0007u);
+    EXPECT_NE(packetIndex(SequenceSpace::Control, 1, 5), packetIndex(true, 1, 5));
+    EXPECT_NE(packetIndex(SequenceSpace::Control, 1, 5), packetIndex(false, 1, 5));
+}
+
+// Test case 4 of the GCM specification (McGrew, Viega)
+TEST_F(AesGcmTest, SpecificationVector)
+{
+    SessionKey key;
+    const auto rawKey = fromHex("feffe9928665731c6d6a8f9467308308");
+    const auto rawIv  = fromHex("cafebabefacedbaddecaf888");
+    std::copy(rawKey.begin(), rawKey.end(), key.key.begin());
+    std::copy(rawIv.begin(), rawIv.end(), key.iv.begin());
+
+    const auto aad = fromHex("feedfacedeadbeeffeedfacedeadbeefabaddad2");
+    auto       data = fromHex(
+            "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+            "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39");
+    const auto ciphertext = fromHex(
+            "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+            "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091");
+    const auto expectedTag = fromHex("5bc94fbc3221a5db94fae95ae7121a47");
+
+    AesGcm aes { key };
+
+    std::array<uint8_t, TAG_SIZE> tag {};
+    ASSERT_TRUE(aes.seal(aad, data, tag, 0));
+    EXPECT_EQ(data, ciphertext);
+    EXPECT_TRUE(std::equal(tag.begin(), tag.end(), expectedTag.begin()));
+}
+
+TEST_F(AesGcmTest, RoundTripInPlace)
+{
+    AesGcm sender { testKey() };
+    AesGcm receiver { testKey() };
+
+    std::vector<uint8_t> aad(16, 0x42);
+
+    for (std::size_t size: { 0u, 1u, 15u, 16u, 17u, 1392u }) {
+        std::vector<uint8_t> plaintext(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            plaintext[i] = static_cast<uint8_t>(i * 3);
+        }
+
+        auto                          data = plaintext;
+        std::array<uint8_t, TAG_SIZE> tag {};
+        ASSERT_TRUE(sender.seal(aad, data, tag, size));
+        if (size >= 16) {
+            EXPECT_NE(data, plaintext) << size;
+        }
+
+        ASSERT_TRUE(receiver.open(aad, data, tag, size)) << size;
+        EXPECT_EQ(data, plaintext) << size;
+    }
+}
+
+TEST_F(AesGcmTest, DetectsTampering)
+{
+    AesGcm sender { testKey() };
+    AesGcm receiver { testKey() };
+
+    const std::vector<uint8_t> aad(16, 7);
+    const std::vector<uint8_t> plaintext(100, 9);
+
+    auto                          data = plaintext;
+    std::array<uint8_t, TAG_SIZE> tag {};
+    ASSERT_TRUE(sender.seal(aad, data, tag, 1234));
+
+    auto tryOpen = [&](std::vector<uint8_t> open_aad,
+                       std::vector<uint8_t> open_data,
+                       std::array<uint8_t, TAG_SIZE> open_tag,
+                       uint64_t index) {
+        return receiver.open(open_aad, open_data, open_tag, index);
+    };
+
+    EXPECT_TRUE(tryOpen(aad, data, tag, 1234));
+
+    auto badData = data;
+    badData[50] ^= 1;
+    EXPECT_FALSE(tryOpen(aad, badData, tag, 1234));
+
+    auto badAad = aad;
+    badAad[4] ^= 0x80;
+    EXPECT_FALSE(tryOpen(badAad, data, tag, 1234));
+
+    auto badTag = tag;
+    badTag[15] ^= 1;
+    EXPECT_FALSE(tryOpen(aad, data, badTag, 1234));
+
+    // Nonce of another packet, e.g. replayed with a different sequence number
+    EXPECT_FALSE(tryOpen(aad, data, tag, 1235));
+
+    // Key of the other direction
+    auto otherKey = testKey();
+    otherKey.key[0] ^= 1;
+    AesGcm other { otherKey };
+    auto   copy = data;
+    EXPECT_FALSE(other.open(aad, copy, tag, 1234));
+}
+
+TEST_F(AesGcmTest, NonceDependsOnIndex)
+{
+    AesGcm aes { testKey() };
+
+    std::vector<uint8_t>          first(64, 1);
+    std::vector<uint8_t>          second(64, 1);
+    std::array<uint8_t, TAG_SIZE> tag {};
+    ASSERT_TRUE(aes.seal({}, first, tag, packetIndex(false, 3, 1)));
+    ASSERT_TRUE(aes.seal({}, second, tag, packetIndex(true, 3, 1)));
+    EXPECT_NE(first, second);
+}
+
+TEST_F(AesGcmTest, GenerateSessionKey)
+{
+    const auto first  = generateSessionKey();
+    const auto second = generateSessionKey();
+    EXPECT_NE(first.key, second.key);
+    EXPECT_NE(first.iv, second.iv);
+}
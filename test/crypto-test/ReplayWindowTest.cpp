@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include "ReplayWindow.h"
+
+using namespace pirks::networking::crypto;
+
+using Status = ReplayWindow::Status;
+
+TEST(ReplayWindow, RejectsSeenIndices)
+{
+    ReplayWindow window;
+
+    EXPECT_EQ(window.check(0), Status::Fresh);
+    window.accept(0);
+    EXPECT_EQ(window.check(0), Status::Seen);
+
+    // Reordered packets are accepted once
+    window.accept(5);
+    EXPECT_EQ(window.newest(), 5u);
+    EXPECT_EQ(window.check(3), Status::Fresh);
+    window.accept(3);
+    EXPECT_EQ(window.check(3), Status::Seen);
+    EXPECT_EQ(window.check(4), Status::Fresh);
+    EXPECT_EQ(window.check(5), Status::Seen);
+    EXPECT_EQ(window.check(6), Status::Fresh);
+}
+
+TEST(ReplayWindow, Slides)
+{
+    ReplayWindow window;
+    window.accept(10);
+    window.accept(10 + ReplayWindow::SIZE - 1);
+
+    // Oldest index of the window is still remembered
+    EXPECT_EQ(window.check(10), Status::Seen);
+    EXPECT_EQ(window.check(9), Status::Stale);
+
+    window.accept(10 + ReplayWindow::SIZE);
+    EXPECT_EQ(window.check(10), Status::Stale);
+    EXPECT_EQ(window.check(11), Status::Fresh);
+    EXPECT_EQ(window.check(10 + ReplayWindow::SIZE - 1), Status::Seen);
+
+    // Jump further than the window forgets everything
+    window.accept(100000);
+    EXPECT_EQ(window.check(10 + ReplayWindow::SIZE), Status::Stale);
+    EXPECT_EQ(window.check(100000 - 1), Status::Fresh);
+    EXPECT_EQ(window.check(100000), Status::Seen);
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "ColorConvert.h"
+#include "FrameDiff.h"
+
+using namespace video;
+using namespace video::encode_video;
+
+namespace {
+
+auto makeFrame(std::uint32_t w, std::uint32_t h, std::uint8_t b, std::uint8_t g, std::uint8_t r)
+        -> std::vector<std::uint8_t>
+{
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(w) * h * 4);
+    for (std::size_t i = 0; i < pixels.size(); i += 4) {
+        pixels[i]     = b;
+        pixels[i + 1] = g;
+        pixels[i + 2] = r;
+        pixels[i + 3] = 255;
+    }
+    return pixels;
+}
+
+} // namespace
+
+TEST(ColorConvert, BlackAndWhite)
+{
+    auto black = makeFrame(16, 16, 0, 0, 0);
+    auto white = makeFrame(16, 16, 255, 255, 255);
+
+    I420Frame out;
+    convertBgraToI420(FrameView { black.data(), 16, 16, 16 * 4, 4 }, out);
+    EXPECT_EQ(out.y[0], 16);
+    EXPECT_EQ(out.u[0], 128);
+    EXPECT_EQ(out.v[0], 128);
+
+    convertBgraToI420(FrameView { white.data(), 16, 16, 16 * 4, 4 }, out);
+    EXPECT_EQ(out.y[0], 235);
+    EXPECT_EQ(out.u[0], 128);
+    EXPECT_EQ(out.v[0], 128);
+}
+
+TEST(ColorConvert, PrimaryColors)
+{
+    auto red  = makeFrame(2, 2, 0, 0, 255);
+    auto blue = makeFrame(2, 2, 255, 0, 0);
+
+    I420Frame out;
+    convertBgraToI420(FrameView { red.data(), 2, 2, 8, 4 }, out);
+    EXPECT_NEAR(out.y[0], 63, 1);
+    EXPECT_NEAR(out.u[0], 102, 1);
+    EXPECT_NEAR(out.v[0], 240, 1);
+
+    convertBgraToI420(FrameView { blue.data(), 2, 2, 8, 4 }, out);
+    EXPECT_NEAR(out.y[0], 32, 1);
+    EXPECT_NEAR(out.u[0], 240, 1);
+    EXPECT_NEAR(out.v[0], 118, 1);
+}
+
+TEST(ColorConvert, OddSize)
+{
+    auto      white = makeFrame(5, 3, 255, 255, 255);
+    I420Frame out;
+    convertBgraToI420(FrameView { white.data(), 5, 3, 5 * 4, 4 }, out);
+
+    ASSERT_EQ(out.chromaWidth(), 3u);
+    ASSERT_EQ(out.chromaHeight(), 2u);
+    for (auto y: out.y) {
+        EXPECT_EQ(y, 235);
+    }
+}
+
+TEST(ColorConvert, OnlyDirtyTilesAreConverted)
+{
+    constexpr std::uint32_t W = 64;
+    constexpr std::uint32_t H = 32;
+
+    auto                  pixels = makeFrame(W, H, 0, 0, 0);
+    const FrameView       view { pixels.data(), W, H, W * 4, 4 };
+    frame_diff::FrameDiff diff { 16 };
+    I420Frame             out;
+
+    diff.compare(view);
+    convertBgraToI420(view, out, nullptr, 16);
+
+    // Make everything white, but pretend that only tile (1, 0) was changed
+    pixels = makeFrame(W, H, 255, 255, 255);
+    frame_diff::DirtyTileMap dirty { W / 16, H / 16 };
+    dirty.set(1, 0);
+    convertBgraToI420(FrameView { pixels.data(), W, H, W * 4, 4 }, out, &dirty, 16);
+
+    // tile (0, 0) kept old value
+    EXPECT_EQ(out.y[0], 16);
+
+    // tile (1, 0) converted
+    EXPECT_EQ(out.y[16], 235);
+    EXPECT_EQ(out.y[15 * W + 31], 235);
+
+    // tile (1, 1) kept old value
+    EXPECT_EQ(out.y[16 * W + 16], 16);
+}
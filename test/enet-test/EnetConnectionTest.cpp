@@ -0,0 +1,479 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "EnetConnection.h"
+
+#ifdef WITH_ENET
+#include <enet/enet.h>
+#endif
+
+using namespace pirks::networking;
+using namespace pirks::networking::enet;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::size_t BLOCK_SIZE  = 1400;
+constexpr std::size_t BLOCK_COUNT = 4096;
+
+auto makePool(std::size_t headroom = wire::PACKET_HEADROOM)
+{
+    return std::make_shared<PacketPool>(BLOCK_SIZE, BLOCK_COUNT, headroom);
+}
+
+auto waitFor(const std::function<bool()> &condition, std::chrono::milliseconds timeout) -> bool
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+/**
+ * @brief Wire header and payload of a packet, as ENet carries it
+ */
+auto makeDatagram(const wire::Header &header) -> std::vector<uint8_t>
+{
+    std::vector<uint8_t> datagram(wire::HEADER_SIZE + header.payloadSize);
+    wire::serialize(header, wire::headerBefore(datagram.data() + wire::HEADER_SIZE));
+    return datagram;
+}
+
+auto makeHeader(Channel channel, bool reliable, uint16_t payloadSize) -> wire::Header
+{
+    wire::Header header;
+    header.flags       = reliable ? wire::Flags::Reliable : 0;
+    header.channel     = channel;
+    header.payloadSize = payloadSize;
+    return header;
+}
+
+class EnetLoopbackTest: public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (!isAvailable()) {
+            GTEST_SKIP() << "built without ENet";
+        }
+
+        server_ = std::make_unique<EnetConnection>(EnetSettings {}, serverPool_);
+        server_->create(serverIn_, serverOut_);
+        ASSERT_NE(server_->localPort(), 0);
+
+        EnetSettings clientSettings;
+        clientSettings.host = "127.0.0.1";
+        clientSettings.port = server_->localPort();
+
+        client_ = std::make_unique<EnetConnection>(clientSettings, clientPool_);
+        client_->create(clientIn_, clientOut_);
+
+        ASSERT_TRUE(waitFor(
+                [this] {
+                    return server_->isConnected() && client_->isConnected();
+                },
+                2s));
+    }
+
+    auto makePacket(PacketPool &pool, Channel channel, bool reliable, uint32_t size)
+            -> PacketInfo
+    {
+        PacketInfo packet;
+        packet.channel  = channel;
+        packet.reliable = reliable;
+        packet.size     = size;
+        packet.data     = pool.acquire();
+        while (packet.data == nullptr) {
+            // Blocks come back when ENet destroys sent packets
+            std::this_thread::yield();
+            packet.data = pool.acquire();
+        }
+        return packet;
+    }
+
+protected:
+    std::shared_ptr<PacketPool>     serverPool_ { makePool() };
+    std::shared_ptr<PacketPool>     clientPool_ { makePool() };
+    std::shared_ptr<PacketsQueue>   serverIn_ { std::make_shared<PacketsQueue>(BLOCK_COUNT) };
+    std::shared_ptr<PacketsQueue>   serverOut_ { std::make_shared<PacketsQueue>(BLOCK_COUNT) };
+    std::shared_ptr<PacketsQueue>   clientIn_ { std::make_shared<PacketsQueue>(BLOCK_COUNT) };
+    std::shared_ptr<PacketsQueue>   clientOut_ { std::make_shared<PacketsQueue>(BLOCK_COUNT) };
+    std::unique_ptr<EnetConnection> server_;
+    std::unique_ptr<EnetConnection> client_;
+};
+
+#ifdef WITH_ENET
+
+/**
+ * @brief Plain ENet host connected to a connection, sees how its packets go over ENet
+ */
+class RawPeer
+{
+public:
+    struct Received
+    {
+        uint8_t              channel { 0 };
+        uint32_t             flags { 0 };
+        std::vector<uint8_t> data;
+    };
+
+public:
+    explicit RawPeer(uint16_t port)
+    {
+        enet_initialize();
+
+        ENetAddress address {};
+        enet_address_set_host(&address, "127.0.0.1");
+        address.port = port;
+
+        host_ = enet_host_create(nullptr, 1, CHANNEL_COUNT, 0, 0);
+        peer_ = host_ != nullptr ? enet_host_connect(host_, &address, CHANNEL_COUNT, 0) : nullptr;
+    }
+
+    ~RawPeer()
+    {
+        if (host_ != nullptr) {
+            enet_host_destroy(host_);
+        }
+        enet_deinitialize();
+    }
+
+    RawPeer(const RawPeer &)            = delete;
+    RawPeer &operator=(const RawPeer &) = delete;
+
+    bool connect()
+    {
+        ENetEvent event;
+        while (peer_ != nullptr && enet_host_service(host_, &event, 2000) > 0) {
+            if (event.type == ENET_EVENT_TYPE_CONNECT) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void send(uint8_t channel, uint32_t flags, const std::vector<uint8_t> &datagram)
+    {
+        enet_peer_send(peer_, channel, enet_packet_create(datagram.data(), datagram.size(), flags));
+        enet_host_flush(host_);
+    }
+
+    auto receive(std::chrono::milliseconds timeout) -> std::optional<Received>
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+        ENetEvent event;
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (enet_host_service(host_, &event, 1) <= 0 || event.type != ENET_EVENT_TYPE_RECEIVE) {
+                continue;
+            }
+
+            Received received;
+            received.channel = event.channelID;
+            received.flags   = event.packet->flags;
+            received.data.assign(
+                    event.packet->data,
+                    event.packet->data + event.packet->dataLength);
+            enet_packet_destroy(event.packet);
+            return received;
+        }
+        return std::nullopt;
+    }
+
+private:
+    ENetHost *host_ { nullptr };
+    ENetPeer *peer_ { nullptr };
+};
+
+class EnetPeerTest: public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        server_ = std::make_unique<EnetConnection>(EnetSettings {}, pool_);
+        server_->create(in_, out_);
+        ASSERT_NE(server_->localPort(), 0);
+
+        peer_ = std::make_unique<RawPeer>(server_->localPort());
+        ASSERT_TRUE(peer_->connect());
+        ASSERT_TRUE(waitFor(
+                [this] {
+                    return server_->isConnected();
+                },
+                2s));
+    }
+
+protected:
+    std::shared_ptr<PacketPool>     pool_ { makePool() };
+    std::shared_ptr<PacketsQueue>   in_ { std::make_shared<PacketsQueue>(BLOCK_COUNT) };
+    std::shared_ptr<PacketsQueue>   out_ { std::make_shared<PacketsQueue>(BLOCK_COUNT) };
+    std::unique_ptr<EnetConnection> server_;
+    std::unique_ptr<RawPeer>        peer_;
+};
+
+#endif
+
+} // namespace
+
+TEST(EnetConnection, NotAvailableThrows)
+{
+    if (isAvailable()) {
+        GTEST_SKIP() << "built with ENet";
+    }
+
+    EXPECT_THROW((EnetConnection { EnetSettings {}, makePool() }), std::runtime_error);
+}
+
+TEST(EnetConnection, PoolWithoutHeadroom)
+{
+    EXPECT_THROW((EnetConnection { EnetSettings {}, makePool(0) }), std::invalid_argument);
+}
+
+TEST(EnetConnection, SendOptions)
+{
+    PacketInfo control;
+    control.channel  = Channel::Control;
+    control.reliable = true;
+    EXPECT_EQ(sendOptions(control),
+              (SendOptions { Channel::Control, PacketFlags::NoAllocate | PacketFlags::Reliable }));
+
+    // Unreliable packets stay unreliable when ENet fragments them
+    PacketInfo video;
+    video.channel  = Channel::Video;
+    video.reliable = false;
+    EXPECT_EQ(sendOptions(video),
+              (SendOptions { Channel::Video,
+                             PacketFlags::NoAllocate | PacketFlags::UnreliableFragment }));
+}
+
+TEST(EnetConnection, ParseReceived)
+{
+    const auto control = makeDatagram(makeHeader(Channel::Control, true, 4));
+    const auto video   = makeDatagram(makeHeader(Channel::Video, false, 4));
+
+    const auto header = parseReceived(Channel::Control, PacketFlags::Reliable, control);
+    ASSERT_TRUE(header);
+    EXPECT_EQ(*header, makeHeader(Channel::Control, true, 4));
+
+    EXPECT_TRUE(parseReceived(Channel::Video, 0, video));
+    EXPECT_TRUE(parseReceived(Channel::Video, PacketFlags::UnreliableFragment, video));
+
+    // Header and ENet must agree on the channel and the reliability
+    EXPECT_FALSE(parseReceived(Channel::Video, PacketFlags::Reliable, control));
+    EXPECT_FALSE(parseReceived(Channel::Control, 0, control));
+    EXPECT_FALSE(parseReceived(Channel::Video, PacketFlags::Reliable, video));
+
+    // Acknowledgements and parity are not sent over ENet
+    auto ack  = makeHeader(Channel::Control, true, 4);
+    ack.flags = wire::Flags::Ack;
+    EXPECT_FALSE(parseReceived(Channel::Control, 0, makeDatagram(ack)));
+
+    auto truncated = control;
+    truncated.pop_back();
+    EXPECT_FALSE(parseReceived(Channel::Control, PacketFlags::Reliable, truncated));
+}
+
+TEST_F(EnetLoopbackTest, ChannelsAndReliability)
+{
+    constexpr uint32_t COUNT = 200;
+
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        auto control = makePacket(*clientPool_, Channel::Control, true, sizeof(i));
+        std::memcpy(control.data, &i, sizeof(i));
+        control.timestamp = i;
+        clientOut_->push(control);
+
+        auto video = makePacket(*clientPool_, Channel::Video, false, BLOCK_SIZE);
+        std::fill_n(video.data, video.size, static_cast<uint8_t>(i));
+        video.timestamp     = i;
+        video.fragmentIndex = 1;
+        video.fragmentCount = 3;
+        clientOut_->push(video);
+    }
+
+    uint32_t nextControl = 0;
+    uint32_t video       = 0;
+    while (auto packet = serverIn_->pop(1s)) {
+        if (packet->channel == Channel::Control) {
+            EXPECT_TRUE(packet->reliable);
+            ASSERT_EQ(packet->size, sizeof(nextControl));
+
+            uint32_t value = 0;
+            std::memcpy(&value, packet->data, sizeof(value));
+            EXPECT_EQ(value, nextControl);
+            EXPECT_EQ(packet->timestamp, nextControl);
+            ++nextControl;
+        } else {
+            EXPECT_EQ(packet->channel, Channel::Video);
+            EXPECT_FALSE(packet->reliable);
+            EXPECT_EQ(packet->size, BLOCK_SIZE);
+            EXPECT_EQ(packet->fragmentIndex, 1);
+            EXPECT_EQ(packet->fragmentCount, 3);
+            EXPECT_EQ(packet->data[BLOCK_SIZE - 1], static_cast<uint8_t>(packet->timestamp));
+            ++video;
+        }
+        serverPool_->release(packet->data);
+
+        if (nextControl == COUNT && video == COUNT) {
+            break;
+        }
+    }
+
+    // Unreliable packets may be lost even on loopback, reliable ones may not
+    EXPECT_EQ(nextControl, COUNT);
+    EXPECT_GT(video, 0u);
+
+    // Sent packets are destroyed by ENet after the acknowledgement at the latest
+    EXPECT_TRUE(waitFor(
+            [this] {
+                return clientPool_->available() == BLOCK_COUNT;
+            },
+            2s));
+}
+
+#ifdef WITH_ENET
+
+TEST_F(EnetPeerTest, PacketsGoOnTheirChannels)
+{
+    constexpr uint32_t COUNT = 20;
+
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        for (const auto &[channel, reliable] : { std::pair { Channel::Control, true },
+                                                 std::pair { Channel::Video, false } })
+        {
+            PacketInfo packet;
+            packet.channel   = channel;
+            packet.reliable  = reliable;
+            packet.size      = sizeof(i);
+            packet.timestamp = i;
+            packet.data      = pool_->acquire();
+            ASSERT_NE(packet.data, nullptr);
+            std::memcpy(packet.data, &i, sizeof(i));
+            out_->push(packet);
+        }
+    }
+
+    uint32_t control = 0;
+    uint32_t video   = 0;
+    while (auto received = peer_->receive(1s)) {
+        const auto header = wire::parse(received->data);
+        ASSERT_TRUE(header);
+        EXPECT_EQ(received->channel, header->channel);
+
+        const bool reliable = (header->flags & wire::Flags::Reliable) != 0;
+        EXPECT_EQ((received->flags & ENET_PACKET_FLAG_RELIABLE) != 0, reliable);
+
+        if (header->channel == Channel::Control) {
+            EXPECT_TRUE(reliable);
+            EXPECT_EQ(header->timestamp, control);
+            ++control;
+        } else {
+            EXPECT_EQ(header->channel, Channel::Video);
+            EXPECT_FALSE(reliable);
+            ++video;
+        }
+
+        if (control == COUNT && video == COUNT) {
+            break;
+        }
+    }
+
+    // Unreliable packets may be lost even on loopback, reliable ones may not
+    EXPECT_EQ(control, COUNT);
+    EXPECT_GT(video, 0u);
+}
+
+TEST_F(EnetPeerTest, ReceivedAsSent)
+{
+    // Header says reliable, ENet carried it unreliably
+    peer_->send(Channel::Control, 0, makeDatagram(makeHeader(Channel::Control, true, 4)));
+    // Header of the video channel on the control one
+    peer_->send(
+            Channel::Control,
+            ENET_PACKET_FLAG_RELIABLE,
+            makeDatagram(makeHeader(Channel::Video, true, 4)));
+    peer_->send(
+            Channel::Control,
+            ENET_PACKET_FLAG_RELIABLE,
+            makeDatagram(makeHeader(Channel::Control, true, 8)));
+
+    // Channel delivers in order, so what is in front of the last packet is dropped
+    const auto packet = in_->pop(1s);
+    ASSERT_TRUE(packet);
+    EXPECT_EQ(packet->channel, Channel::Control);
+    EXPECT_TRUE(packet->reliable);
+    EXPECT_EQ(packet->size, 8u);
+    pool_->release(packet->data);
+
+    EXPECT_EQ(in_->size(), 0u);
+}
+
+#endif
+
+// Not a pass/fail test: reports throughput and one way latency of unreliable
+// video packets from server to client, 1080p60 needs about 20-50 Mbit/s
+TEST_F(EnetLoopbackTest, Throughput)
+{
+    constexpr uint32_t PACKET_COUNT = 100'000;
+
+    const auto start     = std::chrono::steady_clock::now();
+    auto       elapsedUs = [start] {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                             std::chrono::steady_clock::now() - start)
+                                             .count());
+    };
+
+    std::thread producer { [&] {
+        for (uint32_t i = 0; i < PACKET_COUNT; ++i) {
+            auto packet      = makePacket(*serverPool_, Channel::Video, false, BLOCK_SIZE);
+            packet.timestamp = elapsedUs();
+            serverOut_->push(packet);
+        }
+    } };
+
+    std::vector<uint32_t> latencyUs;
+    latencyUs.reserve(PACKET_COUNT);
+    while (auto packet = clientIn_->pop(500ms)) {
+        latencyUs.push_back(elapsedUs() - packet->timestamp);
+        clientPool_->release(packet->data);
+        if (latencyUs.size() == PACKET_COUNT) {
+            break;
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    producer.join();
+
+    ASSERT_FALSE(latencyUs.empty());
+    std::sort(latencyUs.begin(), latencyUs.end());
+
+    const auto percentile = [&latencyUs](double p) {
+        return latencyUs[static_cast<std::size_t>(p * static_cast<double>(latencyUs.size() - 1))];
+    };
+
+    const auto mbitSec = static_cast<double>(latencyUs.size() * BLOCK_SIZE * 8) / elapsed.count()
+                         / 1e6;
+    RecordProperty("unreliable_mbit_per_second", std::to_string(mbitSec));
+    std::printf(
+            "ENet loopback, %zu byte packets: %.1f Mbit/s, %zu of %u delivered, "
+            "latency p50 %u us, p99 %u us\n",
+            BLOCK_SIZE,
+            mbitSec,
+            latencyUs.size(),
+            PACKET_COUNT,
+            percentile(0.5),
+            percentile(0.99));
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "GaloisField.h"
+#include "GaloisKernels.h"
+
+using namespace pirks::networking::fec;
+
+namespace {
+
+// Slow reference multiplication: shift and add with reduction
+auto referenceMul(std::uint8_t a, std::uint8_t b) -> std::uint8_t
+{
+    unsigned result = 0;
+    unsigned x      = a;
+    for (unsigned bits = b; bits != 0; bits >>= 1) {
+        if (bits & 1) {
+            result ^= x;
+        }
+        x <<= 1;
+        if (x & 0x100) {
+            x ^= gf::POLYNOMIAL;
+        }
+    }
+    return static_cast<std::uint8_t>(result);
+}
+
+} // namespace
+
+TEST(GaloisField, MulMatchesReference)
+{
+    for (unsigned a = 0; a < 256; ++a) {
+        for (unsigned b = 0; b < 256; ++b) {
+            const auto x = static_cast<std::uint8_t>(a);
+            const auto y = static_cast<std::uint8_t>(b);
+            ASSERT_EQ(gf::mul(x, y), referenceMul(x, y)) << a << " * " << b;
+        }
+    }
+}
+
+TEST(GaloisField, InverseAndDivision)
+{
+    for (unsigned a = 1; a < 256; ++a) {
+        const auto x = static_cast<std::uint8_t>(a);
+        EXPECT_EQ(gf::mul(x, gf::inv(x)), 1);
+        EXPECT_EQ(gf::div(x, x), 1);
+        EXPECT_EQ(gf::div(gf::mul(x, 0x53), x), 0x53);
+    }
+}
+
+TEST(GaloisKernels, AllKernelsMatchScalar)
+{
+    const auto kernels = availableKernels();
+    ASSERT_FALSE(kernels.empty());
+    EXPECT_STREQ(kernels.front().name, "scalar");
+
+    std::mt19937 rng { 7 };
+
+    // Sizes cover vector bodies and scalar tails
+    for (std::size_t size: { 1u, 15u, 16u, 31u, 32u, 33u, 100u, 1400u }) {
+        std::vector<std::uint8_t> src(size);
+        std::vector<std::uint8_t> init(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            src[i]  = static_cast<std::uint8_t>(rng());
+            init[i] = static_cast<std::uint8_t>(rng());
+        }
+
+        for (unsigned c = 0; c < 256; ++c) {
+            auto expected = init;
+            for (std::size_t i = 0; i < size; ++i) {
+                expected[i] ^= gf::mul(static_cast<std::uint8_t>(c), src[i]);
+            }
+
+            for (const auto &kernel: kernels) {
+                auto dst = init;
+                kernel.mulAdd(dst.data(), src.data(), static_cast<std::uint8_t>(c), size);
+                ASSERT_EQ(dst, expected) << kernel.name << " c=" << c << " size=" << size;
+            }
+        }
+    }
+}
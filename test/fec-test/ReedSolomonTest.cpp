@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "FecCodec.h"
+#include "ReedSolomon.h"
+
+using namespace pirks::networking;
+using namespace pirks::networking::fec;
+
+namespace {
+
+auto randomBytes(std::mt19937 &rng, std::size_t size) -> std::vector<std::uint8_t>
+{
+    std::vector<std::uint8_t> bytes(size);
+    for (auto &b: bytes) {
+        b = static_cast<std::uint8_t>(rng());
+    }
+    return bytes;
+}
+
+} // namespace
+
+TEST(ReedSolomon, InvalidShardCount)
+{
+    EXPECT_THROW(ReedSolomon(0, 2), std::invalid_argument);
+    EXPECT_THROW(ReedSolomon(4, 0), std::invalid_argument);
+    EXPECT_THROW(ReedSolomon(200, 57), std::invalid_argument);
+    EXPECT_NO_THROW(ReedSolomon(200, 56));
+}
+
+TEST(ReedSolomon, RecoverAnyLossPattern)
+{
+    constexpr std::size_t K    = 5;
+    constexpr std::size_t M    = 3;
+    constexpr std::size_t SIZE = 100;
+
+    std::mt19937 rng { 1 };
+    ReedSolomon  codec { K, M };
+
+    // Shards of different sizes, shorter ones are padded with zeros
+    std::vector<std::vector<std::uint8_t>> data;
+    std::vector<ShardView>                 dataViews;
+    for (std::size_t i = 0; i < K; ++i) {
+        data.push_back(randomBytes(rng, SIZE - i * 7));
+        dataViews.push_back({ data.back().data(), data.back().size() });
+    }
+
+    std::vector<std::vector<std::uint8_t>> parity(M, std::vector<std::uint8_t>(SIZE));
+    std::vector<std::uint8_t *>            parityPointers;
+    for (auto &p: parity) {
+        parityPointers.push_back(p.data());
+    }
+    codec.encode(dataViews, parityPointers, SIZE);
+
+    // Every subset of lost shards, up to M shards
+    for (unsigned mask = 0; mask < (1u << (K + M)); ++mask) {
+        if (std::popcount(mask) > static_cast<int>(M)) {
+            continue;
+        }
+
+        std::vector<ShardView> shards;
+        for (std::size_t s = 0; s < K + M; ++s) {
+            if (mask & (1u << s)) {
+                shards.push_back({});
+            } else if (s < K) {
+                shards.push_back(dataViews[s]);
+            } else {
+                shards.push_back({ parity[s - K].data(), SIZE });
+            }
+        }
+
+        std::vector<std::vector<std::uint8_t>> out(K, std::vector<std::uint8_t>(SIZE, 0xCC));
+        std::vector<std::uint8_t *>            outPointers;
+        for (auto &o: out) {
+            outPointers.push_back(o.data());
+        }
+
+        ASSERT_TRUE(codec.reconstruct(shards, outPointers, SIZE)) << "mask " << mask;
+
+        for (std::size_t i = 0; i < K; ++i) {
+            if (mask & (1u << i)) {
+                std::vector<std::uint8_t> expected = data[i];
+                expected.resize(SIZE, 0);
+                ASSERT_EQ(out[i], expected) << "mask " << mask << " shard " << i;
+            }
+        }
+    }
+}
+
+TEST(ReedSolomon, TooManyLosses)
+{
+    ReedSolomon               codec { 3, 1 };
+    std::vector<std::uint8_t> a(10, 1);
+    std::vector<std::uint8_t> out(10);
+    std::vector<std::uint8_t *> outPointers { out.data(), out.data(), out.data() };
+
+    std::vector<ShardView> shards { {}, {}, { a.data(), a.size() }, { a.data(), a.size() } };
+    EXPECT_FALSE(codec.reconstruct(shards, outPointers, 10));
+}
+
+TEST(FecCodec, RecoverPackets)
+{
+    auto pool = std::make_shared<PacketPool>(256, 64);
+
+    FecSettings settings;
+    settings.dataShards   = 4;
+    settings.parityShards = 2;
+
+    FecEncoder encoder { settings, pool };
+    FecDecoder decoder { settings, pool };
+
+    std::mt19937                           rng { 3 };
+    std::vector<std::vector<std::uint8_t>> payloads;
+    std::vector<PacketInfo>                data;
+
+    // Short group: only 3 of 4 data packets
+    for (std::size_t i = 0; i < 3; ++i) {
+        payloads.push_back(randomBytes(rng, 50 + i * 30));
+
+        PacketInfo packet;
+        packet.channel       = Channel::Video;
+        packet.size          = static_cast<std::uint32_t>(payloads.back().size());
+        packet.timestamp     = 3000;
+        packet.fragmentIndex = static_cast<std::uint16_t>(i);
+        packet.fragmentCount = 3;
+        packet.data          = payloads.back().data();
+        data.push_back(packet);
+    }
+
+    std::vector<PacketInfo> parity(2);
+    ASSERT_TRUE(encoder.encode(data, parity));
+    EXPECT_EQ(parity[0].size, 110u + FEC_HEADER_SIZE);
+    EXPECT_EQ(parity[0].channel, Channel::Video);
+
+    // Lose two packets
+    auto received    = data;
+    received[0].data = nullptr;
+    received[2].data = nullptr;
+
+    const auto available = pool->available();
+    ASSERT_TRUE(decoder.recover(received, parity));
+    EXPECT_EQ(pool->available(), available - 2);
+
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        ASSERT_NE(received[i].data, nullptr);
+        ASSERT_EQ(received[i].size, payloads[i].size());
+        EXPECT_EQ(received[i].channel, Channel::Video);
+        EXPECT_EQ(received[i].timestamp, 3000u);
+        EXPECT_EQ(received[i].fragmentIndex, i);
+        EXPECT_EQ(received[i].fragmentCount, 3);
+        EXPECT_TRUE(std::equal(payloads[i].begin(), payloads[i].end(), received[i].data));
+    }
+
+    pool->release(received[0].data);
+    pool->release(received[2].data);
+    pool->release(parity[0].data);
+    pool->release(parity[1].data);
+    EXPECT_EQ(pool->available(), pool->blockCount());
+}
+
+TEST(FecCodec, PacketTooBig)
+{
+    auto pool = std::make_shared<PacketPool>(64, 8);
+
+    FecEncoder encoder { FecSettings { 2, 1 }, pool };
+
+    std::vector<std::uint8_t> payload(64);
+    PacketInfo                packet;
+    packet.size = static_cast<std::uint32_t>(payload.size());
+    packet.data = payload.data();
+
+    std::vector<PacketInfo> data { packet };
+    std::vector<PacketInfo> parity(1);
+    EXPECT_FALSE(encoder.encode(data, parity));
+    EXPECT_EQ(pool->available(), 8u);
+}
+
+TEST(FecCodec, FailedRecoveryChangesNothing)
+{
+    auto pool = std::make_shared<PacketPool>(256, 4);
+
+    FecSettings settings;
+    settings.dataShards   = 3;
+    settings.parityShards = 2;
+
+    FecEncoder encoder { settings, pool };
+    FecDecoder decoder { settings, pool };
+
+    std::mt19937                           rng { 4 };
+    std::vector<std::vector<std::uint8_t>> payloads;
+    std::vector<PacketInfo>                data;
+    for (std::size_t i = 0; i < 3; ++i) {
+        payloads.push_back(randomBytes(rng, 40 + i * 20));
+
+        PacketInfo packet;
+        packet.size = static_cast<std::uint32_t>(payloads.back().size());
+        packet.data = payloads.back().data();
+        data.push_back(packet);
+    }
+
+    std::vector<PacketInfo> parity(2);
+    ASSERT_TRUE(encoder.encode(data, parity));
+
+    // Two lost packets need two blocks, the pool has only one left
+    auto received    = data;
+    received[0].data = nullptr;
+    received[1].data = nullptr;
+    received[0].size = 0;
+    received[1].size = 0;
+
+    auto *taken = pool->acquire();
+    ASSERT_EQ(pool->available(), 1u);
+
+    const auto before = received;
+    EXPECT_FALSE(decoder.recover(received, parity));
+    EXPECT_EQ(pool->available(), 1u);
+    for (std::size_t i = 0; i < received.size(); ++i) {
+        EXPECT_EQ(received[i].data, before[i].data);
+        EXPECT_EQ(received[i].size, before[i].size);
+    }
+
+    // Corrupt parity gives sizes over the shard size
+    pool->release(taken);
+    parity[1].data = nullptr;
+    received[1]    = data[1];
+    parity[0].data[0] ^= 0xFF;
+    EXPECT_FALSE(decoder.recover(received, parity));
+    EXPECT_EQ(pool->available(), 2u);
+    EXPECT_EQ(received[0].data, nullptr);
+    EXPECT_EQ(received[0].size, 0u);
+}
@@ -0,0 +1,252 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Fragmenter.h"
+#include "Reassembler.h"
+
+using namespace pirks::networking;
+using namespace pirks::networking::fragment;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = Reassembler::Clock;
+
+constexpr std::size_t FRAGMENT_SIZE = 100;
+
+class ReassemblerTest: public ::testing::Test
+{
+protected:
+    // Fragments as the receiver gets them: every one in its own block, with
+    // sequence numbers assigned back to back from first
+    auto fragments(std::size_t size, SequenceNumber first, uint32_t timestamp)
+            -> std::vector<PacketInfo>
+    {
+        auto &source = sources.emplace_back(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            source[i] = static_cast<uint8_t>(i * 7 + timestamp);
+        }
+
+        PacketInfo frame;
+        frame.channel   = Channel::Video;
+        frame.timestamp = timestamp;
+        frame.size      = static_cast<uint32_t>(size);
+        frame.data      = source.data();
+
+        std::vector<PacketInfo> result;
+        Fragmenter { FRAGMENT_SIZE }.split(frame, [&](const PacketInfo &fragment) {
+            auto copy     = fragment;
+            copy.sequence = static_cast<SequenceNumber>(first + fragment.fragmentIndex);
+            copy.data     = packets->acquire();
+            std::copy_n(fragment.data, fragment.size, copy.data);
+            result.push_back(copy);
+        });
+        return result;
+    }
+
+    // Inserts fragment and releases its block like the connection does
+    auto insert(Reassembler &reassembler, const PacketInfo &fragment, Clock::time_point now)
+            -> FragmentResult
+    {
+        const auto result = reassembler.insert(fragment, now, [&](const PacketInfo &frame) {
+            delivered.push_back(frame);
+        });
+        packets->release(fragment.data);
+        return result;
+    }
+
+    void expectFrame(const PacketInfo &frame, std::size_t size, uint32_t timestamp)
+    {
+        EXPECT_EQ(frame.size, size);
+        EXPECT_EQ(frame.timestamp, timestamp);
+        for (std::size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(frame.data[i], static_cast<uint8_t>(i * 7 + timestamp)) << i;
+        }
+    }
+
+    void TearDown() override
+    {
+        for (const auto &frame: delivered) {
+            frames->release(frame.data);
+        }
+        EXPECT_EQ(packets->available(), packets->blockCount());
+    }
+
+    std::shared_ptr<PacketPool> packets { std::make_shared<PacketPool>(FRAGMENT_SIZE, 256) };
+    std::shared_ptr<PacketPool> frames { std::make_shared<PacketPool>(1024, 4) };
+
+    std::vector<std::vector<uint8_t>> sources;
+    std::vector<PacketInfo>           delivered;
+};
+
+} // namespace
+
+TEST(Fragmenter, SplitsWithoutCopying)
+{
+    std::vector<uint8_t> buffer(1000);
+
+    PacketInfo frame;
+    frame.channel   = Channel::Video;
+    frame.timestamp = 42;
+    frame.size      = 950;
+    frame.data      = buffer.data();
+
+    std::vector<PacketInfo> fragments;
+    const auto count = Fragmenter { 128 }.split(frame, [&](const PacketInfo &fragment) {
+        fragments.push_back(fragment);
+    });
+
+    ASSERT_EQ(count, 8u);
+    ASSERT_EQ(fragments.size(), 8u);
+    for (std::size_t i = 0; i < fragments.size(); ++i) {
+        EXPECT_EQ(fragments[i].data, buffer.data() + i * 128);
+        EXPECT_EQ(fragments[i].fragmentIndex, i);
+        EXPECT_EQ(fragments[i].fragmentCount, 8);
+        EXPECT_EQ(fragments[i].timestamp, 42u);
+        EXPECT_EQ(fragments[i].channel, Channel::Video);
+    }
+    EXPECT_EQ(fragments[6].size, 128u);
+    EXPECT_EQ(fragments[7].size, 950u - 7 * 128);
+}
+
+TEST(Fragmenter, FragmentCount)
+{
+    const Fragmenter fragmenter { 100 };
+
+    EXPECT_EQ(fragmenter.fragmentCount(0), 0u);
+    EXPECT_EQ(fragmenter.fragmentCount(1), 1u);
+    EXPECT_EQ(fragmenter.fragmentCount(100), 1u);
+    EXPECT_EQ(fragmenter.fragmentCount(101), 2u);
+    EXPECT_EQ(fragmenter.fragmentCount(100 * Fragmenter::MAX_FRAGMENTS), Fragmenter::MAX_FRAGMENTS);
+    EXPECT_EQ(fragmenter.fragmentCount(100 * Fragmenter::MAX_FRAGMENTS + 1), 0u);
+}
+
+TEST_F(ReassemblerTest, ReassemblesOutOfOrder)
+{
+    Reassembler reassembler { { FRAGMENT_SIZE, 2, 100ms }, frames };
+
+    auto parts = fragments(950, 65530, 1);
+    std::shuffle(parts.begin(), parts.end(), std::mt19937 { 1 });
+
+    const auto now = Clock::now();
+    for (std::size_t i = 0; i + 1 < parts.size(); ++i) {
+        auto copy = parts[i];
+        copy.data = packets->acquire();
+        std::copy_n(parts[i].data, parts[i].size, copy.data);
+
+        EXPECT_EQ(insert(reassembler, parts[i], now), FragmentResult::Buffered);
+        EXPECT_EQ(insert(reassembler, copy, now), FragmentResult::Duplicate);
+    }
+    EXPECT_EQ(reassembler.pending(), 1u);
+    EXPECT_EQ(insert(reassembler, parts.back(), now), FragmentResult::Completed);
+
+    ASSERT_EQ(delivered.size(), 1u);
+    expectFrame(delivered[0], 950, 1);
+    EXPECT_EQ(delivered[0].sequence, 65530);
+    EXPECT_EQ(reassembler.pending(), 0u);
+    EXPECT_EQ(reassembler.stats().duplicates, 9u);
+}
+
+TEST_F(ReassemblerTest, InterleavedFrames)
+{
+    Reassembler reassembler { { FRAGMENT_SIZE, 2, 100ms }, frames };
+
+    const auto first  = fragments(300, 10, 1);
+    const auto second = fragments(250, 13, 2);
+
+    const auto now = Clock::now();
+    for (std::size_t i = 0; i < 3; ++i) {
+        insert(reassembler, second[i], now);
+        insert(reassembler, first[i], now);
+    }
+
+    ASSERT_EQ(delivered.size(), 2u);
+    expectFrame(delivered[0], 250, 2);
+    expectFrame(delivered[1], 300, 1);
+}
+
+TEST_F(ReassemblerTest, ExpiresIncompleteFrames)
+{
+    Reassembler reassembler { { FRAGMENT_SIZE, 2, 100ms }, frames };
+
+    const auto parts = fragments(300, 0, 1);
+
+    const auto now = Clock::now();
+    insert(reassembler, parts[0], now);
+    insert(reassembler, parts[1], now);
+
+    reassembler.evictExpired(now + 50ms);
+    EXPECT_EQ(reassembler.pending(), 1u);
+
+    reassembler.evictExpired(now + 150ms);
+    EXPECT_EQ(reassembler.pending(), 0u);
+    EXPECT_EQ(reassembler.stats().expired, 1u);
+    EXPECT_EQ(frames->available(), frames->blockCount());
+
+    // Late fragment starts a new frame, which never completes
+    EXPECT_EQ(insert(reassembler, parts[2], now + 150ms), FragmentResult::Buffered);
+    EXPECT_TRUE(delivered.empty());
+}
+
+TEST_F(ReassemblerTest, MemoryIsCapped)
+{
+    Reassembler reassembler { { FRAGMENT_SIZE, 2, 100ms }, frames };
+
+    const auto now = Clock::now();
+
+    // Frame buffer is 1024 bytes, 12 fragments can't fit into it
+    const auto large = fragments(1200, 0, 1);
+    EXPECT_EQ(insert(reassembler, large[0], now), FragmentResult::Rejected);
+    for (std::size_t i = 1; i < large.size(); ++i) {
+        packets->release(large[i].data);
+    }
+
+    // Only two incomplete frames are kept, the oldest gives way
+    const auto a = fragments(200, 100, 2);
+    const auto b = fragments(200, 200, 3);
+    const auto c = fragments(200, 300, 4);
+    insert(reassembler, a[0], now);
+    insert(reassembler, b[0], now + 1ms);
+    insert(reassembler, c[0], now + 2ms);
+    EXPECT_EQ(reassembler.pending(), 2u);
+    EXPECT_EQ(reassembler.stats().evicted, 1u);
+
+    insert(reassembler, a[1], now + 3ms);
+    insert(reassembler, c[1], now + 3ms);
+    ASSERT_EQ(delivered.size(), 1u);
+    expectFrame(delivered[0], 200, 4);
+
+    packets->release(b[1].data);
+}
+
+TEST_F(ReassemblerTest, RejectsInconsistentFragments)
+{
+    Reassembler reassembler { { FRAGMENT_SIZE, 2, 100ms }, frames };
+
+    const auto now   = Clock::now();
+    auto       parts = fragments(300, 0, 1);
+
+    // Only the last fragment may be short
+    parts[0].size = FRAGMENT_SIZE - 1;
+    EXPECT_EQ(insert(reassembler, parts[0], now), FragmentResult::Rejected);
+
+    // Fragment count differs from the one of the frame
+    insert(reassembler, parts[1], now);
+    parts[2].fragmentCount = 4;
+    EXPECT_EQ(insert(reassembler, parts[2], now), FragmentResult::Rejected);
+    EXPECT_EQ(reassembler.stats().rejected, 2u);
+}
+
+TEST(Reassembler, InvalidSettings)
+{
+    auto frames = std::make_shared<PacketPool>(1024, 1);
+
+    EXPECT_THROW(Reassembler({ 0, 1, 100ms }, frames), std::invalid_argument);
+    EXPECT_THROW(Reassembler({ 2048, 1, 100ms }, frames), std::invalid_argument);
+    EXPECT_THROW(Reassembler({ 100, 0, 100ms }, frames), std::invalid_argument);
+    EXPECT_THROW(Reassembler({ 100, 1, 100ms }, nullptr), std::invalid_argument);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "FrameDiff.h"
+#include "TileCompare.h"
+
+using namespace video;
+using namespace video::frame_diff;
+
+namespace {
+
+struct TestFrame
+{
+    TestFrame(std::uint32_t w, std::uint32_t h, std::uint32_t padding = 0)
+            : width { w }
+            , height { h }
+            , stride { w * 4 + padding }
+            , pixels(static_cast<std::size_t>(stride) * h, 0)
+    {
+    }
+
+    auto view() const -> FrameView
+    {
+        return FrameView { pixels.data(), width, height, stride, 4 };
+    }
+
+    void setPixel(std::uint32_t x, std::uint32_t y, std::uint8_t value)
+    {
+        pixels[static_cast<std::size_t>(y) * stride + x * 4] = value;
+    }
+
+    std::uint32_t             width;
+    std::uint32_t             height;
+    std::uint32_t             stride;
+    std::vector<std::uint8_t> pixels;
+};
+
+} // namespace
+
+TEST(TileCompare, MatchesMemcmp)
+{
+    std::mt19937 rng { 42 };
+
+    for (std::size_t size: { 0u, 1u, 15u, 63u, 64u, 65u, 255u, 256u, 1000u }) {
+        std::vector<std::uint8_t> a(size);
+        for (auto &v: a) {
+            v = static_cast<std::uint8_t>(rng());
+        }
+        auto b = a;
+        EXPECT_TRUE(bytesEqual(a.data(), b.data(), size)) << "size " << size;
+
+        // Flip every position one by one, including tail bytes
+        for (std::size_t i = 0; i < size; ++i) {
+            b[i] ^= 0x01;
+            EXPECT_FALSE(bytesEqual(a.data(), b.data(), size)) << "size " << size << " pos " << i;
+            b[i] ^= 0x01;
+        }
+    }
+}
+
+TEST(FrameDiff, FirstFrameIsFull)
+{
+    TestFrame frame { 128, 128 };
+    FrameDiff diff;
+
+    const auto result = diff.compare(frame.view());
+    EXPECT_EQ(result.decision, FrameDecision::Full);
+    EXPECT_EQ(result.totalTiles, 4u);
+    EXPECT_EQ(result.dirtyTiles, 4u);
+    EXPECT_EQ(diff.dirtyTiles().count(), 4u);
+}
+
+TEST(FrameDiff, IdenticalFrameIsRepeat)
+{
+    TestFrame frame { 200, 100, 32 };
+    FrameDiff diff;
+
+    EXPECT_EQ(diff.compare(frame.view()).decision, FrameDecision::Full);
+
+    const auto result = diff.compare(frame.view());
+    EXPECT_EQ(result.decision, FrameDecision::Repeat);
+    EXPECT_EQ(result.dirtyTiles, 0u);
+    EXPECT_TRUE(diff.dirtyTiles().isEmpty());
+}
+
+TEST(FrameDiff, SinglePixelMarksOneTile)
+{
+    TestFrame frame { 256, 192 };
+    FrameDiff diff;
+    EXPECT_EQ(diff.compare(frame.view()).decision, FrameDecision::Full);
+
+    frame.setPixel(130, 70, 0xFF); // tile (2, 1)
+
+    const auto result = diff.compare(frame.view());
+    EXPECT_EQ(result.decision, FrameDecision::Partial);
+    EXPECT_EQ(result.dirtyTiles, 1u);
+    EXPECT_TRUE(diff.dirtyTiles().isDirty(2, 1));
+
+    // Change is remembered, so the same frame again is a repeat
+    EXPECT_EQ(diff.compare(frame.view()).decision, FrameDecision::Repeat);
+}
+
+TEST(FrameDiff, PartialEdgeTiles)
+{
+    // 100x70 gives 2x2 tiles, right and bottom tiles are not complete
+    TestFrame frame { 100, 70, 12 };
+    FrameDiff diff;
+    EXPECT_EQ(diff.compare(frame.view()).totalTiles, 4u);
+
+    frame.setPixel(99, 69, 1);
+    frame.setPixel(0, 0, 1);
+
+    const auto result = diff.compare(frame.view());
+    EXPECT_EQ(result.dirtyTiles, 2u);
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> tiles;
+    diff.dirtyTiles().forEachDirty([&](auto tx, auto ty) { tiles.emplace_back(tx, ty); });
+    ASSERT_EQ(tiles.size(), 2u);
+    EXPECT_EQ(tiles[0], std::make_pair(0u, 0u));
+    EXPECT_EQ(tiles[1], std::make_pair(1u, 1u));
+}
+
+TEST(FrameDiff, ChangesInRowPaddingAreIgnored)
+{
+    TestFrame frame { 64, 64, 16 };
+    FrameDiff diff;
+    EXPECT_EQ(diff.compare(frame.view()).decision, FrameDecision::Full);
+
+    frame.pixels[64 * 4 + 3] = 0xAA; // padding of the first row
+    EXPECT_EQ(diff.compare(frame.view()).decision, FrameDecision::Repeat);
+}
+
+TEST(FrameDiff, ResolutionChangeAndInvalidate)
+{
+    TestFrame small { 64, 64 };
+    TestFrame large { 128, 64 };
+    FrameDiff diff { 32 };
+
+    EXPECT_EQ(diff.compare(small.view()).decision, FrameDecision::Full);
+    EXPECT_EQ(diff.compare(small.view()).decision, FrameDecision::Repeat);
+
+    const auto result = diff.compare(large.view());
+    EXPECT_EQ(result.decision, FrameDecision::Full);
+    EXPECT_EQ(result.totalTiles, 8u);
+
+    diff.invalidate();
+    EXPECT_EQ(diff.compare(large.view()).decision, FrameDecision::Full);
+    EXPECT_EQ(diff.compare(large.view()).decision, FrameDecision::Repeat);
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <stdexcept>
+
+#include "FrameDiff.h"
+#include "TestPatternSource.h"
+
+using namespace video;
+using namespace video::frame_source;
+using namespace std::chrono_literals;
+
+TEST(TestPatternSource, MovingSquare)
+{
+    TestPatternSettings settings;
+    settings.width  = 256;
+    settings.height = 128;
+    settings.fps    = 1000;
+
+    TestPatternSource     source { settings };
+    frame_diff::FrameDiff diff;
+
+    const auto first = source.next();
+    ASSERT_TRUE(first);
+    EXPECT_EQ(first->width, settings.width);
+    EXPECT_EQ(first->height, settings.height);
+    EXPECT_EQ(first->stride, settings.width * 4);
+    EXPECT_EQ(diff.compare(*first).decision, frame_diff::FrameDecision::Full);
+
+    // Only tiles under the old and new square change
+    for (int i = 0; i < 40; ++i) {
+        const auto frame = source.next();
+        ASSERT_TRUE(frame);
+        const auto result = diff.compare(*frame);
+        EXPECT_EQ(result.decision, frame_diff::FrameDecision::Partial);
+        EXPECT_LT(result.dirtyTiles, result.totalTiles);
+    }
+}
+
+TEST(TestPatternSource, Paced)
+{
+    TestPatternSettings settings;
+    settings.width  = 64;
+    settings.height = 64;
+    settings.fps    = 100;
+
+    TestPatternSource source { settings };
+
+    const auto started = TestPatternSource::Clock::now();
+    for (int i = 0; i < 6; ++i) {
+        ASSERT_TRUE(source.next());
+    }
+    EXPECT_GE(TestPatternSource::Clock::now() - started, 50ms);
+}
+
+TEST(TestPatternSource, InvalidSettings)
+{
+    TestPatternSettings settings;
+    settings.width = TestPatternSource::SQUARE_SIZE - 1;
+    EXPECT_THROW(TestPatternSource { settings }, std::invalid_argument);
+
+    settings.width = 64;
+    settings.fps   = 0;
+    EXPECT_THROW(TestPatternSource { settings }, std::invalid_argument);
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "JitterBuffer.h"
+
+using namespace pirks::networking;
+using namespace pirks::networking::jitter;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = JitterBuffer::Clock;
+
+// 10 ms audio packets at 48 kHz
+constexpr uint32_t TICKS_PER_PACKET = 480;
+constexpr auto     PACKET_DURATION  = 10ms;
+
+class JitterBufferTest: public ::testing::Test
+{
+protected:
+    auto packet(SequenceNumber seq) -> PacketInfo
+    {
+        PacketInfo result;
+        result.channel   = Channel::Audio;
+        result.sequence  = seq;
+        result.timestamp = seq * TICKS_PER_PACKET;
+        result.size      = 1;
+        result.data      = pool->acquire();
+        result.data[0]   = static_cast<uint8_t>(seq);
+        return result;
+    }
+
+    auto popAll(JitterBuffer &buffer, Clock::time_point now) -> std::vector<uint8_t>
+    {
+        std::vector<uint8_t> played;
+        buffer.pop(now, [&](const PacketInfo &p) {
+            played.push_back(p.data[0]);
+            pool->release(p.data);
+        });
+        return played;
+    }
+
+    std::shared_ptr<PacketPool> pool { std::make_shared<PacketPool>(16, 64) };
+    JitterBufferSettings        settings;
+    Clock::time_point           start { Clock::now() };
+};
+
+} // namespace
+
+TEST_F(JitterBufferTest, ReordersPackets)
+{
+    JitterBuffer buffer { settings, pool };
+
+    // Packet 0 arrives on time, 1 is delayed behind 2
+    EXPECT_EQ(buffer.insert(packet(0), start), InsertResult::Buffered);
+    EXPECT_EQ(buffer.insert(packet(2), start + 2 * PACKET_DURATION), InsertResult::Buffered);
+    EXPECT_EQ(buffer.insert(packet(1), start + 2 * PACKET_DURATION + 1ms), InsertResult::Buffered);
+    EXPECT_EQ(buffer.depth(), 3u);
+
+    // Nothing is played before target delay
+    EXPECT_TRUE(popAll(buffer, start).empty());
+    ASSERT_TRUE(buffer.nextPlayoutTime());
+    EXPECT_EQ(*buffer.nextPlayoutTime(), start + buffer.targetDelay());
+
+    EXPECT_EQ(popAll(buffer, start + 1s), (std::vector<uint8_t> { 0, 1, 2 }));
+    EXPECT_EQ(buffer.depth(), 0u);
+    EXPECT_EQ(buffer.stats().played, 3u);
+    EXPECT_EQ(pool->available(), pool->blockCount());
+}
+
+TEST_F(JitterBufferTest, DropsLatePackets)
+{
+    JitterBuffer buffer { settings, pool };
+
+    buffer.insert(packet(0), start);
+    buffer.insert(packet(2), start + 2 * PACKET_DURATION);
+
+    // 1 is skipped as lost when it's time to play 2
+    EXPECT_EQ(popAll(buffer, start + 1s), (std::vector<uint8_t> { 0, 2 }));
+    EXPECT_EQ(buffer.stats().lost, 1u);
+
+    auto late = packet(1);
+    EXPECT_EQ(buffer.insert(late, start + 1s), InsertResult::Late);
+    EXPECT_EQ(buffer.stats().late, 1u);
+    pool->release(late.data);
+
+    EXPECT_EQ(buffer.insert(packet(3), start + 1s), InsertResult::Buffered);
+    auto copy = packet(3);
+    EXPECT_EQ(buffer.insert(copy, start + 1s), InsertResult::Duplicate);
+    pool->release(copy.data);
+}
+
+TEST_F(JitterBufferTest, HoleWaitsForItsPlayoutTime)
+{
+    JitterBuffer buffer { settings, pool };
+
+    buffer.insert(packet(0), start);
+    buffer.insert(packet(2), start + 2 * PACKET_DURATION);
+
+    // Packet 1 may still arrive before packet 2 has to be played
+    EXPECT_EQ(popAll(buffer, start + buffer.targetDelay()), (std::vector<uint8_t> { 0 }));
+    EXPECT_EQ(buffer.insert(packet(1), start + 15ms), InsertResult::Buffered);
+    EXPECT_EQ(popAll(buffer, start + 1s), (std::vector<uint8_t> { 1, 2 }));
+    EXPECT_EQ(buffer.stats().lost, 0u);
+}
+
+TEST_F(JitterBufferTest, TargetDelayFollowsJitter)
+{
+    settings.capacity = 64;
+    JitterBuffer buffer { settings, pool };
+
+    std::mt19937                       rng { 5 };
+    std::uniform_int_distribution<int> noise { 0, 20000 };
+    EXPECT_EQ(buffer.targetDelay(), settings.minDelay);
+
+    SequenceNumber seq = 0;
+    auto           now = start;
+    for (int i = 0; i < 200; ++i, ++seq) {
+        now = start + PACKET_DURATION * seq + std::chrono::microseconds { noise(rng) };
+        buffer.insert(packet(seq), now);
+        popAll(buffer, now);
+    }
+    const auto jittery = buffer.targetDelay();
+    EXPECT_GT(buffer.jitter(), 3ms);
+    EXPECT_GT(jittery, 4 * 3ms);
+    EXPECT_LE(jittery, settings.maxDelay);
+
+    // Smooth network again, delay goes down slowly
+    const auto offset = now - (start + PACKET_DURATION * seq);
+    for (int i = 0; i < 2000; ++i, ++seq) {
+        now = start + PACKET_DURATION * seq + offset;
+        buffer.insert(packet(seq), now);
+        popAll(buffer, now + 1s);
+    }
+    EXPECT_LT(buffer.targetDelay(), jittery);
+    EXPECT_LT(buffer.jitter(), 1ms);
+}
+
+TEST_F(JitterBufferTest, ResyncOnSequenceJump)
+{
+    settings.capacity = 16;
+    JitterBuffer buffer { settings, pool };
+
+    buffer.insert(packet(0), start);
+    buffer.insert(packet(1), start);
+    buffer.insert(packet(1000), start + 10ms);
+
+    EXPECT_EQ(buffer.stats().resyncs, 1u);
+    EXPECT_EQ(buffer.depth(), 1u);
+    EXPECT_EQ(popAll(buffer, start + 1s), (std::vector<uint8_t> { static_cast<uint8_t>(1000) }));
+    EXPECT_EQ(pool->available(), pool->blockCount());
+}
+
+TEST_F(JitterBufferTest, InvalidSettings)
+{
+    settings.capacity = 100;
+    EXPECT_THROW(JitterBuffer(settings, pool), std::invalid_argument);
+
+    settings.capacity = 64;
+    settings.minDelay = 300ms;
+    EXPECT_THROW(JitterBuffer(settings, pool), std::invalid_argument);
+}
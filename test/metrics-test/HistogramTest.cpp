@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "Histogram.h"
+
+using namespace pirks::metrics;
+using namespace std::chrono_literals;
+
+TEST(Histogram, SmallValuesAreExact)
+{
+    for (uint64_t value = 0; value < 2 * Histogram::SUB_BUCKET_COUNT; ++value) {
+        const auto index = Histogram::bucketIndex(value);
+        EXPECT_EQ(Histogram::bucketUpperBound(index), value);
+    }
+}
+
+TEST(Histogram, BucketsCoverValues)
+{
+    const std::vector<uint64_t> values = {
+        100,
+        1'000,
+        123'456,
+        1'000'000'000,
+        std::numeric_limits<uint64_t>::max(),
+    };
+
+    for (const auto value: values) {
+        const auto index = Histogram::bucketIndex(value);
+        ASSERT_LT(index, Histogram::BUCKET_COUNT);
+
+        // Value is in its bucket, and the bucket is narrow
+        const auto upper = Histogram::bucketUpperBound(index);
+        const auto lower = Histogram::bucketUpperBound(index - 1) + 1;
+        EXPECT_LE(lower, value);
+        EXPECT_GE(upper, value);
+        EXPECT_LE(upper - lower, value / Histogram::SUB_BUCKET_COUNT);
+    }
+}
+
+TEST(Histogram, Quantiles)
+{
+    Histogram histogram;
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        histogram.record(value);
+    }
+
+    const auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 1000u);
+    EXPECT_EQ(snapshot.sum, 500'500u);
+
+    // Within the relative error of a bucket
+    constexpr double ERROR = 1.0 / Histogram::SUB_BUCKET_COUNT;
+    EXPECT_NEAR(static_cast<double>(snapshot.quantile(0.5)), 500.0, 500.0 * ERROR);
+    EXPECT_NEAR(static_cast<double>(snapshot.quantile(0.99)), 990.0, 990.0 * ERROR);
+    EXPECT_GE(snapshot.quantile(1.0), 1000u);
+}
+
+TEST(Histogram, EmptyQuantile)
+{
+    Histogram histogram;
+    EXPECT_EQ(histogram.snapshot().count, 0u);
+    EXPECT_EQ(histogram.snapshot().quantile(0.5), 0u);
+}
+
+TEST(Histogram, Durations)
+{
+    Histogram histogram;
+    histogram.record(2ms);
+    histogram.record(-1ms);
+
+    const auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 2u);
+    EXPECT_EQ(snapshot.sum, 2'000'000u);
+}
+
+TEST(Histogram, ThreadsMergeOnRead)
+{
+    // More threads than shards, so some of them share one
+    constexpr std::size_t THREADS = Histogram::MAX_SHARDS + 4;
+    constexpr uint64_t    RECORDS = 10'000;
+
+    Histogram                histogram;
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < THREADS; ++i) {
+        threads.emplace_back([&histogram] {
+            for (uint64_t value = 0; value < RECORDS; ++value) {
+                histogram.record(value);
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    const auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, THREADS * RECORDS);
+    EXPECT_EQ(snapshot.sum, THREADS * (RECORDS * (RECORDS - 1) / 2));
+}
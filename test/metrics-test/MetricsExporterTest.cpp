@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstring>
+#include <string>
+
+#include "MetricsExporter.h"
+
+using namespace pirks::metrics;
+
+namespace {
+
+// Send request over a connected socket and read the whole response
+auto exchange(int fd, const std::string &request) -> std::string
+{
+    if (::send(fd, request.data(), request.size(), 0) != static_cast<ssize_t>(request.size())) {
+        ::close(fd);
+        return {};
+    }
+
+    std::string            response;
+    std::array<char, 4096> buffer;
+    while (true) {
+        const auto size = ::recv(fd, buffer.data(), buffer.size(), 0);
+        if (size <= 0) {
+            break;
+        }
+        response.append(buffer.data(), static_cast<std::size_t>(size));
+    }
+
+    ::close(fd);
+    return response;
+}
+
+auto requestTcp(uint16_t port, const std::string &request) -> std::string
+{
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+
+    sockaddr_in address {};
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port        = htons(port);
+    if (::connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return {};
+    }
+
+    return exchange(fd, request);
+}
+
+auto requestUnix(const std::string &path, const std::string &request) -> std::string
+{
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.data(), path.size());
+    if (::connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return {};
+    }
+
+    return exchange(fd, request);
+}
+
+constexpr auto GET = "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+} // namespace
+
+TEST(MetricsExporter, ServesOverTcp)
+{
+    Registry::instance().counter("test_exporter_tcp_total", "Test").add(7);
+
+    MetricsExporter exporter;
+    exporter.listenTcp(0);
+    ASSERT_NE(exporter.tcpPort(), 0);
+    exporter.start();
+
+    const auto response = requestTcp(exporter.tcpPort(), GET);
+    EXPECT_TRUE(response.starts_with("HTTP/1.1 200 OK\r\n")) << response;
+    EXPECT_NE(response.find("Content-Type: text/plain; version=0.0.4"), std::string::npos);
+    EXPECT_NE(response.find("test_exporter_tcp_total 7\n"), std::string::npos);
+}
+
+TEST(MetricsExporter, ServesOverUnixSocket)
+{
+    Registry::instance().gauge("test_exporter_unix", "Test").set(5);
+
+    const std::string path = "/tmp/pirks-metrics-test-" + std::to_string(::getpid()) + ".sock";
+
+    {
+        MetricsExporter exporter;
+        exporter.listenUnix(path);
+        exporter.start();
+
+        const auto response = requestUnix(path, GET);
+        EXPECT_TRUE(response.starts_with("HTTP/1.1 200 OK\r\n")) << response;
+        EXPECT_NE(response.find("test_exporter_unix 5\n"), std::string::npos);
+    }
+
+    // Socket file is removed with the exporter
+    EXPECT_NE(::access(path.c_str(), F_OK), 0);
+}
+
+TEST(MetricsExporter, OnlyGet)
+{
+    MetricsExporter exporter;
+    exporter.listenTcp(0);
+    exporter.start();
+
+    const auto response = requestTcp(
+            exporter.tcpPort(),
+            "POST /metrics HTTP/1.1\r\nContent-Length: 0\r\n\r\n");
+    EXPECT_TRUE(response.starts_with("HTTP/1.1 405")) << response;
+}
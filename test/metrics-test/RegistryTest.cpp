@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include "CircularBuffer.h"
+#include "Registry.h"
+
+using namespace pirks::metrics;
+using namespace std::chrono_literals;
+
+// Registry is one per process, so every test uses its own metric names
+
+TEST(Registry, SameNameAndLabelsSameMetric)
+{
+    auto &registry = Registry::instance();
+
+    auto &a = registry.counter("test_same_total", "Test", "kind=\"a\"");
+    auto &b = registry.counter("test_same_total", "Test", "kind=\"b\"");
+    EXPECT_EQ(&a, &registry.counter("test_same_total", "Test", "kind=\"a\""));
+    EXPECT_NE(&a, &b);
+
+    a.add(2);
+    b.add();
+    EXPECT_EQ(a.value(), 2u);
+    EXPECT_EQ(b.value(), 1u);
+}
+
+TEST(Registry, TypeMismatchThrows)
+{
+    auto &registry = Registry::instance();
+
+    (void)registry.counter("test_mismatch", "Test");
+    EXPECT_THROW((void)registry.gauge("test_mismatch", "Test"), std::invalid_argument);
+}
+
+TEST(Registry, Exposition)
+{
+    auto &registry = Registry::instance();
+
+    registry.counter("test_exposition_total", "Counted things", "channel=\"video\"").add(3);
+    registry.gauge("test_exposition_depth", "Queue depth").set(-2);
+
+    auto &histogram = registry.histogram("test_exposition_seconds", "Latency");
+    histogram.record(1ms);
+    histogram.record(3ms);
+
+    const auto text = registry.exposition();
+
+    EXPECT_NE(text.find("# HELP test_exposition_total Counted things\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE test_exposition_total counter\n"), std::string::npos);
+    EXPECT_NE(text.find("test_exposition_total{channel=\"video\"} 3\n"), std::string::npos);
+
+    EXPECT_NE(text.find("# TYPE test_exposition_depth gauge\n"), std::string::npos);
+    EXPECT_NE(text.find("test_exposition_depth -2\n"), std::string::npos);
+
+    EXPECT_NE(text.find("# TYPE test_exposition_seconds summary\n"), std::string::npos);
+    EXPECT_NE(text.find("test_exposition_seconds{quantile=\"0.5\"} 0.001"), std::string::npos);
+    EXPECT_NE(text.find("test_exposition_seconds_sum 0.004\n"), std::string::npos);
+    EXPECT_NE(text.find("test_exposition_seconds_count 2\n"), std::string::npos);
+}
+
+TEST(Registry, QueueDepthGauge)
+{
+    auto &depth = Registry::instance().gauge("test_queue_depth", "Test");
+
+    CircularBuffer<int> buffer { 3 };
+    buffer.push(1);
+    buffer.setDepthGauge(&depth);
+    EXPECT_EQ(depth.value(), 1);
+
+    buffer.push(2);
+    buffer.push(3);
+    buffer.push(4);
+    EXPECT_EQ(depth.value(), 3);
+
+    std::vector<int> out;
+    EXPECT_EQ(buffer.pop(out, 2), 2u);
+    EXPECT_EQ(depth.value(), 1);
+
+    EXPECT_EQ(buffer.pop(), 4);
+    EXPECT_EQ(depth.value(), 0);
+}
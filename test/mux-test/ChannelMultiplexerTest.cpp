@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory_resource>
+#include <vector>
+
+#include "ChannelMultiplexer.h"
+
+using namespace pirks::networking;
+using namespace pirks::networking::mux;
+using namespace std::chrono_literals;
+
+namespace {
+
+auto makePacket(Channel channel, uint32_t size, uint32_t timestamp = 0) -> PacketInfo
+{
+    PacketInfo packet;
+    packet.channel   = channel;
+    packet.size      = size;
+    packet.timestamp = timestamp;
+    return packet;
+}
+
+} // namespace
+
+TEST(ChannelMultiplexer, StrictPriorityFirst)
+{
+    ChannelMultiplexer mux;
+
+    ASSERT_TRUE(mux.push(makePacket(Channel::Video, 1200)));
+    ASSERT_TRUE(mux.push(makePacket(Channel::Audio, 200)));
+    ASSERT_TRUE(mux.push(makePacket(Channel::Input, 20)));
+    ASSERT_TRUE(mux.push(makePacket(Channel::Control, 20)));
+    ASSERT_TRUE(mux.push(makePacket(Channel::Input, 20, 1)));
+
+    std::vector<uint8_t> order;
+    while (auto packet = mux.pop()) {
+        order.push_back(packet->channel);
+    }
+
+    const std::vector<uint8_t> expected {
+        Channel::Control, Channel::Input, Channel::Input, Channel::Audio, Channel::Video
+    };
+    EXPECT_EQ(order, expected);
+    EXPECT_TRUE(mux.isEmpty());
+}
+
+TEST(ChannelMultiplexer, WeightedShareOfBacklog)
+{
+    ChannelMultiplexer mux;
+
+    for (uint32_t i = 0; i < 100; ++i) {
+        ASSERT_TRUE(mux.push(makePacket(Channel::Audio, 1000, i)));
+        ASSERT_TRUE(mux.push(makePacket(Channel::Video, 1000, i)));
+    }
+
+    // Default weights are 1:3, both channels stay backlogged for 100 packets
+    std::size_t audio = 0;
+    for (std::size_t i = 0; i < 100; ++i) {
+        const auto packet = mux.pop();
+        ASSERT_TRUE(packet);
+        if (packet->channel == Channel::Audio) {
+            ++audio;
+        }
+    }
+    EXPECT_NEAR(static_cast<double>(audio), 25.0, 1.0);
+
+    // Packets of one channel keep their order
+    uint32_t previous = 0;
+    while (auto packet = mux.pop()) {
+        if (packet->channel == Channel::Video) {
+            EXPECT_GE(packet->timestamp, previous);
+            previous = packet->timestamp;
+        }
+    }
+}
+
+TEST(ChannelMultiplexer, Budgets)
+{
+    MultiplexerSettings settings;
+    settings.channels[Channel::Video] = { 4, 3000, false, 1 };
+
+    ChannelMultiplexer mux { settings };
+
+    EXPECT_TRUE(mux.canPush(Channel::Video, 3, 3000));
+    EXPECT_FALSE(mux.canPush(Channel::Video, 5, 100));
+    EXPECT_FALSE(mux.canPush(Channel::Video, 1, 3001));
+    EXPECT_FALSE(mux.canPush(CHANNEL_COUNT, 1, 1));
+
+    // Bytes run out first
+    EXPECT_TRUE(mux.push(makePacket(Channel::Video, 1400)));
+    EXPECT_TRUE(mux.push(makePacket(Channel::Video, 1400)));
+    EXPECT_FALSE(mux.push(makePacket(Channel::Video, 1400)));
+
+    // Then packets
+    EXPECT_TRUE(mux.push(makePacket(Channel::Video, 100)));
+    EXPECT_TRUE(mux.push(makePacket(Channel::Video, 100)));
+    EXPECT_FALSE(mux.push(makePacket(Channel::Video, 100)));
+
+    EXPECT_EQ(mux.size(Channel::Video), 4u);
+    EXPECT_EQ(mux.bytes(Channel::Video), 3000u);
+    EXPECT_EQ(mux.stats(Channel::Video).dropped, 2u);
+
+    // Other channels have their own budget
+    EXPECT_TRUE(mux.push(makePacket(Channel::Audio, 1400)));
+
+    // Sent packets free the budget
+    while (mux.size(Channel::Video) == 4) {
+        ASSERT_TRUE(mux.pop());
+    }
+    EXPECT_TRUE(mux.push(makePacket(Channel::Video, 100)));
+}
+
+TEST(ChannelMultiplexer, ClearReleasesEverything)
+{
+    ChannelMultiplexer mux;
+
+    for (uint8_t channel = 0; channel < CHANNEL_COUNT; ++channel) {
+        ASSERT_TRUE(mux.push(makePacket(static_cast<Channel>(channel), 100)));
+        ASSERT_TRUE(mux.push(makePacket(static_cast<Channel>(channel), 100)));
+    }
+
+    std::size_t released = 0;
+    mux.clear([&](const PacketInfo &) {
+        ++released;
+    });
+
+    EXPECT_EQ(released, 2 * CHANNEL_COUNT);
+    EXPECT_TRUE(mux.isEmpty());
+    EXPECT_FALSE(mux.pop());
+    for (uint8_t channel = 0; channel < CHANNEL_COUNT; ++channel) {
+        EXPECT_EQ(mux.bytes(channel), 0u);
+        EXPECT_EQ(mux.stats(channel).sent, 0u);
+    }
+}
+
+TEST(ChannelMultiplexer, AudioLatencyIsFlatUnderVideoLoad)
+{
+    using Duration = std::chrono::microseconds;
+
+    // 4 Mbps link, video produces 8 Mbps in 30 fps frames of 1400 byte
+    // packets, audio a 200 byte packet every 20 ms
+    constexpr int64_t  LINK_BYTES_PER_SECOND = 4'000'000 / 8;
+    constexpr uint32_t VIDEO_PACKET          = 1400;
+    constexpr uint32_t VIDEO_PACKETS         = 8'000'000 / 8 / 30 / VIDEO_PACKET;
+    constexpr uint32_t AUDIO_PACKET          = 200;
+
+    // Half a second of video may wait for the link
+    MultiplexerSettings settings;
+    settings.channels[Channel::Video].maxBytes = LINK_BYTES_PER_SECOND / 2;
+
+    ChannelMultiplexer mux { settings };
+
+    auto transmitTime = [](uint32_t size) {
+        return Duration { int64_t { size } * 1'000'000 / LINK_BYTES_PER_SECOND };
+    };
+
+    Duration now { 0 };
+    Duration linkFree { 0 };
+    Duration nextFrame { 0 };
+    Duration nextAudio { 0 };
+
+    std::vector<Duration> audioDelay;
+    uint64_t              videoSent = 0;
+
+    while (now < 5s) {
+        if (now >= nextFrame) {
+            for (uint32_t i = 0; i < VIDEO_PACKETS; ++i) {
+                mux.push(makePacket(Channel::Video, VIDEO_PACKET));
+            }
+            nextFrame += Duration { 1'000'000 / 30 };
+        }
+        if (now >= nextAudio) {
+            const auto timestamp = static_cast<uint32_t>(now.count());
+            ASSERT_TRUE(mux.push(makePacket(Channel::Audio, AUDIO_PACKET, timestamp)));
+            nextAudio += 20ms;
+        }
+
+        if (now >= linkFree) {
+            if (const auto packet = mux.pop()) {
+                if (packet->channel == Channel::Audio) {
+                    audioDelay.push_back(now - Duration { packet->timestamp });
+                } else {
+                    ++videoSent;
+                }
+                linkFree = now + transmitTime(packet->size);
+            }
+        }
+
+        now += Duration { 100 };
+    }
+
+    ASSERT_GE(audioDelay.size(), 240u);
+
+    // Audio waits at most for the video packet already on the wire
+    const auto worst = *std::max_element(audioDelay.begin(), audioDelay.end());
+    EXPECT_LE(worst, transmitTime(VIDEO_PACKET) + Duration { 200 });
+
+    // Video absorbs the overload: it fills the link and drops the excess
+    EXPECT_GT(videoSent, 5 * LINK_BYTES_PER_SECOND / VIDEO_PACKET * 9 / 10);
+    EXPECT_GT(mux.stats(Channel::Video).dropped, 0u);
+    EXPECT_EQ(mux.stats(Channel::Audio).dropped, 0u);
+}
+
+TEST(ChannelMultiplexer, MemoryResource)
+{
+    std::pmr::unsynchronized_pool_resource pool;
+
+    // Rings of all channels take memory from the given resource only
+    auto *previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+    {
+        ChannelMultiplexer mux { {}, &pool };
+        std::pmr::set_default_resource(previous);
+
+        ASSERT_TRUE(mux.push(makePacket(Channel::Video, 1200)));
+        ASSERT_TRUE(mux.push(makePacket(Channel::Audio, 200)));
+        EXPECT_EQ(mux.pop()->channel, Channel::Audio);
+        EXPECT_EQ(mux.pop()->channel, Channel::Video);
+        EXPECT_FALSE(mux.pop());
+    }
+}
+
+TEST(ChannelMultiplexer, InvalidSettings)
+{
+    MultiplexerSettings noPackets;
+    noPackets.channels[Channel::Audio].maxPackets = 0;
+    EXPECT_THROW(ChannelMultiplexer { noPackets }, std::invalid_argument);
+
+    MultiplexerSettings noBytes;
+    noBytes.channels[Channel::Video].maxBytes = 0;
+    EXPECT_THROW(ChannelMultiplexer { noBytes }, std::invalid_argument);
+
+    MultiplexerSettings noWeight;
+    noWeight.channels[Channel::Video].weight = 0;
+    EXPECT_THROW(ChannelMultiplexer { noWeight }, std::invalid_argument);
+}
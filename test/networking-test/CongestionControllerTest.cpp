@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <vector>
+
+#include "CongestionController.h"
+#include "CongestionFeedback.h"
+#include "LinkEmulator.h"
+#include "Pacer.h"
+
+using namespace pirks::networking;
+using namespace pirks::networking::test;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = CongestionController::Clock;
+
+constexpr std::size_t PACKET_SIZE       = 1200;
+constexpr auto        FRAME_INTERVAL    = 16667us;
+constexpr auto        FEEDBACK_INTERVAL = 20ms;
+constexpr auto        STEP              = 100us;
+
+struct SimulationResult
+{
+    uint32_t        targetKbps { 0 };
+    Clock::duration maxQueueDelay {}; ///< Over the second half of the run
+};
+
+/**
+ * @brief Sender with an ideal encoder, which produces exactly the target
+ *        bitrate, talking to a receiver over the emulated link
+ */
+auto simulate(
+        const LinkSettings       &link_settings,
+        const CongestionSettings &settings,
+        Clock::duration           duration) -> SimulationResult
+{
+    CongestionController controller { settings };
+    FeedbackBuilder      feedback;
+    Pacer                pacer { settings.startBitrateKbps };
+    LinkEmulator         link { link_settings };
+
+    // Feedback travels back without loss or queueing
+    std::deque<std::pair<Clock::time_point, FeedbackFrame>> feedbackInFlight;
+    std::deque<std::size_t>                                 pacingQueue;
+
+    SimulationResult result;
+
+    const auto start        = Clock::now();
+    auto       nextFrame    = start;
+    auto       nextFeedback = start + FEEDBACK_INTERVAL;
+
+    SequenceNumber seq = 0;
+
+    for (auto now = start; now < start + duration; now += STEP) {
+        if (now >= nextFrame) {
+            const auto kbps  = controller.targetBitrateKbps();
+            auto       bytes = std::size_t { kbps } * 1000 / 8 * FRAME_INTERVAL / 1s;
+            for (; bytes > 0; bytes -= std::min(bytes, PACKET_SIZE)) {
+                pacingQueue.push_back(std::min(bytes, PACKET_SIZE));
+            }
+            nextFrame += FRAME_INTERVAL;
+        }
+
+        pacer.setBitrate(controller.targetBitrateKbps());
+        while (!pacingQueue.empty() && pacer.delayUntilSend(now) == Clock::duration::zero()) {
+            const auto size = pacingQueue.front();
+            pacingQueue.pop_front();
+
+            controller.onPacketSent(Channel::Video, seq, size, now);
+            pacer.onSent(size, now);
+            link.send(seq, size, now);
+            ++seq;
+        }
+
+        link.deliver(now, [&](const LinkEmulator::Delivery &delivery, Clock::time_point arrival) {
+            feedback.onReceived(Channel::Video, delivery.seq, arrival);
+        });
+
+        if (now >= nextFeedback) {
+            if (auto frame = feedback.build(Channel::Video)) {
+                feedbackInFlight.emplace_back(now + link_settings.delay, *frame);
+            }
+            nextFeedback += FEEDBACK_INTERVAL;
+        }
+
+        while (!feedbackInFlight.empty() && feedbackInFlight.front().first <= now) {
+            controller.onFeedback(feedbackInFlight.front().second, now);
+            feedbackInFlight.pop_front();
+        }
+
+        if (now - start > duration / 2) {
+            result.maxQueueDelay = std::max(result.maxQueueDelay, link.queueDelay(now));
+        }
+    }
+
+    result.targetKbps = controller.targetBitrateKbps();
+    return result;
+}
+
+} // namespace
+
+TEST(Pacer, SpreadsBurst)
+{
+    Pacer pacer { 1000 };
+
+    // 1000 kbps with 150% pacing factor is 187.5 bytes per millisecond
+    auto       now   = Clock::now();
+    const auto start = now;
+    for (int i = 0; i < 10; ++i) {
+        now += pacer.delayUntilSend(now);
+        EXPECT_EQ(pacer.delayUntilSend(now), Clock::duration::zero());
+        pacer.onSent(PACKET_SIZE, now);
+    }
+
+    // First MIN_BURST_BYTES go at once, the rest at the paced rate
+    const auto expectedMs = static_cast<double>(9 * PACKET_SIZE - Pacer::MIN_BURST_BYTES) / 187.5;
+    const auto elapsed    = std::chrono::duration<double, std::milli>(now - start);
+    EXPECT_NEAR(elapsed.count(), expectedMs, 1.0);
+}
+
+TEST(Pacer, IdleDoesNotAccumulateCredit)
+{
+    Pacer pacer { 100000 };
+
+    auto now = Clock::now();
+    pacer.onSent(0, now);
+    now += 10s;
+
+    std::size_t sent = 0;
+    while (pacer.delayUntilSend(now) == Clock::duration::zero()) {
+        pacer.onSent(PACKET_SIZE, now);
+        sent += PACKET_SIZE;
+    }
+
+    // 2 ms at 150 Mbps, not 10 seconds worth of data
+    EXPECT_LE(sent, 37500 + PACKET_SIZE);
+}
+
+TEST(FeedbackBuilder, ReportsArrivalsAndLosses)
+{
+    FeedbackBuilder builder;
+
+    const auto now = Clock::now();
+    builder.onReceived(Channel::Video, 100, now + 1ms);
+    builder.onReceived(Channel::Video, 102, now + 3ms);
+    builder.onReceived(Channel::Video, 103, now + 2ms);
+
+    auto frame = builder.build(Channel::Video);
+    ASSERT_TRUE(frame);
+    EXPECT_EQ(frame->base, 100);
+    EXPECT_EQ(frame->count, 4);
+    EXPECT_EQ(frame->arrival[0], 0);
+    EXPECT_EQ(frame->arrival[1], FeedbackFrame::NOT_RECEIVED);
+    EXPECT_EQ(frame->arrival[2], 2000 / 64);
+    EXPECT_EQ(frame->arrival[3], 1000 / 64);
+
+    EXPECT_FALSE(builder.build(Channel::Video));
+
+    // Late packet was already reported as lost
+    builder.onReceived(Channel::Video, 101, now + 4ms);
+    EXPECT_FALSE(builder.build(Channel::Video));
+
+    builder.onReceived(Channel::Video, 104, now + 5ms);
+    frame = builder.build(Channel::Video);
+    ASSERT_TRUE(frame);
+    EXPECT_EQ(frame->base, 104);
+    EXPECT_EQ(frame->count, 1);
+}
+
+TEST(CongestionController, ConvergesToBottleneck)
+{
+    LinkSettings link;
+    link.bandwidthKbps = 4000;
+    link.delay         = 25ms;
+    link.jitter        = 1ms;
+
+    const auto result = simulate(link, { 8000, 500, 10000 }, 30s);
+
+    EXPECT_GT(result.targetKbps, 2000u);
+    EXPECT_LT(result.targetKbps, 4800u);
+    EXPECT_LT(result.maxQueueDelay, 150ms);
+}
+
+TEST(CongestionController, IncreasesWhenCapacityIsAvailable)
+{
+    LinkSettings link;
+    link.bandwidthKbps = 50000;
+
+    const auto result = simulate(link, { 1000, 500, 10000 }, 20s);
+
+    EXPECT_GT(result.targetKbps, 3000u);
+    EXPECT_LT(result.maxQueueDelay, 10ms);
+}
+
+TEST(CongestionController, DecreasesOnLoss)
+{
+    LinkSettings link;
+    link.bandwidthKbps = 50000;
+    link.loss          = 0.2;
+
+    const auto result = simulate(link, { 5000, 500, 10000 }, 10s);
+
+    EXPECT_LT(result.targetKbps, 2500u);
+}
+
+TEST(CongestionController, StaysWithinLimits)
+{
+    LinkSettings link;
+    link.bandwidthKbps = 200;
+    link.queueBytes    = 8 * 1024;
+
+    const auto result = simulate(link, { 2000, 500, 3000 }, 20s);
+
+    EXPECT_EQ(result.targetKbps, 500u);
+}
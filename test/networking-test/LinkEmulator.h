@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <random>
+
+#include "SequenceNumber.h"
+
+namespace pirks::networking::test
+{
+
+struct LinkSettings
+{
+    uint32_t                            bandwidthKbps { 10000 };
+    std::chrono::steady_clock::duration delay { std::chrono::milliseconds { 20 } };
+    std::chrono::steady_clock::duration jitter { 0 }; ///< Uniform, added to delay
+    double                              loss { 0 };
+    std::size_t                         queueBytes { 64 * 1024 }; ///< Drop-tail bottleneck queue
+    uint32_t                            seed { 1 };
+};
+
+/**
+ * @brief In-process netem: bottleneck link with limited bandwidth, drop-tail
+ *        queue, propagation delay, jitter and random loss, in simulated time
+ *
+ * Packets are serialized one after another at the link bandwidth, so queue
+ * delay grows when the sender exceeds it. Jitter does not reorder packets.
+ */
+class LinkEmulator final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Delivery
+    {
+        SequenceNumber seq { 0 };
+        std::size_t    size { 0 };
+    };
+
+public:
+    explicit LinkEmulator(const LinkSettings &settings)
+            : settings_ { settings }
+            , random_ { settings.seed }
+    {
+        //
+    }
+
+public:
+    /**
+     * @brief Returns false if packet was dropped by the queue or lost
+     */
+    auto send(SequenceNumber seq, std::size_t size, Clock::time_point now) -> bool
+    {
+        const auto start = std::max(now, linkFreeAt_);
+
+        if (queuedBytes(now) + size > settings_.queueBytes) {
+            ++dropped_;
+            return false;
+        }
+
+        const auto serialization = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::nanoseconds { static_cast<int64_t>(size) * 8 * 1'000'000
+                                           / settings_.bandwidthKbps });
+        linkFreeAt_ = start + serialization;
+
+        if (std::bernoulli_distribution { settings_.loss }(random_)) {
+            ++lost_;
+            return false;
+        }
+
+        auto jitter = Clock::duration::zero();
+        if (settings_.jitter > Clock::duration::zero()) {
+            jitter = Clock::duration { std::uniform_int_distribution<Clock::rep> {
+                    0, settings_.jitter.count() }(random_) };
+        }
+
+        lastArrival_ = std::max(lastArrival_, linkFreeAt_ + settings_.delay + jitter);
+        inFlight_.emplace(lastArrival_, Delivery { seq, size });
+        return true;
+    }
+
+    template <typename DeliverFunc>
+    void deliver(Clock::time_point now, DeliverFunc func)
+    {
+        while (!inFlight_.empty() && inFlight_.begin()->first <= now) {
+            const auto [arrival, delivery] = *inFlight_.begin();
+            inFlight_.erase(inFlight_.begin());
+            func(delivery, arrival);
+        }
+    }
+
+    /**
+     * @brief How long a packet sent now waits in the bottleneck queue
+     */
+    [[nodiscard]]
+    auto queueDelay(Clock::time_point now) const -> Clock::duration
+    {
+        return std::max(linkFreeAt_ - now, Clock::duration::zero());
+    }
+
+    [[nodiscard]]
+    auto dropped() const -> std::size_t
+    {
+        return dropped_;
+    }
+
+    [[nodiscard]]
+    auto lost() const -> std::size_t
+    {
+        return lost_;
+    }
+
+private:
+    auto queuedBytes(Clock::time_point now) const -> std::size_t
+    {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(queueDelay(now));
+        return static_cast<std::size_t>(ns.count() * settings_.bandwidthKbps / 8 / 1'000'000);
+    }
+
+private:
+    LinkSettings settings_;
+    std::mt19937 random_;
+
+    Clock::time_point linkFreeAt_ {};
+    Clock::time_point lastArrival_ {};
+
+    std::multimap<Clock::time_point, Delivery> inFlight_;
+
+    std::size_t dropped_ { 0 };
+    std::size_t lost_ { 0 };
+};
+
+}; // namespace pirks::networking::test
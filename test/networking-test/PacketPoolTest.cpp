@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory_resource>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "PacketPool.h"
+
+using namespace pirks::networking;
+
+TEST(PacketPool, AcquireRelease)
+{
+    PacketPool pool { 1400, 4 };
+    EXPECT_EQ(pool.blockSize() % PacketPool::BLOCK_ALIGNMENT, 0u);
+    EXPECT_GE(pool.blockSize(), 1400u);
+    EXPECT_EQ(pool.available(), 4u);
+
+    std::set<std::uint8_t *> blocks;
+    for (int i = 0; i < 4; ++i) {
+        auto *block = pool.acquire();
+        ASSERT_NE(block, nullptr);
+        EXPECT_TRUE(pool.owns(block));
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(block) % PacketPool::BLOCK_ALIGNMENT, 0u);
+        blocks.insert(block);
+    }
+    EXPECT_EQ(blocks.size(), 4u);
+
+    // Pool is exhausted
+    EXPECT_EQ(pool.acquire(), nullptr);
+    EXPECT_EQ(pool.available(), 0u);
+
+    for (auto *block: blocks) {
+        pool.release(block);
+    }
+    EXPECT_EQ(pool.available(), 4u);
+
+    pool.release(nullptr);
+    EXPECT_EQ(pool.available(), 4u);
+}
+
+TEST(PacketPool, Owns)
+{
+    PacketPool pool { 100, 2 };
+    auto      *block = pool.acquire();
+
+    EXPECT_TRUE(pool.owns(block));
+    EXPECT_FALSE(pool.owns(block + 1));
+
+    std::uint8_t other = 0;
+    EXPECT_FALSE(pool.owns(&other));
+
+    pool.release(block);
+}
+
+TEST(PacketPool, ConcurrentUse)
+{
+    PacketPool pool { 64, 64 };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool]() {
+            for (int i = 0; i < 10000; ++i) {
+                auto *block = pool.acquire();
+                if (block != nullptr) {
+                    block[0] = 1;
+                    pool.release(block);
+                }
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(pool.available(), 64u);
+}
+
+TEST(PacketPool, Headroom)
+{
+    PacketPool pool { 100, 2, 16 };
+    EXPECT_EQ(pool.headroom(), PacketPool::BLOCK_ALIGNMENT);
+
+    auto *first  = pool.acquire();
+    auto *second = pool.acquire();
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+
+    // Payload stays aligned, headroom of one block does not overlap another block
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(first) % PacketPool::BLOCK_ALIGNMENT, 0u);
+    const auto distance = first < second ? second - first : first - second;
+    EXPECT_GE(static_cast<std::size_t>(distance), pool.blockSize() + pool.headroom());
+
+    EXPECT_TRUE(pool.owns(first));
+    EXPECT_FALSE(pool.owns(first - pool.headroom()));
+
+    pool.release(first);
+    pool.release(second);
+    EXPECT_EQ(pool.available(), 2u);
+}
+
+TEST(PacketPool, Tailroom)
+{
+    PacketPool pool { 128, 2, 16, 16 };
+    EXPECT_EQ(pool.blockSize(), 128u);
+    EXPECT_EQ(pool.tailroom(), PacketPool::BLOCK_ALIGNMENT);
+
+    auto *first  = pool.acquire();
+    auto *second = pool.acquire();
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+
+    // Tailroom of one block ends before headroom of the next one
+    const auto distance = first < second ? second - first : first - second;
+    EXPECT_GE(
+            static_cast<std::size_t>(distance),
+            pool.blockSize() + pool.tailroom() + pool.headroom());
+    EXPECT_FALSE(pool.owns(first + pool.blockSize()));
+
+    pool.release(first);
+    pool.release(second);
+    EXPECT_EQ(pool.available(), 2u);
+}
+
+TEST(PacketPool, MemoryResource)
+{
+    std::pmr::monotonic_buffer_resource resource;
+
+    PacketPool pool { 100, 4, 0, 0, &resource };
+
+    auto *block = pool.acquire();
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(block) % PacketPool::BLOCK_ALIGNMENT, 0u);
+
+    // All blocks are in memory of the resource, which is given out in order
+    auto *next = static_cast<std::uint8_t *>(resource.allocate(1));
+    EXPECT_GT(next, block);
+
+    pool.release(block);
+}
@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "ReliableChannels.h"
+
+using namespace pirks::networking;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = ReliableChannels::Clock;
+
+struct Sent
+{
+    PacketInfo     packet;
+    SequenceNumber seq;
+};
+
+auto makePacket(PacketPool &pool, uint8_t channel, bool reliable, uint8_t value) -> PacketInfo
+{
+    PacketInfo packet;
+    packet.channel  = channel;
+    packet.reliable = reliable;
+    packet.size     = 1;
+    packet.data     = pool.acquire();
+    packet.data[0]  = value;
+    return packet;
+}
+
+// Copy of the packet as receiver would get it from the socket
+auto receivedCopy(PacketPool &pool, const PacketInfo &packet) -> PacketInfo
+{
+    auto copy = packet;
+    copy.data = pool.acquire();
+    std::copy_n(packet.data, packet.size, copy.data);
+    return copy;
+}
+
+} // namespace
+
+TEST(ReliableChannels, ReliableDeliveredInOrderAfterLoss)
+{
+    auto             pool = std::make_shared<PacketPool>(64, 64);
+    ReliableChannels sender { pool };
+    ReliableChannels receiver { pool };
+
+    auto now = Clock::now();
+
+    std::vector<Sent> sent;
+    for (uint8_t i = 0; i < 4; ++i) {
+        auto packet = makePacket(*pool, Channel::Input, true, i);
+        auto seq    = sender.send(packet, now);
+        ASSERT_TRUE(seq);
+        EXPECT_EQ(*seq, i);
+        sent.push_back({ packet, *seq });
+    }
+
+    std::vector<uint8_t> delivered;
+    auto                 deliver = [&](const PacketInfo &packet) {
+        delivered.push_back(packet.data[0]);
+        pool->release(packet.data);
+    };
+
+    // Packet 1 is lost
+    for (std::size_t i: { 0u, 2u, 3u }) {
+        receiver.receive(receivedCopy(*pool, sent[i].packet), sent[i].seq, deliver);
+    }
+    EXPECT_EQ(delivered, (std::vector<uint8_t> { 0 }));
+
+    // Acknowledgement reports the hole: 0 received, 1 missing, 2 and 3 received
+    auto ack = receiver.takeAck(Channel::Input);
+    ASSERT_TRUE(ack);
+    EXPECT_EQ(ack->next, 1);
+    EXPECT_EQ(ack->mask, 0b11u);
+    EXPECT_FALSE(receiver.takeAck(Channel::Input));
+
+    now += 50ms;
+    sender.onAck(*ack, now);
+    EXPECT_EQ(sender.rtt().srtt(), 50ms);
+
+    // Hole is retransmitted immediately, without waiting for timeout
+    std::vector<SequenceNumber> retransmitted;
+    sender.retransmit(now, [&](const PacketInfo &packet, SequenceNumber seq) {
+        retransmitted.push_back(seq);
+        receiver.receive(receivedCopy(*pool, packet), seq, deliver);
+    });
+    EXPECT_EQ(retransmitted, (std::vector<SequenceNumber> { 1 }));
+    EXPECT_EQ(delivered, (std::vector<uint8_t> { 0, 1, 2, 3 }));
+
+    ack = receiver.takeAck(Channel::Input);
+    ASSERT_TRUE(ack);
+    EXPECT_EQ(ack->next, 4);
+    EXPECT_EQ(ack->mask, 0u);
+    sender.onAck(*ack, now + 50ms);
+
+    EXPECT_EQ(sender.sendStats(Channel::Input, true).retransmitted, 1u);
+    EXPECT_EQ(pool->available(), pool->blockCount());
+}
+
+TEST(ReliableChannels, RetransmitAfterTimeout)
+{
+    auto             pool = std::make_shared<PacketPool>(64, 8);
+    ReliableChannels sender { pool };
+
+    const auto start  = Clock::now();
+    auto       packet = makePacket(*pool, Channel::Control, true, 7);
+    ASSERT_TRUE(sender.send(packet, start));
+
+    int count = 0;
+    auto func = [&](const PacketInfo &, SequenceNumber) { ++count; };
+
+    sender.retransmit(start + RttEstimator::INITIAL_RTO - 1ms, func);
+    EXPECT_EQ(count, 0);
+
+    sender.retransmit(start + RttEstimator::INITIAL_RTO, func);
+    EXPECT_EQ(count, 1);
+
+    // Timeout is doubled for the second retransmission
+    sender.retransmit(start + RttEstimator::INITIAL_RTO * 2, func);
+    EXPECT_EQ(count, 1);
+    sender.retransmit(start + RttEstimator::INITIAL_RTO * 3, func);
+    EXPECT_EQ(count, 2);
+
+    // Retransmitted packet does not give RTT sample
+    sender.onAck({ Channel::Control, 1, 0 }, start + RttEstimator::INITIAL_RTO * 3 + 1ms);
+    EXPECT_FALSE(sender.rtt().hasSamples());
+    EXPECT_EQ(pool->available(), pool->blockCount());
+}
+
+TEST(ReliableChannels, SendWindowIsLimited)
+{
+    auto             pool = std::make_shared<PacketPool>(16, ReliableChannels::WINDOW_SIZE + 2);
+    ReliableChannels sender { pool };
+
+    const auto now = Clock::now();
+    for (std::size_t i = 0; i < ReliableChannels::WINDOW_SIZE; ++i) {
+        ASSERT_TRUE(sender.send(makePacket(*pool, Channel::Control, true, 0), now));
+    }
+
+    auto extra = makePacket(*pool, Channel::Control, true, 0);
+    EXPECT_FALSE(sender.send(extra, now));
+
+    // Other channels have their own windows
+    EXPECT_TRUE(sender.send(makePacket(*pool, Channel::Video, false, 0), now));
+
+    sender.onAck({ Channel::Control, 1, 0 }, now + 1ms);
+    EXPECT_TRUE(sender.send(extra, now));
+}
+
+TEST(ReliableChannels, StaleAckIsIgnored)
+{
+    auto             pool = std::make_shared<PacketPool>(16, 8);
+    ReliableChannels sender { pool };
+
+    const auto now = Clock::now();
+    ASSERT_TRUE(sender.send(makePacket(*pool, Channel::Control, true, 0), now));
+
+    // Acknowledges packets that were never sent
+    sender.onAck({ Channel::Control, 5, 0 }, now);
+    EXPECT_EQ(pool->available(), 7u);
+
+    sender.onAck({ Channel::Control, 1, 0 }, now);
+    EXPECT_EQ(pool->available(), 8u);
+}
+
+TEST(ReliableChannels, UnreliableLossDetection)
+{
+    auto             pool = std::make_shared<PacketPool>(16, 8);
+    ReliableChannels receiver { pool };
+
+    PacketInfo packet;
+    packet.channel  = Channel::Video;
+    packet.reliable = false;
+
+    int  delivered = 0;
+    auto deliver   = [&](const PacketInfo &) { ++delivered; };
+
+    // Start near wrap around
+    for (int seq: { 0xFFFE, 0xFFFF, 2, 1, 1, 5 }) {
+        receiver.receive(packet, static_cast<SequenceNumber>(seq), deliver);
+    }
+
+    const auto stats = receiver.receiveStats(Channel::Video, false);
+    EXPECT_EQ(delivered, 5);
+    EXPECT_EQ(stats.received, 6u);
+    EXPECT_EQ(stats.duplicates, 1u);
+    EXPECT_EQ(stats.reordered, 1u);
+    // 0 is lost, 1 arrived late, 3 and 4 are lost
+    EXPECT_EQ(stats.lost, 3u);
+
+    // Unreliable channels are never acknowledged
+    EXPECT_FALSE(receiver.takeAck(Channel::Video));
+}
+
+TEST(ReliableChannels, ReliableDuplicatesAreAcknowledged)
+{
+    auto             pool = std::make_shared<PacketPool>(16, 8);
+    ReliableChannels receiver { pool };
+
+    PacketInfo packet;
+    packet.channel  = Channel::Control;
+    packet.reliable = true;
+    packet.data     = pool->acquire();
+
+    auto deliver = [&](const PacketInfo &ready) { pool->release(ready.data); };
+
+    EXPECT_EQ(receiver.receive(packet, 0, deliver), ReceiveResult::Delivered);
+    ASSERT_TRUE(receiver.takeAck(Channel::Control));
+
+    // Acknowledgement was lost and sender retransmitted the packet
+    EXPECT_EQ(receiver.receive(packet, 0, deliver), ReceiveResult::Duplicate);
+    EXPECT_TRUE(receiver.takeAck(Channel::Control));
+
+    // Far outside of receive window
+    EXPECT_EQ(receiver.receive(packet, 1000, deliver), ReceiveResult::Dropped);
+}
+
+TEST(RttEstimator, FollowsRfc6298)
+{
+    RttEstimator rtt;
+    EXPECT_EQ(rtt.rto(), RttEstimator::INITIAL_RTO);
+
+    rtt.addSample(40ms);
+    EXPECT_EQ(rtt.srtt(), 40ms);
+    EXPECT_EQ(rtt.rttvar(), 20ms);
+    EXPECT_EQ(rtt.rto(), 120ms);
+
+    rtt.addSample(80ms);
+    EXPECT_EQ(rtt.srtt(), 45ms);
+    EXPECT_EQ(rtt.rttvar(), 25ms);
+
+    for (int i = 0; i < 100; ++i) {
+        rtt.addSample(1ms);
+    }
+    EXPECT_EQ(rtt.rto(), RttEstimator::MIN_RTO);
+}
@@ -0,0 +1,514 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "AesGcm.h"
+#include "FecCodec.h"
+#include "UDPConnection.h"
+
+using namespace pirks::networking;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::size_t BLOCK_COUNT = 256;
+
+auto makePool()
+{
+    return std::make_shared<PacketPool>(
+            UDPConnection::MAX_PAYLOAD_SIZE,
+            BLOCK_COUNT,
+            wire::PACKET_HEADROOM,
+            wire::PACKET_TAILROOM);
+}
+
+auto waitFor(const std::function<bool()> &condition, std::chrono::milliseconds timeout) -> bool
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+auto makePayload(std::size_t size, uint8_t seed) -> std::vector<uint8_t>
+{
+    std::vector<uint8_t> payload(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        payload[i] = static_cast<uint8_t>(i * 13 + seed);
+    }
+    return payload;
+}
+
+// Remote side speaking the wire format directly, so datagrams can be lost on purpose
+class RawPeer final
+{
+public:
+    using Datagram = std::pair<wire::Header, std::vector<uint8_t>>;
+
+    explicit RawPeer(uint16_t port)
+    {
+        socket_.bind(0);
+        socket_.setReceiveTimeout(100ms);
+
+        server_.address.sin_family      = AF_INET;
+        server_.address.sin_port        = htons(port);
+        server_.address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    }
+
+    void sendRaw(std::span<const uint8_t> datagram)
+    {
+        EXPECT_TRUE(socket_.sendTo(datagram, server_));
+    }
+
+    void send(wire::Header header, std::span<const uint8_t> payload)
+    {
+        header.payloadSize = static_cast<uint16_t>(payload.size());
+
+        std::vector<uint8_t> datagram(wire::HEADER_SIZE + payload.size());
+        wire::serialize(header, std::span { datagram }.first<wire::HEADER_SIZE>());
+        std::ranges::copy(payload, datagram.begin() + wire::HEADER_SIZE);
+
+        EXPECT_TRUE(socket_.sendTo(datagram, server_));
+    }
+
+    void sendSealed(
+            wire::Header             header,
+            std::span<const uint8_t> payload,
+            crypto::AesGcm          &sealer,
+            uint64_t                 index)
+    {
+        header.flags       = header.flags | wire::Flags::Encrypted;
+        header.payloadSize = static_cast<uint16_t>(payload.size() + crypto::TAG_SIZE);
+
+        std::vector<uint8_t> datagram(wire::HEADER_SIZE + header.payloadSize);
+        const auto           bytes = std::span { datagram };
+        wire::serialize(header, bytes.first<wire::HEADER_SIZE>());
+        std::ranges::copy(payload, datagram.begin() + wire::HEADER_SIZE);
+
+        ASSERT_TRUE(sealer.seal(
+                bytes.first<wire::HEADER_SIZE>(),
+                bytes.subspan(wire::HEADER_SIZE, payload.size()),
+                bytes.last<crypto::TAG_SIZE>(),
+                index));
+        EXPECT_TRUE(socket_.sendTo(datagram, server_));
+    }
+
+    /**
+     * @brief Next packet or parity datagram, or the next acknowledgement or
+     *        feedback if control is set. Datagrams of the other kind are skipped
+     */
+    auto receive(bool control = false) -> std::optional<Datagram>
+    {
+        std::array<uint8_t, UDPConnection::MAX_DATAGRAM_SIZE> buffer;
+
+        for (int i = 0; i < 20; ++i) {
+            SocketAddress from;
+
+            const auto size = socket_.receiveFrom(buffer, from);
+            if (!size) {
+                continue;
+            }
+
+            const auto header = wire::parse(std::span { buffer }.first(*size));
+            if (!header
+                || ((header->flags & (wire::Flags::Ack | wire::Flags::Feedback)) != 0) != control)
+            {
+                continue;
+            }
+
+            return Datagram { *header,
+                              { buffer.begin() + wire::HEADER_SIZE, buffer.begin() + *size } };
+        }
+        return std::nullopt;
+    }
+
+private:
+    UdpSocket     socket_;
+    SocketAddress server_;
+};
+
+class UDPConnectionTest: public ::testing::Test
+{
+protected:
+    // Configures the connection before it's created
+    void start(const std::function<void(UDPConnection &)> &configure)
+    {
+        connection_ = std::make_unique<UDPConnection>(0, pool_);
+        configure(*connection_);
+        connection_->create(in_, out_);
+
+        peer_ = std::make_unique<RawPeer>(connection_->localPort());
+    }
+
+    void start(const fec::FecSettings &settings)
+    {
+        start([&](UDPConnection &connection) { connection.enableFec(settings); });
+    }
+
+    // Packet the remote side sends first, so the connection knows where it is
+    void connect()
+    {
+        const std::array<uint8_t, 1> hello {};
+
+        wire::Header header;
+        header.channel = Channel::Control;
+        peer_->send(header, hello);
+
+        const auto packet = in_->pop(1s);
+        ASSERT_TRUE(packet);
+        pool_->release(packet->data);
+
+        waitForReceiveBlock();
+    }
+
+    // Receive thread takes the block for the next datagram after it pushed
+    // the last one, so blocks in use are counted only after that
+    void waitForReceiveBlock()
+    {
+        ASSERT_TRUE(waitFor([&] { return pool_->available() == BLOCK_COUNT - 1; }, 1s));
+    }
+
+    std::shared_ptr<PacketPool>    pool_ { makePool() };
+    std::shared_ptr<PacketsQueue>  in_ { std::make_shared<PacketsQueue>() };
+    std::shared_ptr<PacketsQueue>  out_ { std::make_shared<PacketsQueue>() };
+    std::unique_ptr<UDPConnection> connection_;
+    std::unique_ptr<RawPeer>       peer_;
+};
+
+} // namespace
+
+TEST_F(UDPConnectionTest, FecRestoresLostPacket)
+{
+    const fec::FecSettings settings { 4, 2 };
+    start(settings);
+
+    // Short group: 3 data packets, sequence numbers 0..2, parity 3..4
+    std::vector<std::vector<uint8_t>> payloads;
+    std::vector<PacketInfo>           data;
+    for (uint8_t i = 0; i < 3; ++i) {
+        payloads.push_back(makePayload(100 + i * 150u, i));
+
+        PacketInfo packet;
+        packet.channel   = Channel::Video;
+        packet.size      = static_cast<uint32_t>(payloads.back().size());
+        packet.timestamp = 9000;
+        packet.data      = payloads.back().data();
+        data.push_back(packet);
+    }
+
+    auto                    encoderPool = makePool();
+    fec::FecEncoder         encoder { settings, encoderPool };
+    std::vector<PacketInfo> parity(settings.parityShards);
+    ASSERT_TRUE(encoder.encode(data, parity));
+
+    auto send = [&](const PacketInfo &packet, SequenceNumber seq, bool is_parity) {
+        auto header     = wire::packetHeader(packet, seq);
+        header.fecShard = static_cast<uint8_t>(seq + 1);
+        if (is_parity) {
+            header.flags         = wire::Flags::Parity;
+            header.fragmentIndex = static_cast<uint16_t>(seq - data.size());
+            header.fragmentCount = settings.parityShards;
+        }
+        peer_->send(header, { packet.data, packet.size });
+    };
+
+    // Second data packet and first parity packet are lost
+    send(data[0], 0, false);
+    send(data[2], 2, false);
+    send(parity[1], 4, true);
+
+    std::vector<PacketInfo> received;
+    for (int i = 0; i < 3; ++i) {
+        const auto packet = in_->pop(1s);
+        ASSERT_TRUE(packet);
+        received.push_back(*packet);
+    }
+    std::ranges::sort(received, {}, &PacketInfo::sequence);
+
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        EXPECT_EQ(received[i].sequence, i);
+        EXPECT_EQ(received[i].channel, Channel::Video);
+        EXPECT_EQ(received[i].timestamp, 9000u);
+        ASSERT_EQ(received[i].size, payloads[i].size());
+        EXPECT_TRUE(std::ranges::equal(payloads[i],
+                                       std::span { received[i].data, received[i].size }));
+        pool_->release(received[i].data);
+    }
+
+    // Parity is not delivered
+    EXPECT_FALSE(in_->pop(50ms));
+
+    for (auto &packet: parity) {
+        encoderPool->release(packet.data);
+    }
+}
+
+TEST_F(UDPConnectionTest, FecParityOnSend)
+{
+    const fec::FecSettings settings { 4, 2 };
+    start(settings);
+    connect();
+
+    std::vector<std::vector<uint8_t>> payloads;
+    std::vector<PacketInfo>           packets;
+    for (uint8_t i = 0; i < settings.dataShards; ++i) {
+        payloads.push_back(makePayload(200 + i * 100u, i));
+
+        PacketInfo packet;
+        packet.channel   = Channel::Video;
+        packet.size      = static_cast<uint32_t>(payloads.back().size());
+        packet.timestamp = 3000u * i;
+        packet.data      = pool_->acquire();
+        std::ranges::copy(payloads.back(), packet.data);
+        packets.push_back(packet);
+    }
+
+    // Pushed at once, so the group is not closed early for lack of packets
+    out_->push(packets);
+
+    std::vector<RawPeer::Datagram> datagrams;
+    for (int i = 0; i < settings.dataShards + settings.parityShards; ++i) {
+        auto datagram = peer_->receive();
+        ASSERT_TRUE(datagram);
+        datagrams.push_back(std::move(*datagram));
+    }
+
+    const auto base = datagrams[0].first.sequence;
+    for (std::size_t i = 0; i < datagrams.size(); ++i) {
+        const auto &header = datagrams[i].first;
+        EXPECT_EQ(header.sequence, static_cast<SequenceNumber>(base + i));
+        EXPECT_EQ(header.fecShard, i + 1);
+        EXPECT_EQ((header.flags & wire::Flags::Parity) != 0, i >= settings.dataShards);
+    }
+
+    // Remote side restores a lost packet from parity, headers of the
+    // received ones are a part of it
+    std::vector<PacketInfo> data(settings.dataShards);
+    std::vector<PacketInfo> parity(settings.parityShards);
+    for (std::size_t i = 0; i < datagrams.size(); ++i) {
+        auto &[header, payload] = datagrams[i];
+
+        auto &packet         = i < data.size() ? data[i] : parity[i - data.size()];
+        packet.size          = static_cast<uint32_t>(payload.size());
+        packet.timestamp     = header.timestamp;
+        packet.fragmentIndex = header.fragmentIndex;
+        packet.fragmentCount = header.fragmentCount;
+        packet.data          = payload.data();
+    }
+    data[1].data = nullptr;
+
+    auto            decoderPool = makePool();
+    fec::FecDecoder decoder { settings, decoderPool };
+    ASSERT_TRUE(decoder.recover(data, parity));
+
+    ASSERT_EQ(data[1].size, payloads[1].size());
+    EXPECT_EQ(data[1].timestamp, 3000u);
+    EXPECT_TRUE(std::ranges::equal(payloads[1], std::span { data[1].data, data[1].size }));
+    decoderPool->release(data[1].data);
+}
+
+TEST_F(UDPConnectionTest, GarbageDoesNotBecomePeer)
+{
+    start([](UDPConnection &) {});
+
+    RawPeer intruder { connection_->localPort() };
+
+    const std::array<uint8_t, 3> garbage { 0xDE, 0xAD, 0x00 };
+    intruder.sendRaw(garbage);
+
+    std::array<uint8_t, wire::HEADER_SIZE + 4> header {};
+    header.fill(0xFF);
+    intruder.sendRaw(header);
+
+    connect();
+
+    PacketInfo packet;
+    packet.channel = Channel::Control;
+    packet.size    = 8;
+    packet.data    = pool_->acquire();
+    out_->push(packet);
+
+    EXPECT_TRUE(peer_->receive());
+    EXPECT_FALSE(intruder.receive());
+}
+
+TEST_F(UDPConnectionTest, ForeignPacketsAreDropped)
+{
+    start([](UDPConnection &) {});
+    connect();
+
+    const auto available = pool_->available();
+
+    // Neither a pool block nor a fragment of a frame, fragmentation is off
+    std::array<uint8_t, 16> foreign {};
+
+    PacketInfo packet;
+    packet.channel = Channel::Control;
+    packet.size    = foreign.size();
+    packet.data    = foreign.data();
+    out_->push(packet);
+
+    packet.reliable = true;
+    out_->push(packet);
+
+    packet.data = nullptr;
+    packet.size = 0;
+    out_->push(packet);
+
+    packet.fragmentIndex = 1;
+    packet.fragmentCount = 2;
+    packet.reliable      = false;
+    packet.data          = foreign.data() + 8;
+    out_->push(packet);
+
+    // Packet with a channel out of range never reaches the wire either
+    PacketInfo invalid;
+    invalid.channel = CHANNEL_COUNT;
+    invalid.size    = 8;
+    invalid.data    = pool_->acquire();
+    out_->push(invalid);
+
+    PacketInfo valid;
+    valid.channel = Channel::Input;
+    valid.size    = 8;
+    valid.data    = pool_->acquire();
+    out_->push(valid);
+
+    const auto sent = peer_->receive();
+    ASSERT_TRUE(sent);
+    EXPECT_EQ(sent->first.channel, Channel::Input);
+    EXPECT_FALSE(peer_->receive());
+
+    EXPECT_TRUE(waitFor([&] { return pool_->available() == available; }, 1s));
+}
+
+TEST_F(UDPConnectionTest, ControlFramesAreAuthenticated)
+{
+    if (!crypto::isAvailable()) {
+        GTEST_SKIP() << "built without OpenSSL";
+    }
+
+    const auto sendKey    = crypto::generateSessionKey();
+    const auto receiveKey = crypto::generateSessionKey();
+    start([&](UDPConnection &connection) { connection.enableEncryption(sendKey, receiveKey); });
+
+    // Remote side uses the keys the other way round
+    crypto::AesGcm sealer { receiveKey };
+    crypto::AesGcm opener { sendKey };
+
+    const std::array<uint8_t, 4> input { 1, 2, 3, 4 };
+
+    wire::Header header;
+    header.channel = Channel::Input;
+    peer_->sendSealed(header, input, sealer, crypto::packetIndex(false, Channel::Input, 0));
+
+    auto packet = in_->pop(1s);
+    ASSERT_TRUE(packet);
+    pool_->release(packet->data);
+    waitForReceiveBlock();
+
+    // Feedback on the packet is sealed in the control sequence space
+    auto feedback = peer_->receive(true);
+    ASSERT_TRUE(feedback);
+    auto &[feedbackHeader, sealed] = *feedback;
+    ASSERT_NE(feedbackHeader.flags & wire::Flags::Encrypted, 0);
+    ASSERT_GE(sealed.size(), crypto::TAG_SIZE);
+
+    std::array<uint8_t, wire::HEADER_SIZE> aad;
+    wire::serialize(feedbackHeader, aad);
+
+    const auto size = sealed.size() - crypto::TAG_SIZE;
+    EXPECT_TRUE(opener.open(
+            aad,
+            std::span { sealed }.first(size),
+            std::span { sealed }.last<crypto::TAG_SIZE>(),
+            crypto::packetIndex(
+                    crypto::SequenceSpace::Control,
+                    Channel::Input,
+                    feedbackHeader.sequence)));
+
+    const auto available = pool_->available();
+
+    PacketInfo reliable;
+    reliable.channel  = Channel::Control;
+    reliable.reliable = true;
+    reliable.size     = 8;
+    reliable.data     = pool_->acquire();
+    out_->push(reliable);
+
+    const auto sent = peer_->receive();
+    ASSERT_TRUE(sent);
+    ASSERT_NE(sent->first.flags & wire::Flags::Reliable, 0);
+
+    wire::Header ack;
+    ack.flags   = wire::Flags::Reliable | wire::Flags::Ack;
+    ack.channel = Channel::Control;
+
+    std::array<uint8_t, 10> acknowledged {};
+    const auto next = static_cast<SequenceNumber>(sent->first.sequence + 1);
+    wire::storeBigEndian(acknowledged.data(), next);
+
+    // Plaintext acknowledgement is dropped, the packet is sent again
+    peer_->send(ack, acknowledged);
+
+    const auto retransmitted = peer_->receive();
+    ASSERT_TRUE(retransmitted);
+    EXPECT_EQ(retransmitted->first.sequence, sent->first.sequence);
+    EXPECT_EQ(pool_->available(), available - 1);
+
+    // Sealed one releases it
+    peer_->sendSealed(
+            ack,
+            acknowledged,
+            sealer,
+            crypto::packetIndex(crypto::SequenceSpace::Control, Channel::Control, 0));
+    EXPECT_TRUE(waitFor([&] { return pool_->available() == available; }, 1s));
+}
+
+TEST_F(UDPConnectionTest, ReplayedPacketIsDropped)
+{
+    if (!crypto::isAvailable()) {
+        GTEST_SKIP() << "built without OpenSSL";
+    }
+
+    const auto sendKey    = crypto::generateSessionKey();
+    const auto receiveKey = crypto::generateSessionKey();
+    start([&](UDPConnection &connection) { connection.enableEncryption(sendKey, receiveKey); });
+
+    crypto::AesGcm sealer { receiveKey };
+
+    // Sealing is deterministic, so sealing the same packet again records it
+    const std::array<uint8_t, 4> input { 1, 2, 3, 4 };
+    auto send = [&](SequenceNumber seq) {
+        wire::Header header;
+        header.channel  = Channel::Input;
+        header.sequence = seq;
+        peer_->sendSealed(header, input, sealer, crypto::packetIndex(false, Channel::Input, seq));
+    };
+
+    // Packets further back than ReliableChannels remembers, it would take
+    // the replayed one as reordered
+    for (SequenceNumber seq = 0; seq < 100; ++seq) {
+        send(seq);
+
+        const auto packet = in_->pop(1s);
+        ASSERT_TRUE(packet);
+        pool_->release(packet->data);
+    }
+
+    send(0);
+    send(99);
+    EXPECT_FALSE(in_->pop(100ms));
+}
@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <random>
+#include <vector>
+
+#include "PacketPool.h"
+#include "WireHeader.h"
+
+using namespace pirks::networking;
+
+namespace {
+
+constexpr int FUZZ_ITERATIONS = 100000;
+
+auto randomHeader(std::mt19937 &random) -> wire::Header
+{
+    std::uniform_int_distribution<uint32_t> any;
+
+    wire::Header header;
+    header.flags         = static_cast<uint8_t>(any(random) % 2 ? wire::Flags::Reliable : 0);
+    header.channel       = static_cast<uint8_t>(any(random) % CHANNEL_COUNT);
+    header.sequence      = static_cast<SequenceNumber>(any(random));
+    header.timestamp     = any(random);
+    header.fragmentCount = static_cast<uint16_t>(any(random) % 1000 + 1);
+    header.fragmentIndex = static_cast<uint16_t>(any(random) % header.fragmentCount);
+    header.payloadSize   = static_cast<uint16_t>(any(random) % 64);
+
+    // Only unreliable packets are protected by FEC
+    if (header.flags == 0 && any(random) % 2) {
+        header.fecShard = static_cast<uint8_t>(any(random) % 255 + 1);
+    }
+    return header;
+}
+
+auto datagramOf(const wire::Header &header) -> std::vector<uint8_t>
+{
+    std::vector<uint8_t> datagram(wire::HEADER_SIZE + header.payloadSize, 0xA5);
+    wire::serialize(header, std::span { datagram }.first<wire::HEADER_SIZE>());
+    return datagram;
+}
+
+// Accepted datagram must describe itself exactly: serializing the parsed
+// header gives back the same bytes
+void expectCanonical(const std::vector<uint8_t> &datagram)
+{
+    const auto header = wire::parse(datagram);
+    if (!header) {
+        return;
+    }
+
+    EXPECT_EQ(header->payloadSize + wire::HEADER_SIZE, datagram.size());
+    EXPECT_LT(header->channel, CHANNEL_COUNT);
+    EXPECT_LT(header->fragmentIndex, header->fragmentCount);
+
+    std::array<uint8_t, wire::HEADER_SIZE> serialized {};
+    wire::serialize(*header, serialized);
+    EXPECT_TRUE(std::equal(serialized.begin(), serialized.end(), datagram.begin()));
+}
+
+} // namespace
+
+TEST(WireHeader, BigEndianLayout)
+{
+    wire::Header header;
+    header.flags         = wire::Flags::Reliable;
+    header.channel       = Channel::Input;
+    header.sequence      = 0x1234;
+    header.timestamp     = 0x89ABCDEF;
+    header.fragmentIndex = 0x0102;
+    header.fragmentCount = 0x0304;
+    header.payloadSize   = 0;
+
+    std::array<uint8_t, wire::HEADER_SIZE> buffer {};
+    wire::serialize(header, buffer);
+
+    const std::array<uint8_t, wire::HEADER_SIZE> expected {
+        wire::PROTOCOL_VERSION, 0x01, 0x01, 0x00, 0x12, 0x34, 0x89, 0xAB,
+        0xCD, 0xEF, 0x01, 0x02, 0x03, 0x04, 0x00, 0x00,
+    };
+    EXPECT_EQ(buffer, expected);
+}
+
+TEST(WireHeader, RoundTrip)
+{
+    std::mt19937 random { 1 };
+
+    for (int i = 0; i < 1000; ++i) {
+        const auto header = randomHeader(random);
+        const auto parsed = wire::parse(datagramOf(header));
+        ASSERT_TRUE(parsed);
+        EXPECT_EQ(*parsed, header);
+    }
+}
+
+TEST(WireHeader, RejectsMalformed)
+{
+    wire::Header valid;
+    valid.channel     = Channel::Video;
+    valid.payloadSize = 4;
+    ASSERT_TRUE(wire::parse(datagramOf(valid)));
+
+    auto datagram = datagramOf(valid);
+
+    // Truncated and too long
+    EXPECT_FALSE(wire::parse(std::span { datagram }.first(wire::HEADER_SIZE - 1)));
+    EXPECT_FALSE(wire::parse(std::span { datagram }.first(datagram.size() - 1)));
+    datagram.push_back(0);
+    EXPECT_FALSE(wire::parse(datagram));
+
+    auto modified = [&](auto change) {
+        auto header = valid;
+        change(header);
+        return datagramOf(header);
+    };
+
+    EXPECT_FALSE(wire::parse(modified([](auto &h) { h.version = wire::PROTOCOL_VERSION + 1; })));
+    EXPECT_FALSE(wire::parse(modified([](auto &h) { h.flags = 0x80; })));
+    EXPECT_FALSE(wire::parse(modified([](auto &h) { h.channel = CHANNEL_COUNT; })));
+    EXPECT_FALSE(wire::parse(modified([](auto &h) { h.fragmentCount = 0; })));
+    EXPECT_FALSE(wire::parse(modified([](auto &h) {
+        h.fragmentIndex = 3;
+        h.fragmentCount = 3;
+    })));
+    EXPECT_FALSE(wire::parse(modified([](auto &h) {
+        h.flags         = wire::Flags::Ack;
+        h.fragmentCount = 2;
+    })));
+
+    // FEC shard of reliable packets and control frames
+    EXPECT_FALSE(wire::parse(modified([](auto &h) {
+        h.flags    = wire::Flags::Reliable;
+        h.fecShard = 1;
+    })));
+    EXPECT_FALSE(wire::parse(modified([](auto &h) {
+        h.flags    = wire::Flags::Feedback;
+        h.fecShard = 1;
+    })));
+
+    // Parity without data packets in front of it
+    EXPECT_FALSE(wire::parse(modified([](auto &h) { h.flags = wire::Flags::Parity; })));
+    EXPECT_FALSE(wire::parse(modified([](auto &h) {
+        h.flags         = wire::Flags::Parity;
+        h.fragmentIndex = 1;
+        h.fragmentCount = 2;
+        h.fecShard      = 2;
+    })));
+}
+
+TEST(WireHeader, FecShard)
+{
+    wire::Header parity;
+    parity.flags         = wire::Flags::Parity;
+    parity.channel       = Channel::Video;
+    parity.sequence      = 109;
+    parity.fragmentIndex = 1;
+    parity.fragmentCount = 2;
+    parity.fecShard      = 10;
+    parity.payloadSize   = 4;
+
+    const auto datagram = datagramOf(parity);
+    EXPECT_EQ(datagram[3], 10);
+
+    // Second parity shard of a group of 8 data packets starting at 100
+    const auto parsed = wire::parse(datagram);
+    ASSERT_TRUE(parsed);
+    EXPECT_EQ(*parsed, parity);
+    EXPECT_EQ(parsed->sequence - (parsed->fecShard - 1), 100);
+    EXPECT_EQ(parsed->fecShard - 1 - parsed->fragmentIndex, 8);
+}
+
+TEST(WireHeader, InPlaceInPoolBlock)
+{
+    PacketPool pool { 64, 1, wire::PACKET_HEADROOM };
+
+    auto *payload = pool.acquire();
+    std::fill_n(payload, 8, uint8_t { 0x5A });
+
+    PacketInfo packet;
+    packet.channel = Channel::Audio;
+    packet.size    = 8;
+    packet.data    = payload;
+
+    const auto header = wire::headerBefore(packet.data);
+    wire::serialize(wire::packetHeader(packet, 7), header);
+
+    // Header and payload form one contiguous datagram, payload was not touched
+    const std::span<const uint8_t> datagram { header.data(), wire::HEADER_SIZE + packet.size };
+    const auto                     parsed = wire::parse(datagram);
+    ASSERT_TRUE(parsed);
+    EXPECT_EQ(parsed->channel, Channel::Audio);
+    EXPECT_EQ(parsed->sequence, 7);
+    EXPECT_EQ(datagram.data() + wire::HEADER_SIZE, payload);
+    EXPECT_EQ(payload[0], 0x5A);
+
+    pool.release(payload);
+}
+
+TEST(WireHeader, FuzzRandomBytes)
+{
+    std::mt19937                            random { 2 };
+    std::uniform_int_distribution<uint32_t> any;
+
+    for (int i = 0; i < FUZZ_ITERATIONS; ++i) {
+        std::vector<uint8_t> datagram(any(random) % 48);
+        for (auto &byte: datagram) {
+            byte = static_cast<uint8_t>(any(random));
+        }
+
+        // Bias towards datagrams which pass the first checks
+        if (datagram.size() >= wire::HEADER_SIZE && any(random) % 2) {
+            datagram[0] = wire::PROTOCOL_VERSION;
+            datagram[3] = 0;
+            datagram[2] = static_cast<uint8_t>(datagram[2] % CHANNEL_COUNT);
+            wire::storeBigEndian(&datagram[14],
+                                 static_cast<uint16_t>(datagram.size() - wire::HEADER_SIZE));
+        }
+
+        expectCanonical(datagram);
+    }
+}
+
+TEST(WireHeader, FuzzMutations)
+{
+    std::mt19937                            random { 3 };
+    std::uniform_int_distribution<uint32_t> any;
+
+    for (int i = 0; i < FUZZ_ITERATIONS; ++i) {
+        auto datagram = datagramOf(randomHeader(random));
+
+        switch (any(random) % 3) {
+        case 0: {
+            const auto bit = any(random) % (datagram.size() * 8);
+            datagram[bit / 8] ^= static_cast<uint8_t>(1 << (bit % 8));
+            break;
+        }
+        case 1:
+            datagram.resize(any(random) % (datagram.size() + 1));
+            break;
+        case 2:
+            datagram.resize(datagram.size() + any(random) % 8 + 1);
+            break;
+        }
+
+        expectCanonical(datagram);
+    }
+}
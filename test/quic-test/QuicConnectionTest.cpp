@@ -0,0 +1,305 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "QuicConnection.h"
+
+#ifdef WITH_OPENSSL
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#endif
+
+using namespace pirks::networking;
+using namespace pirks::networking::quic;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::size_t BLOCK_SIZE  = 1200;
+constexpr std::size_t BLOCK_COUNT = 4096;
+
+auto makePool(std::size_t headroom = QuicConnection::PACKET_HEADROOM)
+{
+    return std::make_shared<PacketPool>(BLOCK_SIZE, BLOCK_COUNT, headroom);
+}
+
+#ifdef WITH_OPENSSL
+
+/**
+ * @brief Self-signed P-256 certificate for localhost, written as PEM files
+ */
+bool makeCertificate(const std::filesystem::path &certificate, const std::filesystem::path &key)
+{
+    std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> pkey { EVP_EC_gen("P-256"), EVP_PKEY_free };
+    std::unique_ptr<X509, decltype(&X509_free)>         x509 { X509_new(), X509_free };
+    if (!pkey || !x509) {
+        return false;
+    }
+
+    X509_set_version(x509.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(x509.get()), 1);
+    X509_gmtime_adj(X509_getm_notBefore(x509.get()), 0);
+    X509_gmtime_adj(X509_getm_notAfter(x509.get()), 3600);
+    X509_set_pubkey(x509.get(), pkey.get());
+
+    auto *name = X509_get_subject_name(x509.get());
+    X509_NAME_add_entry_by_txt(
+            name,
+            "CN",
+            MBSTRING_ASC,
+            reinterpret_cast<const unsigned char *>("localhost"),
+            -1,
+            -1,
+            0);
+    X509_set_issuer_name(x509.get(), name);
+    if (X509_sign(x509.get(), pkey.get(), EVP_sha256()) == 0) {
+        return false;
+    }
+
+    std::unique_ptr<FILE, decltype(&std::fclose)> certificateFile {
+        std::fopen(certificate.string().c_str(), "wb"), std::fclose
+    };
+    std::unique_ptr<FILE, decltype(&std::fclose)> keyFile {
+        std::fopen(key.string().c_str(), "wb"), std::fclose
+    };
+    return certificateFile && keyFile && PEM_write_X509(certificateFile.get(), x509.get()) == 1
+           && PEM_write_PrivateKey(keyFile.get(), pkey.get(), nullptr, nullptr, 0, nullptr, nullptr)
+                      == 1;
+}
+
+#endif
+
+auto waitFor(const std::function<bool()> &condition, std::chrono::milliseconds timeout) -> bool
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+class QuicLoopbackTest: public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (!isAvailable()) {
+            GTEST_SKIP() << "built without QUIC";
+        }
+
+#ifdef WITH_OPENSSL
+        const auto directory = std::filesystem::temp_directory_path();
+        certificate_         = directory / "pirks-quic-test-cert.pem";
+        key_                 = directory / "pirks-quic-test-key.pem";
+        ASSERT_TRUE(makeCertificate(certificate_, key_));
+#else
+        GTEST_SKIP() << "test certificate needs OpenSSL";
+#endif
+
+        serverPool_ = makePool();
+        clientPool_ = makePool();
+
+        QuicSettings serverSettings;
+        serverSettings.certificateFile = certificate_.string();
+        serverSettings.privateKeyFile  = key_.string();
+
+        server_ = std::make_unique<QuicConnection>(serverSettings, serverPool_);
+        server_->create(serverIn_, serverOut_);
+        ASSERT_NE(server_->localPort(), 0);
+
+        QuicSettings clientSettings;
+        clientSettings.host         = "localhost";
+        clientSettings.port         = server_->localPort();
+        clientSettings.verifyServer = false;
+
+        client_ = std::make_unique<QuicConnection>(clientSettings, clientPool_);
+        client_->create(clientIn_, clientOut_);
+
+        ASSERT_TRUE(waitFor(
+                [this] {
+                    return server_->isConnected() && client_->isConnected();
+                },
+                2s));
+    }
+
+    void TearDown() override
+    {
+        client_.reset();
+        server_.reset();
+
+        std::error_code error;
+        std::filesystem::remove(certificate_, error);
+        std::filesystem::remove(key_, error);
+    }
+
+    auto makePacket(PacketPool &pool, Channel channel, bool reliable, uint32_t size)
+            -> PacketInfo
+    {
+        PacketInfo packet;
+        packet.channel  = channel;
+        packet.reliable = reliable;
+        packet.size     = size;
+        packet.data     = pool.acquire();
+        while (packet.data == nullptr) {
+            // Blocks come back when msquic is done with them
+            std::this_thread::yield();
+            packet.data = pool.acquire();
+        }
+        return packet;
+    }
+
+protected:
+    std::filesystem::path           certificate_;
+    std::filesystem::path           key_;
+    std::shared_ptr<PacketPool>     serverPool_;
+    std::shared_ptr<PacketPool>     clientPool_;
+    std::shared_ptr<PacketsQueue>   serverIn_ { std::make_shared<PacketsQueue>(BLOCK_COUNT) };
+    std::shared_ptr<PacketsQueue>   serverOut_ { std::make_shared<PacketsQueue>(BLOCK_COUNT) };
+    std::shared_ptr<PacketsQueue>   clientIn_ { std::make_shared<PacketsQueue>(BLOCK_COUNT) };
+    std::shared_ptr<PacketsQueue>   clientOut_ { std::make_shared<PacketsQueue>(BLOCK_COUNT) };
+    std::unique_ptr<QuicConnection> server_;
+    std::unique_ptr<QuicConnection> client_;
+};
+
+} // namespace
+
+TEST(QuicConnection, NotAvailableThrows)
+{
+    if (isAvailable()) {
+        GTEST_SKIP() << "built with QUIC";
+    }
+
+    QuicSettings settings;
+    settings.host = "localhost";
+    EXPECT_THROW((QuicConnection { settings, makePool() }), std::runtime_error);
+}
+
+TEST(QuicConnection, InvalidSettings)
+{
+    QuicSettings client;
+    client.host = "localhost";
+    EXPECT_THROW((QuicConnection { client, makePool(0) }), std::invalid_argument);
+
+    // Server can't do TLS handshake without credentials
+    QuicSettings server;
+    EXPECT_THROW((QuicConnection { server, makePool() }), std::invalid_argument);
+}
+
+TEST_F(QuicLoopbackTest, ReliableInOrderUnreliableAsDatagrams)
+{
+    constexpr uint32_t CONTROL_COUNT = 200;
+
+    for (uint32_t i = 0; i < CONTROL_COUNT; ++i) {
+        auto control = makePacket(*clientPool_, Channel::Control, true, sizeof(i));
+        std::memcpy(control.data, &i, sizeof(i));
+        clientOut_->push(control);
+
+        auto video = makePacket(*clientPool_, Channel::Video, false, BLOCK_SIZE);
+        std::fill_n(video.data, video.size, static_cast<uint8_t>(i));
+        video.timestamp = i;
+        clientOut_->push(video);
+    }
+
+    uint32_t nextControl = 0;
+    uint32_t video       = 0;
+    while (auto packet = serverIn_->pop(1s)) {
+        if (packet->channel == Channel::Control) {
+            EXPECT_TRUE(packet->reliable);
+            ASSERT_EQ(packet->size, sizeof(nextControl));
+
+            uint32_t value = 0;
+            std::memcpy(&value, packet->data, sizeof(value));
+            EXPECT_EQ(value, nextControl);
+            ++nextControl;
+        } else {
+            EXPECT_EQ(packet->channel, Channel::Video);
+            EXPECT_FALSE(packet->reliable);
+            EXPECT_EQ(packet->size, BLOCK_SIZE);
+            EXPECT_EQ(packet->data[BLOCK_SIZE - 1], static_cast<uint8_t>(packet->timestamp));
+            ++video;
+        }
+        serverPool_->release(packet->data);
+
+        if (nextControl == CONTROL_COUNT && video == CONTROL_COUNT) {
+            break;
+        }
+    }
+
+    // Datagrams may be lost even on loopback, reliable packets may not
+    EXPECT_EQ(nextControl, CONTROL_COUNT);
+    EXPECT_GT(video, 0u);
+
+    // Every block comes back once msquic is done with it
+    EXPECT_TRUE(waitFor(
+            [this] {
+                return clientPool_->available() == BLOCK_COUNT;
+            },
+            2s));
+}
+
+// Not a pass/fail test: reports throughput and one way latency of video
+// datagrams from server to client, 1080p60 needs about 20-50 Mbit/s
+TEST_F(QuicLoopbackTest, Throughput)
+{
+    constexpr uint32_t PACKET_COUNT = 100'000;
+
+    const auto start     = std::chrono::steady_clock::now();
+    auto       elapsedUs = [start] {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                             std::chrono::steady_clock::now() - start)
+                                             .count());
+    };
+
+    std::thread producer { [&] {
+        for (uint32_t i = 0; i < PACKET_COUNT; ++i) {
+            auto packet      = makePacket(*serverPool_, Channel::Video, false, BLOCK_SIZE);
+            packet.timestamp = elapsedUs();
+            serverOut_->push(packet);
+        }
+    } };
+
+    std::vector<uint32_t> latencyUs;
+    latencyUs.reserve(PACKET_COUNT);
+    while (auto packet = clientIn_->pop(500ms)) {
+        latencyUs.push_back(elapsedUs() - packet->timestamp);
+        clientPool_->release(packet->data);
+        if (latencyUs.size() == PACKET_COUNT) {
+            break;
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    producer.join();
+
+    ASSERT_FALSE(latencyUs.empty());
+    std::sort(latencyUs.begin(), latencyUs.end());
+
+    const auto percentile = [&latencyUs](double p) {
+        return latencyUs[static_cast<std::size_t>(p * static_cast<double>(latencyUs.size() - 1))];
+    };
+
+    const auto mbitSec = static_cast<double>(latencyUs.size() * BLOCK_SIZE * 8) / elapsed.count()
+                         / 1e6;
+    RecordProperty("datagram_mbit_per_second", std::to_string(mbitSec));
+    std::printf(
+            "QUIC loopback, %zu byte datagrams: %.1f Mbit/s, %zu of %u delivered, "
+            "latency p50 %u us, p99 %u us\n",
+            BLOCK_SIZE,
+            mbitSec,
+            latencyUs.size(),
+            PACKET_COUNT,
+            percentile(0.5),
+            percentile(0.99));
+}
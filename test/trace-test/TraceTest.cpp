@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "Trace.h"
+
+using namespace pirks::trace;
+
+namespace {
+
+// Events of all threads ever traced are in every dump, so every test uses
+// its own event names
+auto dump() -> std::string
+{
+    const std::string file = "/tmp/pirks-trace-test-" + std::to_string(::getpid()) + ".json";
+    EXPECT_TRUE(writeChromeJson(file));
+
+    std::ifstream      in { file };
+    std::ostringstream text;
+    text << in.rdbuf();
+    std::remove(file.c_str());
+    return text.str();
+}
+
+auto count(const std::string &text, const std::string &what) -> std::size_t
+{
+    std::size_t result = 0;
+    for (auto pos = text.find(what); pos != std::string::npos; pos = text.find(what, pos + 1)) {
+        ++result;
+    }
+    return result;
+}
+
+// Each test starts recording, a disabled library would record nothing
+struct Enabled
+{
+    Enabled()
+    {
+        enable();
+    }
+
+    ~Enabled()
+    {
+        enable(false);
+    }
+};
+
+} // namespace
+
+TEST(Trace, ScopeIsCompleteEvent)
+{
+    const Enabled enabled;
+
+    {
+        PIRKS_TRACE_SCOPE("test", "scope-event");
+    }
+
+    const auto text = dump();
+    EXPECT_TRUE(text.starts_with(R"({"displayTimeUnit":"ns","traceEvents":[)")) << text;
+    EXPECT_TRUE(text.ends_with("]}\n"));
+    EXPECT_EQ(count(text, R"({"name":"scope-event","cat":"test","ph":"X","ts":)"), 1u);
+}
+
+TEST(Trace, DurationInMicroseconds)
+{
+    const Enabled enabled;
+
+    {
+        PIRKS_TRACE_SCOPE("test", "sleep-event");
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    const auto text = dump();
+    const auto pos  = text.find(R"("dur":)", text.find("sleep-event"));
+    ASSERT_NE(pos, std::string::npos);
+
+    const auto duration = std::stod(text.substr(pos + 6));
+    EXPECT_GE(duration, 2000.0);
+    EXPECT_LT(duration, 1'000'000.0);
+}
+
+TEST(Trace, InstantEvent)
+{
+    const Enabled enabled;
+
+    PIRKS_TRACE_INSTANT("test", "instant-event");
+
+    EXPECT_EQ(count(dump(), R"({"name":"instant-event","cat":"test","ph":"i","s":"t")"), 1u);
+}
+
+TEST(Trace, NothingRecordedWhenDisabled)
+{
+    enable(false);
+
+    {
+        PIRKS_TRACE_SCOPE("test", "disabled-event");
+    }
+    PIRKS_TRACE_INSTANT("test", "disabled-event");
+
+    EXPECT_EQ(count(dump(), "disabled-event"), 0u);
+}
+
+TEST(Trace, ThreadName)
+{
+    const Enabled enabled;
+
+    std::thread thread { [] {
+        setThreadName("named-thread");
+        PIRKS_TRACE_INSTANT("test", "named-thread-event");
+    } };
+    thread.join();
+
+    // Ring of the exited thread keeps its events
+    const auto text = dump();
+    EXPECT_EQ(count(text, R"("args":{"name":"named-thread"})"), 1u);
+    EXPECT_EQ(count(text, "named-thread-event"), 1u);
+}
+
+TEST(Trace, OldestEventsAreOverwritten)
+{
+    const Enabled enabled;
+
+    std::thread thread { [] {
+        for (std::size_t i = 0; i < RING_CAPACITY + 100; ++i) {
+            PIRKS_TRACE_INSTANT("test", "overwritten-event");
+        }
+    } };
+    thread.join();
+
+    // Oldest slot is the one being written next, so it's skipped as well
+    EXPECT_EQ(count(dump(), "overwritten-event"), RING_CAPACITY - 1);
+}
+
+// Writer overwrites events while they are dumped, a torn event would have
+// its category and name from different events
+TEST(Trace, DumpWhileRecording)
+{
+    std::atomic_bool stop { false };
+    std::thread      writer { [&stop] {
+        for (uint64_t i = 0; !stop; ++i) {
+            const char *name = i % 2 == 0 ? "torn-even" : "torn-odd";
+            pirks::trace::detail::record(name, name, now(), 1);
+        }
+    } };
+
+    for (int i = 0; i < 10; ++i) {
+        const auto text = dump();
+
+        std::size_t events = 0;
+        std::size_t pos    = 0;
+        while ((pos = text.find(R"({"name":"torn-)", pos)) != std::string::npos) {
+            const auto event = text.substr(pos, text.find('}', pos) - pos);
+            pos += event.size();
+
+            const bool even = event.starts_with(R"({"name":"torn-even","cat":"torn-even")");
+            const bool odd  = event.starts_with(R"({"name":"torn-odd","cat":"torn-odd")");
+            ASSERT_TRUE(even || odd) << event;
+            ++events;
+        }
+        EXPECT_LE(events, RING_CAPACITY);
+    }
+
+    stop = true;
+    writer.join();
+}
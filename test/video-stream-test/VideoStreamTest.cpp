@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "VideoStream.h"
+
+using namespace pirks;
+using namespace pirks::networking;
+using namespace video;
+using namespace video::encode_video;
+
+namespace {
+
+constexpr std::uint32_t WIDTH  = 64;
+constexpr std::uint32_t HEIGHT = 64;
+
+// Multiples of PacketPool::BLOCK_ALIGNMENT, so the pools don't round them up
+constexpr std::size_t BLOCK_SIZE       = 1024;
+constexpr std::size_t FRAME_BLOCK_SIZE = 4096;
+
+// Reports the same slice for every frame, as the real encoder would from
+// its callback
+class StubEncoder final : public IVideoEncoder
+{
+public:
+    StubEncoder(const EncoderSettings &settings, std::vector<std::uint8_t> slice)
+            : settings_ { settings }
+            , slice_ { std::move(slice) }
+    {
+    }
+
+    auto encode(const I420Frame &, const SliceCallback &on_slice) -> EncodeStats override
+    {
+        on_slice(EncodedSlice { slice_, frameIndex_++, 5 });
+
+        EncodeStats stats;
+        stats.bytes  = slice_.size();
+        stats.slices = 1;
+        return stats;
+    }
+
+    void requestKeyFrame() override {}
+
+    void setBitrate(std::uint32_t bitrate_kbps) override
+    {
+        settings_.bitrateKbps = bitrate_kbps;
+    }
+
+    auto settings() const -> const EncoderSettings & override
+    {
+        return settings_;
+    }
+
+private:
+    EncoderSettings           settings_;
+    std::vector<std::uint8_t> slice_;
+    std::uint64_t             frameIndex_ { 0 };
+};
+
+// IDR slice in Annex B format with a payload nothing else would produce
+auto makeSlice(std::size_t size) -> std::vector<std::uint8_t>
+{
+    std::vector<std::uint8_t> slice(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        slice[i] = static_cast<std::uint8_t>(i * 13 + 7);
+    }
+    const std::uint8_t startCode[] = { 0, 0, 0, 1, 0x65 };
+    std::memcpy(slice.data(), startCode, sizeof(startCode));
+    return slice;
+}
+
+class VideoStreamTest : public ::testing::Test
+{
+protected:
+    auto submit(const std::vector<std::uint8_t> &slice) -> VideoFrameStats
+    {
+        VideoStream stream { EncoderSettings {}, pool_, out_ };
+        stream.setFramePool(framePool_);
+        stream.setEncoderFactory([&slice](const EncoderSettings &settings) {
+            return std::make_unique<StubEncoder>(settings, slice);
+        });
+
+        const std::vector<std::uint8_t> pixels(std::size_t { WIDTH } * HEIGHT * 4, 0x80);
+        return stream.submit(FrameView { pixels.data(), WIDTH, HEIGHT, WIDTH * 4, 4 });
+    }
+
+    auto popAll() -> std::vector<PacketInfo>
+    {
+        // pop() waits when the queue is empty
+        std::vector<PacketInfo> packets;
+        while (out_->size() != 0) {
+            packets.push_back(*out_->pop());
+        }
+        return packets;
+    }
+
+    std::shared_ptr<PacketPool>   pool_ { std::make_shared<PacketPool>(BLOCK_SIZE, 16) };
+    std::shared_ptr<PacketPool>   framePool_ { std::make_shared<PacketPool>(FRAME_BLOCK_SIZE, 2) };
+    std::shared_ptr<PacketsQueue> out_ { std::make_shared<PacketsQueue>() };
+};
+
+} // namespace
+
+TEST_F(VideoStreamTest, SliceFitsFrameBlock)
+{
+    const auto slice = makeSlice(FRAME_BLOCK_SIZE);
+    const auto stats = submit(slice);
+    EXPECT_EQ(stats.packets, 1u);
+
+    const auto packets = popAll();
+    ASSERT_EQ(packets.size(), 1u);
+    EXPECT_TRUE(framePool_->owns(packets[0].data));
+    EXPECT_EQ(packets[0].channel, Channel::Video);
+    ASSERT_EQ(packets[0].size, slice.size());
+    EXPECT_EQ(std::memcmp(packets[0].data, slice.data(), slice.size()), 0);
+
+    framePool_->release(packets[0].data);
+}
+
+TEST_F(VideoStreamTest, OversizeSliceIsSplit)
+{
+    // Doesn't fit a frames block, so goes in packet blocks, last one partly filled
+    const auto slice = makeSlice(FRAME_BLOCK_SIZE + 1);
+    const auto stats = submit(slice);
+
+    const auto packets = popAll();
+    ASSERT_EQ(packets.size(), 5u);
+    EXPECT_EQ(stats.packets, packets.size());
+
+    // Receiver gets the Annex B byte stream back by joining the packets
+    std::vector<std::uint8_t> joined;
+    for (const auto &packet: packets) {
+        EXPECT_TRUE(pool_->owns(packet.data));
+        EXPECT_EQ(packet.channel, Channel::Video);
+        EXPECT_FALSE(packet.reliable);
+        EXPECT_EQ(packet.timestamp, packets[0].timestamp);
+        EXPECT_LE(packet.size, BLOCK_SIZE);
+
+        joined.insert(joined.end(), packet.data, packet.data + packet.size);
+        pool_->release(packet.data);
+    }
+    EXPECT_EQ(packets.back().size, 1u);
+    EXPECT_EQ(joined, slice);
+}
+
+TEST_F(VideoStreamTest, OversizeSliceWithoutBlocks)
+{
+    // Split stops at the first packet without a block, the rest of the slice
+    // is useless to the receiver anyway
+    std::vector<std::uint8_t *> taken;
+    while (pool_->available() > 2) {
+        taken.push_back(pool_->acquire());
+    }
+
+    const auto stats = submit(makeSlice(FRAME_BLOCK_SIZE * 2));
+    EXPECT_EQ(stats.packets, 2u);
+
+    for (const auto &packet: popAll()) {
+        pool_->release(packet.data);
+    }
+    for (auto *block: taken) {
+        pool_->release(block);
+    }
+}
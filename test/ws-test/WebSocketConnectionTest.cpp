@@ -0,0 +1,414 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "WebSocketConnection.h"
+
+using namespace pirks::networking;
+using namespace pirks::networking::ws;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::size_t BLOCK_SIZE  = 1400;
+constexpr std::size_t BLOCK_COUNT = 4096;
+
+auto makePool(std::size_t headroom = WebSocketConnection::PACKET_HEADROOM)
+{
+    return std::make_shared<PacketPool>(BLOCK_SIZE, BLOCK_COUNT, headroom);
+}
+
+auto waitFor(const std::function<bool()> &condition, std::chrono::milliseconds timeout) -> bool
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+class MessageReaderTest: public ::testing::Test
+{
+protected:
+    /**
+     * @brief Message of a packet with size bytes of payload, sent from a block of the pool
+     */
+    auto makeMessage(Channel channel, bool reliable, uint32_t size) -> std::vector<uint8_t>
+    {
+        PacketInfo packet;
+        packet.channel       = channel;
+        packet.reliable      = reliable;
+        packet.size          = size;
+        packet.timestamp     = 0x01020304;
+        packet.fragmentIndex = 1;
+        packet.fragmentCount = 2;
+        packet.data          = senderPool_->acquire();
+        std::iota(packet.data, packet.data + size, uint8_t { 0 });
+
+        const auto message = frameMessage(packet, 7);
+        std::vector<uint8_t> result { message.begin(), message.end() };
+        senderPool_->release(packet.data);
+        return result;
+    }
+
+protected:
+    std::shared_ptr<PacketPool> senderPool_ { makePool() };
+    std::shared_ptr<PacketPool> pool_ { makePool() };
+    MessageReader               reader_ { pool_ };
+};
+
+class WebSocketLoopbackTest: public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (!isAvailable()) {
+            GTEST_SKIP() << "built without libwebsockets";
+        }
+
+        server_ = std::make_unique<WebSocketConnection>(WebSocketSettings {}, serverPool_);
+        server_->create(serverIn_, serverOut_);
+        ASSERT_NE(server_->localPort(), 0);
+
+        WebSocketSettings clientSettings;
+        clientSettings.host = "127.0.0.1";
+        clientSettings.port = server_->localPort();
+
+        client_ = std::make_unique<WebSocketConnection>(clientSettings, clientPool_);
+        client_->create(clientIn_, clientOut_);
+
+        ASSERT_TRUE(waitFor(
+                [this] {
+                    return server_->isConnected() && client_->isConnected();
+                },
+                2s));
+    }
+
+    auto makePacket(PacketPool &pool, Channel channel, bool reliable, uint32_t size)
+            -> PacketInfo
+    {
+        PacketInfo packet;
+        packet.channel  = channel;
+        packet.reliable = reliable;
+        packet.size     = size;
+        packet.data     = pool.acquire();
+        while (packet.data == nullptr) {
+            // Blocks come back when packets are written to the socket
+            std::this_thread::yield();
+            packet.data = pool.acquire();
+        }
+        return packet;
+    }
+
+protected:
+    std::shared_ptr<PacketPool>   serverPool_ { makePool() };
+    std::shared_ptr<PacketPool>   clientPool_ { makePool() };
+    std::shared_ptr<PacketsQueue> serverIn_ { std::make_shared<PacketsQueue>(BLOCK_COUNT) };
+    std::shared_ptr<PacketsQueue> serverOut_ { std::make_shared<PacketsQueue>(BLOCK_COUNT) };
+    std::shared_ptr<PacketsQueue> clientIn_ { std::make_shared<PacketsQueue>(BLOCK_COUNT) };
+    std::shared_ptr<PacketsQueue> clientOut_ { std::make_shared<PacketsQueue>(BLOCK_COUNT) };
+    std::unique_ptr<WebSocketConnection> server_;
+    std::unique_ptr<WebSocketConnection> client_;
+};
+
+} // namespace
+
+TEST(WebSocketConnection, NotAvailableThrows)
+{
+    if (isAvailable()) {
+        GTEST_SKIP() << "built with libwebsockets";
+    }
+
+    EXPECT_THROW((WebSocketConnection { WebSocketSettings {}, makePool() }), std::runtime_error);
+}
+
+TEST(WebSocketConnection, PoolWithoutHeadroom)
+{
+    EXPECT_THROW(
+            (WebSocketConnection { WebSocketSettings {}, makePool(0) }),
+            std::invalid_argument);
+}
+
+TEST_F(MessageReaderTest, FramedPacketRoundTrip)
+{
+    const auto message = makeMessage(Channel::Video, false, 100);
+    ASSERT_EQ(message.size(), wire::HEADER_SIZE + 100);
+
+    // Header and payload split between fragments
+    const auto data = std::span<const uint8_t> { message };
+    EXPECT_FALSE(reader_.add(data.first(5), true, false));
+    EXPECT_FALSE(reader_.add(data.subspan(5, 20), true, false));
+    const auto packet = reader_.add(data.subspan(25), true, true);
+
+    ASSERT_TRUE(packet);
+    EXPECT_EQ(packet->channel, Channel::Video);
+    EXPECT_FALSE(packet->reliable);
+    EXPECT_EQ(packet->sequence, 7);
+    EXPECT_EQ(packet->size, 100u);
+    EXPECT_EQ(packet->timestamp, 0x01020304u);
+    EXPECT_EQ(packet->fragmentIndex, 1);
+    EXPECT_EQ(packet->fragmentCount, 2);
+    EXPECT_TRUE(pool_->owns(packet->data));
+    EXPECT_TRUE(std::equal(packet->data, packet->data + 100, &data[wire::HEADER_SIZE]));
+    pool_->release(packet->data);
+
+    // Next message starts from scratch
+    const auto control = reader_.add(makeMessage(Channel::Control, true, 0), true, true);
+    ASSERT_TRUE(control);
+    EXPECT_EQ(control->channel, Channel::Control);
+    EXPECT_TRUE(control->reliable);
+    EXPECT_EQ(control->size, 0u);
+    pool_->release(control->data);
+
+    EXPECT_EQ(pool_->available(), BLOCK_COUNT);
+}
+
+TEST_F(MessageReaderTest, MalformedMessagesDropped)
+{
+    const auto message = makeMessage(Channel::Control, true, 8);
+
+    // Text message
+    EXPECT_FALSE(reader_.add(message, false, true));
+
+    // Shorter or longer than the header says
+    EXPECT_FALSE(reader_.add(std::span { message }.first(message.size() - 1), true, true));
+    EXPECT_FALSE(reader_.add(message, true, false));
+    EXPECT_FALSE(reader_.add(message, true, true));
+
+    // Header only in part
+    EXPECT_FALSE(reader_.add(std::span { message }.first(4), true, true));
+
+    // Acknowledgements are not sent over WebSocket
+    auto ack = message;
+    ack[1]   = wire::Flags::Ack;
+    EXPECT_FALSE(reader_.add(ack, true, true));
+
+    // Bigger than a block
+    std::vector<uint8_t> oversize(wire::HEADER_SIZE + BLOCK_SIZE + 1);
+    std::copy_n(message.begin(), wire::HEADER_SIZE, oversize.begin());
+    EXPECT_FALSE(reader_.add(oversize, true, true));
+
+    EXPECT_EQ(pool_->available(), BLOCK_COUNT);
+
+    // Reader recovers after every one of them
+    const auto packet = reader_.add(message, true, true);
+    ASSERT_TRUE(packet);
+    pool_->release(packet->data);
+}
+
+TEST_F(MessageReaderTest, NoBlockForMessage)
+{
+    std::vector<uint8_t *> blocks;
+    while (auto *block = pool_->acquire()) {
+        blocks.push_back(block);
+    }
+
+    const auto message = makeMessage(Channel::Video, false, 8);
+    EXPECT_FALSE(reader_.add(message, true, true));
+
+    pool_->release(blocks.back());
+    blocks.pop_back();
+    const auto packet = reader_.add(message, true, true);
+    ASSERT_TRUE(packet);
+    pool_->release(packet->data);
+
+    for (auto *block : blocks) {
+        pool_->release(block);
+    }
+}
+
+TEST_F(MessageReaderTest, ResetDropsMessage)
+{
+    const auto message = makeMessage(Channel::Video, false, 8);
+    EXPECT_FALSE(reader_.add(std::span { message }.first(20), true, false));
+    EXPECT_EQ(pool_->available(), BLOCK_COUNT - 1);
+
+    reader_.reset();
+    EXPECT_EQ(pool_->available(), BLOCK_COUNT);
+
+    const auto packet = reader_.add(message, true, true);
+    ASSERT_TRUE(packet);
+    pool_->release(packet->data);
+}
+
+TEST_F(WebSocketLoopbackTest, EveryPacketInOrder)
+{
+    constexpr uint32_t COUNT = 200;
+
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        auto control = makePacket(*clientPool_, Channel::Control, true, sizeof(i));
+        std::memcpy(control.data, &i, sizeof(i));
+        control.timestamp = i;
+        clientOut_->push(control);
+
+        auto video = makePacket(*clientPool_, Channel::Video, false, BLOCK_SIZE);
+        std::fill_n(video.data, video.size, static_cast<uint8_t>(i));
+        video.timestamp     = i;
+        video.fragmentIndex = 1;
+        video.fragmentCount = 3;
+        clientOut_->push(video);
+    }
+
+    // WebSocket runs over TCP, unreliable packets arrive too
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        const auto control = serverIn_->pop(1s);
+        ASSERT_TRUE(control);
+        EXPECT_EQ(control->channel, Channel::Control);
+        EXPECT_TRUE(control->reliable);
+        ASSERT_EQ(control->size, sizeof(i));
+
+        uint32_t value = 0;
+        std::memcpy(&value, control->data, sizeof(value));
+        EXPECT_EQ(value, i);
+        EXPECT_EQ(control->timestamp, i);
+        serverPool_->release(control->data);
+
+        const auto video = serverIn_->pop(1s);
+        ASSERT_TRUE(video);
+        EXPECT_EQ(video->channel, Channel::Video);
+        EXPECT_FALSE(video->reliable);
+        EXPECT_EQ(video->size, BLOCK_SIZE);
+        EXPECT_EQ(video->timestamp, i);
+        EXPECT_EQ(video->fragmentIndex, 1);
+        EXPECT_EQ(video->fragmentCount, 3);
+        EXPECT_EQ(video->data[BLOCK_SIZE - 1], static_cast<uint8_t>(i));
+        serverPool_->release(video->data);
+    }
+
+    // Blocks are released as soon as they are written
+    EXPECT_TRUE(waitFor(
+            [this] {
+                return clientPool_->available() == BLOCK_COUNT;
+            },
+            2s));
+}
+
+#ifdef WITH_LIBWEBSOCKETS
+
+TEST_F(WebSocketLoopbackTest, RoundTrip)
+{
+    constexpr uint32_t COUNT = 100;
+
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        const bool reliable = i % 2 == 0;
+        const auto channel  = reliable ? Channel::Control : Channel::Video;
+        const auto size     = static_cast<uint32_t>(BLOCK_SIZE - i);
+
+        auto packet = makePacket(*clientPool_, channel, reliable, size);
+        std::fill_n(packet.data, packet.size, static_cast<uint8_t>(i));
+        packet.timestamp     = i;
+        packet.fragmentIndex = static_cast<uint16_t>(i % 3);
+        packet.fragmentCount = 3;
+        clientOut_->push(packet);
+    }
+
+    // Server sends every packet back from the block it arrived in
+    std::thread echo { [this] {
+        for (uint32_t i = 0; i < COUNT; ++i) {
+            const auto packet = serverIn_->pop(1s);
+            if (!packet) {
+                return;
+            }
+            serverOut_->push(*packet);
+        }
+    } };
+
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        const auto packet = clientIn_->pop(2s);
+        ASSERT_TRUE(packet);
+
+        const bool reliable = i % 2 == 0;
+        EXPECT_EQ(packet->channel, reliable ? Channel::Control : Channel::Video);
+        EXPECT_EQ(packet->reliable, reliable);
+        EXPECT_EQ(packet->size, BLOCK_SIZE - i);
+        EXPECT_EQ(packet->timestamp, i);
+        EXPECT_EQ(packet->fragmentIndex, i % 3);
+        EXPECT_EQ(packet->fragmentCount, 3);
+        EXPECT_EQ(packet->data[0], static_cast<uint8_t>(i));
+        EXPECT_EQ(packet->data[packet->size - 1], static_cast<uint8_t>(i));
+        clientPool_->release(packet->data);
+    }
+
+    echo.join();
+
+    EXPECT_TRUE(waitFor(
+            [this] {
+                return clientPool_->available() == BLOCK_COUNT
+                       && serverPool_->available() == BLOCK_COUNT;
+            },
+            2s));
+}
+
+#endif
+
+// Not a pass/fail test: reports throughput, one way latency and CPU time of
+// video packets from server to client. 1080p60 needs about 20-50 Mbit/s, CPU
+// time of both sides less than the elapsed time means one core carries it.
+TEST_F(WebSocketLoopbackTest, Throughput)
+{
+    constexpr uint32_t PACKET_COUNT = 100'000;
+
+    const auto startCpu  = std::clock();
+    const auto start     = std::chrono::steady_clock::now();
+    auto       elapsedUs = [start] {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                             std::chrono::steady_clock::now() - start)
+                                             .count());
+    };
+
+    std::thread producer { [&] {
+        for (uint32_t i = 0; i < PACKET_COUNT; ++i) {
+            auto packet      = makePacket(*serverPool_, Channel::Video, false, BLOCK_SIZE);
+            packet.timestamp = elapsedUs();
+            serverOut_->push(packet);
+        }
+    } };
+
+    std::vector<uint32_t> latencyUs;
+    latencyUs.reserve(PACKET_COUNT);
+    while (auto packet = clientIn_->pop(500ms)) {
+        latencyUs.push_back(elapsedUs() - packet->timestamp);
+        clientPool_->release(packet->data);
+        if (latencyUs.size() == PACKET_COUNT) {
+            break;
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const auto cpuSeconds = static_cast<double>(std::clock() - startCpu) / CLOCKS_PER_SEC;
+
+    producer.join();
+
+    ASSERT_EQ(latencyUs.size(), PACKET_COUNT);
+    std::sort(latencyUs.begin(), latencyUs.end());
+
+    const auto percentile = [&latencyUs](double p) {
+        return latencyUs[static_cast<std::size_t>(p * static_cast<double>(latencyUs.size() - 1))];
+    };
+
+    const auto mbitSec = static_cast<double>(latencyUs.size() * BLOCK_SIZE * 8) / elapsed.count()
+                         / 1e6;
+    RecordProperty("mbit_per_second", std::to_string(mbitSec));
+    RecordProperty("cpu_cores", std::to_string(cpuSeconds / elapsed.count()));
+    std::printf(
+            "WebSocket loopback, %zu byte packets: %.1f Mbit/s, CPU %.2f of a core, "
+            "latency p50 %u us, p99 %u us\n",
+            BLOCK_SIZE,
+            mbitSec,
+            cpuSeconds / elapsed.count(),
+            percentile(0.5),
+            percentile(0.99));
+}